@@ -3,20 +3,37 @@ import struct
 import random
 import enum
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
+CURRENT_REQUEST_VERSION = 2
+MAX_REQUEST_DATA_SIZE = 0x100000
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadMemoryGather = 3,
+    WriteMemoryScatter = 4,
+    SetWatchList = 5,
+    WatchListUpdate = 6
+
+class ReplyStatus(enum.IntEnum):
+    Success = 0,
+    InvalidRequest = 1,
+    AddressNotWritable = 2
+
+class RequestError(Exception):
+    def __init__(self, status):
+        super().__init__("Citra rejected the request: " + str(status))
+        self.status = status
 
 CITRA_PORT = "45987"
+CITRA_WATCH_PORT = "45988"
 
 class Citra:
-    def __init__(self, address="127.0.0.1", port=CITRA_PORT):
+    def __init__(self, address="127.0.0.1", port=CITRA_PORT, watch_port=CITRA_WATCH_PORT):
         self.context = zmq.Context()
         self.socket = self.context.socket(zmq.REQ)
         self.socket.connect("tcp://" + address + ":" + port)
+        self.watch_address = "tcp://" + address + ":" + watch_port
+        self.watch_socket = None
 
     def is_connected(self):
         return self.socket is not None
@@ -25,6 +42,30 @@ class Citra:
         request_id = random.getrandbits(32)
         return (struct.pack("IIII", CURRENT_REQUEST_VERSION, request_id, request_type, data_size), request_id)
 
+    def _request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        self.socket.send(request + request_data)
+        return self._read_and_validate_header(self.socket.recv(), request_id, request_type)
+
+    @staticmethod
+    def _check_status(reply_data):
+        """Raises RequestError if Citra rejected a request which doesn't return data"""
+        if reply_data is None:
+            return False
+        if len(reply_data) != 4:
+            raise RequestError(ReplyStatus.InvalidRequest)
+        status, = struct.unpack("I", reply_data)
+        if status != ReplyStatus.Success:
+            raise RequestError(ReplyStatus(status))
+        return True
+
+    @staticmethod
+    def _pack_ranges(ranges):
+        request_data = struct.pack("I", len(ranges))
+        for address, size in ranges:
+            request_data += struct.pack("II", address, size)
+        return request_data
+
     def _read_and_validate_header(self, raw_reply, expected_id, expected_type):
         reply_version, reply_id, reply_type, reply_data_size = struct.unpack("IIII", raw_reply[:4*4])
         if (CURRENT_REQUEST_VERSION == reply_version and
@@ -69,6 +110,8 @@ class Citra:
         True
         >>> c.read_memory(0x100000, 4)
         b'\\x07\\x00\\x00\\xeb'
+
+        Raises RequestError if a write isn't within the regions scripts may write to.
         """
         write_size = len(write_contents)
         while write_size > 0:
@@ -82,7 +125,7 @@ class Citra:
             raw_reply = self.socket.recv()
             reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.WriteMemory)
 
-            if None != reply_data:
+            if self._check_status(reply_data):
                 write_address += temp_write_size
                 write_size -= temp_write_size
                 write_contents = write_contents[temp_write_size:]
@@ -90,6 +133,73 @@ class Citra:
                 return False
         return True
 
+    def read_memory_ranges(self, ranges):
+        """
+        Reads several (address, size) ranges in a single request.
+        >>> c.read_memory_ranges([(0x100000, 4), (0x100000, 2)])
+        [b'\\x07\\x00\\x00\\xeb', b'\\x07\\x00']
+        """
+        reply_data = self._request(RequestType.ReadMemoryGather, self._pack_ranges(ranges))
+        if not reply_data and ranges:
+            return None
+        result = []
+        for _, size in ranges:
+            result.append(reply_data[:size])
+            reply_data = reply_data[size:]
+        return result
+
+    def write_memory_ranges(self, writes):
+        """
+        Writes several (address, contents) pairs in a single request.
+        >>> c.write_memory_ranges([(0x100000, b"\\xff\\xff"), (0x100002, b"\\xff\\xff")])
+        True
+        >>> c.read_memory(0x100000, 4)
+        b'\\xff\\xff\\xff\\xff'
+        >>> c.write_memory_ranges([(0x100000, b"\\x07\\x00\\x00\\xeb")])
+        True
+
+        Nothing is written if any of the writes isn't within the regions scripts may write to, in
+        which case RequestError is raised.
+        """
+        request_data = struct.pack("I", len(writes))
+        for address, contents in writes:
+            request_data += struct.pack("II", address, len(contents)) + contents
+        return self._check_status(self._request(RequestType.WriteMemoryScatter, request_data))
+
+    def set_watch_list(self, ranges):
+        """
+        Sets the (address, size) ranges which are published by watch_updates whenever they change
+        at the end of a frame. An empty list stops the updates. Raises RequestError if the list is
+        too long.
+        >>> c.set_watch_list([(0x100000, 4)])
+        True
+        """
+        return self._check_status(self._request(RequestType.SetWatchList, self._pack_ranges(ranges)))
+
+    def watch_updates(self):
+        """
+        Yields (frame_number, [(address, contents), ...]) with the watched ranges which changed,
+        once per frame. All watched ranges are reported on the first frame after set_watch_list.
+        """
+        if self.watch_socket is None:
+            self.watch_socket = self.context.socket(zmq.SUB)
+            self.watch_socket.setsockopt(zmq.SUBSCRIBE, b"")
+            self.watch_socket.connect(self.watch_address)
+        while True:
+            raw_update = self.watch_socket.recv()
+            version, frame_number, update_type, data_size = struct.unpack("IIII", raw_update[:4*4])
+            data = raw_update[4*4:]
+            if update_type != RequestType.WatchListUpdate or data_size != len(data):
+                continue
+            count, = struct.unpack("I", data[:4])
+            offset = 4
+            changes = []
+            for _ in range(count):
+                address, size = struct.unpack("II", data[offset:offset + 8])
+                changes.append((address, data[offset + 8:offset + 8 + size]))
+                offset += 8 + size
+            yield frame_number, changes
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
@@ -12,6 +12,8 @@
 #include "common/ring_buffer.h"
 #include "core/memory.h"
 
+class PointerWrap;
+
 namespace Service {
 namespace DSP {
 class DSP_DSP;
@@ -94,6 +96,9 @@ public:
     /// Unloads the DSP program
     virtual void UnloadComponent() = 0;
 
+    /// Serializes or deserializes the DSP state, excluding the contents of DSP memory
+    virtual void DoState(PointerWrap& p) = 0;
+
     /// Select the sink to use based on sink id.
     void SetSink(const std::string& sink_id, const std::string& audio_device);
     /// Get the current sink
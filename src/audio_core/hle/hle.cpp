@@ -14,6 +14,7 @@
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
@@ -44,6 +45,8 @@ public:
 
     void SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp);
 
+    void DoState(PointerWrap& p);
+
 private:
     void ResetPipes();
     void WriteU16(DspPipe pipe_number, u16 value);
@@ -266,6 +269,22 @@ void DspHle::Impl::SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp) {
     dsp_dsp = std::move(dsp);
 }
 
+void DspHle::Impl::DoState(PointerWrap& p) {
+    auto s = p.Section("DspHle", 1);
+    if (!s)
+        return;
+
+    // DSP RAM itself is saved along with the rest of physical memory
+    p.Do(dsp_state);
+    for (auto& pipe : pipe_data) {
+        p.Do(pipe);
+    }
+    for (auto& source : sources) {
+        source.DoState(p);
+    }
+    mixers.DoState(p);
+}
+
 void DspHle::Impl::ResetPipes() {
     for (auto& data : pipe_data) {
         data.clear();
@@ -386,6 +405,9 @@ bool DspHle::Impl::Tick() {
 }
 
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
+    Core::PerfStats::SubsystemScope subsystem_scope{Core::System::GetInstance().perf_stats,
+                                                    Core::PerfStats::Subsystem::Audio};
+
     if (Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         if (auto service = dsp_dsp.lock()) {
@@ -450,4 +472,8 @@ void DspHle::UnloadComponent() {
     // Do nothing
 }
 
+void DspHle::DoState(PointerWrap& p) {
+    impl->DoState(p);
+}
+
 } // namespace AudioCore
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include "audio_core/hle/mixers.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 
 namespace AudioCore {
@@ -16,6 +17,13 @@ void Mixers::Reset() {
     state = {};
 }
 
+void Mixers::DoState(PointerWrap& p) {
+    static_assert(std::is_trivially_copyable_v<decltype(state)>,
+                  "Mixer state must be trivially copyable");
+    p.Do(current_frame);
+    p.DoVoid(&state, sizeof(state));
+}
+
 DspStatus Mixers::Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                        IntermediateMixSamples& write_samples,
                        const std::array<QuadFrame32, 3>& input) {
@@ -8,6 +8,8 @@
 #include "audio_core/audio_types.h"
 #include "audio_core/hle/shared_memory.h"
 
+class PointerWrap;
+
 namespace AudioCore {
 namespace HLE {
 
@@ -26,6 +28,9 @@ public:
         return current_frame;
     }
 
+    /// Serializes or deserializes the internal state of the mixers.
+    void DoState(PointerWrap& p);
+
 private:
     StereoFrame16 current_frame = {};
 
@@ -9,6 +9,7 @@
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
@@ -45,6 +46,53 @@ void Source::Reset() {
     state = {};
 }
 
+void Source::DoState(PointerWrap& p) {
+    static_assert(std::is_trivially_copyable_v<Buffer>, "Buffer must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<SourceFilters>,
+                  "SourceFilters must be trivially copyable");
+
+    p.Do(current_frame);
+
+    p.Do(state.enabled);
+    p.Do(state.sync);
+    p.Do(state.gain);
+
+    // std::priority_queue doesn't expose its container, so drain it into a vector and rebuild it.
+    std::vector<Buffer> queue;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        auto copy = state.input_queue;
+        for (; !copy.empty(); copy.pop()) {
+            queue.push_back(copy.top());
+        }
+    }
+    u32 queue_size = static_cast<u32>(queue.size());
+    p.Do(queue_size);
+    queue.resize(queue_size);
+    if (queue_size > 0) {
+        p.DoVoid(queue.data(), static_cast<int>(queue_size * sizeof(Buffer)));
+    }
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        state.input_queue = {};
+        for (const Buffer& buffer : queue) {
+            state.input_queue.push(buffer);
+        }
+    }
+
+    p.Do(state.mono_or_stereo);
+    p.Do(state.format);
+    p.Do(state.current_sample_number);
+    p.Do(state.next_sample_number);
+    p.Do(state.current_buffer);
+    p.Do(state.buffer_update);
+    p.Do(state.current_buffer_id);
+    p.Do(state.adpcm_coeffs);
+    p.Do(state.adpcm_state);
+    p.Do(state.rate_multiplier);
+    p.Do(state.interpolation_mode);
+    p.DoVoid(&state.interp_state, sizeof(state.interp_state));
+    p.DoVoid(&state.filters, sizeof(state.filters));
+}
+
 void Source::SetMemory(Memory::MemorySystem& memory) {
     memory_system = &memory;
 }
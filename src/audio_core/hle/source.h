@@ -14,6 +14,8 @@
 #include "audio_core/interpolate.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace Memory {
 class MemorySystem;
 }
@@ -61,6 +63,9 @@ public:
      */
     void MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const;
 
+    /// Serializes or deserializes the internal state of this source.
+    void DoState(PointerWrap& p);
+
 private:
     const std::size_t source_id;
     Memory::MemorySystem* memory_system;
@@ -9,6 +9,7 @@
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/chunk_file.h"
 #include "common/swap.h"
 #include "common/thread.h"
 #include "core/core.h"
@@ -473,6 +474,12 @@ void DspLle::UnloadComponent() {
     impl->UnloadComponent();
 }
 
+void DspLle::DoState(PointerWrap& p) {
+    // Teakra does not expose its internal state, so LLE sessions can't be snapshotted yet.
+    LOG_ERROR(Audio_DSP, "Save states are not supported with DSP LLE");
+    p.SetError(PointerWrap::ERROR_FAILURE);
+}
+
 DspLle::DspLle(Memory::MemorySystem& memory, bool multithread)
     : impl(std::make_unique<Impl>(multithread)) {
     Teakra::AHBMCallback ahbm;
@@ -103,6 +103,8 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.idle_fast_forward =
+        sdl2_config->GetBoolean("Core", "idle_fast_forward", true);
 
     // Renderer
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", true);
@@ -119,6 +121,15 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_gpu_thread = sdl2_config->GetBoolean("Renderer", "use_gpu_thread", false);
+    Settings::values.use_disk_shader_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "sw_rasterizer_threads", 1));
+    Settings::values.vertex_cache_size =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "vertex_cache_size", 256));
+    Settings::values.surface_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "surface_cache_budget", 1024));
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.use_frame_limit = sdl2_config->GetBoolean("Renderer", "use_frame_limit", true);
@@ -219,6 +230,10 @@ void Config::ReadValues() {
 
     // Miscellaneous
     Settings::values.log_filter = sdl2_config->GetString("Miscellaneous", "log_filter", "*:Info");
+    Settings::values.log_deferred_formatting =
+        sdl2_config->GetBoolean("Miscellaneous", "log_deferred_formatting", false);
+    Settings::values.log_binary_file =
+        sdl2_config->GetBoolean("Miscellaneous", "log_binary_file", false);
 
     // Debugging
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
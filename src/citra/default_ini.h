@@ -89,6 +89,11 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to skip straight to the next scheduled event while all emulated threads are waiting,
+# instead of idling through it slice by slice
+# 0: Off, 1 (default): On
+idle_fast_forward =
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -110,6 +115,27 @@ shaders_accurate_gs =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to emulate the GPU on a separate thread, overlapping it with CPU emulation (experimental)
+# 0 (default): Off, 1: On
+use_gpu_thread =
+
+# Whether to store the generated shaders on disk, to avoid compiling them again in later sessions
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Number of threads rasterizing triangles by screen tiles when using the software renderer
+# 0: One per CPU core, 1 (default): Rasterize on the emulation thread, Otherwise the thread count
+sw_rasterizer_threads =
+
+# Number of vertex shader outputs reused within indexed draws when not using hardware shaders.
+# Rounded up to a power of two, up to 65536. Larger values shade fewer vertices but use more memory.
+# Default: 256
+vertex_cache_size =
+
+# Memory in MiB the hardware renderer's surfaces may use before the least recently used ones are
+# evicted. 0: Unlimited, Default: 1024
+surface_cache_budget =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -240,6 +266,14 @@ camera_inner_flip =
 # Examples: *:Debug Kernel.SVC:Trace Service.*:Critical
 log_filter = *:Info
 
+# Leaves the formatting of log messages to the logging thread, lowering the cost of logging
+# 0 (default): Off, 1: On
+log_deferred_formatting =
+
+# Also writes the log to a compact binary file, which can be read with citra-log-decoder
+# 0 (default): Off, 1: On
+log_binary_file =
+
 [Debugging]
 # Port for listening to GDB connections.
 use_gdbstub=false
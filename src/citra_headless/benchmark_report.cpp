@@ -0,0 +1,115 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include <fmt/format.h>
+#include "citra_headless/benchmark_report.h"
+#include "common/scm_rev.h"
+#include "common/statistics.h"
+
+namespace {
+
+constexpr const char* GetSubsystemName(Core::PerfStats::Subsystem subsystem) {
+    switch (subsystem) {
+    case Core::PerfStats::Subsystem::Other:
+        return "other";
+    case Core::PerfStats::Subsystem::CPU:
+        return "cpu";
+    case Core::PerfStats::Subsystem::Kernel:
+        return "kernel";
+    case Core::PerfStats::Subsystem::GPU:
+        return "gpu";
+    case Core::PerfStats::Subsystem::Rendering:
+        return "rendering";
+    case Core::PerfStats::Subsystem::Audio:
+        return "audio";
+    default:
+        return "unknown";
+    }
+}
+
+/// Escapes a string to be used as a JSON string literal
+std::string Quote(const std::string& str) {
+    std::string quoted = "\"";
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            quoted += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + '"';
+}
+
+} // anonymous namespace
+
+std::string FormatBenchmarkReport(const BenchmarkInfo& info,
+                                  const Core::PerfStats::BenchmarkResults& results) {
+    std::vector<double> frame_times_ms;
+    frame_times_ms.reserve(results.frame_times.size());
+    for (const double frame_time : results.frame_times) {
+        frame_times_ms.push_back(frame_time * 1000.0);
+    }
+    std::sort(frame_times_ms.begin(), frame_times_ms.end());
+    double total_frame_time_ms = 0.0;
+    for (const double frame_time : frame_times_ms) {
+        total_frame_time_ms += frame_time;
+    }
+
+    std::string subsystems;
+    for (std::size_t i = 0; i < results.subsystem_times.size(); ++i) {
+        subsystems += fmt::format(
+            "{}    {}: {:.6f}", i == 0 ? "" : ",\n",
+            Quote(GetSubsystemName(static_cast<Core::PerfStats::Subsystem>(i))),
+            results.subsystem_times[i]);
+    }
+
+    return fmt::format(
+        "{{\n"
+        "  \"version\": {},\n"
+        "  \"title\": {},\n"
+        "  \"program_id\": \"{:016X}\",\n"
+        "  \"movie\": {},\n"
+        "  \"system_frames\": {},\n"
+        "  \"game_frames\": {},\n"
+        "  \"walltime_s\": {:.6f},\n"
+        "  \"emulated_time_s\": {:.6f},\n"
+        "  \"emulated_fps\": {:.3f},\n"
+        "  \"game_fps\": {:.3f},\n"
+        "  \"emulation_speed\": {:.4f},\n"
+        "  \"frame_time_ms\": {{\n"
+        "    \"mean\": {:.4f},\n"
+        "    \"min\": {:.4f},\n"
+        "    \"p50\": {:.4f},\n"
+        "    \"p90\": {:.4f},\n"
+        "    \"p95\": {:.4f},\n"
+        "    \"p99\": {:.4f},\n"
+        "    \"max\": {:.4f}\n"
+        "  }},\n"
+        "  \"subsystem_time_s\": {{\n"
+        "{}\n"
+        "  }},\n"
+        "  \"idle\": {{\n"
+        "    \"idle_cycles\": {},\n"
+        "    \"fast_forwarded_cycles\": {},\n"
+        "    \"fast_forwards\": {}\n"
+        "  }}\n"
+        "}}\n",
+        Quote(fmt::format("{} {}", Common::g_scm_branch, Common::g_scm_desc)),
+        Quote(info.title_path), info.program_id, Quote(info.movie_path), results.system_frames,
+        results.game_frames, results.walltime, results.emulated_time,
+        Common::Ratio(results.system_frames, results.walltime),
+        Common::Ratio(results.game_frames, results.walltime),
+        Common::Ratio(results.emulated_time, results.walltime),
+        Common::Ratio(total_frame_time_ms, static_cast<double>(frame_times_ms.size())),
+        Common::Percentile(frame_times_ms, 0.0), Common::Percentile(frame_times_ms, 50.0),
+        Common::Percentile(frame_times_ms, 90.0), Common::Percentile(frame_times_ms, 95.0),
+        Common::Percentile(frame_times_ms, 99.0), Common::Percentile(frame_times_ms, 100.0),
+        subsystems,
+        info.idle_cycles, info.fast_forwarded_cycles, info.fast_forwards);
+}
@@ -0,0 +1,30 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+#include "core/perf_stats.h"
+
+/// Information about the benchmarked run, included in the report
+struct BenchmarkInfo {
+    std::string title_path;
+    u64 program_id;
+    std::string movie_path;
+    /// Emulated cycles in which no thread was ready to run
+    u64 idle_cycles;
+    /// Part of the idle cycles skipped by fast-forwarding to the next event
+    u64 fast_forwarded_cycles;
+    /// Number of jumps to the next event
+    u64 fast_forwards;
+};
+
+/**
+ * Formats the results of a benchmark as a JSON object, with the emulated frame rate, percentiles of
+ * the host frame times in milliseconds, the walltime spent in each subsystem in seconds and the
+ * idle cycles.
+ */
+std::string FormatBenchmarkReport(const BenchmarkInfo& info,
+                                  const Core::PerfStats::BenchmarkResults& results);
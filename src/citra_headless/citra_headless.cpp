@@ -0,0 +1,482 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// This needs to be included before getopt.h because the latter #defines symbols used by it
+#include "common/microprofile.h"
+
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// windows.h needs to be included before shellapi.h
+#include <windows.h>
+
+#include <shellapi.h>
+#endif
+
+#include "citra_headless/benchmark_report.h"
+#include "citra_headless/config.h"
+#include "citra_headless/emu_window/emu_window_headless.h"
+#include "citra_headless/frame_sink.h"
+#include "common/common_paths.h"
+#include "common/detached_tasks.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/string_util.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/applets/default_applets.h"
+#include "core/hle/service/am/am.h"
+#include "core/loader/loader.h"
+#include "core/movie.h"
+#include "core/savestate.h"
+#include "core/settings.h"
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "-o, --output=null|memory|FILE  Where to output frames. null (default) doesn't\n"
+                 "                     render the screens, memory keeps the latest frame and\n"
+                 "                     otherwise raw 400x480 RGBA frames are written to FILE\n"
+                 "-n, --frames=NUMBER  Exit after NUMBER frames\n"
+                 "-u, --unthrottled    Run as fast as possible, disabling the frame limiter\n"
+                 "-b, --benchmark[=FILE]  Play back the movie given with -p unthrottled, until\n"
+                 "                     it ends or for the number of frames given with -n, then\n"
+                 "                     write a JSON report to FILE or to the standard output\n"
+                 "-g, --gdbport=NUMBER Enable gdb stub on port NUMBER\n"
+                 "-i, --install=FILE    Installs a specified CIA file\n"
+                 "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
+                 "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
+                 "-s, --save-state=FRAME:FILE  Save a full snapshot to FILE after FRAME frames\n"
+                 "-d, --save-delta-state=FRAME:FILE  Save the memory changed since the previous\n"
+                 "                     snapshot saved or loaded to FILE after FRAME frames\n"
+                 "-l, --load-state=FRAME:FILE  Load the snapshot in FILE after FRAME frames. It\n"
+                 "                     must have been saved earlier in the same run\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+/// Save state operation given on the command line, run once a number of frames were presented
+struct SaveStateAction {
+    enum class Type { Save, SaveDelta, Load };
+
+    Type type;
+    u64 frame;
+    std::string path;
+    bool succeeded = false;
+    Core::SaveStateManager::Stats stats;
+};
+
+/// Parses a FRAME:FILE argument
+static bool ParseSaveStateAction(const char* argument, SaveStateAction::Type type,
+                                 std::vector<SaveStateAction>& actions) {
+    char* end;
+    errno = 0;
+    const u64 frame = strtoull(argument, &end, 0);
+    if (end == argument || *end != ':' || end[1] == '\0' || errno != 0) {
+        return false;
+    }
+    actions.push_back({type, frame, end + 1});
+    return true;
+}
+
+static void RunSaveStateAction(Core::SaveStateManager& save_states, SaveStateAction& action) {
+    switch (action.type) {
+    case SaveStateAction::Type::Save:
+        action.succeeded =
+            save_states.SaveToFile(action.path, Core::SaveStateManager::SnapshotMode::Full);
+        break;
+    case SaveStateAction::Type::SaveDelta:
+        action.succeeded =
+            save_states.SaveToFile(action.path, Core::SaveStateManager::SnapshotMode::Delta);
+        break;
+    case SaveStateAction::Type::Load:
+        action.succeeded = save_states.LoadFromFile(action.path);
+        break;
+    }
+    if (!action.succeeded) {
+        LOG_ERROR(Frontend, "Failed to {} state {}",
+                  action.type == SaveStateAction::Type::Load ? "load" : "save", action.path);
+    }
+    action.stats = save_states.GetStats();
+}
+
+static void PrintSaveStateAction(const SaveStateAction& action) {
+    if (!action.succeeded) {
+        std::cout << action.path << " at frame " << action.frame << ": failed\n";
+        return;
+    }
+    std::cout << action.path << " at frame " << action.frame << ": "
+              << action.stats.snapshot_size << " bytes, " << action.stats.pages_stored << "/"
+              << action.stats.pages_total << " pages, ";
+    if (action.type != SaveStateAction::Type::Load) {
+        std::cout << "saved in " << action.stats.save_time.count() << " us\n";
+        return;
+    }
+    std::cout << "loaded in " << action.stats.load_time.count() << " us";
+    if (action.stats.load_to_first_frame.count() != 0) {
+        std::cout << ", first frame after " << action.stats.load_to_first_frame.count() << " us";
+    }
+    std::cout << "\n";
+}
+
+static void InitializeLogging() {
+    Log::Filter log_filter(Log::Level::Debug);
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    const std::string& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    FileUtil::CreateFullPath(log_dir);
+    Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
+    if (Settings::values.log_binary_file) {
+        Log::AddBackend(std::make_unique<Log::BinaryFileBackend>(log_dir + BINARY_LOG_FILE));
+    }
+#ifdef _WIN32
+    Log::AddBackend(std::make_unique<Log::DebuggerBackend>());
+#endif
+    Log::SetDeferredFormatting(Settings::values.log_deferred_formatting);
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::DetachedTasks detached_tasks;
+    Config config;
+    int option_index = 0;
+    bool use_gdbstub = Settings::values.use_gdbstub;
+    u32 gdb_port = static_cast<u32>(Settings::values.gdbstub_port);
+    std::string movie_record;
+    std::string movie_play;
+    std::string output = "null";
+    u64 max_frames = 0;
+    bool unthrottled = false;
+    bool benchmark = false;
+    std::string benchmark_report_path;
+    std::vector<SaveStateAction> save_state_actions;
+
+    InitializeLogging();
+
+    char* endarg;
+#ifdef _WIN32
+    int argc_w;
+    auto argv_w = CommandLineToArgvW(GetCommandLineW(), &argc_w);
+
+    if (argv_w == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to get command line arguments");
+        return -1;
+    }
+#endif
+    std::string filepath;
+
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"frames", required_argument, 0, 'n'},
+        {"unthrottled", no_argument, 0, 'u'},
+        {"benchmark", optional_argument, 0, 'b'},
+        {"gdbport", required_argument, 0, 'g'},
+        {"install", required_argument, 0, 'i'},
+        {"movie-record", required_argument, 0, 'r'},
+        {"movie-play", required_argument, 0, 'p'},
+        {"save-state", required_argument, 0, 's'},
+        {"save-delta-state", required_argument, 0, 'd'},
+        {"load-state", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        char arg = getopt_long(argc, argv, "o:n:ub::g:i:r:p:s:d:l:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (arg) {
+            case 'o':
+                output = optarg;
+                break;
+            case 'n':
+                errno = 0;
+                max_frames = strtoull(optarg, &endarg, 0);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--frames");
+                    exit(1);
+                }
+                break;
+            case 'u':
+                unthrottled = true;
+                break;
+            case 'b':
+                benchmark = true;
+                if (optarg != nullptr) {
+                    benchmark_report_path = optarg;
+                }
+                break;
+            case 'g':
+                errno = 0;
+                gdb_port = strtoul(optarg, &endarg, 0);
+                use_gdbstub = true;
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--gdbport");
+                    exit(1);
+                }
+                break;
+            case 'i': {
+                const auto cia_progress = [](std::size_t written, std::size_t total) {
+                    LOG_INFO(Frontend, "{:02d}%", (written * 100 / total));
+                };
+                if (Service::AM::InstallCIA(std::string(optarg), cia_progress) !=
+                    Service::AM::InstallStatus::Success)
+                    errno = EINVAL;
+                if (errno != 0)
+                    exit(1);
+                break;
+            }
+            case 'r':
+                movie_record = optarg;
+                break;
+            case 'p':
+                movie_play = optarg;
+                break;
+            case 's':
+            case 'd':
+            case 'l': {
+                const auto type = arg == 's'   ? SaveStateAction::Type::Save
+                                  : arg == 'd' ? SaveStateAction::Type::SaveDelta
+                                               : SaveStateAction::Type::Load;
+                if (!ParseSaveStateAction(optarg, type, save_state_actions)) {
+                    std::cerr << "Expected FRAME:FILE, got " << optarg << std::endl;
+                    exit(1);
+                }
+                break;
+            }
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+#ifdef _WIN32
+            filepath = Common::UTF16ToUTF8(argv_w[optind]);
+#else
+            filepath = argv[optind];
+#endif
+            optind++;
+        }
+    }
+
+#ifdef _WIN32
+    LocalFree(argv_w);
+#endif
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty()) {
+        LOG_CRITICAL(Frontend, "Failed to load ROM: No ROM specified");
+        return -1;
+    }
+
+    if (!movie_record.empty() && !movie_play.empty()) {
+        LOG_CRITICAL(Frontend, "Cannot both play and record a movie");
+        return -1;
+    }
+
+    if (benchmark) {
+        if (movie_play.empty()) {
+            LOG_CRITICAL(Frontend, "Benchmarking requires a movie to play back");
+            return -1;
+        }
+        unthrottled = true;
+    }
+
+    // Only render the screens if the frames are going somewhere
+    std::unique_ptr<FrameSink> frame_sink;
+    MemoryFrameSink* memory_frame_sink = nullptr;
+    if (output == "memory") {
+        auto sink = std::make_unique<MemoryFrameSink>();
+        memory_frame_sink = sink.get();
+        frame_sink = std::move(sink);
+    } else if (output != "null") {
+        auto sink = std::make_unique<FileFrameSink>(output);
+        if (!sink->IsOpen()) {
+            LOG_CRITICAL(Frontend, "Failed to open {} for writing frames", output);
+            return -1;
+        }
+        frame_sink = std::move(sink);
+    }
+
+    if (!movie_record.empty()) {
+        Core::Movie::GetInstance().PrepareForRecording();
+    }
+    if (!movie_play.empty()) {
+        Core::Movie::GetInstance().PrepareForPlayback(movie_play);
+    }
+
+    // Apply the command line arguments
+    Settings::values.gdbstub_port = gdb_port;
+    Settings::values.use_gdbstub = use_gdbstub;
+    Settings::values.renderer_backend =
+        frame_sink ? Settings::RendererBackend::Software : Settings::RendererBackend::Null;
+    if (unthrottled) {
+        Settings::values.use_frame_limit = false;
+    }
+    Settings::Apply();
+
+    // Register frontend applets
+    Frontend::RegisterDefaultApplets();
+
+    std::unique_ptr<EmuWindow_Headless> emu_window{
+        std::make_unique<EmuWindow_Headless>(std::move(frame_sink), max_frames)};
+
+    Core::System& system{Core::System::GetInstance()};
+
+    SCOPE_EXIT({ system.Shutdown(); });
+
+    const Core::System::ResultStatus load_result{system.Load(*emu_window, filepath)};
+
+    switch (load_result) {
+    case Core::System::ResultStatus::ErrorGetLoader:
+        LOG_CRITICAL(Frontend, "Failed to obtain loader for {}!", filepath);
+        return -1;
+    case Core::System::ResultStatus::ErrorLoader:
+        LOG_CRITICAL(Frontend, "Failed to load ROM!");
+        return -1;
+    case Core::System::ResultStatus::ErrorLoader_ErrorEncrypted:
+        LOG_CRITICAL(Frontend, "The game that you are trying to load must be decrypted before "
+                               "being used with Citra. \n\n For more information on dumping and "
+                               "decrypting games, please refer to: "
+                               "https://citra-emu.org/wiki/dumping-game-cartridges/");
+        return -1;
+    case Core::System::ResultStatus::ErrorLoader_ErrorInvalidFormat:
+        LOG_CRITICAL(Frontend, "Error while loading ROM: The ROM format is not supported.");
+        return -1;
+    case Core::System::ResultStatus::ErrorNotInitialized:
+        LOG_CRITICAL(Frontend, "CPUCore not initialized");
+        return -1;
+    case Core::System::ResultStatus::ErrorSystemMode:
+        LOG_CRITICAL(Frontend, "Failed to determine system mode!");
+        return -1;
+    case Core::System::ResultStatus::ErrorVideoCore:
+        LOG_CRITICAL(Frontend, "VideoCore not initialized");
+        return -1;
+    case Core::System::ResultStatus::Success:
+        break; // Expected case
+    }
+
+    Core::Telemetry().AddField(Telemetry::FieldType::App, "Frontend", "Headless");
+
+    std::atomic<bool> movie_finished{false};
+    if (!movie_play.empty()) {
+        Core::Movie::GetInstance().StartPlayback(movie_play, [&] { movie_finished = true; });
+    }
+    if (!movie_record.empty()) {
+        Core::Movie::GetInstance().StartRecording(movie_record);
+    }
+
+    Core::Timing& timing = system.CoreTiming();
+    const u64 start_idle_ticks = timing.GetIdleTicks();
+    const u64 start_fast_forwarded_ticks = timing.GetFastForwardedTicks();
+    const u64 start_fast_forwards = timing.GetFastForwardCount();
+    if (benchmark) {
+        system.perf_stats.BeginBenchmark(timing.GetGlobalTimeUs());
+    }
+
+    // Actions given for the same frame run in command line order
+    std::stable_sort(save_state_actions.begin(), save_state_actions.end(),
+                     [](const auto& a, const auto& b) { return a.frame < b.frame; });
+    std::size_t next_save_state_action = 0;
+    // The first frame after a load ends by the time the next action runs or emulation stops
+    const auto record_first_frame = [&] {
+        if (next_save_state_action == 0)
+            return;
+        SaveStateAction& previous = save_state_actions[next_save_state_action - 1];
+        if (previous.type == SaveStateAction::Type::Load && previous.succeeded) {
+            previous.stats.load_to_first_frame =
+                system.SaveStates().GetStats().load_to_first_frame;
+        }
+    };
+    const auto run_save_state_actions = [&] {
+        while (next_save_state_action < save_state_actions.size() &&
+               save_state_actions[next_save_state_action].frame <= emu_window->GetFrameCount()) {
+            record_first_frame();
+            RunSaveStateAction(system.SaveStates(), save_state_actions[next_save_state_action++]);
+        }
+    };
+
+    while (emu_window->IsOpen() && !(benchmark && max_frames == 0 && movie_finished)) {
+        system.RunLoop();
+        run_save_state_actions();
+    }
+    record_first_frame();
+
+    const u64 idle_ticks = timing.GetIdleTicks() - start_idle_ticks;
+    const u64 fast_forwarded_ticks = timing.GetFastForwardedTicks() - start_fast_forwarded_ticks;
+    const u64 fast_forwards = timing.GetFastForwardCount() - start_fast_forwards;
+    LOG_INFO(Frontend, "Idled for {} cycles, {} of which were fast-forwarded in {} jumps",
+             idle_ticks, fast_forwarded_ticks, fast_forwards);
+
+    if (benchmark) {
+        BenchmarkInfo info{filepath, 0, movie_play, idle_ticks, fast_forwarded_ticks,
+                           fast_forwards};
+        system.GetAppLoader().ReadProgramId(info.program_id);
+        const std::string report = FormatBenchmarkReport(
+            info, system.perf_stats.GetBenchmarkResults(timing.GetGlobalTimeUs()));
+        if (benchmark_report_path.empty()) {
+            std::cout << report << std::flush;
+        } else if (FileUtil::WriteStringToFile(true, report, benchmark_report_path.c_str()) !=
+                   report.size()) {
+            LOG_ERROR(Frontend, "Failed to write the benchmark report to {}",
+                      benchmark_report_path);
+        }
+    }
+
+    LOG_INFO(Frontend, "Emulated {} frames", emu_window->GetFrameCount());
+    if (memory_frame_sink) {
+        const auto frame = memory_frame_sink->GetLatestFrame();
+        LOG_INFO(Frontend, "Hash of the last frame: {:016X}",
+                 Common::ComputeHash64(frame.pixels.data(), frame.pixels.size()));
+    }
+
+    bool save_states_succeeded = true;
+    for (std::size_t i = 0; i < save_state_actions.size(); ++i) {
+        const SaveStateAction& action = save_state_actions[i];
+        if (i >= next_save_state_action) {
+            LOG_ERROR(Frontend, "Frame {} for {} was never reached", action.frame, action.path);
+            save_states_succeeded = false;
+            continue;
+        }
+        PrintSaveStateAction(action);
+        save_states_succeeded &= action.succeeded;
+    }
+
+    Core::Movie::GetInstance().Shutdown();
+
+    detached_tasks.WaitForAllTasks();
+    return save_states_succeeded ? 0 : 1;
+}
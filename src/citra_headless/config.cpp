@@ -0,0 +1,154 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <inih/cpp/INIReader.h>
+#include "citra_headless/config.h"
+#include "citra_headless/default_ini.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/hle/service/service.h"
+#include "core/settings.h"
+
+Config::Config() {
+    // TODO: Don't hardcode the path; let the frontend decide where to put the config files.
+    ini_config_loc = FileUtil::GetUserPath(FileUtil::UserPath::ConfigDir) + "headless-config.ini";
+    ini_config = std::make_unique<INIReader>(ini_config_loc);
+
+    Reload();
+}
+
+Config::~Config() = default;
+
+bool Config::LoadINI(const std::string& default_contents, bool retry) {
+    const char* location = this->ini_config_loc.c_str();
+    if (ini_config->ParseError() < 0) {
+        if (retry) {
+            LOG_WARNING(Config, "Failed to load {}. Creating file from defaults...", location);
+            FileUtil::CreateFullPath(location);
+            FileUtil::WriteStringToFile(true, default_contents, location);
+            ini_config = std::make_unique<INIReader>(location); // Reopen file
+
+            return LoadINI(default_contents, false);
+        }
+        LOG_ERROR(Config, "Failed.");
+        return false;
+    }
+    LOG_INFO(Config, "Successfully loaded {}", location);
+    return true;
+}
+
+void Config::ReadValues() {
+    // Core
+    Settings::values.use_cpu_jit = ini_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.idle_fast_forward = ini_config->GetBoolean("Core", "idle_fast_forward", true);
+
+    // Renderer
+    // There is no graphics context, so the GPU is always emulated in software
+    Settings::values.use_hw_renderer = false;
+    Settings::values.use_hw_shader = false;
+    Settings::values.use_shader_jit = ini_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_gpu_thread = ini_config->GetBoolean("Renderer", "use_gpu_thread", false);
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(ini_config->GetInteger("Renderer", "sw_rasterizer_threads", 1));
+    Settings::values.vertex_cache_size =
+        static_cast<u32>(ini_config->GetInteger("Renderer", "vertex_cache_size", 256));
+    Settings::values.use_frame_limit = ini_config->GetBoolean("Renderer", "use_frame_limit", true);
+    Settings::values.frame_limit =
+        static_cast<u16>(ini_config->GetInteger("Renderer", "frame_limit", 100));
+
+    // Audio
+    Settings::values.enable_dsp_lle = ini_config->GetBoolean("Audio", "enable_dsp_lle", false);
+    Settings::values.enable_dsp_lle_multithread =
+        ini_config->GetBoolean("Audio", "enable_dsp_lle_multithread", false);
+    Settings::values.sink_id = ini_config->GetString("Audio", "output_engine", "null");
+    Settings::values.enable_audio_stretching =
+        ini_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.audio_device_id = ini_config->GetString("Audio", "output_device", "auto");
+    Settings::values.volume = ini_config->GetReal("Audio", "volume", 1);
+
+    // Data Storage
+    Settings::values.use_virtual_sd =
+        ini_config->GetBoolean("Data Storage", "use_virtual_sd", true);
+
+    // System
+    Settings::values.is_new_3ds = ini_config->GetBoolean("System", "is_new_3ds", false);
+    Settings::values.region_value =
+        ini_config->GetInteger("System", "region_value", Settings::REGION_VALUE_AUTO_SELECT);
+    Settings::values.init_clock =
+        static_cast<Settings::InitClock>(ini_config->GetInteger("System", "init_clock", 1));
+    {
+        std::tm t;
+        t.tm_sec = 1;
+        t.tm_min = 0;
+        t.tm_hour = 0;
+        t.tm_mday = 1;
+        t.tm_mon = 0;
+        t.tm_year = 100;
+        t.tm_isdst = 0;
+        std::istringstream string_stream(
+            ini_config->GetString("System", "init_time", "2000-01-01 00:00:01"));
+        string_stream >> std::get_time(&t, "%Y-%m-%d %H:%M:%S");
+        if (string_stream.fail()) {
+            LOG_ERROR(Config, "Failed To parse init_time. Using 2000-01-01 00:00:01");
+        }
+        Settings::values.init_time =
+            std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::from_time_t(std::mktime(&t)).time_since_epoch())
+                .count();
+    }
+
+    // Camera
+    using namespace Service::CAM;
+    Settings::values.camera_name[OuterRightCamera] =
+        ini_config->GetString("Camera", "camera_outer_right_name", "blank");
+    Settings::values.camera_config[OuterRightCamera] =
+        ini_config->GetString("Camera", "camera_outer_right_config", "");
+    Settings::values.camera_flip[OuterRightCamera] =
+        ini_config->GetInteger("Camera", "camera_outer_right_flip", 0);
+    Settings::values.camera_name[InnerCamera] =
+        ini_config->GetString("Camera", "camera_inner_name", "blank");
+    Settings::values.camera_config[InnerCamera] =
+        ini_config->GetString("Camera", "camera_inner_config", "");
+    Settings::values.camera_flip[InnerCamera] =
+        ini_config->GetInteger("Camera", "camera_inner_flip", 0);
+    Settings::values.camera_name[OuterLeftCamera] =
+        ini_config->GetString("Camera", "camera_outer_left_name", "blank");
+    Settings::values.camera_config[OuterLeftCamera] =
+        ini_config->GetString("Camera", "camera_outer_left_config", "");
+    Settings::values.camera_flip[OuterLeftCamera] =
+        ini_config->GetInteger("Camera", "camera_outer_left_flip", 0);
+
+    // Miscellaneous
+    Settings::values.log_filter = ini_config->GetString("Miscellaneous", "log_filter", "*:Info");
+    Settings::values.log_deferred_formatting =
+        ini_config->GetBoolean("Miscellaneous", "log_deferred_formatting", false);
+    Settings::values.log_binary_file =
+        ini_config->GetBoolean("Miscellaneous", "log_binary_file", false);
+
+    // Debugging
+    Settings::values.use_gdbstub = ini_config->GetBoolean("Debugging", "use_gdbstub", false);
+    Settings::values.gdbstub_port =
+        static_cast<u16>(ini_config->GetInteger("Debugging", "gdbstub_port", 24689));
+
+    for (const auto& service_module : Service::service_module_map) {
+        bool use_lle = ini_config->GetBoolean("Debugging", "LLE\\" + service_module.name, false);
+        Settings::values.lle_modules.emplace(service_module.name, use_lle);
+    }
+
+    // Web Service
+    Settings::values.enable_telemetry =
+        ini_config->GetBoolean("WebService", "enable_telemetry", false);
+    Settings::values.web_api_url =
+        ini_config->GetString("WebService", "web_api_url", "https://api.citra-emu.org");
+    Settings::values.citra_username = ini_config->GetString("WebService", "citra_username", "");
+    Settings::values.citra_token = ini_config->GetString("WebService", "citra_token", "");
+}
+
+void Config::Reload() {
+    LoadINI(DefaultINI::headless_config_file);
+    ReadValues();
+}
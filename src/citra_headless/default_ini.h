@@ -0,0 +1,149 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace DefaultINI {
+
+const char* headless_config_file = R"(
+[Core]
+# Whether to use the Just-In-Time (JIT) compiler for CPU emulation
+# 0: Interpreter (slow), 1 (default): JIT (fast)
+use_cpu_jit =
+
+# Whether to skip straight to the next scheduled event while all emulated threads are waiting,
+# instead of idling through it slice by slice
+# 0: Off, 1 (default): On
+idle_fast_forward =
+
+[Renderer]
+# Whether to use the Just-In-Time (JIT) compiler for shader emulation
+# 0: Interpreter (slow), 1 (default): JIT (fast)
+use_shader_jit =
+
+# Whether to emulate the GPU on a separate thread, overlapping it with CPU emulation (experimental)
+# 0 (default): Off, 1: On
+use_gpu_thread =
+
+# Number of threads rasterizing triangles by screen tiles when using the software renderer
+# 0: One per CPU core, 1 (default): Rasterize on the emulation thread, Otherwise the thread count
+sw_rasterizer_threads =
+
+# Number of vertex shader outputs reused within indexed draws when not using hardware shaders.
+# Rounded up to a power of two, up to 65536. Larger values shade fewer vertices but use more memory.
+# Default: 256
+vertex_cache_size =
+
+# Turns on the frame limiter, which will limit frames output to the target game speed.
+# Can be turned off from the command line with --unthrottled.
+# 0: Off, 1: On (default)
+use_frame_limit =
+
+# Limits the speed of the game to run no faster than this value as a percentage of target speed
+# 1 - 9999: Speed limit as a percentage of target game speed. 100 (default)
+frame_limit =
+
+[Audio]
+# Whether or not to enable DSP LLE
+# 0 (default): No, 1: Yes
+enable_dsp_lle =
+
+# Whether or not to run DSP LLE on a different thread
+# 0 (default): No, 1: Yes
+enable_dsp_lle_multithread =
+
+# Which audio output engine to use.
+# auto: Auto-select, null (default): No audio output, sdl2: SDL2 (if available)
+output_engine =
+
+# Whether or not to enable the audio-stretching post-processing effect.
+# This effect adjusts audio speed to match emulation speed and helps prevent audio stutter,
+# at the cost of increasing audio latency.
+# 0: No, 1 (default): Yes
+enable_audio_stretching =
+
+# Which audio device to use.
+# auto (default): Auto-select
+output_device =
+
+# Output volume.
+# 1.0 (default): 100%, 0.0; mute
+volume =
+
+[Data Storage]
+# Whether to create a virtual SD card.
+# 1 (default): Yes, 0: No
+use_virtual_sd =
+
+[System]
+# The system model that Citra will try to emulate
+# 0: Old 3DS (default), 1: New 3DS
+is_new_3ds =
+
+# The system region that Citra will use during emulation
+# -1: Auto-select (default), 0: Japan, 1: USA, 2: Europe, 3: Australia, 4: China, 5: Korea, 6: Taiwan
+region_value =
+
+# The clock to use when citra starts. The fixed time keeps runs reproducible.
+# 0: System clock, 1: fixed time (default)
+init_clock =
+
+# Time used when init_clock is set to fixed_time in the format %Y-%m-%d %H:%M:%S
+# set to fixed time. Default 2000-01-01 00:00:01
+# Note: 3DS can only handle times later then Jan 1 2000
+init_time =
+
+[Camera]
+# Which camera engine to use for the right outer camera
+# blank (default): a dummy camera that always returns black image
+camera_outer_right_name =
+
+# A config string for the right outer camera. Its meaning is defined by the camera engine
+camera_outer_right_config =
+
+# The image flip to apply
+# 0: None (default), 1: Horizontal, 2: Vertical, 3: Reverse
+camera_outer_right_flip =
+
+# ... for the left outer camera
+camera_outer_left_name =
+camera_outer_left_config =
+camera_outer_left_flip =
+
+# ... for the inner camera
+camera_inner_name =
+camera_inner_config =
+camera_inner_flip =
+
+[Miscellaneous]
+# A filter which removes logs below a certain logging level.
+# Examples: *:Debug Kernel.SVC:Trace Service.*:Critical
+log_filter = *:Info
+
+# Leaves the formatting of log messages to the logging thread, lowering the cost of logging
+# 0 (default): Off, 1: On
+log_deferred_formatting =
+
+# Also writes the log to a compact binary file, which can be read with citra-log-decoder
+# 0 (default): Off, 1: On
+log_binary_file =
+
+[Debugging]
+# Port for listening to GDB connections.
+use_gdbstub=false
+gdbstub_port=24689
+# To LLE a service module add "LLE\<module name>=true"
+
+[WebService]
+# Whether or not to enable telemetry
+# 0 (default): No, 1: Yes
+enable_telemetry =
+# URL for Web API
+web_api_url = https://api.citra-emu.org
+# Username and token for Citra Web Service
+# See https://profile.citra-emu.org/ for more info
+citra_username =
+citra_token =
+)";
+}
@@ -0,0 +1,62 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "citra_headless/emu_window/emu_window_headless.h"
+#include "citra_headless/frame_sink.h"
+#include "core/3ds.h"
+#include "video_core/renderer_software/renderer_software.h"
+#include "video_core/video_core.h"
+
+constexpr u32 FRAME_WIDTH = Core::kScreenTopWidth;
+constexpr u32 FRAME_HEIGHT = Core::kScreenTopHeight + Core::kScreenBottomHeight;
+
+/// Copies a screen image into the frame at the given position, clipping it to the frame.
+static void CopyScreen(const VideoCore::RendererSoftware::ScreenImage& image, u32 left, u32 top,
+                       std::vector<u8>& frame) {
+    if (left >= FRAME_WIDTH || top >= FRAME_HEIGHT) {
+        return;
+    }
+    const u32 width = std::min(image.width, FRAME_WIDTH - left);
+    const u32 height = std::min(image.height, FRAME_HEIGHT - top);
+    for (u32 y = 0; y < height; ++y) {
+        std::memcpy(&frame[((top + y) * FRAME_WIDTH + left) * 4],
+                    &image.pixels[y * image.width * 4], width * 4);
+    }
+}
+
+EmuWindow_Headless::EmuWindow_Headless(std::unique_ptr<FrameSink> frame_sink, u64 max_frames)
+    : frame_sink(std::move(frame_sink)), max_frames(max_frames) {
+    UpdateCurrentFramebufferLayout(FRAME_WIDTH, FRAME_HEIGHT);
+}
+
+EmuWindow_Headless::~EmuWindow_Headless() = default;
+
+void EmuWindow_Headless::SwapBuffers() {
+    ++frame_count;
+    if (!frame_sink) {
+        return;
+    }
+
+    using Screen = VideoCore::RendererSoftware::Screen;
+    const auto& renderer =
+        static_cast<const VideoCore::RendererSoftware&>(*VideoCore::GetRenderer());
+    const auto& top_screen = renderer.GetScreenImage(Screen::Top);
+    const auto& bottom_screen = renderer.GetScreenImage(Screen::Bottom);
+
+    frame.assign(FRAME_WIDTH * FRAME_HEIGHT * 4, 0);
+    for (std::size_t i = 3; i < frame.size(); i += 4) {
+        frame[i] = 255;
+    }
+    CopyScreen(top_screen, 0, 0, frame);
+    CopyScreen(bottom_screen, (FRAME_WIDTH - Core::kScreenBottomWidth) / 2, Core::kScreenTopHeight,
+               frame);
+
+    frame_sink->WriteFrame(FRAME_WIDTH, FRAME_HEIGHT, frame);
+}
+
+bool EmuWindow_Headless::IsOpen() const {
+    return max_frames == 0 || frame_count < max_frames;
+}
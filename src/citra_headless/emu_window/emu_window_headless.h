@@ -0,0 +1,48 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "core/frontend/emu_window.h"
+
+class FrameSink;
+
+/**
+ * Window which needs no display, for running without a graphics API. If a frame sink is given, the
+ * screens are stacked as in the default layout and each frame is written to it. This requires the
+ * software renderer backend.
+ */
+class EmuWindow_Headless : public EmuWindow {
+public:
+    /// @param max_frames Number of frames after which the window reports being closed, 0 for none
+    EmuWindow_Headless(std::unique_ptr<FrameSink> frame_sink, u64 max_frames);
+    ~EmuWindow_Headless();
+
+    /// Writes the current frame to the frame sink
+    void SwapBuffers() override;
+
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+
+    /// Whether the requested number of frames hasn't been presented yet
+    bool IsOpen() const;
+
+    u64 GetFrameCount() const {
+        return frame_count;
+    }
+
+private:
+    void OnMinimalClientAreaChangeRequest(
+        const std::pair<unsigned, unsigned>& minimal_size) override {}
+
+    std::unique_ptr<FrameSink> frame_sink;
+    std::vector<u8> frame;
+
+    const u64 max_frames;
+    std::atomic<u64> frame_count{0};
+};
@@ -0,0 +1,26 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "citra_headless/frame_sink.h"
+#include "common/logging/log.h"
+
+void MemoryFrameSink::WriteFrame(u32 width, u32 height, const std::vector<u8>& pixels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latest_frame.width = width;
+    latest_frame.height = height;
+    latest_frame.pixels = pixels;
+}
+
+MemoryFrameSink::Frame MemoryFrameSink::GetLatestFrame() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return latest_frame;
+}
+
+FileFrameSink::FileFrameSink(const std::string& path) : file(path, "wb") {}
+
+void FileFrameSink::WriteFrame(u32 width, u32 height, const std::vector<u8>& pixels) {
+    if (file.WriteBytes(pixels.data(), pixels.size()) != pixels.size()) {
+        LOG_ERROR(Frontend, "Failed to write a {}x{} frame", width, height);
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+/// Receives the frames output by the headless frontend, as RGBA8 images.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    /// Called on the thread presenting frames, with `width * height * 4` bytes of pixels.
+    virtual void WriteFrame(u32 width, u32 height, const std::vector<u8>& pixels) = 0;
+};
+
+/// Keeps a copy of the latest frame.
+class MemoryFrameSink : public FrameSink {
+public:
+    struct Frame {
+        u32 width = 0;
+        u32 height = 0;
+        std::vector<u8> pixels;
+    };
+
+    void WriteFrame(u32 width, u32 height, const std::vector<u8>& pixels) override;
+
+    /// Returns a copy of the latest frame, which is empty if no frame was written yet.
+    Frame GetLatestFrame() const;
+
+private:
+    mutable std::mutex mutex;
+    Frame latest_frame;
+};
+
+/**
+ * Appends each frame to a file as raw RGBA8 pixels, without any header. The output can be played
+ * back with e.g. `ffplay -f rawvideo -pixel_format rgba -video_size 400x480 <file>`.
+ */
+class FileFrameSink : public FrameSink {
+public:
+    explicit FileFrameSink(const std::string& path);
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    void WriteFrame(u32 width, u32 height, const std::vector<u8>& pixels) override;
+
+private:
+    FileUtil::IOFile file;
+};
@@ -119,6 +119,7 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Core");
     Settings::values.use_cpu_jit = ReadSetting("use_cpu_jit", true).toBool();
+    Settings::values.idle_fast_forward = ReadSetting("idle_fast_forward", true).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
@@ -134,6 +135,13 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_gs = ReadSetting("shaders_accurate_gs", true).toBool();
     Settings::values.shaders_accurate_mul = ReadSetting("shaders_accurate_mul", false).toBool();
     Settings::values.use_shader_jit = ReadSetting("use_shader_jit", true).toBool();
+    Settings::values.use_disk_shader_cache = ReadSetting("use_disk_shader_cache", true).toBool();
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(ReadSetting("sw_rasterizer_threads", 1).toInt());
+    Settings::values.vertex_cache_size =
+        static_cast<u32>(ReadSetting("vertex_cache_size", 256).toUInt());
+    Settings::values.surface_cache_budget =
+        static_cast<u32>(ReadSetting("surface_cache_budget", 1024).toUInt());
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting("resolution_factor", 1).toInt());
     Settings::values.vsync_enabled = ReadSetting("vsync_enabled", false).toBool();
@@ -210,6 +218,9 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Miscellaneous");
     Settings::values.log_filter = ReadSetting("log_filter", "*:Info").toString().toStdString();
+    Settings::values.log_deferred_formatting =
+        ReadSetting("log_deferred_formatting", false).toBool();
+    Settings::values.log_binary_file = ReadSetting("log_binary_file", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
@@ -344,6 +355,7 @@ void Config::ReadValues() {
     UISettings::values.first_start = ReadSetting("firstStart", true).toBool();
     UISettings::values.callout_flags = ReadSetting("calloutFlags", 0).toUInt();
     UISettings::values.show_console = ReadSetting("showConsole", false).toBool();
+    UISettings::values.show_renderer_stats = ReadSetting("showRendererStats", false).toBool();
 
     qt_config->beginGroup("Multiplayer");
     UISettings::values.nickname = ReadSetting("nickname", "").toString();
@@ -416,6 +428,7 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Core");
     WriteSetting("use_cpu_jit", Settings::values.use_cpu_jit, true);
+    WriteSetting("idle_fast_forward", Settings::values.idle_fast_forward, true);
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
@@ -424,6 +437,10 @@ void Config::SaveValues() {
     WriteSetting("shaders_accurate_gs", Settings::values.shaders_accurate_gs, true);
     WriteSetting("shaders_accurate_mul", Settings::values.shaders_accurate_mul, false);
     WriteSetting("use_shader_jit", Settings::values.use_shader_jit, true);
+    WriteSetting("use_disk_shader_cache", Settings::values.use_disk_shader_cache, true);
+    WriteSetting("sw_rasterizer_threads", Settings::values.sw_rasterizer_threads, 1);
+    WriteSetting("vertex_cache_size", Settings::values.vertex_cache_size, 256);
+    WriteSetting("surface_cache_budget", Settings::values.surface_cache_budget, 1024);
     WriteSetting("resolution_factor", Settings::values.resolution_factor, 1);
     WriteSetting("vsync_enabled", Settings::values.vsync_enabled, false);
     WriteSetting("use_frame_limit", Settings::values.use_frame_limit, true);
@@ -494,6 +511,8 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Miscellaneous");
     WriteSetting("log_filter", QString::fromStdString(Settings::values.log_filter), "*:Info");
+    WriteSetting("log_deferred_formatting", Settings::values.log_deferred_formatting, false);
+    WriteSetting("log_binary_file", Settings::values.log_binary_file, false);
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
@@ -577,6 +596,7 @@ void Config::SaveValues() {
     WriteSetting("firstStart", UISettings::values.first_start, true);
     WriteSetting("calloutFlags", UISettings::values.callout_flags, 0);
     WriteSetting("showConsole", UISettings::values.show_console, false);
+    WriteSetting("showRendererStats", UISettings::values.show_renderer_stats, false);
 
     qt_config->beginGroup("Multiplayer");
     WriteSetting("nickname", UISettings::values.nickname, "");
@@ -35,6 +35,7 @@ void ConfigureDebug::setConfiguration() {
     ui->toggle_console->setChecked(UISettings::values.show_console);
     ui->log_filter_edit->setText(QString::fromStdString(Settings::values.log_filter));
     ui->toggle_cpu_jit->setChecked(Settings::values.use_cpu_jit);
+    ui->toggle_renderer_stats->setChecked(UISettings::values.show_renderer_stats);
 }
 
 void ConfigureDebug::applyConfiguration() {
@@ -47,6 +48,7 @@ void ConfigureDebug::applyConfiguration() {
     filter.ParseFilterString(Settings::values.log_filter);
     Log::SetGlobalFilter(filter);
     Settings::values.use_cpu_jit = ui->toggle_cpu_jit->isChecked();
+    UISettings::values.show_renderer_stats = ui->toggle_renderer_stats->isChecked();
 }
 
 void ConfigureDebug::retranslateUi() {
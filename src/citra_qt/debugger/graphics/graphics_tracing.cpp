@@ -62,8 +62,8 @@ void GraphicsTracingWidget::StartRecording() {
     if (!context)
         return;
 
-    auto shader_binary = Pica::g_state.vs.program_code;
-    auto swizzle_data = Pica::g_state.vs.swizzle_data;
+    auto shader_binary = Pica::GetState().vs.program_code;
+    auto swizzle_data = Pica::GetState().vs.swizzle_data;
 
     // Encode floating point numbers to 24-bit values
     // TODO: Drop this explicit conversion once we store float24 values bit-correctly internally.
@@ -71,7 +71,7 @@ void GraphicsTracingWidget::StartRecording() {
     for (unsigned i = 0; i < 16; ++i) {
         for (unsigned comp = 0; comp < 3; ++comp) {
             default_attributes[4 * i + comp] = nihstro::to_float24(
-                Pica::g_state.input_default_attributes.attr[i][comp].ToFloat32());
+                Pica::GetState().input_default_attributes.attr[i][comp].ToFloat32());
         }
     }
 
@@ -79,14 +79,14 @@ void GraphicsTracingWidget::StartRecording() {
     for (unsigned i = 0; i < 96; ++i)
         for (unsigned comp = 0; comp < 3; ++comp)
             vs_float_uniforms[4 * i + comp] =
-                nihstro::to_float24(Pica::g_state.vs.uniforms.f[i][comp].ToFloat32());
+                nihstro::to_float24(Pica::GetState().vs.uniforms.f[i][comp].ToFloat32());
 
     CiTrace::Recorder::InitialState state;
-    std::copy_n((u32*)&GPU::g_regs, sizeof(GPU::g_regs) / sizeof(u32),
+    std::copy_n((u32*)&GPU::GetRegs(), sizeof(GPU::Regs) / sizeof(u32),
                 std::back_inserter(state.gpu_registers));
-    std::copy_n((u32*)&LCD::g_regs, sizeof(LCD::g_regs) / sizeof(u32),
+    std::copy_n((u32*)&LCD::GetRegs(), sizeof(LCD::Regs) / sizeof(u32),
                 std::back_inserter(state.lcd_registers));
-    std::copy_n((u32*)&Pica::g_state.regs, sizeof(Pica::g_state.regs) / sizeof(u32),
+    std::copy_n((u32*)&Pica::GetState().regs, sizeof(Pica::Regs) / sizeof(u32),
                 std::back_inserter(state.pica_registers));
     boost::copy(default_attributes, std::back_inserter(state.default_attributes));
     boost::copy(shader_binary, std::back_inserter(state.vs_program_binary));
@@ -48,6 +48,7 @@
 #include "common/detached_tasks.h"
 #include "common/file_util.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
@@ -116,9 +117,13 @@ static void InitializeLogging() {
     const std::string& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
     FileUtil::CreateFullPath(log_dir);
     Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
+    if (Settings::values.log_binary_file) {
+        Log::AddBackend(std::make_unique<Log::BinaryFileBackend>(log_dir + BINARY_LOG_FILE));
+    }
 #ifdef _WIN32
     Log::AddBackend(std::make_unique<Log::DebuggerBackend>());
 #endif
+    Log::SetDeferredFormatting(Settings::values.log_deferred_formatting);
 }
 
 GMainWindow::GMainWindow() : config(new Config()), emu_thread(nullptr) {
@@ -233,8 +238,15 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
-
-    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
+    renderer_stats_label = new QLabel();
+    renderer_stats_label->setToolTip(
+        tr("Texture data per frame the renderer didn't upload again, as the game rewrote it "
+           "unchanged, rendered surfaces per frame read back to emulated memory that had to wait "
+           "for the GPU, video memory used by cached surfaces, and vertex data per frame drawn "
+           "from the vertex cache instead of being uploaded."));
+
+    for (auto& label :
+         {emu_speed_label, game_fps_label, emu_frametime_label, renderer_stats_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -908,6 +920,7 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    renderer_stats_label->setVisible(false);
 
     emulation_running = false;
 
@@ -1592,6 +1605,23 @@ void GMainWindow::UpdateStatusBar() {
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+
+    // Only the hardware renderer caches textures
+    const bool show_renderer_stats =
+        UISettings::values.show_renderer_stats && Settings::values.use_hw_renderer;
+    if (show_renderer_stats) {
+        renderer_stats_label->setText(
+            tr("Uploads skipped: %1 KiB, flushes stalled: %2 of %3, surfaces: %4 MiB, "
+               "vertices reused: %5 of %6 KiB")
+                .arg(results.skipped_upload_bytes / 1024.0, 0, 'f', 0)
+                .arg(results.stalled_surface_flushes, 0, 'f', 1)
+                .arg(results.surface_flushes, 0, 'f', 1)
+                .arg(results.surface_cache_bytes / (1024.0 * 1024.0), 0, 'f', 0)
+                .arg(results.reused_vertex_bytes / 1024.0, 0, 'f', 0)
+                .arg((results.reused_vertex_bytes + results.uploaded_vertex_bytes) / 1024.0, 0,
+                     'f', 0));
+    }
+    renderer_stats_label->setVisible(show_renderer_stats);
 }
 
 void GMainWindow::OnCoreError(Core::System::ResultStatus result, std::string details) {
@@ -1834,6 +1864,11 @@ void GMainWindow::RetranslateStatusBar() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    renderer_stats_label->setToolTip(
+        tr("Texture data per frame the renderer didn't upload again, as the game rewrote it "
+           "unchanged, rendered surfaces per frame read back to emulated memory that had to wait "
+           "for the GPU, video memory used by cached surfaces, and vertex data per frame drawn "
+           "from the vertex cache instead of being uploaded."));
 
     multiplayer_state->retranslateUi();
 }
@@ -116,6 +116,9 @@ struct Values {
 
     // logging
     bool show_console;
+
+    // Renderer cache counters in the status bar, for performance debugging
+    bool show_renderer_stats;
 };
 
 extern Values values;
@@ -0,0 +1,210 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// This needs to be included before getopt.h because the latter #defines symbols used by it
+#include "common/microprofile.h"
+
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#include "citra_trace_player/emu_window/emu_window_offscreen.h"
+#include "citra_trace_player/trace_stats.h"
+#ifdef HAVE_SDL2
+#include "citra_trace_player/emu_window/emu_window_sdl2_hidden.h"
+#endif
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "core/core.h"
+#include "core/settings.h"
+#include "core/tracer/player.h"
+#include "video_core/command_processor.h"
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <trace>\n"
+                 "Replays a CiTrace recorded by the graphics debugger and reports how long each\n"
+                 "frame and draw took on the host.\n"
+                 "-r, --renderer=software|opengl  Rasterizer to replay the trace with (software)\n"
+                 "-l, --loops=NUMBER   Replay the trace NUMBER times (1), the state recorded at\n"
+                 "                     its start is restored before each loop\n"
+                 "-c, --csv=FILE       Write the timings of every frame to FILE\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+/// Configures the emulator for replaying a trace as fast as possible
+static void ApplySettings(bool use_opengl) {
+    Settings::values.renderer_backend =
+        use_opengl ? Settings::RendererBackend::OpenGL : Settings::RendererBackend::Null;
+    Settings::values.use_hw_renderer = use_opengl;
+    Settings::values.use_hw_shader = use_opengl;
+    Settings::values.shaders_accurate_gs = true;
+    Settings::values.shaders_accurate_mul = false;
+    Settings::values.use_shader_jit = true;
+    // Draws are timed on the thread processing the command lists
+    Settings::values.use_gpu_thread = false;
+    Settings::values.use_disk_shader_cache = false;
+    Settings::values.sw_rasterizer_threads = 1;
+    Settings::values.vertex_cache_size = 256;
+    Settings::values.surface_cache_budget = 1024;
+    Settings::values.resolution_factor = 1;
+    Settings::values.vsync_enabled = false;
+    Settings::values.use_frame_limit = false;
+    Settings::values.sink_id = "null";
+    Settings::values.use_virtual_sd = true;
+    Settings::Apply();
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Log::Filter log_filter(Log::Level::Info);
+    Log::SetGlobalFilter(log_filter);
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    std::string renderer = "software";
+    u32 loops = 1;
+    std::string csv_path;
+    std::string filepath;
+    int option_index = 0;
+    char* endarg;
+
+    static struct option long_options[] = {
+        {"renderer", required_argument, 0, 'r'},
+        {"loops", required_argument, 0, 'l'},
+        {"csv", required_argument, 0, 'c'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        char arg = getopt_long(argc, argv, "r:l:c:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (arg) {
+            case 'r':
+                renderer = optarg;
+                break;
+            case 'l':
+                errno = 0;
+                loops = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || loops == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--loops");
+                    return 1;
+                }
+                break;
+            case 'c':
+                csv_path = optarg;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return 1;
+            }
+        } else {
+            filepath = argv[optind];
+            optind++;
+        }
+    }
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty()) {
+        LOG_CRITICAL(Frontend, "No trace specified");
+        return -1;
+    }
+    if (renderer != "software" && renderer != "opengl") {
+        LOG_CRITICAL(Frontend, "Unknown renderer {}", renderer);
+        return -1;
+    }
+    const bool use_opengl = renderer == "opengl";
+
+    CiTrace::Player player;
+    if (!player.Open(filepath)) {
+        return -1;
+    }
+    if (player.GetFrameCount() == 0) {
+        LOG_CRITICAL(Frontend, "{} doesn't contain a complete frame", filepath);
+        return -1;
+    }
+
+    ApplySettings(use_opengl);
+
+    // EmuWindow can't be destroyed through a base pointer, so each kind of window is owned apart
+    EmuWindow_Offscreen offscreen_window;
+    EmuWindow* emu_window = &offscreen_window;
+#ifdef HAVE_SDL2
+    std::unique_ptr<EmuWindow_SDL2_Hidden> sdl2_window;
+#endif
+    if (use_opengl) {
+#ifdef HAVE_SDL2
+        sdl2_window = std::make_unique<EmuWindow_SDL2_Hidden>();
+        if (!sdl2_window->IsValid()) {
+            return -1;
+        }
+        emu_window = sdl2_window.get();
+#else
+        LOG_CRITICAL(Frontend, "The OpenGL renderer requires building with SDL2");
+        return -1;
+#endif
+    }
+
+    Core::System& system{Core::System::GetInstance()};
+    SCOPE_EXIT({ system.Shutdown(); });
+    if (system.InitWithoutApplication(*emu_window) != Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to initialize the emulated GPU");
+        return -1;
+    }
+
+    TraceStats stats;
+    Pica::CommandProcessor::SetDrawCallback(
+        [&stats](const Pica::CommandProcessor::DrawInfo& draw) { stats.AddDraw(draw); });
+    SCOPE_EXIT({ Pica::CommandProcessor::SetDrawCallback(nullptr); });
+
+    for (u32 loop = 0; loop < loops; ++loop) {
+        player.Rewind();
+        for (u32 frame = 0;; ++frame) {
+            const auto start = std::chrono::steady_clock::now();
+            if (!player.PlayFrame()) {
+                // The elements after the last frame marker don't make up a frame
+                break;
+            }
+            stats.EndFrame(loop, frame, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    std::cout << stats.FormatSummary();
+    if (use_opengl) {
+        std::cout << "OpenGL draw times are the time taken to submit the draws, the GPU may "
+                     "execute them later\n";
+    }
+    std::cout << std::flush;
+
+    if (!csv_path.empty() && !stats.WriteFrameCsv(csv_path)) {
+        LOG_ERROR(Frontend, "Failed to write the frame timings to {}", csv_path);
+        return -1;
+    }
+    return 0;
+}
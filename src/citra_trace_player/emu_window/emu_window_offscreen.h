@@ -0,0 +1,26 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/3ds.h"
+#include "core/frontend/emu_window.h"
+
+/// Window which presents nothing, for replaying traces with the software rasterizer
+class EmuWindow_Offscreen : public EmuWindow {
+public:
+    EmuWindow_Offscreen() {
+        UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                       Core::kScreenTopHeight + Core::kScreenBottomHeight);
+    }
+
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+
+private:
+    void OnMinimalClientAreaChangeRequest(
+        const std::pair<unsigned, unsigned>& minimal_size) override {}
+};
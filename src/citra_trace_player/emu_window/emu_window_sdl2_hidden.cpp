@@ -0,0 +1,80 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <SDL.h>
+#include <glad/glad.h>
+#include "citra_trace_player/emu_window/emu_window_sdl2_hidden.h"
+#include "common/logging/log.h"
+#include "core/3ds.h"
+
+EmuWindow_SDL2_Hidden::EmuWindow_SDL2_Hidden() {
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        LOG_CRITICAL(Frontend, "Failed to initialize SDL2: {}", SDL_GetError());
+        return;
+    }
+
+    SDL_SetMainReady();
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
+    SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
+    SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
+    SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 0);
+
+    const u32 width = Core::kScreenTopWidth;
+    const u32 height = Core::kScreenTopHeight + Core::kScreenBottomHeight;
+    render_window = SDL_CreateWindow("citra-trace-player", SDL_WINDOWPOS_UNDEFINED,
+                                     SDL_WINDOWPOS_UNDEFINED, width, height,
+                                     SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (render_window == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to create SDL2 window: {}", SDL_GetError());
+        return;
+    }
+
+    SDL_GLContext context = SDL_GL_CreateContext(render_window);
+    if (context == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to create SDL2 GL context: {}", SDL_GetError());
+        return;
+    }
+
+    if (!gladLoadGLLoader(static_cast<GLADloadproc>(SDL_GL_GetProcAddress))) {
+        LOG_CRITICAL(Frontend, "Failed to initialize GL functions: {}", SDL_GetError());
+        SDL_GL_DeleteContext(context);
+        return;
+    }
+    gl_context = context;
+
+    SDL_GL_SetSwapInterval(0);
+    UpdateCurrentFramebufferLayout(width, height);
+    DoneCurrent();
+}
+
+EmuWindow_SDL2_Hidden::~EmuWindow_SDL2_Hidden() {
+    if (gl_context != nullptr) {
+        SDL_GL_DeleteContext(gl_context);
+    }
+    if (render_window != nullptr) {
+        SDL_DestroyWindow(render_window);
+    }
+    SDL_Quit();
+}
+
+void EmuWindow_SDL2_Hidden::SwapBuffers() {
+    SDL_GL_SwapWindow(render_window);
+}
+
+void EmuWindow_SDL2_Hidden::PollEvents() {
+    SDL_PumpEvents();
+}
+
+void EmuWindow_SDL2_Hidden::MakeCurrent() {
+    SDL_GL_MakeCurrent(render_window, gl_context);
+}
+
+void EmuWindow_SDL2_Hidden::DoneCurrent() {
+    SDL_GL_MakeCurrent(render_window, nullptr);
+}
@@ -0,0 +1,37 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+
+struct SDL_Window;
+
+/**
+ * Hidden SDL2 window providing the OpenGL context of the OpenGL renderer. Buffers are swapped
+ * without vsync, so that presenting doesn't wait for the display.
+ */
+class EmuWindow_SDL2_Hidden : public EmuWindow {
+public:
+    EmuWindow_SDL2_Hidden();
+    ~EmuWindow_SDL2_Hidden();
+
+    /// Returns whether the window and its context were created
+    bool IsValid() const {
+        return gl_context != nullptr;
+    }
+
+    void SwapBuffers() override;
+    void PollEvents() override;
+    void MakeCurrent() override;
+    void DoneCurrent() override;
+
+private:
+    void OnMinimalClientAreaChangeRequest(
+        const std::pair<unsigned, unsigned>& minimal_size) override {}
+
+    SDL_Window* render_window = nullptr;
+    using SDL_GLContext = void*;
+    SDL_GLContext gl_context = nullptr;
+};
@@ -0,0 +1,96 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "citra_trace_player/trace_stats.h"
+#include "common/file_util.h"
+#include "common/statistics.h"
+
+namespace {
+
+double Sum(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (const double value : values) {
+        sum += value;
+    }
+    return sum;
+}
+
+std::string FormatDistribution(std::vector<double> values, const char* unit) {
+    std::sort(values.begin(), values.end());
+    return fmt::format("mean {:.3f}{unit}, min {:.3f}{unit}, p50 {:.3f}{unit}, p90 {:.3f}{unit}, "
+                       "p99 {:.3f}{unit}, max {:.3f}{unit}",
+                       Common::Ratio(Sum(values), static_cast<double>(values.size())),
+                       Common::Percentile(values, 0.0), Common::Percentile(values, 50.0),
+                       Common::Percentile(values, 90.0), Common::Percentile(values, 99.0),
+                       Common::Percentile(values, 100.0), fmt::arg("unit", unit));
+}
+
+} // anonymous namespace
+
+void TraceStats::AddDraw(const Pica::CommandProcessor::DrawInfo& draw) {
+    const double time_us = std::chrono::duration<double, std::micro>(draw.duration).count();
+    DrawTotals& totals = draw.accelerated ? accelerated_draws : software_draws;
+    ++totals.count;
+    totals.vertices += draw.num_vertices;
+    totals.times_us.push_back(time_us);
+
+    ++current_frame.draws;
+    if (draw.accelerated) {
+        ++current_frame.accelerated_draws;
+    }
+    current_frame.vertices += draw.num_vertices;
+    current_frame.draw_time_ms += time_us / 1000.0;
+}
+
+void TraceStats::EndFrame(u32 loop, u32 frame, std::chrono::nanoseconds duration) {
+    current_frame.loop = loop;
+    current_frame.frame = frame;
+    current_frame.time_ms = std::chrono::duration<double, std::milli>(duration).count();
+    frames.push_back(current_frame);
+    current_frame = {};
+}
+
+std::string TraceStats::FormatSummary() const {
+    std::vector<double> frame_times_ms;
+    frame_times_ms.reserve(frames.size());
+    for (const Frame& frame : frames) {
+        frame_times_ms.push_back(frame.time_ms);
+    }
+    const double total_time_ms = Sum(frame_times_ms);
+
+    std::string summary = fmt::format(
+        "Replayed {} frames in {:.3f}s, {:.2f} fps\nFrame time: {}\n", frames.size(),
+        total_time_ms / 1000.0,
+        Common::Ratio(static_cast<double>(frames.size()), total_time_ms / 1000.0),
+        FormatDistribution(frame_times_ms, "ms"));
+
+    const auto format_draws = [&summary](const char* name, const DrawTotals& totals) {
+        if (totals.count == 0) {
+            return;
+        }
+        const double time_ms = Sum(totals.times_us) / 1000.0;
+        summary += fmt::format("{} draws: {} ({} vertices) in {:.3f}ms\n  Draw time: {}\n", name,
+                               totals.count, totals.vertices, time_ms,
+                               FormatDistribution(totals.times_us, "us"));
+    };
+    format_draws("Accelerated", accelerated_draws);
+    format_draws("Software", software_draws);
+    return summary;
+}
+
+bool TraceStats::WriteFrameCsv(const std::string& path) const {
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen()) {
+        return false;
+    }
+    std::string csv = "loop,frame,time_ms,draws,accelerated_draws,vertices,draw_time_ms\n";
+    for (const Frame& frame : frames) {
+        csv += fmt::format("{},{},{:.4f},{},{},{},{:.4f}\n", frame.loop, frame.frame,
+                           frame.time_ms, frame.draws, frame.accelerated_draws, frame.vertices,
+                           frame.draw_time_ms);
+    }
+    return file.WriteBytes(csv.data(), csv.size()) == csv.size();
+}
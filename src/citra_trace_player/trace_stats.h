@@ -0,0 +1,49 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/command_processor.h"
+
+/// Timings gathered while replaying a trace
+class TraceStats {
+public:
+    /// Accounts for a draw of the current frame
+    void AddDraw(const Pica::CommandProcessor::DrawInfo& draw);
+
+    /// Ends the current frame, which took `duration` to replay and present
+    void EndFrame(u32 loop, u32 frame, std::chrono::nanoseconds duration);
+
+    /// Returns a human readable summary of the frame and draw timings
+    std::string FormatSummary() const;
+
+    /// Writes the timings of every frame as CSV. Returns false if the file can't be written.
+    bool WriteFrameCsv(const std::string& path) const;
+
+private:
+    struct Frame {
+        u32 loop;
+        u32 frame;
+        double time_ms;
+        u32 draws;
+        u32 accelerated_draws;
+        u64 vertices;
+        double draw_time_ms;
+    };
+
+    struct DrawTotals {
+        u64 count = 0;
+        u64 vertices = 0;
+        std::vector<double> times_us;
+    };
+
+    std::vector<Frame> frames;
+    Frame current_frame{};
+    DrawTotals accelerated_draws;
+    DrawTotals software_draws;
+};
@@ -40,9 +40,13 @@
 #define CHEATS_DIR "cheats"
 #define DLL_DIR "external_dlls"
 
+// Subdirs in the directory returned by GetUserPath(UserPath::CacheDir)
+#define SHADER_DIR "shaders"
+
 // Filenames
 // Files in the directory returned by GetUserPath(UserPath::LogDir)
 #define LOG_FILE "citra_log.txt"
+#define BINARY_LOG_FILE "citra_log.bin"
 
 // Files in the directory returned by GetUserPath(UserPath::ConfigDir)
 #define EMU_CONFIG "emu.ini"
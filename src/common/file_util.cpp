@@ -569,6 +569,20 @@ bool SetCurrentDir(const std::string& directory) {
 #endif
 }
 
+std::string GetTempDir() {
+#ifdef _WIN32
+    wchar_t temp_path[MAX_PATH + 1];
+    const DWORD length = GetTempPathW(MAX_PATH + 1, temp_path);
+    std::string directory = Common::UTF16ToUTF8(std::wstring(temp_path, length));
+#else
+    const char* envvar = getenv("TMPDIR");
+    std::string directory = envvar && *envvar ? envvar : "/tmp";
+#endif
+    while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\'))
+        directory.pop_back();
+    return directory;
+}
+
 #if defined(__APPLE__)
 std::string GetBundleDirectory() {
     CFURLRef BundleRef;
@@ -705,6 +719,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
             paths.emplace(UserPath::CacheDir, cache_dir + DIR_SEP EMU_DATA_DIR DIR_SEP);
         }
 #endif
+        paths.emplace(UserPath::ShaderDir, paths[UserPath::CacheDir] + SHADER_DIR DIR_SEP);
         paths.emplace(UserPath::SDMCDir, user_path + SDMC_DIR DIR_SEP);
         paths.emplace(UserPath::NANDDir, user_path + NAND_DIR DIR_SEP);
         paths.emplace(UserPath::SysDataDir, user_path + SYSDATA_DIR DIR_SEP);
@@ -731,6 +746,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
             user_path = paths[UserPath::RootDir] + DIR_SEP;
             paths[UserPath::ConfigDir] = user_path + CONFIG_DIR DIR_SEP;
             paths[UserPath::CacheDir] = user_path + CACHE_DIR DIR_SEP;
+            paths[UserPath::ShaderDir] = paths[UserPath::CacheDir] + SHADER_DIR DIR_SEP;
             paths[UserPath::SDMCDir] = user_path + SDMC_DIR DIR_SEP;
             paths[UserPath::NANDDir] = user_path + NAND_DIR DIR_SEP;
             break;
@@ -29,6 +29,7 @@ enum class UserPath {
     NANDDir,
     RootDir,
     SDMCDir,
+    ShaderDir,
     SysDataDir,
     UserDir,
 };
@@ -117,6 +118,9 @@ bool DeleteDirRecursively(const std::string& directory, unsigned int recursion =
 // Returns the current directory
 std::string GetCurrentDir();
 
+// Returns the directory for temporary files, without a trailing separator
+std::string GetTempDir();
+
 // Create directory and copy contents (does not overwrite existing files)
 void CopyDir(const std::string& source_path, const std::string& dest_path);
 
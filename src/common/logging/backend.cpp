@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -18,6 +19,7 @@
 #endif
 #include "common/assert.h"
 #include "common/logging/backend.h"
+#include "common/logging/deferred_message.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
 #include "common/string_util.h"
@@ -25,6 +27,17 @@
 
 namespace Log {
 
+/// Size of the ring holding messages whose formatting is deferred
+constexpr std::size_t DEFERRED_RING_SIZE = 1024 * 1024;
+
+static std::chrono::microseconds GetTimestamp() {
+    using std::chrono::duration_cast;
+    using std::chrono::steady_clock;
+
+    static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
+
 /**
  * Static state as a singleton.
  */
@@ -40,6 +53,45 @@ public:
 
     void PushEntry(Entry e) {
         message_queue.Push(std::move(e));
+        Wake();
+    }
+
+    /**
+     * Copies an encoded message into the deferred message ring, waiting for the logging thread to
+     * make room if it's full.
+     * @returns false if deferred formatting is disabled
+     */
+    bool PushDeferred(const u8* message, std::size_t size, Level log_level) {
+        if (!deferred_formatting.load(std::memory_order_acquire))
+            return false;
+
+        // Falling back to the message queue would let this message overtake the ones in the ring
+        while (!deferred_ring->Push(message, size)) {
+            // The logging thread can't wait for itself
+            if (std::this_thread::get_id() == backend_thread.get_id())
+                return false;
+            Wake();
+            std::this_thread::yield();
+        }
+        // Less severe messages are picked up by the periodic drain of the ring
+        if (log_level >= Level::Warning) {
+            Wake();
+        }
+        return true;
+    }
+
+    bool IsDeferredFormattingEnabled() const {
+        return deferred_formatting.load(std::memory_order_acquire);
+    }
+
+    void SetDeferredFormatting(bool enabled) {
+        std::lock_guard<std::mutex> lock(writing_mutex);
+        if (enabled && !deferred_ring) {
+            deferred_ring = std::make_unique<DeferredMessageRing>(DEFERRED_RING_SIZE);
+        }
+        deferred_formatting.store(enabled, std::memory_order_release);
+        // The logging thread only drains the ring periodically while deferred formatting is on
+        Wake();
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -76,24 +128,89 @@ private:
     Impl() {
         backend_thread = std::thread([&] {
             Entry entry;
+            std::vector<u8> encoded_message;
+            DeferredMessage message;
             auto write_logs = [&](Entry& e) {
                 std::lock_guard<std::mutex> lock(writing_mutex);
                 for (const auto& backend : backends) {
                     backend->Write(e);
                 }
             };
+            auto write_deferred = [&] {
+                DecodeDeferredMessage(encoded_message.data(), message);
+                std::lock_guard<std::mutex> lock(writing_mutex);
+                // Only format the message if one of the backends needs it
+                bool formatted = false;
+                for (const auto& backend : backends) {
+                    if (backend->WriteDeferred(message)) {
+                        continue;
+                    }
+                    if (!formatted) {
+                        entry = message.ToEntry();
+                        formatted = true;
+                    }
+                    backend->Write(entry);
+                }
+            };
+            DeferredMessageRing* ring = nullptr;
+            auto pop_deferred = [&] {
+                // The ring is created when deferred formatting is first enabled, and kept after
+                if (ring == nullptr) {
+                    std::lock_guard<std::mutex> lock(writing_mutex);
+                    ring = deferred_ring.get();
+                }
+                return ring != nullptr && ring->Pop(encoded_message);
+            };
             while (true) {
-                entry = message_queue.PopWait();
-                if (entry.final_entry) {
+                bool written = false;
+                while (pop_deferred()) {
+                    write_deferred();
+                    written = true;
+                }
+                bool final_entry = false;
+                while (message_queue.Pop(entry)) {
+                    if (entry.final_entry) {
+                        final_entry = true;
+                        break;
+                    }
+                    write_logs(entry);
+                    written = true;
+                }
+                if (final_entry) {
                     break;
                 }
-                write_logs(entry);
+                if (!written) {
+                    std::unique_lock<std::mutex> lock(wake_mutex);
+                    // Producers only wake a parked thread, so check for messages pushed before
+                    // they could see the flag
+                    parked.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (message_queue.Empty() && (ring == nullptr || ring->Empty())) {
+                        if (deferred_formatting.load(std::memory_order_acquire)) {
+                            // Less severe deferred messages don't wake the thread
+                            wake_cv.wait_for(lock, DEFERRED_DRAIN_INTERVAL,
+                                             [this] { return woken; });
+                        } else {
+                            wake_cv.wait(lock, [this] { return woken; });
+                        }
+                    }
+                    parked.store(false, std::memory_order_relaxed);
+                    woken = false;
+                }
             }
 
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
             // where a system is repeatedly spamming logs even on close.
             constexpr int MAX_LOGS_TO_WRITE = 100;
             int logs_written = 0;
+            while (logs_written++ < MAX_LOGS_TO_WRITE && pop_deferred()) {
+                write_deferred();
+            }
+            // Free the text of the formatted messages left in the ring
+            while (pop_deferred()) {
+                DecodeDeferredMessage(encoded_message.data(), message);
+            }
+            logs_written = 0;
             while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
                 write_logs(entry);
             }
@@ -103,15 +220,39 @@ private:
     ~Impl() {
         Entry entry;
         entry.final_entry = true;
-        message_queue.Push(entry);
+        PushEntry(std::move(entry));
         backend_thread.join();
     }
 
+    void Wake() {
+        // Pairs with the fence of the logging thread between parking and checking for messages
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!parked.load(std::memory_order_relaxed))
+            return;
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            woken = true;
+        }
+        wake_cv.notify_one();
+    }
+
+    /// How long the logging thread sleeps before checking the deferred message ring again
+    static constexpr std::chrono::milliseconds DEFERRED_DRAIN_INTERVAL{10};
+
     std::mutex writing_mutex;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
     Common::MPSCQueue<Log::Entry> message_queue;
     Filter filter;
+
+    std::unique_ptr<DeferredMessageRing> deferred_ring;
+    std::atomic<bool> deferred_formatting{false};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    bool woken = false;
+    /// Set while the logging thread waits for messages
+    std::atomic<bool> parked{false};
 };
 
 void ConsoleBackend::Write(const Entry& entry) {
@@ -250,13 +391,8 @@ const char* GetLevelName(Level log_level) {
 
 Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                   const char* function, std::string message) {
-    using std::chrono::duration_cast;
-    using std::chrono::steady_clock;
-
-    static steady_clock::time_point time_origin = steady_clock::now();
-
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
     entry.filename = Common::TrimSourcePath(filename);
@@ -283,6 +419,66 @@ Backend* GetBackend(std::string_view backend_name) {
     return Impl::Instance().GetBackend(backend_name);
 }
 
+void SetDeferredFormatting(bool enabled) {
+    Impl::Instance().SetDeferredFormatting(enabled);
+}
+
+/**
+ * Pushes a message that was formatted when logged into the deferred message ring, to keep its
+ * order with the deferred messages. Messages too long to be copied into the ring are moved to the
+ * heap and handed over to the logging thread.
+ * @returns false if the ring can't be used, in which case `message` is left as is
+ */
+static bool PushFormattedMessage(Impl& instance, Class log_class, Level log_level,
+                                 const char* filename, unsigned int line_num,
+                                 const char* function, std::string& message) {
+    std::array<u8, MAX_DEFERRED_MESSAGE_SIZE> buffer;
+    const DeferredArgument argument = MakeDeferredArgument(message);
+    if (FitsDeferredMessage(&argument, 1)) {
+        const std::size_t size =
+            EncodeDeferredMessage(buffer.data(), GetTimestamp(), log_class, log_level, filename,
+                                  line_num, function, "{}", &argument, 1);
+        return instance.PushDeferred(buffer.data(), size, log_level);
+    }
+
+    auto formatted_message = std::make_unique<std::string>(std::move(message));
+    const std::size_t size =
+        EncodeFormattedMessage(buffer.data(), GetTimestamp(), log_class, log_level, filename,
+                               line_num, function, formatted_message.get());
+    if (!instance.PushDeferred(buffer.data(), size, log_level)) {
+        message = std::move(*formatted_message);
+        return false;
+    }
+    formatted_message.release();
+    return true;
+}
+
+bool PushDeferredMessage(Class log_class, Level log_level, const char* filename,
+                         unsigned int line_num, const char* function, const char* format,
+                         const DeferredArgument* arguments, std::size_t num_arguments) {
+    auto& instance = Impl::Instance();
+    if (!instance.IsDeferredFormattingEnabled())
+        return false;
+    // Filtering here rather than on the logging thread costs a table lookup, and keeps disabled
+    // messages from being encoded and taking room in the ring
+    if (!instance.GetGlobalFilter().CheckMessage(log_class, log_level))
+        return true;
+
+    if (!FitsDeferredMessage(arguments, num_arguments)) {
+        // Format the message now rather than truncating its strings
+        std::string message = FormatDeferredMessage(format, arguments, num_arguments);
+        return PushFormattedMessage(instance, log_class, log_level, filename, line_num, function,
+                                    message);
+    }
+
+    std::array<u8, MAX_DEFERRED_MESSAGE_SIZE> buffer;
+    const std::size_t size =
+        EncodeDeferredMessage(buffer.data(), GetTimestamp(), log_class, log_level, filename,
+                              line_num, function, format, arguments, num_arguments);
+    // When the ring is full the message is formatted and queued instead, so that it isn't lost
+    return instance.PushDeferred(buffer.data(), size, log_level);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
@@ -291,8 +487,17 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
     if (!filter.CheckMessage(log_class, log_level))
         return;
 
+    std::string message = fmt::vformat(format, args);
+
+    // Keep the order of the messages by going through the ring whenever it is in use
+    if (instance.IsDeferredFormattingEnabled() &&
+        PushFormattedMessage(instance, log_class, log_level, filename, line_num, function,
+                             message)) {
+        return;
+    }
+
     Entry entry =
-        CreateEntry(log_class, log_level, filename, line_num, function, fmt::vformat(format, args));
+        CreateEntry(log_class, log_level, filename, line_num, function, std::move(message));
 
     instance.PushEntry(std::move(entry));
 }
@@ -15,6 +15,7 @@
 namespace Log {
 
 class Filter;
+struct DeferredMessage;
 
 /**
  * A log entry. Log entries are store in a structured format to permit more varied output
@@ -50,6 +51,14 @@ public:
     virtual const char* GetName() const = 0;
     virtual void Write(const Entry& entry) = 0;
 
+    /**
+     * Writes a message whose formatting was deferred, without formatting it.
+     * @returns false if the backend needs the formatted message passed to Write instead
+     */
+    virtual bool WriteDeferred(const DeferredMessage& message) {
+        return false;
+    }
+
 private:
     Filter filter;
 };
@@ -146,4 +155,11 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
  * never get the message
  */
 void SetGlobalFilter(const Filter& filter);
+
+/**
+ * Enables or disables deferred formatting. While enabled, messages with a literal format string
+ * and simple arguments are captured into a preallocated ring and only formatted by the logging
+ * thread, if one of the backends needs the formatted text.
+ */
+void SetDeferredFormatting(bool enabled);
 } // namespace Log
@@ -0,0 +1,340 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/logging/binary_log.h"
+#include "common/logging/deferred_message.h"
+#include "common/string_util.h"
+
+namespace Log {
+
+/*
+ * File layout: a header of FILE_MAGIC and FILE_VERSION as little endian u32s, followed by
+ * records starting with a RecordKind byte. Integers are LEB128 varints, signed ones zigzag
+ * encoded first.
+ *
+ * String:  varint id, varint length, bytes
+ * Message: varint timestamp delta (signed), u8 class, u8 level, varint file id, varint line,
+ *          varint function id, varint format id, u8 argument count, then for each argument its
+ *          u8 ArgumentType and value:
+ *            Bool, Char, Unsigned, Pointer: varint
+ *            Signed: signed varint
+ *            Float, Double: 4 or 8 bytes of IEEE 754, little endian
+ *            String: varint length, bytes
+ */
+
+namespace {
+
+constexpr u32 FILE_MAGIC = 0x474F4C43; // "CLOG"
+constexpr u32 FILE_VERSION = 1;
+
+enum class RecordKind : u8 {
+    String = 0,
+    Message = 1,
+};
+
+/// Records are written out once this much has accumulated, or after an error message
+constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+/// Same purpose as the limit of FileBackend, allowing for longer sessions as the file is compact
+constexpr std::size_t MAX_BYTES_WRITTEN = 256 * 1024L * 1024L;
+
+void WriteVarint(std::vector<u8>& out, u64 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<u8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<u8>(value));
+}
+
+void WriteSignedVarint(std::vector<u8>& out, s64 value) {
+    WriteVarint(out, (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63));
+}
+
+template <typename T>
+void WriteRaw(std::vector<u8>& out, const T& value) {
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(&out[offset], &value, sizeof(T));
+}
+
+void WriteString(std::vector<u8>& out, std::string_view string) {
+    WriteVarint(out, string.size());
+    out.insert(out.end(), string.begin(), string.end());
+}
+
+/// Bounds-checked reads from a record, any failure sets `failed` and returns zeroes
+class RecordReader {
+public:
+    RecordReader(const std::vector<u8>& data, std::size_t& offset) : data(data), offset(offset) {}
+
+    bool Failed() const {
+        return failed;
+    }
+
+    u8 ReadByte() {
+        if (offset >= data.size()) {
+            failed = true;
+            return 0;
+        }
+        return data[offset++];
+    }
+
+    u64 ReadVarint() {
+        u64 value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const u8 byte = ReadByte();
+            value |= static_cast<u64>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    s64 ReadSignedVarint() {
+        const u64 value = ReadVarint();
+        return static_cast<s64>(value >> 1) ^ -static_cast<s64>(value & 1);
+    }
+
+    template <typename T>
+    T ReadRaw() {
+        T value{};
+        if (data.size() - offset < sizeof(T)) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, &data[offset], sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string_view ReadString() {
+        const u64 length = ReadVarint();
+        if (failed || data.size() - offset < length) {
+            failed = true;
+            return {};
+        }
+        const std::string_view string(reinterpret_cast<const char*>(&data[offset]), length);
+        offset += length;
+        return string;
+    }
+
+private:
+    const std::vector<u8>& data;
+    std::size_t& offset;
+    bool failed = false;
+};
+
+} // anonymous namespace
+
+BinaryFileBackend::BinaryFileBackend(const std::string& filename) : file(filename, "wb") {
+    WriteRaw(records, FILE_MAGIC);
+    WriteRaw(records, FILE_VERSION);
+    FlushRecords(true);
+}
+
+BinaryFileBackend::~BinaryFileBackend() {
+    FlushRecords(true);
+}
+
+void BinaryFileBackend::Write(const Entry& entry) {
+    // Messages formatted when logged are stored as the only argument of a "{}" format
+    const DeferredArgument message = MakeDeferredArgument(entry.message);
+    WriteMessage(entry.timestamp, entry.log_class, entry.log_level,
+                 GetStringId(std::string_view(entry.filename)), entry.line_num,
+                 GetStringId(std::string_view(entry.function)), GetStringId("{}"), &message, 1);
+}
+
+bool BinaryFileBackend::WriteDeferred(const DeferredMessage& message) {
+    WriteMessage(message.timestamp, message.log_class, message.log_level,
+                 GetStringId(message.filename, true), message.line_num,
+                 GetStringId(message.function), GetStringId(message.format.data()),
+                 message.arguments.data(), message.arguments.size());
+    return true;
+}
+
+u32 BinaryFileBackend::GetStringId(const char* string, bool source_path) {
+    const auto it = ids_by_address.find(string);
+    if (it != ids_by_address.end()) {
+        return it->second;
+    }
+    // Different literals can have the same content, e.g. the file name of inlined functions
+    const u32 id =
+        GetStringId(std::string_view(source_path ? Common::TrimSourcePath(string) : string));
+    ids_by_address.emplace(string, id);
+    return id;
+}
+
+u32 BinaryFileBackend::GetStringId(std::string_view string) {
+    std::string content(string);
+    const auto it = ids_by_content.find(content);
+    if (it != ids_by_content.end()) {
+        return it->second;
+    }
+    const u32 id = static_cast<u32>(ids_by_content.size());
+    records.push_back(static_cast<u8>(RecordKind::String));
+    WriteVarint(records, id);
+    WriteString(records, content);
+    ids_by_content.emplace(std::move(content), id);
+    return id;
+}
+
+void BinaryFileBackend::WriteMessage(std::chrono::microseconds timestamp, Class log_class,
+                                     Level log_level, u32 filename_id, unsigned int line_num,
+                                     u32 function_id, u32 format_id,
+                                     const DeferredArgument* arguments,
+                                     std::size_t num_arguments) {
+    records.push_back(static_cast<u8>(RecordKind::Message));
+    WriteSignedVarint(records, timestamp.count() - previous_timestamp);
+    previous_timestamp = timestamp.count();
+    records.push_back(static_cast<u8>(log_class));
+    records.push_back(static_cast<u8>(log_level));
+    WriteVarint(records, filename_id);
+    WriteVarint(records, line_num);
+    WriteVarint(records, function_id);
+    WriteVarint(records, format_id);
+    records.push_back(static_cast<u8>(num_arguments));
+
+    for (std::size_t i = 0; i < num_arguments; ++i) {
+        const DeferredArgument& argument = arguments[i];
+        records.push_back(static_cast<u8>(argument.type));
+        switch (argument.type) {
+        case ArgumentType::Bool:
+        case ArgumentType::Char:
+        case ArgumentType::Unsigned:
+        case ArgumentType::Pointer:
+            WriteVarint(records, argument.integer);
+            break;
+        case ArgumentType::Signed:
+            WriteSignedVarint(records, static_cast<s64>(argument.integer));
+            break;
+        case ArgumentType::Float:
+            WriteRaw(records, static_cast<float>(argument.floating));
+            break;
+        case ArgumentType::Double:
+            WriteRaw(records, argument.floating);
+            break;
+        case ArgumentType::String:
+            WriteString(records, argument.string);
+            break;
+        }
+    }
+
+    FlushRecords(log_level >= Level::Error);
+}
+
+void BinaryFileBackend::FlushRecords(bool force) {
+    if (!force && records.size() < FLUSH_THRESHOLD) {
+        return;
+    }
+    // Like FileBackend, stop writing instead of filling the disk
+    if (file.IsOpen() && bytes_written <= MAX_BYTES_WRITTEN) {
+        bytes_written += file.WriteBytes(records.data(), records.size());
+        if (force) {
+            file.Flush();
+        }
+    }
+    records.clear();
+}
+
+BinaryLogReader::BinaryLogReader(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        return;
+    }
+    data.resize(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        return;
+    }
+
+    RecordReader reader(data, offset);
+    const u32 magic = reader.ReadRaw<u32>();
+    const u32 version = reader.ReadRaw<u32>();
+    valid = !reader.Failed() && magic == FILE_MAGIC && version == FILE_VERSION;
+}
+
+bool BinaryLogReader::ReadEntry(Entry& entry) {
+    if (!valid || corrupt) {
+        return false;
+    }
+
+    RecordReader reader(data, offset);
+    while (offset < data.size()) {
+        const u8 kind = reader.ReadByte();
+        if (kind == static_cast<u8>(RecordKind::String)) {
+            const u64 id = reader.ReadVarint();
+            const std::string_view string = reader.ReadString();
+            if (reader.Failed() || id != strings.size()) {
+                corrupt = true;
+                return false;
+            }
+            strings.emplace_back(string);
+            continue;
+        }
+        if (kind != static_cast<u8>(RecordKind::Message)) {
+            corrupt = true;
+            return false;
+        }
+
+        timestamp += reader.ReadSignedVarint();
+        const u8 log_class = reader.ReadByte();
+        const u8 log_level = reader.ReadByte();
+        const u64 filename_id = reader.ReadVarint();
+        const u64 line_num = reader.ReadVarint();
+        const u64 function_id = reader.ReadVarint();
+        const u64 format_id = reader.ReadVarint();
+        const u8 num_arguments = reader.ReadByte();
+        if (reader.Failed() || log_class >= static_cast<u8>(Class::Count) ||
+            log_level >= static_cast<u8>(Level::Count) || filename_id >= strings.size() ||
+            function_id >= strings.size() || format_id >= strings.size()) {
+            corrupt = true;
+            return false;
+        }
+
+        std::vector<DeferredArgument> arguments(num_arguments);
+        for (DeferredArgument& argument : arguments) {
+            argument.type = static_cast<ArgumentType>(reader.ReadByte());
+            switch (argument.type) {
+            case ArgumentType::Bool:
+            case ArgumentType::Char:
+            case ArgumentType::Unsigned:
+            case ArgumentType::Pointer:
+                argument.integer = reader.ReadVarint();
+                break;
+            case ArgumentType::Signed:
+                argument.integer = static_cast<u64>(reader.ReadSignedVarint());
+                break;
+            case ArgumentType::Float:
+                argument.floating = reader.ReadRaw<float>();
+                break;
+            case ArgumentType::Double:
+                argument.floating = reader.ReadRaw<double>();
+                break;
+            case ArgumentType::String:
+                argument.string = reader.ReadString();
+                break;
+            default:
+                corrupt = true;
+                return false;
+            }
+        }
+        if (reader.Failed()) {
+            corrupt = true;
+            return false;
+        }
+
+        entry.timestamp = std::chrono::microseconds(timestamp);
+        entry.log_class = static_cast<Class>(log_class);
+        entry.log_level = static_cast<Level>(log_level);
+        entry.filename = strings[filename_id];
+        entry.line_num = static_cast<unsigned int>(line_num);
+        entry.function = strings[function_id];
+        entry.message = FormatDeferredMessage(strings[format_id], arguments.data(), num_arguments);
+        return true;
+    }
+    return false;
+}
+
+} // namespace Log
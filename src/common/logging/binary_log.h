@@ -0,0 +1,92 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+
+namespace Log {
+
+/**
+ * Backend that writes messages to a compact binary file, to be decoded by citra-log-decoder.
+ * File names, function names and format strings are written once and referred to by id, and the
+ * arguments of deferred messages are stored unformatted.
+ */
+class BinaryFileBackend : public Backend {
+public:
+    explicit BinaryFileBackend(const std::string& filename);
+    ~BinaryFileBackend() override;
+
+    static const char* Name() {
+        return "binary_file";
+    }
+
+    const char* GetName() const override {
+        return Name();
+    }
+
+    void Write(const Entry& entry) override;
+    bool WriteDeferred(const DeferredMessage& message) override;
+
+private:
+    /**
+     * Returns the id of a string, writing its definition first if it's new.
+     * @param source_path Whether the string is a source file path to trim like CreateEntry does
+     */
+    u32 GetStringId(const char* string, bool source_path = false);
+    u32 GetStringId(std::string_view string);
+
+    void WriteMessage(std::chrono::microseconds timestamp, Class log_class, Level log_level,
+                      u32 filename_id, unsigned int line_num, u32 function_id, u32 format_id,
+                      const DeferredArgument* arguments, std::size_t num_arguments);
+    void FlushRecords(bool force);
+
+    FileUtil::IOFile file;
+    std::size_t bytes_written = 0;
+    std::vector<u8> records;
+    s64 previous_timestamp = 0;
+
+    /// Strings of deferred messages are literals, so their address is enough to recognize them
+    std::unordered_map<const char*, u32> ids_by_address;
+    std::unordered_map<std::string, u32> ids_by_content;
+};
+
+/// Reads back the messages of a file written by BinaryFileBackend
+class BinaryLogReader {
+public:
+    explicit BinaryLogReader(const std::string& filename);
+
+    /// Whether the file was read and has a valid header
+    bool IsValid() const {
+        return valid;
+    }
+
+    /**
+     * Reads and formats the next message.
+     * @returns false at the end of the file, or if the rest of the file is invalid
+     */
+    bool ReadEntry(Entry& entry);
+
+    /// Whether reading stopped because of invalid data rather than at the end of the file
+    bool IsCorrupt() const {
+        return corrupt;
+    }
+
+private:
+    std::vector<u8> data;
+    std::size_t offset = 0;
+    bool valid = false;
+    bool corrupt = false;
+    s64 timestamp = 0;
+    std::vector<std::string> strings;
+};
+
+} // namespace Log
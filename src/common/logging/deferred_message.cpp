@@ -0,0 +1,328 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/assert.h"
+#include "common/logging/backend.h"
+#include "common/logging/deferred_message.h"
+#include "common/string_util.h"
+
+namespace Log {
+
+namespace {
+
+/// Fixed-size part of an encoded message, followed by its arguments
+struct EncodedHeader {
+    s64 timestamp;
+    const char* filename;
+    const char* function;
+    const char* format;
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+    u8 num_arguments;
+    /// The header is followed by a pointer to the text of the message instead of its arguments
+    bool formatted;
+};
+
+/// Format of the messages encoded by EncodeFormattedMessage
+constexpr char FORMATTED_MESSAGE_FORMAT[] = "{}";
+
+std::size_t EncodedArgumentSize(const DeferredArgument& argument) {
+    if (argument.type == ArgumentType::String) {
+        return 1 + sizeof(u32) + argument.string.size();
+    }
+    return 1 + sizeof(u64);
+}
+
+template <typename T>
+std::string FormatValue(std::string_view field, const T& value) {
+    try {
+        return fmt::vformat(field, fmt::make_format_args(value));
+    } catch (const fmt::format_error&) {
+        return std::string(field);
+    }
+}
+
+std::string FormatArgument(std::string_view field, const DeferredArgument& argument) {
+    switch (argument.type) {
+    case ArgumentType::Bool:
+        return FormatValue(field, argument.integer != 0);
+    case ArgumentType::Char:
+        return FormatValue(field, static_cast<char>(argument.integer));
+    case ArgumentType::Signed:
+        return FormatValue(field, static_cast<s64>(argument.integer));
+    case ArgumentType::Unsigned:
+        return FormatValue(field, argument.integer);
+    case ArgumentType::Float:
+        return FormatValue(field, static_cast<float>(argument.floating));
+    case ArgumentType::Double:
+        return FormatValue(field, argument.floating);
+    case ArgumentType::Pointer:
+        return FormatValue(field,
+                           reinterpret_cast<const void*>(static_cast<uintptr_t>(argument.integer)));
+    case ArgumentType::String:
+        return FormatValue(field, argument.string);
+    }
+    return std::string(field);
+}
+
+} // anonymous namespace
+
+Entry DeferredMessage::ToEntry() const {
+    Entry entry;
+    entry.timestamp = timestamp;
+    entry.log_class = log_class;
+    entry.log_level = log_level;
+    entry.filename = Common::TrimSourcePath(filename);
+    entry.line_num = line_num;
+    entry.function = function;
+    entry.message = FormatDeferredMessage(format, arguments.data(), arguments.size());
+    return entry;
+}
+
+std::string FormatDeferredMessage(std::string_view format, const DeferredArgument* arguments,
+                                  std::size_t num_arguments) {
+    std::string message;
+    message.reserve(format.size());
+    std::size_t next_argument = 0;
+
+    std::size_t i = 0;
+    while (i < format.size()) {
+        const std::size_t special = format.find_first_of("{}", i);
+        message.append(format.substr(i, special - i));
+        if (special == std::string_view::npos) {
+            break;
+        }
+        i = special;
+
+        // Escaped braces, or a lone closing brace which fmt would reject
+        if (format[i] == '}' || (i + 1 < format.size() && format[i + 1] == '{')) {
+            message += format[i];
+            i += (i + 1 < format.size() && format[i + 1] == format[i]) ? 2 : 1;
+            continue;
+        }
+
+        const std::size_t end = format.find('}', i);
+        if (end == std::string_view::npos) {
+            message.append(format.substr(i));
+            break;
+        }
+        const std::string_view field = format.substr(i, end + 1 - i);
+        i = end + 1;
+
+        // Split "{index:spec}" into its index and the field to format the argument with
+        const std::size_t colon = std::min(field.find(':'), field.size() - 1);
+        const std::string_view index = field.substr(1, colon - 1);
+        std::size_t argument = next_argument++;
+        if (!index.empty()) {
+            argument = 0;
+            for (const char c : index) {
+                if (c < '0' || c > '9') {
+                    argument = num_arguments;
+                    break;
+                }
+                argument = argument * 10 + (c - '0');
+            }
+        }
+        if (argument >= num_arguments || field.find('{', 1) != std::string_view::npos) {
+            message.append(field);
+            continue;
+        }
+
+        std::string argument_field = "{";
+        argument_field.append(field.substr(colon));
+        message += FormatArgument(argument_field, arguments[argument]);
+    }
+    return message;
+}
+
+bool FitsDeferredMessage(const DeferredArgument* arguments, std::size_t num_arguments) {
+    std::size_t size = sizeof(EncodedHeader);
+    for (std::size_t i = 0; i < num_arguments; ++i) {
+        size += EncodedArgumentSize(arguments[i]);
+    }
+    return size <= MAX_DEFERRED_MESSAGE_SIZE;
+}
+
+std::size_t EncodeDeferredMessage(u8* buffer, std::chrono::microseconds timestamp,
+                                  Class log_class, Level log_level, const char* filename,
+                                  unsigned int line_num, const char* function, const char* format,
+                                  const DeferredArgument* arguments, std::size_t num_arguments) {
+    DEBUG_ASSERT(FitsDeferredMessage(arguments, num_arguments));
+    EncodedHeader header;
+    header.timestamp = timestamp.count();
+    header.filename = filename;
+    header.function = function;
+    header.format = format;
+    header.line_num = line_num;
+    header.log_class = log_class;
+    header.log_level = log_level;
+    header.num_arguments = static_cast<u8>(num_arguments);
+    header.formatted = false;
+    std::memcpy(buffer, &header, sizeof(header));
+    std::size_t size = sizeof(header);
+
+    for (std::size_t i = 0; i < num_arguments; ++i) {
+        const DeferredArgument& argument = arguments[i];
+        buffer[size++] = static_cast<u8>(argument.type);
+        if (argument.type == ArgumentType::String) {
+            const u32 length = static_cast<u32>(argument.string.size());
+            std::memcpy(&buffer[size], &length, sizeof(length));
+            std::memcpy(&buffer[size + sizeof(length)], argument.string.data(), length);
+            size += sizeof(length) + length;
+        } else {
+            std::memcpy(&buffer[size], &argument.integer, sizeof(argument.integer));
+            size += sizeof(argument.integer);
+        }
+    }
+    return size;
+}
+
+std::size_t EncodeFormattedMessage(u8* buffer, std::chrono::microseconds timestamp,
+                                   Class log_class, Level log_level, const char* filename,
+                                   unsigned int line_num, const char* function,
+                                   std::string* formatted_message) {
+    EncodedHeader header;
+    header.timestamp = timestamp.count();
+    header.filename = filename;
+    header.function = function;
+    header.format = FORMATTED_MESSAGE_FORMAT;
+    header.line_num = line_num;
+    header.log_class = log_class;
+    header.log_level = log_level;
+    header.num_arguments = 1;
+    header.formatted = true;
+    std::memcpy(buffer, &header, sizeof(header));
+    std::memcpy(&buffer[sizeof(header)], &formatted_message, sizeof(formatted_message));
+    return sizeof(header) + sizeof(formatted_message);
+}
+
+void DecodeDeferredMessage(const u8* data, DeferredMessage& message) {
+    EncodedHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    message.timestamp = std::chrono::microseconds(header.timestamp);
+    message.log_class = header.log_class;
+    message.log_level = header.log_level;
+    message.filename = header.filename;
+    message.line_num = header.line_num;
+    message.function = header.function;
+    message.format = header.format;
+
+    if (header.formatted) {
+        std::string* formatted_message;
+        std::memcpy(&formatted_message, &data[sizeof(header)], sizeof(formatted_message));
+        message.formatted_message.reset(formatted_message);
+        message.arguments.assign(1, MakeDeferredArgument(*formatted_message));
+        return;
+    }
+    message.formatted_message.reset();
+
+    std::size_t offset = sizeof(header);
+    message.arguments.resize(header.num_arguments);
+    for (DeferredArgument& argument : message.arguments) {
+        argument.type = static_cast<ArgumentType>(data[offset++]);
+        if (argument.type == ArgumentType::String) {
+            u32 length;
+            std::memcpy(&length, &data[offset], sizeof(length));
+            argument.string = std::string_view(
+                reinterpret_cast<const char*>(&data[offset + sizeof(length)]), length);
+            offset += sizeof(length) + length;
+        } else {
+            std::memcpy(&argument.integer, &data[offset], sizeof(argument.integer));
+            offset += sizeof(argument.integer);
+        }
+    }
+}
+
+DeferredMessageRing::DeferredMessageRing(std::size_t capacity) {
+    // Always fit at least two messages of the largest size
+    capacity = std::max(capacity, 2 * (sizeof(u32) + MAX_DEFERRED_MESSAGE_SIZE));
+    num_slots = 1;
+    while (num_slots * SLOT_SIZE < capacity) {
+        num_slots <<= 1;
+    }
+    buffer = std::make_unique<u8[]>(num_slots * SLOT_SIZE);
+    sequences = std::make_unique<std::atomic<u64>[]>(num_slots);
+    for (std::size_t i = 0; i < num_slots; ++i) {
+        sequences[i].store(i, std::memory_order_relaxed);
+    }
+}
+
+DeferredMessageRing::~DeferredMessageRing() = default;
+
+bool DeferredMessageRing::Push(const u8* message, std::size_t size) {
+    const u64 needed = (sizeof(u32) + size + SLOT_SIZE - 1) / SLOT_SIZE;
+    if (needed > num_slots) {
+        return false;
+    }
+
+    // The consumer frees the slots in order, so the whole range is free if its last slot is
+    u64 position = enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+        const u64 last = position + needed - 1;
+        const u64 sequence = sequences[last & (num_slots - 1)].load(std::memory_order_acquire);
+        if (sequence == last) {
+            if (enqueue_position.compare_exchange_weak(position, position + needed,
+                                                       std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < last) {
+            return false;
+        } else {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    const u32 size32 = static_cast<u32>(size);
+    CopyIn(position, 0, reinterpret_cast<const u8*>(&size32), sizeof(size32));
+    CopyIn(position, sizeof(size32), message, size);
+    sequences[position & (num_slots - 1)].store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool DeferredMessageRing::Pop(std::vector<u8>& message) {
+    const u64 position = dequeue_position;
+    if (sequences[position & (num_slots - 1)].load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+
+    u32 size;
+    CopyOut(position, 0, reinterpret_cast<u8*>(&size), sizeof(size));
+    message.resize(size);
+    CopyOut(position, sizeof(size), message.data(), size);
+
+    const u64 needed = (sizeof(u32) + size + SLOT_SIZE - 1) / SLOT_SIZE;
+    for (u64 i = position; i < position + needed; ++i) {
+        sequences[i & (num_slots - 1)].store(i + num_slots, std::memory_order_release);
+    }
+    dequeue_position = position + needed;
+    return true;
+}
+
+bool DeferredMessageRing::Empty() const {
+    const u64 position = dequeue_position;
+    return sequences[position & (num_slots - 1)].load(std::memory_order_acquire) != position + 1;
+}
+
+void DeferredMessageRing::CopyIn(u64 position, std::size_t offset, const u8* data,
+                                 std::size_t size) {
+    const std::size_t buffer_size = num_slots * SLOT_SIZE;
+    const std::size_t start = ((position & (num_slots - 1)) * SLOT_SIZE + offset) % buffer_size;
+    const std::size_t first_part = std::min(size, buffer_size - start);
+    std::memcpy(&buffer[start], data, first_part);
+    std::memcpy(&buffer[0], data + first_part, size - first_part);
+}
+
+void DeferredMessageRing::CopyOut(u64 position, std::size_t offset, u8* data,
+                                  std::size_t size) const {
+    const std::size_t buffer_size = num_slots * SLOT_SIZE;
+    const std::size_t start = ((position & (num_slots - 1)) * SLOT_SIZE + offset) % buffer_size;
+    const std::size_t first_part = std::min(size, buffer_size - start);
+    std::memcpy(data, &buffer[start], first_part);
+    std::memcpy(data + first_part, &buffer[0], size - first_part);
+}
+
+} // namespace Log
@@ -0,0 +1,127 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "common/logging/log.h"
+
+namespace Log {
+
+struct Entry;
+
+/// A log message whose formatting was deferred, as read back by the logging thread
+struct DeferredMessage {
+    std::chrono::microseconds timestamp;
+    Class log_class;
+    Level log_level;
+    const char* filename;
+    unsigned int line_num;
+    const char* function;
+    std::string_view format;
+    /// The strings of the arguments point into the buffer the message was decoded from, or into
+    /// formatted_message
+    std::vector<DeferredArgument> arguments;
+    /// Text of a message that was formatted when logged, which is its only argument
+    std::unique_ptr<std::string> formatted_message;
+
+    /// Formats the message into a log entry.
+    Entry ToEntry() const;
+};
+
+/**
+ * Formats a message with fmt syntax from captured arguments. Replacement fields referring to a
+ * missing argument, or with a specification that doesn't apply to their argument, are output as
+ * is. Nested replacement fields (dynamic width and precision) aren't supported.
+ */
+std::string FormatDeferredMessage(std::string_view format, const DeferredArgument* arguments,
+                                  std::size_t num_arguments);
+
+/// Largest size of an encoded message
+constexpr std::size_t MAX_DEFERRED_MESSAGE_SIZE = 2048;
+
+/// Returns whether a message with these arguments fits in MAX_DEFERRED_MESSAGE_SIZE bytes
+bool FitsDeferredMessage(const DeferredArgument* arguments, std::size_t num_arguments);
+
+/**
+ * Encodes a message for DeferredMessageRing into `buffer`, which must hold at least
+ * MAX_DEFERRED_MESSAGE_SIZE bytes. The arguments must pass FitsDeferredMessage.
+ * @returns the size of the encoded message
+ */
+std::size_t EncodeDeferredMessage(u8* buffer, std::chrono::microseconds timestamp,
+                                  Class log_class, Level log_level, const char* filename,
+                                  unsigned int line_num, const char* function, const char* format,
+                                  const DeferredArgument* arguments, std::size_t num_arguments);
+
+/**
+ * Encodes a message that was already formatted, for messages too long to be encoded with their
+ * arguments. Only the pointer is copied into `buffer`, the decoded message takes ownership of
+ * `formatted_message`.
+ * @returns the size of the encoded message
+ */
+std::size_t EncodeFormattedMessage(u8* buffer, std::chrono::microseconds timestamp,
+                                   Class log_class, Level log_level, const char* filename,
+                                   unsigned int line_num, const char* function,
+                                   std::string* formatted_message);
+
+/**
+ * Decodes a message encoded by EncodeDeferredMessage or EncodeFormattedMessage, pointing its
+ * strings into `data`. Every encoded message must be decoded exactly once, so that the text of
+ * formatted messages is freed.
+ */
+void DecodeDeferredMessage(const u8* data, DeferredMessage& message);
+
+/**
+ * Bounded multiple producer, single consumer queue of encoded messages. Messages occupy
+ * consecutive fixed-size slots of a preallocated buffer, which producers claim with a single
+ * compare-and-swap, so pushing never allocates nor blocks.
+ */
+class DeferredMessageRing {
+public:
+    /// @param capacity Size of the buffer in bytes, rounded up to a power of two
+    explicit DeferredMessageRing(std::size_t capacity);
+    ~DeferredMessageRing();
+
+    /**
+     * Copies an encoded message into the ring.
+     * @returns false if there isn't enough free space
+     */
+    bool Push(const u8* message, std::size_t size);
+
+    /**
+     * Copies the oldest message out of the ring into `message`. Must only be called by a single
+     * consumer thread.
+     * @returns false if the ring is empty
+     */
+    bool Pop(std::vector<u8>& message);
+
+    /// Returns whether no message is ready to be popped. Must only be called by the consumer.
+    bool Empty() const;
+
+private:
+    static constexpr std::size_t SLOT_SIZE = 64;
+
+    /// Copies data to or from the message starting at the slot of `position`, wrapping around
+    void CopyIn(u64 position, std::size_t offset, const u8* data, std::size_t size);
+    void CopyOut(u64 position, std::size_t offset, u8* data, std::size_t size) const;
+
+    std::size_t num_slots;
+    std::unique_ptr<u8[]> buffer;
+    /// Sequence number of each slot. A slot is free for the message claiming `position` when its
+    /// sequence is `position`. The first slot of a message is set to `position + 1` once the
+    /// message is ready.
+    std::unique_ptr<std::atomic<u64>[]> sequences;
+
+    alignas(64) std::atomic<u64> enqueue_position{0};
+    alignas(64) u64 dequeue_position = 0;
+};
+
+} // namespace Log
@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -103,14 +108,104 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
+/// Type of an argument captured by a message whose formatting is deferred
+enum class ArgumentType : u8 {
+    Bool,
+    Char,
+    Signed,
+    Unsigned,
+    Float,
+    Double,
+    Pointer,
+    String,
+};
+
+/// Argument of a log message, captured without formatting it
+struct DeferredArgument {
+    ArgumentType type;
+    union {
+        u64 integer; ///< Bool, Char, Unsigned, Pointer, and Signed as two's complement
+        double floating;
+    };
+    std::string_view string;
+};
+
+/// Messages with more arguments than this are always formatted when logged
+constexpr std::size_t MAX_DEFERRED_ARGUMENTS = 16;
+
+/// Whether an argument of type T can be captured by a message whose formatting is deferred
+template <typename T>
+constexpr bool IsDeferrable() {
+    using U = std::decay_t<T>;
+    return (std::is_integral_v<U> && !std::is_same_v<U, wchar_t> && !std::is_same_v<U, char16_t> &&
+            !std::is_same_v<U, char32_t>) ||
+           std::is_same_v<U, float> || std::is_same_v<U, double> ||
+           std::is_same_v<U, const void*> || std::is_same_v<U, void*> ||
+           std::is_same_v<U, const char*> || std::is_same_v<U, char*> ||
+           std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>;
+}
+
+template <typename T>
+DeferredArgument MakeDeferredArgument(const T& value) {
+    using U = std::decay_t<T>;
+    DeferredArgument argument{};
+    if constexpr (std::is_same_v<U, bool>) {
+        argument.type = ArgumentType::Bool;
+        argument.integer = value;
+    } else if constexpr (std::is_same_v<U, char>) {
+        argument.type = ArgumentType::Char;
+        argument.integer = static_cast<unsigned char>(value);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        argument.type = ArgumentType::Signed;
+        argument.integer = static_cast<u64>(static_cast<s64>(value));
+    } else if constexpr (std::is_integral_v<U>) {
+        argument.type = ArgumentType::Unsigned;
+        argument.integer = value;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        argument.type = std::is_same_v<U, float> ? ArgumentType::Float : ArgumentType::Double;
+        argument.floating = value;
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        argument.type = ArgumentType::String;
+        const char* const string = value;
+        argument.string = string != nullptr ? std::string_view(string) : std::string_view();
+    } else if constexpr (std::is_pointer_v<U>) {
+        argument.type = ArgumentType::Pointer;
+        argument.integer = reinterpret_cast<std::uintptr_t>(value);
+    } else {
+        argument.type = ArgumentType::String;
+        argument.string = value;
+    }
+    return argument;
+}
+
+/**
+ * Captures a message into the ring of the global logger if deferred formatting is enabled,
+ * leaving the formatting to the logging thread. The format, file and function names must outlive
+ * the logger.
+ * @returns false if deferred formatting is disabled, in which case the message must be formatted
+ */
+bool PushDeferredMessage(Class log_class, Level log_level, const char* filename,
+                         unsigned int line_num, const char* function, const char* format,
+                         const DeferredArgument* arguments, std::size_t num_arguments);
+
 /// Logs a message to the global logger, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
-template <typename... Args>
+template <typename Format, typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, const char* format, const Args&... args) {
+                   const char* function, const Format& format, const Args&... args) {
+    // The format must outlive the message, which holds for the string literals of the LOG_ macros
+    if constexpr (std::is_array_v<Format> && sizeof...(Args) <= MAX_DEFERRED_ARGUMENTS &&
+                  (IsDeferrable<Args>() && ...)) {
+        const std::array<DeferredArgument, sizeof...(Args)> arguments{
+            {MakeDeferredArgument(args)...}};
+        if (PushDeferredMessage(log_class, log_level, filename, line_num, function, format,
+                                arguments.data(), arguments.size())) {
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -0,0 +1,29 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Common {
+
+/// Returns the nearest-rank percentile of sorted values, or 0 if there are none
+inline double Percentile(const std::vector<double>& sorted_values, double percent) {
+    if (sorted_values.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(percent / 100.0 * static_cast<double>(sorted_values.size())));
+    return sorted_values[std::clamp<std::size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+/// Divides, returning 0 instead of dividing by zero
+inline double Ratio(double dividend, double divisor) {
+    return divisor > 0.0 ? dividend / divisor : 0.0;
+}
+
+} // namespace Common
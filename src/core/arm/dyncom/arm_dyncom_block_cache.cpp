@@ -0,0 +1,69 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+BlockCache::BlockCache() : pages(std::make_unique<std::unique_ptr<Page>[]>(NUM_PAGES)) {}
+
+BlockCache::~BlockCache() = default;
+
+void BlockCache::Insert(u32 address, std::size_t offset) {
+    ASSERT(offset < NO_BLOCK);
+
+    const u32 page_index = address >> PAGE_BITS;
+    std::unique_ptr<Page>& page = pages[page_index];
+    if (page == nullptr) {
+        if (free_pages.empty()) {
+            page = std::make_unique<Page>();
+        } else {
+            page = std::move(free_pages.back());
+            free_pages.pop_back();
+        }
+        page->blocks.fill(NO_BLOCK);
+        used_pages.push_back(page_index);
+    }
+    page->blocks[(address & PAGE_MASK) >> 1] = static_cast<u32>(offset);
+}
+
+void BlockCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+    const u64 first_page = start_address >> PAGE_BITS;
+    const u64 last_page =
+        std::min<u64>((u64{start_address} + length - 1) >> PAGE_BITS, NUM_PAGES - 1);
+
+    // Walk whichever is smaller, the range or the pages in use
+    if (last_page - first_page + 1 < used_pages.size()) {
+        for (u64 page_index = first_page; page_index <= last_page; ++page_index) {
+            if (pages[page_index] != nullptr) {
+                FreePage(static_cast<u32>(page_index));
+                used_pages.erase(std::find(used_pages.begin(), used_pages.end(), page_index));
+            }
+        }
+        return;
+    }
+
+    const auto it = std::remove_if(used_pages.begin(), used_pages.end(), [&](u32 page_index) {
+        if (page_index < first_page || page_index > last_page) {
+            return false;
+        }
+        FreePage(page_index);
+        return true;
+    });
+    used_pages.erase(it, used_pages.end());
+}
+
+void BlockCache::Clear() {
+    for (const u32 page_index : used_pages) {
+        FreePage(page_index);
+    }
+    used_pages.clear();
+}
+
+void BlockCache::FreePage(u32 page_index) {
+    free_pages.push_back(std::move(pages[page_index]));
+}
@@ -0,0 +1,59 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Maps the addresses of translated basic blocks to their offset in the translation buffer of their
+ * ARMul_State. Blocks never cross a page boundary, so the blocks of each page are kept in a table
+ * of their own, found through a table of all pages. Looking a block up takes two loads, and a range
+ * of pages can be invalidated without touching the others.
+ */
+class BlockCache {
+public:
+    /// Returned by Find for addresses without a translated block
+    static constexpr u32 NO_BLOCK = 0xFFFFFFFF;
+
+    BlockCache();
+    ~BlockCache();
+
+    /// Returns the offset of the block translated at `address`, or NO_BLOCK.
+    u32 Find(u32 address) const {
+        const Page* page = pages[address >> PAGE_BITS].get();
+        return page != nullptr ? page->blocks[(address & PAGE_MASK) >> 1] : NO_BLOCK;
+    }
+
+    /// Records the offset of the block translated at `address`.
+    void Insert(u32 address, std::size_t offset);
+
+    /// Forgets the blocks of all pages overlapping the given range.
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    /// Forgets all blocks.
+    void Clear();
+
+private:
+    static constexpr unsigned PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1 << PAGE_BITS) - 1;
+    static constexpr std::size_t NUM_PAGES = std::size_t{1} << (32 - PAGE_BITS);
+
+    /// Offsets of the blocks of a page, indexed by halfword as Thumb blocks are 2-byte aligned
+    struct Page {
+        std::array<u32, (PAGE_MASK + 1) / 2> blocks;
+    };
+
+    void FreePage(u32 page_index);
+
+    std::unique_ptr<std::unique_ptr<Page>[]> pages;
+    /// Indices of the pages with a table, so that clearing doesn't walk all of them
+    std::vector<u32> used_pages;
+    /// Tables of invalidated pages, reused instead of allocating new ones
+    std::vector<std::unique_ptr<Page>> free_pages;
+};
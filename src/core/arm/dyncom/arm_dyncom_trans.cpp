@@ -6,14 +6,14 @@
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
-char trans_cache_buf[TRANS_CACHE_SIZE];
-size_t trans_cache_buf_top = 0;
+thread_local ARMul_State* translating_state = nullptr;
 
 static void* AllocBuffer(std::size_t size) {
-    std::size_t start = trans_cache_buf_top;
-    trans_cache_buf_top += size;
-    ASSERT_MSG(trans_cache_buf_top <= TRANS_CACHE_SIZE, "Translation cache is full!");
-    return static_cast<void*>(&trans_cache_buf[start]);
+    ARMul_State* const state = translating_state;
+    std::size_t start = state->trans_cache_buf_top;
+    state->trans_cache_buf_top += size;
+    ASSERT_MSG(state->trans_cache_buf_top <= TRANS_CACHE_SIZE, "Translation cache is full!");
+    return static_cast<void*>(&state->trans_cache_buf[start]);
 }
 
 #define glue(x, y) x##y
@@ -494,5 +494,8 @@ extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
 
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-extern char trans_cache_buf[TRANS_CACHE_SIZE];
-extern std::size_t trans_cache_buf_top;
+// Upper bound of the size of a translated block, which ends at the latest at the end of its page
+#define TRANS_CACHE_BLOCK_RESERVE (2048 * 256)
+
+/// The state whose translation buffer the instructions being translated on this thread go to
+extern thread_local ARMul_State* translating_state;
@@ -5,12 +5,14 @@
 #include <algorithm>
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 #include "core/core.h"
 #include "core/memory.h"
 
-ARMul_State::ARMul_State(Core::System& system, PrivilegeMode initial_mode) : system(system) {
+ARMul_State::ARMul_State(Core::System& system, PrivilegeMode initial_mode)
+    : system(system), trans_cache_buf(new char[TRANS_CACHE_SIZE]) {
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
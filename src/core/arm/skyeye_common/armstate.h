@@ -18,8 +18,9 @@
 #pragma once
 
 #include <array>
-#include <unordered_map>
+#include <memory>
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/gdbstub/gdbstub.h"
 
@@ -248,7 +249,10 @@ public:
 
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, std::size_t> instruction_cache;
+    BlockCache instruction_cache;
+    /// Translated instructions, filled up to trans_cache_buf_top and then started over
+    std::unique_ptr<char[]> trans_cache_buf;
+    std::size_t trans_cache_buf_top = 0;
 
 private:
     void ResetMPCoreCP15Registers();
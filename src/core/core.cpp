@@ -30,21 +30,35 @@
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/rpc_server.h"
 #endif
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "network/network.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/video_core.h"
 
 namespace Core {
 
 /*static*/ System System::s_instance;
+/*static*/ thread_local System* System::current_instance = &System::s_instance;
+
+System::System()
+    : movie(std::make_unique<Core::Movie>()),
+      hardware_state(std::make_unique<HW::InstanceState>()),
+      video_state(std::make_unique<VideoCore::InstanceState>()) {}
+
+System::~System() = default;
 
 System::ResultStatus System::RunLoop(bool tight_loop) {
+    InstanceScope instance_scope{*this};
+    PerfStats::SubsystemScope subsystem_scope{perf_stats, PerfStats::Subsystem::Other};
+
     status = ResultStatus::Success;
     if (!cpu_core) {
         return ResultStatus::ErrorNotInitialized;
     }
 
-    if (GDBStub::IsServerEnabled()) {
+    const bool gdbstub_enabled = IsDefaultInstance() && GDBStub::IsServerEnabled();
+    if (gdbstub_enabled) {
         GDBStub::HandlePacket();
 
         // If the loop is halted and we want to step, use a tiny (1) number of instructions to
@@ -62,11 +76,16 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     // instead advance to the next event and try to yield to the next thread
     if (kernel->GetThreadManager().GetCurrentThread() == nullptr) {
         LOG_TRACE(Core_ARM11, "Idling");
-        timing->Idle();
+        if (Settings::values.idle_fast_forward) {
+            timing->FastForwardToNextEvent();
+        } else {
+            timing->Idle();
+        }
         timing->Advance();
         PrepareReschedule();
     } else {
         timing->Advance();
+        PerfStats::SubsystemScope cpu_scope{perf_stats, PerfStats::Subsystem::CPU};
         if (tight_loop) {
             cpu_core->Run();
         } else {
@@ -74,13 +93,18 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         }
     }
 
-    if (GDBStub::IsServerEnabled()) {
+    if (gdbstub_enabled) {
         GDBStub::SetCpuStepFlag(false);
     }
 
     HW::Update();
     Reschedule();
 
+    // Let the GPU thread change the state the CPU accesses without locking, between slices
+    if (const auto& gpu_thread = VideoCore::GetGPUThread()) {
+        gpu_thread->RunEmulationThreadWork();
+    }
+
     if (reset_requested.exchange(false)) {
         Reset();
     } else if (shutdown_requested.exchange(false)) {
@@ -95,6 +119,7 @@ System::ResultStatus System::SingleStep() {
 }
 
 System::ResultStatus System::Load(EmuWindow& emu_window, const std::string& filepath) {
+    InstanceScope instance_scope{*this};
     app_loader = Loader::GetLoader(filepath);
 
     if (!app_loader) {
@@ -151,6 +176,23 @@ System::ResultStatus System::Load(EmuWindow& emu_window, const std::string& file
     return status;
 }
 
+System::ResultStatus System::InitWithoutApplication(EmuWindow& emu_window) {
+    InstanceScope instance_scope{*this};
+    // Use the memory layout of retail applications
+    ResultStatus init_result{Init(emu_window, 0)};
+    if (init_result != ResultStatus::Success) {
+        LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                     static_cast<u32>(init_result));
+        System::Shutdown();
+        return init_result;
+    }
+
+    status = ResultStatus::Success;
+    m_emu_window = &emu_window;
+    m_filepath.clear();
+    return status;
+}
+
 void System::PrepareReschedule() {
     cpu_core->PrepareReschedule();
     reschedule_pending = true;
@@ -202,7 +244,10 @@ System::ResultStatus System::Init(EmuWindow& emu_window, u32 system_mode) {
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
 #ifdef ENABLE_SCRIPTING
-    rpc_server = std::make_unique<RPC::RPCServer>();
+    // The server listens on a fixed port
+    if (IsDefaultInstance()) {
+        rpc_server = std::make_unique<RPC::RPCServer>();
+    }
 #endif
 
     service_manager = std::make_shared<Service::SM::ServiceManager>(*this);
@@ -210,13 +255,17 @@ System::ResultStatus System::Init(EmuWindow& emu_window, u32 system_mode) {
 
     HW::Init(*memory);
     Service::Init(*this);
-    GDBStub::Init();
+    if (IsDefaultInstance()) {
+        GDBStub::Init();
+    }
 
     ResultStatus result = VideoCore::Init(emu_window, *memory);
     if (result != ResultStatus::Success) {
         return result;
     }
 
+    savestate_manager = std::make_unique<SaveStateManager>(*this);
+
     LOG_DEBUG(Core, "Initialized OK");
 
     // Reset counters and set time origin to current frame
@@ -274,11 +323,27 @@ const Cheats::CheatEngine& System::CheatEngine() const {
     return *cheat_engine;
 }
 
+SaveStateManager& System::SaveStates() {
+    return *savestate_manager;
+}
+
+const SaveStateManager& System::SaveStates() const {
+    return *savestate_manager;
+}
+
+#ifdef ENABLE_SCRIPTING
+RPC::RPCServer& System::RPCServer() {
+    return *rpc_server;
+}
+#endif
+
 void System::RegisterSoftwareKeyboard(std::shared_ptr<Frontend::SoftwareKeyboard> swkbd) {
     registered_swkbd = std::move(swkbd);
 }
 
 void System::Shutdown() {
+    InstanceScope instance_scope{*this};
+
     // Log last frame performance stats
     auto perf_results = GetAndResetPerfStats();
     Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_EmulationSpeed",
@@ -289,7 +354,10 @@ void System::Shutdown() {
                          perf_results.frametime * 1000.0);
 
     // Shutdown emulation session
-    GDBStub::Shutdown();
+    savestate_manager.reset();
+    if (IsDefaultInstance()) {
+        GDBStub::Shutdown();
+    }
     VideoCore::Shutdown();
     kernel.reset();
     HW::Shutdown();
@@ -47,18 +47,61 @@ namespace Cheats {
 class CheatEngine;
 }
 
+namespace HW {
+struct InstanceState;
+}
+
+namespace VideoCore {
+struct InstanceState;
+}
+
 namespace Core {
 
+class Movie;
+class SaveStateManager;
 class Timing;
 
 class System {
 public:
     /**
-     * Gets the instance of the System singleton class.
-     * @returns Reference to the instance of the System singleton class.
+     * Binds a System to the calling thread for the lifetime of the scope, so that GetInstance
+     * returns it. Threads created on behalf of a System must bind it before emulating anything.
+     */
+    class InstanceScope {
+    public:
+        explicit InstanceScope(System& system) : previous(current_instance) {
+            current_instance = &system;
+        }
+
+        ~InstanceScope() {
+            current_instance = previous;
+        }
+
+        InstanceScope(const InstanceScope&) = delete;
+        InstanceScope& operator=(const InstanceScope&) = delete;
+
+    private:
+        System* previous;
+    };
+
+    /**
+     * Several Systems can run concurrently as long as each one is only run by one thread at a
+     * time. The GDB stub and the RPC server are only available to the default instance.
+     */
+    System();
+    ~System();
+
+    /**
+     * Gets the System bound to the calling thread, see InstanceScope.
+     * @returns Reference to the bound System, or to the default instance if there is none.
      */
     static System& GetInstance() {
-        return s_instance;
+        return *current_instance;
+    }
+
+    /// Whether this is the default instance, which is used by threads that didn't bind another
+    bool IsDefaultInstance() const {
+        return this == &s_instance;
     }
 
     /// Enumeration representing the return values of the System Initialize and Load process.
@@ -124,6 +167,14 @@ public:
      */
     ResultStatus Load(EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Initializes the emulated hardware without loading an application, for tools that drive the
+     * GPU directly such as the CiTrace player. The CPU core must not be run in this state.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus InitWithoutApplication(EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -204,6 +255,32 @@ public:
     /// Gets a const reference to the cheat engine
     const Cheats::CheatEngine& CheatEngine() const;
 
+    /// Gets a reference to the save state manager
+    SaveStateManager& SaveStates();
+
+    /// Gets a const reference to the save state manager
+    const SaveStateManager& SaveStates() const;
+
+    /// Gets a reference to the movie recorder and player
+    Core::Movie& Movie() {
+        return *movie;
+    }
+
+    /// Gets the hardware register state
+    HW::InstanceState& HardwareState() {
+        return *hardware_state;
+    }
+
+    /// Gets the video core state, which also holds the renderer
+    VideoCore::InstanceState& VideoState() {
+        return *video_state;
+    }
+
+#ifdef ENABLE_SCRIPTING
+    /// Gets a reference to the RPC server
+    RPC::RPCServer& RPCServer();
+#endif
+
     PerfStats perf_stats;
     FrameLimiter frame_limiter;
 
@@ -222,6 +299,11 @@ public:
         return *app_loader;
     }
 
+    /// Returns whether an application is loaded, which isn't the case after InitWithoutApplication
+    bool HasAppLoader() const {
+        return app_loader != nullptr;
+    }
+
     /// Frontend Applets
 
     void RegisterSoftwareKeyboard(std::shared_ptr<Frontend::SoftwareKeyboard> swkbd);
@@ -246,9 +328,6 @@ private:
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
-    /// ARM11 CPU core
-    std::unique_ptr<ARM_Interface> cpu_core;
-
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -267,6 +346,9 @@ private:
     /// Cheats manager
     std::unique_ptr<Cheats::CheatEngine> cheat_engine;
 
+    /// Save state manager
+    std::unique_ptr<SaveStateManager> savestate_manager;
+
 #ifdef ENABLE_SCRIPTING
     /// RPC Server for scripting support
     std::unique_ptr<RPC::RPCServer> rpc_server;
@@ -274,14 +356,22 @@ private:
 
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
+    /// State that outlives emulation sessions, created with the System
+    std::unique_ptr<Core::Movie> movie;
+    std::unique_ptr<HW::InstanceState> hardware_state;
+    std::unique_ptr<VideoCore::InstanceState> video_state;
+
 public: // HACK: this is temporary exposed for tests,
         // due to WIP kernel refactor causing desync state in memory
+    /// ARM11 CPU core
+    std::unique_ptr<ARM_Interface> cpu_core;
     std::unique_ptr<Memory::MemorySystem> memory;
     std::unique_ptr<Kernel::KernelSystem> kernel;
     std::unique_ptr<Timing> timing;
 
 private:
     static System s_instance;
+    static thread_local System* current_instance;
 
     ResultStatus status = ResultStatus::Success;
     std::string status_details = "";
@@ -289,8 +379,8 @@ private:
     EmuWindow* m_emu_window;
     std::string m_filepath;
 
-    std::atomic<bool> reset_requested;
-    std::atomic<bool> shutdown_requested;
+    std::atomic<bool> reset_requested{false};
+    std::atomic<bool> shutdown_requested{false};
 };
 
 inline ARM_Interface& CPU() {
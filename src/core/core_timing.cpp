@@ -6,16 +6,14 @@
 #include <cinttypes>
 #include <tuple>
 #include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/core_timing.h"
 
 namespace Core {
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-bool Timing::Event::operator>(const Event& right) const {
-    return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
-}
-
 bool Timing::Event::operator<(const Event& right) const {
     return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
 }
@@ -54,8 +52,16 @@ u64 Timing::GetIdleTicks() const {
     return static_cast<u64>(idled_cycles);
 }
 
-void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                           u64 userdata) {
+u64 Timing::GetFastForwardedTicks() const {
+    return static_cast<u64>(fast_forwarded_cycles);
+}
+
+u64 Timing::GetFastForwardCount() const {
+    return fast_forward_count;
+}
+
+Timing::EventHandle Timing::ScheduleEvent(s64 cycles_into_future,
+                                          const TimingEventType* event_type, u64 userdata) {
     ASSERT(event_type != nullptr);
     s64 timeout = GetTicks() + cycles_into_future;
 
@@ -63,8 +69,7 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    return AddEvent(Event{timeout, event_fifo_id++, userdata, event_type});
 }
 
 void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventType* event_type,
@@ -73,25 +78,30 @@ void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventTy
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
+    for (u32 index = event_type->first_scheduled; index != INVALID_INDEX;) {
+        const u32 next = nodes[index].type_next;
+        if (nodes[index].event.userdata == userdata) {
+            RemoveScheduledEvent(index);
+        }
+        index = next;
+    }
+}
 
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+bool Timing::UnscheduleEvent(EventHandle handle) {
+    if (handle.index >= nodes.size()) {
+        return false;
     }
+    const EventNode& node = nodes[handle.index];
+    if (node.bucket == FREE_BUCKET || node.generation != handle.generation) {
+        return false;
+    }
+    RemoveScheduledEvent(handle.index);
+    return true;
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                              [&](const Event& e) { return e.type == event_type; });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    while (event_type->first_scheduled != INVALID_INDEX) {
+        RemoveScheduledEvent(event_type->first_scheduled);
     }
 }
 
@@ -111,8 +121,7 @@ void Timing::ForceExceptionCheck(s64 cycles) {
 void Timing::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        AddEvent(ev);
     }
 }
 
@@ -125,21 +134,16 @@ void Timing::Advance() {
 
     is_global_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    for (Event evt; PopDueEvent(global_timer, evt);) {
         evt.type->callback(evt.userdata, global_timer - evt.time);
     }
+    if (global_timer > static_cast<s64>(wheel_time)) {
+        MoveWheel(static_cast<u64>(global_timer));
+    }
 
     is_global_timer_sane = false;
 
-    // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
-        slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - global_timer, MAX_SLICE_LENGTH));
-    }
-
+    slice_length = GetCyclesUntilNextEvent(MAX_SLICE_LENGTH);
     downcount = slice_length;
 }
 
@@ -148,6 +152,23 @@ void Timing::Idle() {
     downcount = 0;
 }
 
+void Timing::FastForwardToNextEvent() {
+    MoveEvents();
+    Idle();
+
+    // The slice now ends at global_timer + slice_length, while the next event is measured from
+    // the wheel's time
+    const s64 elapsed = global_timer + slice_length - static_cast<s64>(wheel_time);
+    const s64 cycles = GetCyclesUntilNextEvent(elapsed + MAX_FAST_FORWARD_LENGTH) - elapsed;
+    if (cycles <= 0) {
+        return;
+    }
+    slice_length += cycles;
+    idled_cycles += cycles;
+    fast_forwarded_cycles += cycles;
+    ++fast_forward_count;
+}
+
 std::chrono::microseconds Timing::GetGlobalTimeUs() const {
     return std::chrono::microseconds{GetTicks() * 1000000 / BASE_CLOCK_RATE_ARM11};
 }
@@ -156,4 +177,290 @@ s64 Timing::GetDowncount() const {
     return downcount;
 }
 
+Timing::EventHandle Timing::AddEvent(const Event& event) {
+    u32 index = free_nodes;
+    if (index != INVALID_INDEX) {
+        free_nodes = nodes[index].next;
+    } else {
+        index = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    EventNode& node = nodes[index];
+    node.event = event;
+    node.type_prev = INVALID_INDEX;
+    node.type_next = event.type->first_scheduled;
+    if (node.type_next != INVALID_INDEX) {
+        nodes[node.type_next].type_prev = index;
+    }
+    event.type->first_scheduled = index;
+
+    InsertIntoBucket(index);
+    return {index, node.generation};
+}
+
+void Timing::RemoveScheduledEvent(u32 index) {
+    UnlinkFromBucket(index);
+
+    EventNode& node = nodes[index];
+    if (node.type_prev != INVALID_INDEX) {
+        nodes[node.type_prev].type_next = node.type_next;
+    } else {
+        node.event.type->first_scheduled = node.type_next;
+    }
+    if (node.type_next != INVALID_INDEX) {
+        nodes[node.type_next].type_prev = node.type_prev;
+    }
+
+    // Invalidates the handles of the event
+    ++node.generation;
+    node.bucket = FREE_BUCKET;
+    node.next = free_nodes;
+    free_nodes = index;
+}
+
+void Timing::InsertIntoBucket(u32 index) {
+    EventNode& node = nodes[index];
+    u16 bucket_id = LATE_BUCKET;
+    if (node.event.time >= static_cast<s64>(wheel_time)) {
+        const u64 time = static_cast<u64>(node.event.time);
+        const u64 difference = time ^ wheel_time;
+        unsigned level = 0;
+        while (level + 1 < WHEEL_LEVELS && (difference >> (SLOT_BITS * (level + 1))) != 0) {
+            ++level;
+        }
+        const unsigned slot = (time >> (SLOT_BITS * level)) & (SLOTS_PER_LEVEL - 1);
+        bucket_id = static_cast<u16>(level * SLOTS_PER_LEVEL + slot);
+        occupied_slots[level] |= u64{1} << slot;
+    }
+    node.bucket = bucket_id;
+
+    // Events are run from the late bucket and the slots of level 0, which are kept in order.
+    // Events are mostly added in order, so search for the position from the back.
+    Bucket& bucket = buckets[bucket_id];
+    u32 previous = bucket.tail;
+    if (bucket_id == LATE_BUCKET || bucket_id < SLOTS_PER_LEVEL) {
+        while (previous != INVALID_INDEX && node.event < nodes[previous].event) {
+            previous = nodes[previous].prev;
+        }
+    }
+
+    node.prev = previous;
+    node.next = previous != INVALID_INDEX ? nodes[previous].next : bucket.head;
+    if (node.prev != INVALID_INDEX) {
+        nodes[node.prev].next = index;
+    } else {
+        bucket.head = index;
+    }
+    if (node.next != INVALID_INDEX) {
+        nodes[node.next].prev = index;
+    } else {
+        bucket.tail = index;
+    }
+}
+
+void Timing::UnlinkFromBucket(u32 index) {
+    const EventNode& node = nodes[index];
+    Bucket& bucket = buckets[node.bucket];
+    if (node.prev != INVALID_INDEX) {
+        nodes[node.prev].next = node.next;
+    } else {
+        bucket.head = node.next;
+    }
+    if (node.next != INVALID_INDEX) {
+        nodes[node.next].prev = node.prev;
+    } else {
+        bucket.tail = node.prev;
+    }
+
+    if (bucket.head == INVALID_INDEX && node.bucket != LATE_BUCKET) {
+        occupied_slots[node.bucket / SLOTS_PER_LEVEL] &=
+            ~(u64{1} << (node.bucket % SLOTS_PER_LEVEL));
+    }
+}
+
+void Timing::CascadeSlot(unsigned level, unsigned slot) {
+    Bucket& bucket = buckets[level * SLOTS_PER_LEVEL + slot];
+    u32 index = bucket.head;
+    bucket = Bucket{};
+    occupied_slots[level] &= ~(u64{1} << slot);
+
+    while (index != INVALID_INDEX) {
+        const u32 next = nodes[index].next;
+        InsertIntoBucket(index);
+        index = next;
+    }
+}
+
+u64 Timing::GetSlotStart(unsigned level, unsigned slot) const {
+    const unsigned shift = SLOT_BITS * level;
+    const unsigned upper_shift = shift + SLOT_BITS;
+    const u64 upper = upper_shift < 64 ? (wheel_time >> upper_shift) << upper_shift : 0;
+    return upper | (static_cast<u64>(slot) << shift);
+}
+
+void Timing::MoveWheel(u64 time) {
+    // The wheel only moves up to the next event, so the only slots that can hold events which now
+    // belong to a lower level are the ones `time` falls into.
+    const u64 old_time = wheel_time;
+    wheel_time = time;
+    for (unsigned level = WHEEL_LEVELS - 1; level > 0; --level) {
+        const unsigned shift = SLOT_BITS * level;
+        if ((old_time >> shift) == (time >> shift)) {
+            continue;
+        }
+        const unsigned slot = (time >> shift) & (SLOTS_PER_LEVEL - 1);
+        if (occupied_slots[level] & (u64{1} << slot)) {
+            CascadeSlot(level, slot);
+        }
+    }
+}
+
+bool Timing::PopDueEvent(s64 time, Event& event) {
+    while (true) {
+        // Late events are earlier than all the events in the wheel
+        u32 index = buckets[LATE_BUCKET].head;
+        if (index == INVALID_INDEX) {
+            if (occupied_slots[0] != 0) {
+                const unsigned slot = Common::LeastSignificantSetBit(occupied_slots[0]);
+                const u64 slot_time = GetSlotStart(0, slot);
+                if (static_cast<s64>(slot_time) > time) {
+                    return false;
+                }
+                wheel_time = slot_time;
+                index = buckets[slot].head;
+            } else {
+                // The lowest non-empty slot holds the next events, move the wheel to its start
+                unsigned level = 1;
+                while (level < WHEEL_LEVELS && occupied_slots[level] == 0) {
+                    ++level;
+                }
+                if (level == WHEEL_LEVELS) {
+                    return false;
+                }
+                const unsigned slot = Common::LeastSignificantSetBit(occupied_slots[level]);
+                const u64 slot_start = GetSlotStart(level, slot);
+                if (static_cast<s64>(slot_start) > time) {
+                    return false;
+                }
+                MoveWheel(slot_start);
+                continue;
+            }
+        }
+
+        event = nodes[index].event;
+        RemoveScheduledEvent(index);
+        return true;
+    }
+}
+
+s64 Timing::GetCyclesUntilNextEvent(s64 limit) const {
+    if (buckets[LATE_BUCKET].head != INVALID_INDEX) {
+        return 0;
+    }
+
+    for (unsigned level = 0; level < WHEEL_LEVELS; ++level) {
+        if (occupied_slots[level] == 0) {
+            continue;
+        }
+        const unsigned slot = Common::LeastSignificantSetBit(occupied_slots[level]);
+        const u64 slot_start = GetSlotStart(level, slot);
+        if (slot_start - wheel_time >= static_cast<u64>(limit)) {
+            return limit;
+        }
+        // Slots of higher levels aren't sorted, but are short when they are this close
+        s64 next_time = std::numeric_limits<s64>::max();
+        for (u32 index = buckets[level * SLOTS_PER_LEVEL + slot].head; index != INVALID_INDEX;
+             index = nodes[index].next) {
+            next_time = std::min(next_time, nodes[index].event.time);
+        }
+        return std::min<s64>(next_time - static_cast<s64>(wheel_time), limit);
+    }
+    return limit;
+}
+
+std::vector<Timing::Event> Timing::GetScheduledEvents() const {
+    std::vector<Event> events;
+    for (const auto& [name, event_type] : event_types) {
+        for (u32 index = event_type.first_scheduled; index != INVALID_INDEX;
+             index = nodes[index].type_next) {
+            events.push_back(nodes[index].event);
+        }
+    }
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+void Timing::DoState(PointerWrap& p) {
+    auto s = p.Section("CoreTiming", 1);
+    if (!s)
+        return;
+
+    // Pull in events scheduled from other threads so that they are part of the saved queue
+    MoveEvents();
+
+    // Read everything into temporaries first so that a state referencing an unknown event type
+    // leaves the current queue untouched.
+    s64 new_global_timer = global_timer;
+    s64 new_slice_length = slice_length;
+    s64 new_downcount = downcount;
+    s64 new_idled_cycles = idled_cycles;
+    u64 new_event_fifo_id = event_fifo_id;
+    p.Do(new_global_timer);
+    p.Do(new_slice_length);
+    p.Do(new_downcount);
+    p.Do(new_idled_cycles);
+    p.Do(new_event_fifo_id);
+
+    const std::vector<Event> events =
+        p.GetMode() != PointerWrap::MODE_READ ? GetScheduledEvents() : std::vector<Event>{};
+    u32 num_events = static_cast<u32>(events.size());
+    p.Do(num_events);
+
+    std::vector<Event> new_queue;
+    new_queue.reserve(num_events);
+    for (u32 i = 0; i < num_events; ++i) {
+        Event event{};
+        std::string name;
+        if (p.GetMode() != PointerWrap::MODE_READ) {
+            event = events[i];
+            name = *event.type->name;
+        }
+
+        p.Do(event.time);
+        p.Do(event.fifo_order);
+        p.Do(event.userdata);
+        p.Do(name);
+
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            auto itr = event_types.find(name);
+            if (itr == event_types.end()) {
+                LOG_ERROR(Core_Timing, "Save state references unknown event type \"{}\"", name);
+                p.SetError(PointerWrap::ERROR_FAILURE);
+                return;
+            }
+            event.type = &itr->second;
+            new_queue.push_back(event);
+        }
+    }
+
+    if (p.GetMode() != PointerWrap::MODE_READ)
+        return;
+
+    global_timer = new_global_timer;
+    slice_length = new_slice_length;
+    downcount = new_downcount;
+    idled_cycles = new_idled_cycles;
+    event_fifo_id = new_event_fifo_id;
+
+    // Removing the events one by one keeps the handles of the replaced events invalid
+    for (auto& [name, event_type] : event_types) {
+        RemoveEvent(&event_type);
+    }
+    wheel_time = static_cast<u64>(std::max<s64>(global_timer, 0));
+    for (const Event& event : new_queue) {
+        AddEvent(event);
+    }
+}
+
 } // namespace Core
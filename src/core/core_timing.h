@@ -17,6 +17,7 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <limits>
@@ -27,6 +28,8 @@
 #include "common/logging/log.h"
 #include "common/threadsafe_queue.h"
 
+class PointerWrap;
+
 // The timing we get from the assembly is 268,111,855.956 Hz
 // It is possible that this number isn't just an integer because the compiler could have
 // optimized the multiplication by a multiply-by-constant division.
@@ -130,10 +133,19 @@ using TimedCallback = std::function<void(u64 userdata, int cycles_late)>;
 struct TimingEventType {
     TimedCallback callback;
     const std::string* name;
+    /// First of the scheduled events of this type, maintained by the Timing that registered it
+    mutable u32 first_scheduled = std::numeric_limits<u32>::max();
 };
 
 class Timing {
 public:
+    /// Identifies a scheduled event. Handles of events that already ran or were unscheduled are
+    /// ignored by UnscheduleEvent.
+    struct EventHandle {
+        u32 index = std::numeric_limits<u32>::max();
+        u32 generation = 0;
+    };
+
     ~Timing();
 
     /**
@@ -142,6 +154,10 @@ public:
      */
     u64 GetTicks() const;
     u64 GetIdleTicks() const;
+    /// Returns the number of cycles skipped past the end of slices by FastForwardToNextEvent.
+    u64 GetFastForwardedTicks() const;
+    /// Returns the number of times FastForwardToNextEvent moved the time past the slice.
+    u64 GetFastForwardCount() const;
     void AddTicks(u64 ticks);
 
     /**
@@ -154,7 +170,8 @@ public:
      * event is scheduled earlier than the current values. Scheduling from a callback will not
      * update the downcount until the Advance() completes.
      */
-    void ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type, u64 userdata = 0);
+    EventHandle ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
+                              u64 userdata = 0);
 
     /**
      * This is to be called when outside of hle threads, such as the graphics thread, wants to
@@ -167,6 +184,12 @@ public:
 
     void UnscheduleEvent(const TimingEventType* event_type, u64 userdata);
 
+    /**
+     * Unschedules the event identified by the handle, without searching for it.
+     * @returns Whether the event was still scheduled
+     */
+    bool UnscheduleEvent(EventHandle handle);
+
     /// We only permit one event of each type in the queue at a time.
     void RemoveEvent(const TimingEventType* event_type);
     void RemoveNormalAndThreadsafeEvent(const TimingEventType* event_type);
@@ -183,12 +206,27 @@ public:
     /// Pretend that the main CPU has executed enough cycles to reach the next event.
     void Idle();
 
+    /**
+     * Like Idle, but extends the slice up to the next scheduled event, so that the next Advance()
+     * moves the time straight to it instead of going there slice by slice. To be used while no
+     * thread can run. The time moves by at most MAX_FAST_FORWARD_LENGTH, so that events scheduled
+     * from other threads are still picked up when nothing else is scheduled.
+     */
+    void FastForwardToNextEvent();
+
     void ForceExceptionCheck(s64 cycles);
 
     std::chrono::microseconds GetGlobalTimeUs() const;
 
     s64 GetDowncount() const;
 
+    /**
+     * Serializes or deserializes the global timer and the pending event queue. Events are stored
+     * by the name of their type, so every event type referenced by a saved state must already be
+     * registered when the state is loaded.
+     */
+    void DoState(PointerWrap& p);
+
 private:
     struct Event {
         s64 time;
@@ -196,11 +234,58 @@ private:
         u64 userdata;
         const TimingEventType* type;
 
-        bool operator>(const Event& right) const;
         bool operator<(const Event& right) const;
     };
 
     static constexpr int MAX_SLICE_LENGTH = 20000;
+    /// About one frame
+    static constexpr s64 MAX_FAST_FORWARD_LENGTH = BASE_CLOCK_RATE_ARM11 / 60;
+
+    static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+
+    /*
+     * Scheduled events are kept in a hierarchical timing wheel: each level has 64 slots, and a slot
+     * of level n spans 64^n cycles. An event is stored in the level of the highest bit in which its
+     * time differs from wheel_time, so level 0 slots hold events of a single time, and finding the
+     * next event takes a bit scan per level. Slots of higher levels are cascaded to the lower ones
+     * as wheel_time reaches them.
+     */
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+    static constexpr unsigned WHEEL_LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+    /// Bucket of the events scheduled before wheel_time, which are due on the next Advance
+    static constexpr u16 LATE_BUCKET = WHEEL_LEVELS * SLOTS_PER_LEVEL;
+    /// Bucket of the nodes which hold no event
+    static constexpr u16 FREE_BUCKET = LATE_BUCKET + 1;
+
+    struct EventNode {
+        Event event;
+        u32 prev;      ///< Previous node in the bucket
+        u32 next;      ///< Next node in the bucket, or in the free list
+        u32 type_prev; ///< Previous scheduled event of the same type
+        u32 type_next; ///< Next scheduled event of the same type
+        u32 generation = 0;
+        u16 bucket = FREE_BUCKET;
+    };
+
+    struct Bucket {
+        u32 head = INVALID_INDEX;
+        u32 tail = INVALID_INDEX;
+    };
+
+    EventHandle AddEvent(const Event& event);
+    void RemoveScheduledEvent(u32 index);
+    void InsertIntoBucket(u32 index);
+    void UnlinkFromBucket(u32 index);
+    void CascadeSlot(unsigned level, unsigned slot);
+    u64 GetSlotStart(unsigned level, unsigned slot) const;
+    void MoveWheel(u64 time);
+    /// Takes the next event if it is due at `time`, in (time, fifo_order) order.
+    bool PopDueEvent(s64 time, Event& event);
+    /// Returns the number of cycles from the wheel's time to the next event, up to `limit`.
+    s64 GetCyclesUntilNextEvent(s64 limit) const;
+    /// Returns the scheduled events sorted by (time, fifo_order).
+    std::vector<Event> GetScheduledEvents() const;
 
     s64 global_timer = 0;
     s64 slice_length = MAX_SLICE_LENGTH;
@@ -210,16 +295,23 @@ private:
     // elements remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, TimingEventType> event_types;
 
-    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-    // accomodated by the standard adaptor class.
-    std::vector<Event> event_queue;
+    /// Storage of the scheduled events, which are linked into buckets by index
+    std::vector<EventNode> nodes;
+    u32 free_nodes = INVALID_INDEX;
+    /// Slots of every level, followed by LATE_BUCKET. The late bucket and the slots of level 0 are
+    /// kept in (time, fifo_order) order.
+    std::array<Bucket, LATE_BUCKET + 1> buckets;
+    /// Bitmap of the non-empty slots of each level
+    std::array<u64, WHEEL_LEVELS> occupied_slots{};
+    /// Time the wheel is positioned at, never later than global_timer
+    u64 wheel_time = 0;
     u64 event_fifo_id = 0;
     // the queue for storing the events from other threads threadsafe until they will be added
-    // to the event_queue by the emu thread
+    // to the wheel by the emu thread
     Common::MPSCQueue<Event, false> ts_queue;
     s64 idled_cycles = 0;
+    s64 fast_forwarded_cycles = 0;
+    u64 fast_forward_count = 0;
 
     // Are we in a function that has been called from Advance()
     // If events are sheduled from a function that gets called from Advance(),
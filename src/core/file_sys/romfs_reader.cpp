@@ -1,20 +1,124 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/logging/log.h"
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+struct RomFSReader::Decryptor {
+    Decryptor(const std::array<u8, 16>& key, const std::array<u8, 16>& ctr)
+        : cipher(key.data(), key.size(), ctr.data()) {}
+
+    // Crypto++ picks AES-NI at runtime when the CPU supports it
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption cipher;
+};
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
+                         const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
+                         std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size),
+      decryptor(std::make_unique<Decryptor>(key, ctr)) {}
+
+RomFSReader::~RomFSReader() {
+    if (stats.reads != 0) {
+        LOG_DEBUG(Service_FS,
+                  "RomFS cache: {} reads, {:.1f}% block hit rate, {} bytes read, {} bytes loaded, "
+                  "{} bytes decrypted",
+                  stats.reads, stats.GetHitRate() * 100, stats.bytes_read, stats.bytes_loaded,
+                  stats.bytes_decrypted);
+    }
+}
+
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ does not like zero size buffer
+    length = std::min(length, data_size - offset);
+    ++stats.reads;
+
+    std::size_t read_length = 0;
+    if (length >= READ_AHEAD_BLOCKS * BLOCK_SIZE) {
+        read_length = LoadData(offset, length, buffer);
+    } else {
+        while (read_length < length) {
+            const std::size_t position = offset + read_length;
+            const std::size_t block_offset = position % BLOCK_SIZE;
+            const std::vector<u8>& block = GetBlock(position / BLOCK_SIZE);
+            if (block.size() <= block_offset)
+                break; // The file is shorter than expected
+
+            const std::size_t copy_length =
+                std::min(length - read_length, block.size() - block_offset);
+            std::memcpy(buffer + read_length, block.data() + block_offset, copy_length);
+            read_length += copy_length;
+        }
+    }
+
+    stats.bytes_read += read_length;
+    return read_length;
+}
+
+const std::vector<u8>& RomFSReader::GetBlock(std::size_t index) {
+    const bool sequential = index == next_sequential_block;
+    next_sequential_block = index + 1;
+
+    const auto iter = block_map.find(index);
+    if (iter != block_map.end()) {
+        ++stats.cache_hits;
+        blocks.splice(blocks.begin(), blocks, iter->second);
+        return iter->second->data;
+    }
+    ++stats.cache_misses;
+
+    // Read ahead on sequential accesses, up to the end of the data or the next cached block
+    std::size_t num_blocks = 1;
+    if (sequential) {
+        const std::size_t num_data_blocks = (data_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const std::size_t max_blocks = std::min(READ_AHEAD_BLOCKS, num_data_blocks - index);
+        while (num_blocks < max_blocks && block_map.count(index + num_blocks) == 0)
+            ++num_blocks;
+    }
+
+    const std::size_t offset = index * BLOCK_SIZE;
+    load_buffer.resize(std::min(num_blocks * BLOCK_SIZE, data_size - offset));
+    const std::size_t loaded = LoadData(offset, load_buffer.size(), load_buffer.data());
+
+    // Insert the blocks backwards, so that the requested one ends up most recently used
+    for (std::size_t i = num_blocks; i-- > 0;) {
+        if (blocks.size() < MAX_CACHED_BLOCKS) {
+            blocks.emplace_front();
+        } else {
+            // Recycle the least recently used block and its storage
+            blocks.splice(blocks.begin(), blocks, std::prev(blocks.end()));
+            block_map.erase(blocks.front().index);
+        }
+
+        const std::size_t begin = std::min(i * BLOCK_SIZE, loaded);
+        const std::size_t end = std::min(begin + BLOCK_SIZE, loaded);
+        CachedBlock& block = blocks.front();
+        block.index = index + i;
+        block.data.assign(load_buffer.begin() + begin, load_buffer.begin() + end);
+        block_map[block.index] = blocks.begin();
+    }
+    return blocks.front().data;
+}
+
+std::size_t RomFSReader::LoadData(std::size_t offset, std::size_t length, u8* buffer) {
+    if (!file.IsOpen())
+        return 0;
+
     file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length = file.ReadBytes(buffer, length);
+    stats.bytes_loaded += read_length;
+    if (is_encrypted && read_length != 0) {
+        decryptor->cipher.Seek(crypto_offset + offset);
+        decryptor->cipher.ProcessData(buffer, buffer, read_length);
+        stats.bytes_decrypted += read_length;
     }
     return read_length;
 }
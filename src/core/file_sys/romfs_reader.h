@@ -1,22 +1,50 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/// Counters describing how well the RomFS block cache performs
+struct RomFSReaderStats {
+    u64 reads = 0;           ///< Number of ReadFile calls
+    u64 cache_hits = 0;      ///< Blocks served from the cache
+    u64 cache_misses = 0;    ///< Blocks which had to be read from the file
+    u64 bytes_read = 0;      ///< Bytes returned to callers
+    u64 bytes_loaded = 0;    ///< Bytes read from the file, including read-ahead
+    u64 bytes_decrypted = 0; ///< Bytes run through AES-CTR
+
+    double GetHitRate() const {
+        const u64 lookups = cache_hits + cache_misses;
+        return lookups != 0 ? static_cast<double>(cache_hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * Reads a (possibly AES-CTR encrypted) RomFS from a file. Small reads go through an LRU cache of
+ * decrypted, block-aligned chunks, and sequential accesses read several blocks ahead, so that the
+ * many tiny reads issued by games don't each cost a file access and a cipher setup.
+ */
 class RomFSReader {
 public:
-    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    /// Size of the cached blocks, in bytes
+    static constexpr std::size_t BLOCK_SIZE = 0x4000;
+    /// Maximum number of blocks kept in the cache
+    static constexpr std::size_t MAX_CACHED_BLOCKS = 64;
+    /// Number of blocks fetched at once when a sequential access misses the cache. Reads of at
+    /// least this many blocks bypass the cache, to avoid evicting the blocks of smaller files.
+    static constexpr std::size_t READ_AHEAD_BLOCKS = 8;
 
+    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                std::size_t crypto_offset);
+    ~RomFSReader();
 
     std::size_t GetSize() const {
         return data_size;
@@ -24,14 +52,41 @@ public:
 
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
+    const RomFSReaderStats& GetStats() const {
+        return stats;
+    }
+
 private:
+    struct CachedBlock {
+        std::size_t index;
+        std::vector<u8> data;
+    };
+
+    /// Returns the cached block with the given index, loading it (and possibly the following
+    /// blocks) on a miss. The returned block may be short at the end of the data.
+    const std::vector<u8>& GetBlock(std::size_t index);
+
+    /// Reads and decrypts data from the file, returning the number of bytes read.
+    std::size_t LoadData(std::size_t offset, std::size_t length, u8* buffer);
+
     bool is_encrypted;
     FileUtil::IOFile file;
-    std::array<u8, 16> key;
-    std::array<u8, 16> ctr;
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    /// Cipher context, reused across reads to avoid recomputing the key schedule
+    struct Decryptor;
+    std::unique_ptr<Decryptor> decryptor;
+
+    /// Cached blocks, most recently used first
+    std::list<CachedBlock> blocks;
+    std::unordered_map<std::size_t, std::list<CachedBlock>::iterator> block_map;
+    /// Index of the block following the last accessed one, to detect sequential reads
+    std::size_t next_sequential_block = 0;
+    std::vector<u8> load_buffer;
+
+    RomFSReaderStats stats;
 };
 
 } // namespace FileSys
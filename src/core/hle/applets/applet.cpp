@@ -2,10 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <cstddef>
 #include <memory>
-#include <type_traits>
-#include <unordered_map>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/core.h"
@@ -17,34 +14,15 @@
 #include "core/hle/applets/swkbd.h"
 #include "core/hle/result.h"
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// Specializes std::hash for AppletId, so that we can use it in std::unordered_map.
-// Workaround for libstdc++ bug: https://gcc.gnu.org/bugzilla/show_bug.cgi?id=60970
-namespace std {
-template <>
-struct hash<Service::APT::AppletId> {
-    typedef Service::APT::AppletId argument_type;
-    typedef std::size_t result_type;
-
-    result_type operator()(const argument_type& id_code) const {
-        typedef std::underlying_type<argument_type>::type Type;
-        return std::hash<Type>()(static_cast<Type>(id_code));
-    }
-};
-} // namespace std
-
 namespace HLE {
 namespace Applets {
 
-static std::unordered_map<Service::APT::AppletId, std::shared_ptr<Applet>> applets;
-/// The CoreTiming event identifier for the Applet update callback.
-static Core::TimingEventType* applet_update_event = nullptr;
 /// The interval at which the Applet update callback will be called, 16.6ms
 static const u64 applet_update_interval_us = 16666;
 
 ResultCode Applet::Create(Service::APT::AppletId id,
                           std::weak_ptr<Service::APT::AppletManager> manager) {
+    auto& applets = manager.lock()->GetHLEApplets().applets;
     switch (id) {
     case Service::APT::AppletId::SoftwareKeyboard1:
     case Service::APT::AppletId::SoftwareKeyboard2:
@@ -72,7 +50,9 @@ ResultCode Applet::Create(Service::APT::AppletId id,
     return RESULT_SUCCESS;
 }
 
-std::shared_ptr<Applet> Applet::Get(Service::APT::AppletId id) {
+std::shared_ptr<Applet> Applet::Get(Service::APT::AppletManager& manager,
+                                    Service::APT::AppletId id) {
+    const auto& applets = manager.GetHLEApplets().applets;
     auto itr = applets.find(id);
     if (itr != applets.end())
         return itr->second;
@@ -80,9 +60,10 @@ std::shared_ptr<Applet> Applet::Get(Service::APT::AppletId id) {
 }
 
 /// Handles updating the current Applet every time it's called.
-static void AppletUpdateEvent(u64 applet_id, s64 cycles_late) {
+static void AppletUpdateEvent(Service::APT::AppletManager& manager, u64 applet_id,
+                              s64 cycles_late) {
     Service::APT::AppletId id = static_cast<Service::APT::AppletId>(applet_id);
-    std::shared_ptr<Applet> applet = Applet::Get(id);
+    std::shared_ptr<Applet> applet = Applet::Get(manager, id);
     ASSERT_MSG(applet != nullptr, "Applet doesn't exist! applet_id={:08X}", static_cast<u32>(id));
 
     applet->Update();
@@ -90,10 +71,11 @@ static void AppletUpdateEvent(u64 applet_id, s64 cycles_late) {
     // If the applet is still running after the last update, reschedule the event
     if (applet->IsRunning()) {
         Core::System::GetInstance().CoreTiming().ScheduleEvent(
-            usToCycles(applet_update_interval_us) - cycles_late, applet_update_event, applet_id);
+            usToCycles(applet_update_interval_us) - cycles_late,
+            manager.GetHLEApplets().update_event, applet_id);
     } else {
         // Otherwise the applet has terminated, in which case we should clean it up
-        applets[id] = nullptr;
+        manager.GetHLEApplets().applets[id] = nullptr;
     }
 }
 
@@ -101,9 +83,12 @@ ResultCode Applet::Start(const Service::APT::AppletStartupParameter& parameter)
     ResultCode result = StartImpl(parameter);
     if (result.IsError())
         return result;
+    auto locked = manager.lock();
+    ASSERT(locked != nullptr);
     // Schedule the update event
     Core::System::GetInstance().CoreTiming().ScheduleEvent(
-        usToCycles(applet_update_interval_us), applet_update_event, static_cast<u64>(id));
+        usToCycles(applet_update_interval_us), locked->GetHLEApplets().update_event,
+        static_cast<u64>(id));
     return result;
 }
 
@@ -119,22 +104,25 @@ void Applet::SendParameter(const Service::APT::MessageParameter& parameter) {
     }
 }
 
-bool IsLibraryAppletRunning() {
+bool IsLibraryAppletRunning(Service::APT::AppletManager& manager) {
     // Check the applets map for instances of any applet
+    const auto& applets = manager.GetHLEApplets().applets;
     for (auto itr = applets.begin(); itr != applets.end(); ++itr)
         if (itr->second != nullptr)
             return true;
     return false;
 }
 
-void Init() {
+void Init(Service::APT::AppletManager& manager) {
     // Register the applet update callback
-    applet_update_event = Core::System::GetInstance().CoreTiming().RegisterEvent(
-        "HLE Applet Update Event", AppletUpdateEvent);
+    manager.GetHLEApplets().update_event = Core::System::GetInstance().CoreTiming().RegisterEvent(
+        "HLE Applet Update Event", [&manager](u64 applet_id, s64 cycles_late) {
+            AppletUpdateEvent(manager, applet_id, cycles_late);
+        });
 }
 
-void Shutdown() {
-    Core::System::GetInstance().CoreTiming().RemoveEvent(applet_update_event);
+void Shutdown(Service::APT::AppletManager& manager) {
+    Core::System::GetInstance().CoreTiming().RemoveEvent(manager.GetHLEApplets().update_event);
 }
 } // namespace Applets
 } // namespace HLE
@@ -4,20 +4,51 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <type_traits>
+#include <unordered_map>
 #include "core/hle/result.h"
 #include "core/hle/service/apt/applet_manager.h"
 
+namespace Core {
+struct TimingEventType;
+}
+
+// Specializes std::hash for AppletId, so that we can use it in std::unordered_map.
+// Workaround for libstdc++ bug: https://gcc.gnu.org/bugzilla/show_bug.cgi?id=60970
+namespace std {
+template <>
+struct hash<Service::APT::AppletId> {
+    typedef Service::APT::AppletId argument_type;
+    typedef std::size_t result_type;
+
+    result_type operator()(const argument_type& id_code) const {
+        typedef std::underlying_type<argument_type>::type Type;
+        return std::hash<Type>()(static_cast<Type>(id_code));
+    }
+};
+} // namespace std
+
 namespace HLE {
 namespace Applets {
 
+class Applet;
+
+/// The HLE applets of an AppletManager
+struct AppletState {
+    std::unordered_map<Service::APT::AppletId, std::shared_ptr<Applet>> applets;
+    /// The CoreTiming event identifier for the Applet update callback.
+    Core::TimingEventType* update_event = nullptr;
+};
+
 class Applet {
 public:
     virtual ~Applet() = default;
 
     /**
      * Creates an instance of the Applet subclass identified by the parameter.
-     * and stores it in a global map.
+     * and stores it in the applets of the manager.
      * @param id Id of the applet to create.
      * @returns ResultCode Whether the operation was successful or not.
      */
@@ -26,10 +57,12 @@ public:
 
     /**
      * Retrieves the Applet instance identified by the specified id.
+     * @param manager AppletManager owning the applet.
      * @param id Id of the Applet to retrieve.
      * @returns Requested Applet or nullptr if not found.
      */
-    static std::shared_ptr<Applet> Get(Service::APT::AppletId id);
+    static std::shared_ptr<Applet> Get(Service::APT::AppletManager& manager,
+                                       Service::APT::AppletId id);
 
     /**
      * Handles a parameter from the application.
@@ -78,13 +111,13 @@ private:
     std::weak_ptr<Service::APT::AppletManager> manager;
 };
 
-/// Returns whether a library applet is currently running
-bool IsLibraryAppletRunning();
+/// Returns whether a library applet of the manager is currently running
+bool IsLibraryAppletRunning(Service::APT::AppletManager& manager);
 
-/// Initializes the HLE applets
-void Init();
+/// Initializes the HLE applets of the manager
+void Init(Service::APT::AppletManager& manager);
 
-/// Shuts down the HLE applets
-void Shutdown();
+/// Shuts down the HLE applets of the manager
+void Shutdown(Service::APT::AppletManager& manager);
 } // namespace Applets
 } // namespace HLE
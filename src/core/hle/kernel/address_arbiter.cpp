@@ -19,52 +19,59 @@ namespace Kernel {
 void AddressArbiter::WaitThread(SharedPtr<Thread> thread, VAddr wait_address) {
     thread->wait_address = wait_address;
     thread->status = ThreadStatus::WaitArb;
-    waiting_threads.emplace_back(std::move(thread));
+    waiting_threads[wait_address].emplace_back(std::move(thread));
 }
 
 void AddressArbiter::ResumeAllThreads(VAddr address) {
-    // Determine which threads are waiting on this address, those should be woken up.
-    auto itr = std::stable_partition(waiting_threads.begin(), waiting_threads.end(),
-                                     [address](const auto& thread) {
-                                         ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                                                    "Inconsistent AddressArbiter state");
-                                         return thread->wait_address != address;
-                                     });
+    // Take the threads waiting on this address, those should be woken up.
+    auto list = waiting_threads.find(address);
+    if (list == waiting_threads.end())
+        return;
+    const std::vector<SharedPtr<Thread>> threads = std::move(list->second);
+    waiting_threads.erase(list);
 
     // Wake up all the found threads
-    std::for_each(itr, waiting_threads.end(), [](auto& thread) { thread->ResumeFromWait(); });
-
-    // Remove the woken up threads from the wait list.
-    waiting_threads.erase(itr, waiting_threads.end());
+    for (const auto& thread : threads) {
+        ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+        thread->ResumeFromWait();
+    }
 }
 
 SharedPtr<Thread> AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
-    // Determine which threads are waiting on this address, those should be considered for wakeup.
-    auto matches_start = std::stable_partition(
-        waiting_threads.begin(), waiting_threads.end(), [address](const auto& thread) {
-            ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                       "Inconsistent AddressArbiter state");
-            return thread->wait_address != address;
-        });
+    // Only the threads waiting on this address should be considered for wakeup.
+    auto list = waiting_threads.find(address);
+    if (list == waiting_threads.end())
+        return nullptr;
+    std::vector<SharedPtr<Thread>>& threads = list->second;
 
     // Iterate through threads, find highest priority thread that is waiting to be arbitrated.
     // Note: The real kernel will pick the first thread in the list if more than one have the
     // same highest priority value. Lower priority values mean higher priority.
-    auto itr = std::min_element(matches_start, waiting_threads.end(),
+    auto itr = std::min_element(threads.begin(), threads.end(),
                                 [](const auto& lhs, const auto& rhs) {
                                     return lhs->current_priority < rhs->current_priority;
                                 });
-
-    if (itr == waiting_threads.end())
-        return nullptr;
+    ASSERT_MSG((*itr)->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
 
     auto thread = *itr;
     thread->ResumeFromWait();
 
-    waiting_threads.erase(itr);
+    threads.erase(itr);
+    if (threads.empty())
+        waiting_threads.erase(list);
     return thread;
 }
 
+void AddressArbiter::RemoveWaitingThread(Thread* thread) {
+    auto list = waiting_threads.find(thread->wait_address);
+    if (list == waiting_threads.end())
+        return;
+    std::vector<SharedPtr<Thread>>& threads = list->second;
+    threads.erase(std::remove(threads.begin(), threads.end(), thread), threads.end());
+    if (threads.empty())
+        waiting_threads.erase(list);
+}
+
 AddressArbiter::AddressArbiter(KernelSystem& kernel) : Object(kernel), kernel(kernel) {}
 AddressArbiter::~AddressArbiter() {}
 
@@ -83,8 +90,7 @@ ResultCode AddressArbiter::ArbitrateAddress(SharedPtr<Thread> thread, Arbitratio
                                    SharedPtr<WaitObject> object) {
         ASSERT(reason == ThreadWakeupReason::Timeout);
         // Remove the newly-awakened thread from the Arbiter's waiting list.
-        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                              waiting_threads.end());
+        RemoveWaitingThread(thread.get());
     };
 
     switch (type) {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
@@ -64,8 +65,14 @@ private:
     /// the resumed thread.
     SharedPtr<Thread> ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<SharedPtr<Thread>> waiting_threads;
+    /// Removes a thread that stopped waiting without being signaled from the waiting lists
+    void RemoveWaitingThread(Thread* thread);
+
+    /**
+     * Threads waiting for the address arbiter to be signaled, by arbitration address and in the
+     * order they started waiting in, so that arbitration only looks at the threads of its address.
+     */
+    std::unordered_map<VAddr, std::vector<SharedPtr<Thread>>> waiting_threads;
 
     friend class KernelSystem;
 };
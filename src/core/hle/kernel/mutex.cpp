@@ -109,11 +109,7 @@ void Mutex::UpdatePriority() {
     if (!holding_thread)
         return;
 
-    u32 best_priority = ThreadPrioLowest;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
-    }
+    const u32 best_priority = GetHighestWaitingPriority().value_or(ThreadPrioLowest);
 
     if (best_priority != priority) {
         priority = best_priority;
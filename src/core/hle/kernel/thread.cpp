@@ -379,13 +379,8 @@ ResultVal<SharedPtr<Thread>> KernelSystem::CreateThread(std::string name, VAddr
 void Thread::SetPriority(u32 priority) {
     ASSERT_MSG(priority <= ThreadPrioLowest && priority >= ThreadPrioHighest,
                "Invalid priority value.");
-    // If thread was ready, adjust queues
-    if (status == ThreadStatus::Ready)
-        thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
-
-    nominal_priority = current_priority = priority;
+    nominal_priority = priority;
+    BoostPriority(priority);
 }
 
 void Thread::UpdatePriority() {
@@ -403,7 +398,12 @@ void Thread::BoostPriority(u32 priority) {
         thread_manager.ready_queue.move(this, current_priority, priority);
     else
         thread_manager.ready_queue.prepare(priority);
+    const u32 old_priority = current_priority;
     current_priority = priority;
+
+    // The waiting lists of the objects the thread waits on are sorted by priority
+    for (auto& object : wait_objects)
+        object->UpdateWaitingThreadPriority(this, old_priority);
 }
 
 SharedPtr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority,
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <tuple>
 #include <utility>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -16,14 +17,44 @@
 
 namespace Kernel {
 
+std::pair<WaitObject::WaiterIterator, WaitObject::WaiterIterator> WaitObject::GetPriorityBucket(
+    u32 priority) {
+    struct Compare {
+        bool operator()(const Waiter& waiter, u32 priority) const {
+            return waiter.priority < priority;
+        }
+        bool operator()(u32 priority, const Waiter& waiter) const {
+            return priority < waiter.priority;
+        }
+    };
+    return std::equal_range(waiting_threads.begin(), waiting_threads.end(), priority, Compare{});
+}
+
+WaitObject::WaiterIterator WaitObject::FindWaiter(Thread* thread, u32 priority) {
+    const auto [begin, end] = GetPriorityBucket(priority);
+    const auto itr = std::find_if(begin, end, [thread](const Waiter& waiter) {
+        return waiter.thread == thread;
+    });
+    return itr != end ? itr : waiting_threads.end();
+}
+
+void WaitObject::InsertWaiter(Waiter waiter) {
+    const auto itr = std::upper_bound(waiting_threads.begin(), waiting_threads.end(), waiter,
+                                      [](const Waiter& lhs, const Waiter& rhs) {
+                                          return std::tie(lhs.priority, lhs.order) <
+                                                 std::tie(rhs.priority, rhs.order);
+                                      });
+    waiting_threads.insert(itr, std::move(waiter));
+}
+
 void WaitObject::AddWaitingThread(SharedPtr<Thread> thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    const u32 priority = thread->current_priority;
+    if (FindWaiter(thread.get(), priority) == waiting_threads.end())
+        InsertWaiter(Waiter{priority, next_waiter_order++, std::move(thread)});
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
+    auto itr = FindWaiter(thread, thread->current_priority);
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
     // waiting threads list multiple times.
@@ -31,20 +62,35 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
         waiting_threads.erase(itr);
 }
 
-SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = ThreadPrioLowest + 1;
+void WaitObject::UpdateWaitingThreadPriority(Thread* thread, u32 old_priority) {
+    auto itr = FindWaiter(thread, old_priority);
+    // Not found if the thread waits on this object through several handles and was moved already
+    if (itr == waiting_threads.end() || thread->current_priority == old_priority)
+        return;
 
-    for (const auto& thread : waiting_threads) {
+    Waiter waiter = std::move(*itr);
+    waiting_threads.erase(itr);
+    waiter.priority = thread->current_priority;
+    InsertWaiter(std::move(waiter));
+}
+
+std::optional<u32> WaitObject::GetHighestWaitingPriority() const {
+    if (waiting_threads.empty())
+        return std::nullopt;
+    return waiting_threads.front().priority;
+}
+
+SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
+    // Threads are sorted by priority and then by the order they started waiting in, so the first
+    // ready thread is the one the real kernel would pick
+    for (const Waiter& waiter : waiting_threads) {
+        const SharedPtr<Thread>& thread = waiter.thread;
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
                        thread->status == ThreadStatus::WaitSynchAll ||
                        thread->status == ThreadStatus::WaitHleEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
             continue;
 
@@ -58,13 +104,11 @@ SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
                                         });
         }
 
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
-        }
+        if (ready_to_run)
+            return thread;
     }
 
-    return candidate;
+    return nullptr;
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
@@ -92,8 +136,12 @@ void WaitObject::WakeupAllWaitingThreads() {
         hle_notifier();
 }
 
-const std::vector<SharedPtr<Thread>>& WaitObject::GetWaitingThreads() const {
-    return waiting_threads;
+std::vector<SharedPtr<Thread>> WaitObject::GetWaitingThreads() const {
+    std::vector<SharedPtr<Thread>> threads;
+    threads.reserve(waiting_threads.size());
+    for (const Waiter& waiter : waiting_threads)
+        threads.push_back(waiter.thread);
+    return threads;
 }
 
 void WaitObject::SetHLENotifier(std::function<void()> callback) {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <functional>
+#include <optional>
 #include <vector>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 #include "common/common_types.h"
@@ -50,15 +51,47 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     SharedPtr<Thread> GetHighestPriorityReadyThread();
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<SharedPtr<Thread>>& GetWaitingThreads() const;
+    /**
+     * Moves a waiting thread to the position of its new priority in the waiting list, to be called
+     * when its current priority changes.
+     * @param thread Pointer to the thread whose priority changed
+     * @param old_priority Priority the thread had when it was last added or moved
+     */
+    void UpdateWaitingThreadPriority(Thread* thread, u32 old_priority);
+
+    /// Returns the priority of the highest priority waiting thread, if there is one
+    std::optional<u32> GetHighestWaitingPriority() const;
+
+    /// Get the waiting threads, in the order they would be woken up in, for debug use
+    std::vector<SharedPtr<Thread>> GetWaitingThreads() const;
 
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
 private:
-    /// Threads waiting for this object to become available
-    std::vector<SharedPtr<Thread>> waiting_threads;
+    struct Waiter {
+        u32 priority; ///< Current priority of the thread
+        u64 order;    ///< When the thread started waiting, orders the threads of the same priority
+        SharedPtr<Thread> thread;
+    };
+    using WaiterIterator = std::vector<Waiter>::iterator;
+
+    /// Returns the range of waiting_threads holding the threads of the given priority
+    std::pair<WaiterIterator, WaiterIterator> GetPriorityBucket(u32 priority);
+
+    /// Finds a waiting thread in the bucket of the given priority
+    WaiterIterator FindWaiter(Thread* thread, u32 priority);
+
+    /// Inserts a waiter at the position given by its priority and order
+    void InsertWaiter(Waiter waiter);
+
+    /**
+     * Threads waiting for this object to become available, sorted by priority and then by the
+     * order they started waiting in, which is the order they are woken up in. This keeps wakeups
+     * from scanning the whole list, as the first ready thread is the one to wake up.
+     */
+    std::vector<Waiter> waiting_threads;
+    u64 next_waiter_order = 0;
 
     /// Function to call when this object becomes available
     std::function<void()> hle_notifier;
@@ -185,7 +185,7 @@ ResultCode AppletManager::SendParameter(const MessageParameter& parameter) {
                           ErrorSummary::InvalidState, ErrorLevel::Status);
     }
     CancelAndSendParameter(parameter);
-    if (auto dest_applet = HLE::Applets::Applet::Get(parameter.destination_id)) {
+    if (auto dest_applet = HLE::Applets::Applet::Get(*this, parameter.destination_id)) {
         return dest_applet->ReceiveParameter(parameter);
     } else {
         return RESULT_SUCCESS;
@@ -299,8 +299,8 @@ bool AppletManager::IsRegistered(AppletId app_id) {
 
     if (!is_registered) {
         if (app_id == AppletId::AnyLibraryApplet) {
-            is_registered = HLE::Applets::IsLibraryAppletRunning();
-        } else if (auto applet = HLE::Applets::Applet::Get(app_id)) {
+            is_registered = HLE::Applets::IsLibraryAppletRunning(*this);
+        } else if (auto applet = HLE::Applets::Applet::Get(*this, app_id)) {
             // The applet exists, set it as registered.
             is_registered = true;
         }
@@ -336,7 +336,7 @@ ResultCode AppletManager::PrepareToStartLibraryApplet(AppletId applet_id) {
     }
 
     // If we weren't able to load the native applet title, try to fallback to an HLE implementation.
-    auto applet = HLE::Applets::Applet::Get(applet_id);
+    auto applet = HLE::Applets::Applet::Get(*this, applet_id);
     if (applet) {
         LOG_WARNING(Service_APT, "applet has already been started id={:08X}",
                     static_cast<u32>(applet_id));
@@ -366,7 +366,7 @@ ResultCode AppletManager::PreloadLibraryApplet(AppletId applet_id) {
     }
 
     // If we weren't able to load the native applet title, try to fallback to an HLE implementation.
-    auto applet = HLE::Applets::Applet::Get(applet_id);
+    auto applet = HLE::Applets::Applet::Get(*this, applet_id);
     if (applet) {
         LOG_WARNING(Service_APT, "applet has already been started id={:08X}",
                     static_cast<u32>(applet_id));
@@ -395,7 +395,7 @@ ResultCode AppletManager::StartLibraryApplet(AppletId applet_id,
     CancelAndSendParameter(param);
 
     // In case the applet is being HLEd, attempt to communicate with it.
-    if (auto applet = HLE::Applets::Applet::Get(applet_id)) {
+    if (auto applet = HLE::Applets::Applet::Get(*this, applet_id)) {
         AppletStartupParameter parameter;
         parameter.object = object;
         parameter.buffer = buffer;
@@ -453,7 +453,7 @@ ResultVal<AppletManager::AppletInfo> AppletManager::GetAppletInfo(AppletId app_i
 
     if (slot == nullptr || !slot->registered) {
         // See if there's an HLE applet and try to use it before erroring out.
-        auto hle_applet = HLE::Applets::Applet::Get(app_id);
+        auto hle_applet = HLE::Applets::Applet::Get(*this, app_id);
         if (hle_applet == nullptr) {
             return ResultCode(ErrorDescription::NotFound, ErrorModule::Applet,
                               ErrorSummary::NotFound, ErrorLevel::Status);
@@ -569,7 +569,8 @@ void AppletManager::EnsureHomeMenuLoaded() {
     }
 }
 
-AppletManager::AppletManager(Core::System& system) : system(system) {
+AppletManager::AppletManager(Core::System& system)
+    : hle_applets(std::make_unique<HLE::Applets::AppletState>()), system(system) {
     for (std::size_t slot = 0; slot < applet_slots.size(); ++slot) {
         auto& slot_data = applet_slots[slot];
         slot_data.slot = static_cast<AppletSlot>(slot);
@@ -582,11 +583,11 @@ AppletManager::AppletManager(Core::System& system) : system(system) {
         slot_data.parameter_event =
             system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "APT:Parameter");
     }
-    HLE::Applets::Init();
+    HLE::Applets::Init(*this);
 }
 
 AppletManager::~AppletManager() {
-    HLE::Applets::Shutdown();
+    HLE::Applets::Shutdown(*this);
 }
 
 } // namespace Service::APT
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <optional>
 #include <vector>
 #include "core/hle/kernel/event.h"
@@ -15,6 +16,10 @@ namespace Core {
 class System;
 }
 
+namespace HLE::Applets {
+struct AppletState;
+}
+
 namespace Service::APT {
 
 /// Signals used by APT functions
@@ -166,6 +171,11 @@ public:
         return app_jump_parameters;
     }
 
+    /// Gets the HLE applets started through this manager
+    HLE::Applets::AppletState& GetHLEApplets() {
+        return *hle_applets;
+    }
+
 private:
     /// Parameter data to be returned in the next call to Glance/ReceiveParameter.
     std::optional<MessageParameter> next_parameter;
@@ -214,6 +224,8 @@ private:
     // Command that will be sent to the application when a library applet calls CloseLibraryApplet.
     SignalType library_applet_closing_command;
 
+    std::unique_ptr<HLE::Applets::AppletState> hle_applets;
+
     Core::System& system;
 };
 
@@ -4,23 +4,35 @@
 
 #include <vector>
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/gsp/gsp.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/video_core.h"
 
 namespace Service::GSP {
 
-static std::weak_ptr<GSP_GPU> gsp_gpu;
+/// Gets the GSP_GPU service of the System bound to the calling thread
+static std::shared_ptr<GSP_GPU> GetGSPGPU() {
+    auto gpu = Core::System::GetInstance().ServiceManager().GetService<GSP_GPU>("gsp::Gpu");
+    ASSERT(gpu != nullptr);
+    return gpu;
+}
 
 FrameBufferUpdate* GetFrameBufferInfo(u32 thread_id, u32 screen_index) {
-    auto gpu = gsp_gpu.lock();
-    ASSERT(gpu != nullptr);
-    return gpu->GetFrameBufferInfo(thread_id, screen_index);
+    return GetGSPGPU()->GetFrameBufferInfo(thread_id, screen_index);
 }
 
 void SignalInterrupt(InterruptId interrupt_id) {
-    auto gpu = gsp_gpu.lock();
-    ASSERT(gpu != nullptr);
+    auto gpu = GetGSPGPU();
+    if (VideoCore::GetGPUThread() && VideoCore::GetGPUThread()->IsGPUThread()) {
+        // Kernel objects may only be accessed from the emulation thread
+        Core::System::GetInstance().CoreTiming().ScheduleEventThreadsafe(
+            0, gpu->GetDeferredInterruptEvent(), static_cast<u64>(interrupt_id));
+        return;
+    }
+
     return gpu->SignalInterrupt(interrupt_id);
 }
 
@@ -28,7 +40,13 @@ void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     auto gpu = std::make_shared<GSP_GPU>(system);
     gpu->InstallAsService(service_manager);
-    gsp_gpu = gpu;
+
+    // Every System registers an event under this name, and the callback runs with the System
+    // that scheduled it bound, so SignalInterrupt finds the right service
+    gpu->SetDeferredInterruptEvent(system.CoreTiming().RegisterEvent(
+        "GSP::DeferredInterrupt", [](u64 userdata, s64 cycles_late) {
+            SignalInterrupt(static_cast<InterruptId>(userdata));
+        }));
 
     std::make_shared<GSP_LCD>()->InstallAsService(service_manager);
 }
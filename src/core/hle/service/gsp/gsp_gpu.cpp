@@ -18,6 +18,10 @@
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
 #include "core/memory.h"
+#ifdef ENABLE_SCRIPTING
+#include "core/rpc/rpc_server.h"
+#endif
+#include "core/savestate.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu_debugger.h"
 
@@ -50,12 +54,6 @@ constexpr ResultCode ERR_REGS_INVALID_SIZE(ErrorDescription::InvalidSize, ErrorM
                                            ErrorSummary::InvalidArgument,
                                            ErrorLevel::Usage); // 0xE0E02BEC
 
-/// Maximum number of threads that can be registered at the same time in the GSP module.
-constexpr u32 MaxGSPThreads = 4;
-
-/// Thread ids currently in use by the sessions connected to the GSPGPU service.
-static std::array<bool, MaxGSPThreads> used_thread_ids = {false, false, false, false};
-
 static PAddr VirtualToPhysicalAddress(VAddr addr) {
     if (addr == 0) {
         return 0;
@@ -79,7 +77,7 @@ static PAddr VirtualToPhysicalAddress(VAddr addr) {
     return addr | 0x80000000;
 }
 
-static u32 GetUnusedThreadId() {
+static u32 GetUnusedThreadId(const ThreadIdSlots& used_thread_ids) {
     for (u32 id = 0; id < MaxGSPThreads; ++id) {
         if (!used_thread_ids[id])
             return id;
@@ -312,8 +310,16 @@ ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info) {
         Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
 
     if (screen_id == 0) {
-        MicroProfileFlip();
-        Core::System::GetInstance().perf_stats.EndGameFrame();
+        Core::System& system = Core::System::GetInstance();
+        system.perf_stats.EndGameFrame();
+        system.SaveStates().EndGameFrame();
+        // The profiler and the RPC server are process wide, they follow the default instance
+        if (system.IsDefaultInstance()) {
+            MicroProfileFlip();
+#ifdef ENABLE_SCRIPTING
+            system.RPCServer().EndGameFrame();
+#endif
+        }
     }
 
     return RESULT_SUCCESS;
@@ -821,17 +827,24 @@ GSP_GPU::GSP_GPU(Core::System& system) : ServiceFramework("gsp::Gpu", 2), system
     first_initialization = true;
 };
 
-SessionData::SessionData() {
+std::unique_ptr<Kernel::SessionRequestHandler::SessionDataBase> GSP_GPU::MakeSessionData() const {
+    return std::make_unique<SessionData>(used_thread_ids);
+}
+
+SessionData::SessionData() : SessionData(std::make_shared<ThreadIdSlots>()) {}
+
+SessionData::SessionData(std::shared_ptr<ThreadIdSlots> slots)
+    : used_thread_ids(std::move(slots)) {
     // Assign a new thread id to this session when it connects. Note: In the real GSP service this
     // is done through a real thread (svcCreateThread) but we have to simulate it since our HLE
     // services don't have threads.
-    thread_id = GetUnusedThreadId();
-    used_thread_ids[thread_id] = true;
+    thread_id = GetUnusedThreadId(*used_thread_ids);
+    (*used_thread_ids)[thread_id] = true;
 }
 
 SessionData::~SessionData() {
     // Free the thread id slot so that other sessions can use it.
-    used_thread_ids[thread_id] = false;
+    (*used_thread_ids)[thread_id] = false;
 }
 
 } // namespace Service::GSP
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -15,6 +17,7 @@
 
 namespace Core {
 class System;
+struct TimingEventType;
 }
 
 namespace Kernel {
@@ -182,8 +185,16 @@ struct CommandBuffer {
 };
 static_assert(sizeof(CommandBuffer) == 0x200, "CommandBuffer struct has incorrect size");
 
+/// Maximum number of threads that can be registered at the same time in the GSP module.
+constexpr u32 MaxGSPThreads = 4;
+
+/// Thread ids currently in use by the sessions connected to a GSPGPU service.
+using ThreadIdSlots = std::array<bool, MaxGSPThreads>;
+
 struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
+    /// Takes a thread id from slots of its own, GSP_GPU passes the slots of the service instead
     SessionData();
+    explicit SessionData(std::shared_ptr<ThreadIdSlots> slots);
     ~SessionData();
 
     /// Event triggered when GSP interrupt has been signalled
@@ -192,6 +203,10 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
     u32 thread_id;
     /// Whether RegisterInterruptRelayQueue was called for this session
     bool registered = false;
+
+private:
+    /// Slots of the service this session is connected to, shared so that they outlive it
+    std::shared_ptr<ThreadIdSlots> used_thread_ids;
 };
 
 class GSP_GPU final : public ServiceFramework<GSP_GPU, SessionData> {
@@ -201,6 +216,17 @@ public:
 
     void ClientDisconnected(Kernel::SharedPtr<Kernel::ServerSession> server_session) override;
 
+    std::unique_ptr<SessionDataBase> MakeSessionData() const override;
+
+    /// Sets the event used to deliver interrupts raised by the GPU thread on the emulation thread
+    void SetDeferredInterruptEvent(Core::TimingEventType* event) {
+        deferred_interrupt_event = event;
+    }
+
+    Core::TimingEventType* GetDeferredInterruptEvent() const {
+        return deferred_interrupt_event;
+    }
+
     /**
      * Signals that the specified interrupt type has occurred to userland code
      * @param interrupt_id ID of interrupt that is being signalled
@@ -412,6 +438,10 @@ private:
     int active_thread_id = -1;
 
     bool first_initialization = true;
+
+    std::shared_ptr<ThreadIdSlots> used_thread_ids = std::make_shared<ThreadIdSlots>();
+
+    Core::TimingEventType* deferred_interrupt_event = nullptr;
 };
 
 ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info);
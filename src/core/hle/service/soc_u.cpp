@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -11,8 +13,10 @@
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/hle/service/soc_u.h"
 
@@ -320,10 +324,169 @@ union CTRSockAddr {
     }
 };
 
+/// Result of a socket operation performed on the host
+struct HostResult {
+    s32 ret;              ///< Return value, or translated error
+    std::vector<u8> data; ///< Received data
+    std::vector<u8> addr; ///< Address of the peer, as a CTRSockAddr
+};
+
+/// Whether a (translated) result means that the operation would have blocked
+static bool WouldBlock(s32 ret) {
+    return ret == TranslateError(ERRNO(EAGAIN));
+}
+
+/// Result of the operations of the guest threads woken up by their socket being closed
+static s32 ClosedSocketError() {
+    return TranslateError(ERRNO(EBADF));
+}
+
+/// Accepts a connection on a host socket
+static HostResult AcceptHost(u32 socket_handle) {
+    sockaddr addr;
+    socklen_t addr_len = sizeof(addr);
+    HostResult result{static_cast<s32>(::accept(socket_handle, &addr, &addr_len)), {},
+                      std::vector<u8>(sizeof(CTRSockAddr))};
+    if (result.ret == SOCKET_ERROR_VALUE) {
+        result.ret = TranslateError(GET_ERRNO);
+    } else {
+        CTRSockAddr ctr_addr = CTRSockAddr::FromPlatform(addr);
+        std::memcpy(result.addr.data(), &ctr_addr, sizeof(ctr_addr));
+    }
+    return result;
+}
+
+/// Receives up to `len` bytes on a host socket, along with the source address if `get_addr`
+static HostResult RecvFromHost(u32 socket_handle, u32 len, u32 flags, bool get_addr) {
+    HostResult result{SOCKET_ERROR_VALUE, std::vector<u8>(len), {}};
+    if (get_addr) {
+        // Only get src adr if input adr available
+        sockaddr src_addr;
+        socklen_t src_addr_len = sizeof(src_addr);
+        result.addr.resize(sizeof(CTRSockAddr));
+        result.ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(result.data.data()), len,
+                                flags, &src_addr, &src_addr_len);
+        if (result.ret >= 0 && src_addr_len > 0) {
+            CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+            std::memcpy(result.addr.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+        }
+    } else {
+        result.ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(result.data.data()), len,
+                                flags, NULL, 0);
+    }
+
+    if (result.ret == SOCKET_ERROR_VALUE) {
+        result.ret = TranslateError(GET_ERRNO);
+        result.data.clear();
+    } else {
+        result.data.resize(result.ret);
+    }
+    return result;
+}
+
+/// Returns the result of a connection started on a non-blocking host socket, once it is writable
+static s32 GetConnectResult(u32 socket_handle) {
+    int error = 0;
+    socklen_t error_len = sizeof(error);
+    if (::getsockopt(socket_handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error),
+                     &error_len) != 0) {
+        error = GET_ERRNO;
+    }
+    return error == 0 ? 0 : TranslateError(error);
+}
+
+/// Polls host sockets without blocking, returning the number of ready sockets or an error
+static s32 PollHost(std::vector<pollfd>& platform_pollfd) {
+    s32 ret = ::poll(platform_pollfd.data(), static_cast<u32>(platform_pollfd.size()), 0);
+    if (ret == SOCKET_ERROR_VALUE)
+        ret = TranslateError(GET_ERRNO);
+    return ret;
+}
+
 void SOC_U::CleanupSockets() {
-    for (auto sock : open_sockets)
-        closesocket(sock.second.socket_fd);
-    open_sockets.clear();
+    // Closing a socket removes it from open_sockets
+    std::vector<u32> sockets;
+    for (const auto& sock : open_sockets)
+        sockets.push_back(sock.first);
+    for (const u32 socket_fd : sockets)
+        CloseSocket(socket_fd);
+}
+
+int SOC_U::CloseSocket(u32 socket_fd) {
+    open_sockets.erase(socket_fd);
+    for (const u64 id : poller->CancelSocket(socket_fd)) {
+        WakeUpRequest(id);
+    }
+    return closesocket(socket_fd);
+}
+
+void SOC_U::AddSocket(u32 socket_fd) {
+    if (!SetNonBlocking(socket_fd)) {
+        LOG_ERROR(Service_SOC, "Failed to make socket {} non-blocking", socket_fd);
+    }
+    open_sockets[socket_fd] = {socket_fd, true};
+}
+
+bool SOC_U::IsBlocking(u32 socket_fd) const {
+    const auto iter = open_sockets.find(socket_fd);
+    return iter != open_sockets.end() && iter->second.blocking;
+}
+
+void SOC_U::WaitForSockets(Kernel::HLERequestContext& ctx, const std::string& reason,
+                           std::vector<SocketPoller::WaitTarget> targets,
+                           SocketPoller::Operation operation, std::chrono::nanoseconds timeout,
+                           Kernel::HLERequestContext::WakeupCallback&& callback) {
+    const u64 id = poller->Submit(std::move(targets), std::move(operation));
+    waiting_requests[id] = ctx.SleepClientThread(
+        system.Kernel().GetThreadManager().GetCurrentThread(), reason, timeout,
+        [this, id, callback = std::move(callback)](Kernel::SharedPtr<Kernel::Thread> thread,
+                                                   Kernel::HLERequestContext& ctx,
+                                                   Kernel::ThreadWakeupReason reason) {
+            if (reason == Kernel::ThreadWakeupReason::Timeout) {
+                waiting_requests.erase(id);
+                poller->Cancel(id);
+            }
+            callback(thread, ctx, reason);
+        });
+}
+
+void SOC_U::WakeUpRequest(u64 id) {
+    const auto iter = waiting_requests.find(id);
+    if (iter == waiting_requests.end()) {
+        // The guest thread timed out in the meantime
+        return;
+    }
+    const auto event = std::move(iter->second);
+    waiting_requests.erase(iter);
+    event->Signal();
+}
+
+void SOC_U::RunSocketOperation(Kernel::HLERequestContext& ctx, const std::string& reason,
+                               u32 socket_handle, short events, HostOperation operation,
+                               Responder respond) {
+    HostResult result = operation();
+    if (!WouldBlock(result.ret) || !IsBlocking(socket_handle)) {
+        respond(ctx, result);
+        return;
+    }
+
+    auto pending = std::make_shared<HostResult>(std::move(result));
+    WaitForSockets(
+        ctx, reason, {{socket_handle, events}},
+        [operation = std::move(operation), pending] {
+            *pending = operation();
+            return !WouldBlock(pending->ret);
+        },
+        std::chrono::nanoseconds{0},
+        [pending, respond = std::move(respond)](Kernel::SharedPtr<Kernel::Thread> /*thread*/,
+                                                Kernel::HLERequestContext& ctx,
+                                                Kernel::ThreadWakeupReason /*reason*/) {
+            if (WouldBlock(pending->ret)) {
+                // The socket was closed before the operation could complete
+                pending->ret = ClosedSocketError();
+            }
+            respond(ctx, *pending);
+        });
 }
 
 void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
@@ -357,7 +520,7 @@ void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
     u32 ret = static_cast<u32>(::socket(domain, type, protocol));
 
     if ((s32)ret != SOCKET_ERROR_VALUE)
-        open_sockets[ret] = {ret, true};
+        AddSocket(ret);
 
     if ((s32)ret == SOCKET_ERROR_VALUE)
         ret = TranslateError(GET_ERRNO);
@@ -402,50 +565,19 @@ void SOC_U::Fcntl(Kernel::HLERequestContext& ctx) {
         rb.Push(posix_ret);
     });
 
+    // Host sockets never block, the blocking mode is emulated
+    auto iter = open_sockets.find(socket_handle);
+    if (iter == open_sockets.end()) {
+        posix_ret = TranslateError(ERRNO(EBADF));
+        return;
+    }
+
     if (ctr_cmd == 3) { // F_GETFL
-#ifdef _WIN32
-        posix_ret = 0;
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end() && iter->second.blocking == false)
-            posix_ret |= 4; // O_NONBLOCK
-#else
-        int ret = ::fcntl(socket_handle, F_GETFL, 0);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
         posix_ret = 0;
-        if (ret & O_NONBLOCK)
+        if (!iter->second.blocking)
             posix_ret |= 4; // O_NONBLOCK
-#endif
     } else if (ctr_cmd == 4) { // F_SETFL
-#ifdef _WIN32
-        unsigned long tmp = (ctr_arg & 4 /* O_NONBLOCK */) ? 1 : 0;
-        int ret = ioctlsocket(socket_handle, FIONBIO, &tmp);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end())
-            iter->second.blocking = (tmp == 0);
-#else
-        int flags = ::fcntl(socket_handle, F_GETFL, 0);
-        if (flags == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-
-        flags &= ~O_NONBLOCK;
-        if (ctr_arg & 4) // O_NONBLOCK
-            flags |= O_NONBLOCK;
-
-        int ret = ::fcntl(socket_handle, F_SETFL, flags);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-#endif
+        iter->second.blocking = (ctr_arg & 4 /* O_NONBLOCK */) == 0;
     } else {
         LOG_ERROR(Service_SOC, "Unsupported command ({}) in fcntl call", ctr_cmd);
         posix_ret = TranslateError(EINVAL); // TODO: Find the correct error
@@ -469,33 +601,22 @@ void SOC_U::Listen(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x04, 2, 2);
     u32 socket_handle = rp.Pop<u32>();
     socklen_t max_addr_len = static_cast<socklen_t>(rp.Pop<u32>());
     rp.PopPID();
-    sockaddr addr;
-    socklen_t addr_len = sizeof(addr);
-    u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
 
-    if ((s32)ret != SOCKET_ERROR_VALUE)
-        open_sockets[ret] = {ret, true};
-
-    CTRSockAddr ctr_addr;
-    std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
-    if ((s32)ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        ctr_addr = CTRSockAddr::FromPlatform(addr);
-        std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
-    }
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(ctr_addr_buf, 0);
+    RunSocketOperation(ctx, "soc:U::Accept", socket_handle, POLLIN,
+                       [socket_handle] { return AcceptHost(socket_handle); },
+                       [this](Kernel::HLERequestContext& ctx, HostResult& result) {
+                           if (result.ret >= 0)
+                               AddSocket(static_cast<u32>(result.ret));
+
+                           IPC::RequestBuilder rb(ctx, 0x04, 2, 2);
+                           rb.Push(RESULT_SUCCESS);
+                           rb.Push(result.ret);
+                           rb.PushStaticBuffer(result.addr, 0);
+                       });
 }
 
 void SOC_U::GetHostId(Kernel::HLERequestContext& ctx) {
@@ -522,10 +643,7 @@ void SOC_U::Close(Kernel::HLERequestContext& ctx) {
     u32 socket_handle = rp.Pop<u32>();
     rp.PopPID();
 
-    s32 ret = 0;
-    open_sockets.erase(socket_handle);
-
-    ret = closesocket(socket_handle);
+    s32 ret = CloseSocket(socket_handle);
 
     if (ret != 0)
         ret = TranslateError(GET_ERRNO);
@@ -545,24 +663,34 @@ void SOC_U::SendTo(Kernel::HLERequestContext& ctx) {
     auto input_buff = rp.PopStaticBuffer();
     auto dest_addr_buff = rp.PopStaticBuffer();
 
-    s32 ret = -1;
+    sockaddr dest_addr{};
     if (addr_len > 0) {
         CTRSockAddr ctr_dest_addr;
         std::memcpy(&ctr_dest_addr, dest_addr_buff.data(), sizeof(ctr_dest_addr));
-        sockaddr dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       &dest_addr, sizeof(dest_addr));
-    } else {
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       nullptr, 0);
+        dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
     }
 
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(GET_ERRNO);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
+    RunSocketOperation(
+        ctx, "soc:U::SendTo", socket_handle, POLLOUT,
+        [socket_handle, input_buff = std::move(input_buff), len, flags, addr_len, dest_addr] {
+            s32 ret = -1;
+            if (addr_len > 0) {
+                ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()),
+                               len, flags, &dest_addr, sizeof(dest_addr));
+            } else {
+                ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()),
+                               len, flags, nullptr, 0);
+            }
+
+            if (ret == SOCKET_ERROR_VALUE)
+                ret = TranslateError(GET_ERRNO);
+            return HostResult{ret, {}, {}};
+        },
+        [](Kernel::HLERequestContext& ctx, HostResult& result) {
+            IPC::RequestBuilder rb(ctx, 0x0A, 2, 0);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(result.ret);
+        });
 }
 
 void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
@@ -572,45 +700,27 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     u32 flags = rp.Pop<u32>();
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
-    auto& buffer = rp.PopMappedBuffer();
-
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
-        }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
-
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        buffer.Write(output_buff.data(), 0, ret);
-    }
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(addr_buff, 0);
-    rb.PushMappedBuffer(buffer);
+    const u32 buffer_id = rp.PopMappedBuffer().GetId();
+
+    RunSocketOperation(
+        ctx, "soc:U::RecvFromOther", socket_handle, POLLIN,
+        [socket_handle, len, flags, addr_len] {
+            return RecvFromHost(socket_handle, len, flags, addr_len > 0);
+        },
+        [buffer_id](Kernel::HLERequestContext& ctx, HostResult& result) {
+            auto& buffer = ctx.GetMappedBuffer(buffer_id);
+            if (result.ret >= 0)
+                buffer.Write(result.data.data(), 0, result.data.size());
+
+            IPC::RequestBuilder rb(ctx, 0x07, 2, 4);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(result.ret);
+            rb.PushStaticBuffer(result.addr, 0);
+            rb.PushMappedBuffer(buffer);
+        });
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x08, 4, 2);
     u32 socket_handle = rp.Pop<u32>();
     u32 len = rp.Pop<u32>();
@@ -618,42 +728,21 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        // Only get src adr if input adr available
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
-        }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
-
-    s32 total_received = ret;
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-        total_received = 0;
-    }
-
-    // Write only the data we received to avoid overwriting parts of the buffer with zeros
-    output_buff.resize(total_received);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.Push(total_received);
-    rb.PushStaticBuffer(output_buff, 0);
-    rb.PushStaticBuffer(addr_buff, 1);
+    RunSocketOperation(
+        ctx, "soc:U::RecvFrom", socket_handle, POLLIN,
+        [socket_handle, len, flags, addr_len] {
+            return RecvFromHost(socket_handle, len, flags, addr_len > 0);
+        },
+        [](Kernel::HLERequestContext& ctx, HostResult& result) {
+            // Only the data we received is written, to avoid overwriting parts of the buffer with
+            // zeros
+            IPC::RequestBuilder rb(ctx, 0x08, 3, 4);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(result.ret);
+            rb.Push(static_cast<s32>(result.data.size()));
+            rb.PushStaticBuffer(result.data, 0);
+            rb.PushStaticBuffer(result.addr, 1);
+        });
 }
 
 void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
@@ -669,25 +758,58 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
     // The 3ds_pollfd and the pollfd structures may be different (Windows/Linux have different
     // sizes)
     // so we have to copy the data
-    std::vector<pollfd> platform_pollfd(nfds);
-    std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
+    auto platform_pollfd = std::make_shared<std::vector<pollfd>>(nfds);
+    std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd->begin(),
+                   CTRPollFD::ToPlatform);
 
-    s32 ret = ::poll(platform_pollfd.data(), nfds, timeout);
+    const auto respond = [](Kernel::HLERequestContext& ctx,
+                            const std::vector<pollfd>& platform_pollfd, s32 ret) {
+        // Now update the output pollfd structure
+        std::vector<CTRPollFD> ctr_fds(platform_pollfd.size());
+        std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
+                       CTRPollFD::FromPlatform);
 
-    // Now update the output pollfd structure
-    std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
-                   CTRPollFD::FromPlatform);
+        std::vector<u8> output_fds(ctr_fds.size() * sizeof(CTRPollFD));
+        std::memcpy(output_fds.data(), ctr_fds.data(), output_fds.size());
 
-    std::vector<u8> output_fds(nfds * sizeof(CTRPollFD));
-    std::memcpy(output_fds.data(), ctr_fds.data(), nfds * sizeof(CTRPollFD));
+        IPC::RequestBuilder rb(ctx, 0x14, 2, 2);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+        rb.PushStaticBuffer(output_fds, 0);
+    };
 
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(GET_ERRNO);
+    // The sockets are only polled without blocking on the emulation thread
+    const s32 ret = PollHost(*platform_pollfd);
+    if (ret != 0 || timeout == 0) {
+        respond(ctx, *platform_pollfd, ret);
+        return;
+    }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(output_fds, 0);
+    std::vector<SocketPoller::WaitTarget> targets;
+    for (const pollfd& fd : *platform_pollfd) {
+        targets.push_back({static_cast<u32>(fd.fd), fd.events});
+    }
+
+    // A negative timeout waits forever
+    const std::chrono::nanoseconds wait_timeout =
+        std::chrono::milliseconds(std::max<s32>(timeout, 0));
+    auto pending_ret = std::make_shared<s32>(0);
+    WaitForSockets(
+        ctx, "soc:U::Poll", std::move(targets),
+        [platform_pollfd, pending_ret] {
+            *pending_ret = PollHost(*platform_pollfd);
+            return *pending_ret != 0;
+        },
+        wait_timeout,
+        [platform_pollfd, pending_ret, respond](Kernel::SharedPtr<Kernel::Thread> /*thread*/,
+                                                Kernel::HLERequestContext& ctx,
+                                                Kernel::ThreadWakeupReason /*reason*/) {
+            if (*pending_ret == 0) {
+                // Timed out, or one of the sockets was closed
+                *pending_ret = PollHost(*platform_pollfd);
+            }
+            respond(ctx, *platform_pollfd, *pending_ret);
+        });
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -752,9 +874,6 @@ void SOC_U::GetPeerName(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x06, 2, 4);
     u32 socket_handle = rp.Pop<u32>();
     u32 input_addr_len = rp.Pop<u32>();
@@ -768,10 +887,39 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
     s32 ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
     if (ret != 0)
         ret = TranslateError(GET_ERRNO);
+    // Windows reports connections in progress on non-blocking sockets as EWOULDBLOCK
+    if (WouldBlock(ret))
+        ret = TranslateError(ERRNO(EINPROGRESS));
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
+    const auto respond = [](Kernel::HLERequestContext& ctx, s32 ret) {
+        IPC::RequestBuilder rb(ctx, 0x06, 2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+    };
+
+    if (ret != TranslateError(ERRNO(EINPROGRESS)) || !IsBlocking(socket_handle)) {
+        respond(ctx, ret);
+        return;
+    }
+
+    // The connection is established, or failed, once the socket is writable
+    auto pending_ret = std::make_shared<s32>(ret);
+    WaitForSockets(
+        ctx, "soc:U::Connect", {{socket_handle, POLLOUT}},
+        [socket_handle, pending_ret] {
+            *pending_ret = GetConnectResult(socket_handle);
+            return true;
+        },
+        std::chrono::nanoseconds{0},
+        [pending_ret, respond](Kernel::SharedPtr<Kernel::Thread> /*thread*/,
+                               Kernel::HLERequestContext& ctx,
+                               Kernel::ThreadWakeupReason /*reason*/) {
+            if (*pending_ret == TranslateError(ERRNO(EINPROGRESS))) {
+                // The socket was closed before the connection was established
+                *pending_ret = ClosedSocketError();
+            }
+            respond(ctx, *pending_ret);
+        });
 }
 
 void SOC_U::InitializeSockets(Kernel::HLERequestContext& ctx) {
@@ -858,7 +1006,7 @@ void SOC_U::SetSockOpt(Kernel::HLERequestContext& ctx) {
     rb.Push(err);
 }
 
-SOC_U::SOC_U() : ServiceFramework("soc:U") {
+SOC_U::SOC_U(Core::System& system) : ServiceFramework("soc:U"), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &SOC_U::InitializeSockets, "InitializeSockets"},
         {0x000200C2, &SOC_U::Socket, "Socket"},
@@ -901,10 +1049,20 @@ SOC_U::SOC_U() : ServiceFramework("soc:U") {
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
 #endif
+
+    request_completed_event = system.CoreTiming().RegisterEvent(
+        "SOC_U::RequestCompleted",
+        [this](u64 userdata, s64 cycles_late) { WakeUpRequest(userdata); });
+    poller = std::make_unique<SocketPoller>([this](u64 id) {
+        this->system.CoreTiming().ScheduleEventThreadsafe(0, request_completed_event, id);
+    });
 }
 
 SOC_U::~SOC_U() {
+    // The kernel may already be shutting down, so the waiting guest threads aren't woken up
+    waiting_requests.clear();
     CleanupSockets();
+    poller.reset();
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -912,7 +1070,7 @@ SOC_U::~SOC_U() {
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<SOC_U>()->InstallAsService(service_manager);
+    std::make_shared<SOC_U>(system)->InstallAsService(service_manager);
 }
 
 } // namespace Service::SOC
@@ -4,24 +4,37 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/service/service.h"
+#include "core/hle/service/socket_poller.h"
 
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::SOC {
 
+struct HostResult;
+
 /// Holds information about a particular socket
 struct SocketHolder {
     u32 socket_fd; ///< The socket descriptor
-    bool blocking; ///< Whether the socket is blocking or not, it is only read on Windows.
+    /// Whether the guest expects the socket to block. The host socket itself never blocks, blocking
+    /// operations put the guest thread to sleep until the socket worker completes them.
+    bool blocking;
 };
 
 class SOC_U final : public ServiceFramework<SOC_U> {
 public:
-    SOC_U();
+    explicit SOC_U(Core::System& system);
     ~SOC_U();
 
 private:
@@ -48,8 +61,52 @@ private:
     /// Close all open sockets
     void CleanupSockets();
 
+    /// Closes a host socket, waking up the guest threads waiting on it. Returns the host result.
+    int CloseSocket(u32 socket_fd);
+
+    /// Registers a new host socket, which is made non-blocking
+    void AddSocket(u32 socket_fd);
+
+    /// Whether operations on the socket should block the guest
+    bool IsBlocking(u32 socket_fd) const;
+
+    /**
+     * Puts the calling guest thread to sleep until `operation` completes on the socket worker, or
+     * until the timeout expires if it isn't 0. The callback writes the response, which it also has
+     * to do if the socket was closed in the meantime.
+     */
+    void WaitForSockets(Kernel::HLERequestContext& ctx, const std::string& reason,
+                        std::vector<SocketPoller::WaitTarget> targets,
+                        SocketPoller::Operation operation, std::chrono::nanoseconds timeout,
+                        Kernel::HLERequestContext::WakeupCallback&& callback);
+
+    using HostOperation = std::function<HostResult()>;
+    using Responder = std::function<void(Kernel::HLERequestContext& ctx, HostResult& result)>;
+
+    /**
+     * Runs a socket operation and writes its response with `respond`. If the operation would block
+     * and the guest expects the socket to block, the guest thread is put to sleep and the operation
+     * is retried on the socket worker whenever the socket is ready for `events`.
+     */
+    void RunSocketOperation(Kernel::HLERequestContext& ctx, const std::string& reason,
+                            u32 socket_handle, short events, HostOperation operation,
+                            Responder respond);
+
+    /// Wakes up the guest thread waiting on a request of the socket worker
+    void WakeUpRequest(u64 id);
+
+    Core::System& system;
+
     /// Holds info about the currently open sockets
     std::unordered_map<u32, SocketHolder> open_sockets;
+
+    /// Events waking up the guest threads waiting on the socket worker, by request id
+    std::unordered_map<u64, Kernel::SharedPtr<Kernel::Event>> waiting_requests;
+
+    /// Signals on the emulation thread that the socket worker completed a request
+    Core::TimingEventType* request_completed_event;
+
+    std::unique_ptr<SocketPoller> poller;
 };
 
 void InstallInterfaces(Core::System& system);
@@ -0,0 +1,187 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/service/socket_poller.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define GET_ERRNO WSAGetLastError()
+#define poll(x, y, z) WSAPoll(x, y, z)
+#else
+#define GET_ERRNO errno
+#define closesocket(x) close(x)
+#endif
+
+namespace Service::SOC {
+
+bool SetNonBlocking(u32 socket_fd) {
+#ifdef _WIN32
+    unsigned long non_blocking = 1;
+    return ioctlsocket(socket_fd, FIONBIO, &non_blocking) == 0;
+#else
+    const int flags = ::fcntl(socket_fd, F_GETFL, 0);
+    return flags != -1 && ::fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+/// Creates a non-blocking loopback datagram socket which receives what is sent on it
+static u32 CreateWakeupSocket() {
+    const u32 socket_fd = static_cast<u32>(::socket(AF_INET, SOCK_DGRAM, 0));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    const bool created =
+        static_cast<s32>(socket_fd) != -1 &&
+        ::bind(socket_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0 &&
+        ::getsockname(socket_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0 &&
+        ::connect(socket_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0 &&
+        SetNonBlocking(socket_fd);
+    ASSERT_MSG(created, "Failed to create the wakeup socket of the socket worker (error {})",
+               GET_ERRNO);
+    return socket_fd;
+}
+
+SocketPoller::SocketPoller(CompletionCallback completion_callback)
+    : completion_callback(std::move(completion_callback)), wakeup_socket(CreateWakeupSocket()),
+      worker(&SocketPoller::Run, this) {}
+
+SocketPoller::~SocketPoller() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    Interrupt();
+    worker.join();
+    closesocket(wakeup_socket);
+}
+
+u64 SocketPoller::Submit(std::vector<WaitTarget> targets, Operation operation) {
+    u64 id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = next_id++;
+        requests.emplace(id, Request{std::move(targets), std::move(operation)});
+    }
+    Interrupt();
+    return id;
+}
+
+bool SocketPoller::Cancel(u64 id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests.erase(id) != 0;
+}
+
+std::vector<u64> SocketPoller::CancelSocket(u32 socket_fd) {
+    std::vector<u64> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = requests.begin(); it != requests.end();) {
+            bool waits_on_socket = false;
+            for (const WaitTarget& target : it->second.targets) {
+                waits_on_socket |= target.socket_fd == socket_fd;
+            }
+            if (waits_on_socket) {
+                cancelled.push_back(it->first);
+                it = requests.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (!cancelled.empty()) {
+        // Stop polling the socket before it is closed and its descriptor reused
+        Interrupt();
+    }
+    return cancelled;
+}
+
+void SocketPoller::Interrupt() {
+    // If the socket buffer is full, the worker has yet to wake up anyway
+    const char byte = 0;
+    ::send(wakeup_socket, &byte, 1, 0);
+}
+
+void SocketPoller::Run() {
+    Common::SetCurrentThreadName("SocketPoller");
+
+    std::vector<pollfd> fds;
+    std::vector<u64> fd_requests; ///< Id of the request of each pollfd, 0 for the wakeup socket
+    std::vector<u64> completed;
+    while (true) {
+        fds.assign(1, pollfd{});
+        fds[0].fd = wakeup_socket;
+        fds[0].events = POLLIN;
+        fd_requests.assign(1, 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            for (const auto& [id, request] : requests) {
+                for (const WaitTarget& target : request.targets) {
+                    pollfd fd{};
+                    fd.fd = target.socket_fd;
+                    fd.events = target.events;
+                    fds.push_back(fd);
+                    fd_requests.push_back(id);
+                }
+            }
+        }
+
+        if (::poll(fds.data(), static_cast<u32>(fds.size()), -1) == -1) {
+            const int error = GET_ERRNO;
+#ifndef _WIN32
+            if (error == EINTR) {
+                continue;
+            }
+#endif
+            LOG_ERROR(Service_SOC, "Failed to poll {} sockets (error {})", fds.size(), error);
+            continue;
+        }
+
+        if (fds[0].revents != 0) {
+            char buffer[64];
+            while (::recv(wakeup_socket, buffer, sizeof(buffer), 0) > 0) {
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::size_t i = 1; i < fds.size(); ++i) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                // The request may have been cancelled, or completed by another of its sockets
+                const auto it = requests.find(fd_requests[i]);
+                if (it != requests.end() && it->second.operation()) {
+                    completed.push_back(it->first);
+                    requests.erase(it);
+                }
+            }
+        }
+
+        for (const u64 id : completed) {
+            completion_callback(id);
+        }
+        completed.clear();
+    }
+}
+
+} // namespace Service::SOC
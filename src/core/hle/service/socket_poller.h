@@ -0,0 +1,78 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service::SOC {
+
+/// Puts a host socket in non-blocking mode. Returns false on failure.
+bool SetNonBlocking(u32 socket_fd);
+
+/**
+ * Host event loop for the socket operations of SOC_U that would block. Requests wait on a worker
+ * thread until one of their sockets is ready, then their operation is run there, so that a guest
+ * thread blocked on the network doesn't stall the emulation thread.
+ */
+class SocketPoller {
+public:
+    /// A host socket and the host poll events to wait for on it
+    struct WaitTarget {
+        u32 socket_fd;
+        short events;
+    };
+
+    /**
+     * Runs on the worker thread once one of the sockets of the request is ready. It must not block
+     * and returns false if it would still have blocked, to keep waiting.
+     */
+    using Operation = std::function<bool()>;
+
+    /// Called on the worker thread with the id of each request whose operation completed
+    using CompletionCallback = std::function<void(u64 id)>;
+
+    explicit SocketPoller(CompletionCallback completion_callback);
+    ~SocketPoller();
+
+    /// Queues an operation waiting on the given sockets and returns its id, which is never 0.
+    u64 Submit(std::vector<WaitTarget> targets, Operation operation);
+
+    /**
+     * Drops a request without running its operation.
+     * @returns false if the operation already completed, in which case its completion is reported.
+     */
+    bool Cancel(u64 id);
+
+    /// Drops the requests waiting on a socket, which is about to be closed, and returns their ids.
+    std::vector<u64> CancelSocket(u32 socket_fd);
+
+private:
+    struct Request {
+        std::vector<WaitTarget> targets;
+        Operation operation;
+    };
+
+    void Run();
+    /// Interrupts the worker thread so that it takes the changes of the requests into account
+    void Interrupt();
+
+    CompletionCallback completion_callback;
+
+    std::mutex mutex;
+    std::map<u64, Request> requests; ///< Pending requests by id, protected by mutex
+    u64 next_id = 1;
+    bool stopping = false;
+
+    /// Datagram socket connected to itself, which is written to interrupt the worker thread
+    u32 wakeup_socket;
+    std::thread worker;
+};
+
+} // namespace Service::SOC
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -13,10 +14,12 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "core/core.h"
 #include "core/file_sys/archive_ncch.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hw/aes/arithmetic128.h"
 #include "core/hw/aes/key.h"
+#include "core/hw/hw.h"
 
 namespace HW {
 namespace AES {
@@ -52,42 +55,10 @@ AESKey HexToKey(const std::string& hex) {
     return key;
 }
 
-struct KeySlot {
-    std::optional<AESKey> x;
-    std::optional<AESKey> y;
-    std::optional<AESKey> normal;
-
-    void SetKeyX(std::optional<AESKey> key) {
-        x = key;
-        GenerateNormalKey();
-    }
-
-    void SetKeyY(std::optional<AESKey> key) {
-        y = key;
-        GenerateNormalKey();
-    }
-
-    void SetNormalKey(std::optional<AESKey> key) {
-        normal = key;
-    }
-
-    void GenerateNormalKey() {
-        if (x && y) {
-            normal = Lrot128(Add128(Xor128(Lrot128(*x, 2), *y), generator_constant), 87);
-        } else {
-            normal = {};
-        }
-    }
-
-    void Clear() {
-        x.reset();
-        y.reset();
-        normal.reset();
-    }
-};
-
-std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
-std::array<std::optional<AESKey>, 6> common_key_y_slots;
+/// Gets the key slots of the System bound to the calling thread
+KeyState& GetKeyState() {
+    return Core::System::GetInstance().HardwareState().aes_keys;
+}
 
 enum class FirmwareType : u32 {
     ARM9 = 0,  // uses NDMA
@@ -131,7 +102,7 @@ std::string KeyToString(AESKey& key) {
     return s;
 }
 
-void LoadBootromKeys() {
+void LoadBootromKeys(KeyState& state) {
     constexpr std::array<KeyDesc, 80> keys = {
         {{'X', 0x2C, false}, {'X', 0x2D, true},  {'X', 0x2E, true},  {'X', 0x2F, true},
          {'X', 0x30, false}, {'X', 0x31, true},  {'X', 0x32, true},  {'X', 0x33, true},
@@ -188,13 +159,13 @@ void LoadBootromKeys() {
 
         switch (key.key_type) {
         case 'X':
-            key_slots.at(key.slot_id).SetKeyX(new_key);
+            state.key_slots.at(key.slot_id).SetKeyX(new_key);
             break;
         case 'Y':
-            key_slots.at(key.slot_id).SetKeyY(new_key);
+            state.key_slots.at(key.slot_id).SetKeyY(new_key);
             break;
         case 'N':
-            key_slots.at(key.slot_id).SetNormalKey(new_key);
+            state.key_slots.at(key.slot_id).SetNormalKey(new_key);
             break;
         default:
             LOG_ERROR(HW_AES, "Invalid key type {}", key.key_type);
@@ -203,7 +174,7 @@ void LoadBootromKeys() {
     }
 }
 
-void LoadNativeFirmKeysOld3DS() {
+void LoadNativeFirmKeysOld3DS(KeyState& state) {
     // Use the save mode native firm instead of the normal mode since there are only 2 version of it
     // and thus we can use fixed offsets
 
@@ -234,7 +205,7 @@ void LoadNativeFirmKeysOld3DS() {
     AESKey key;
     constexpr std::size_t SLOT_0x31_KEY_Y_OFFSET = 817672;
     std::memcpy(key.data(), firm_buffer.data() + SLOT_0x31_KEY_Y_OFFSET, sizeof(key));
-    key_slots.at(0x31).SetKeyY(key);
+    state.key_slots.at(0x31).SetKeyY(key);
     LOG_DEBUG(HW_AES, "Loaded Slot0x31 KeyY: {}", KeyToString(key));
 
     auto LoadCommonKey = [&firm_buffer](std::size_t key_slot) -> AESKey {
@@ -247,12 +218,12 @@ void LoadNativeFirmKeysOld3DS() {
 
     for (std::size_t key_slot{0}; key_slot < 6; ++key_slot) {
         AESKey key = LoadCommonKey(key_slot);
-        common_key_y_slots[key_slot] = key;
+        state.common_key_y_slots[key_slot] = key;
         LOG_DEBUG(HW_AES, "Loaded common key{}: {}", key_slot, KeyToString(key));
     }
 }
 
-void LoadNativeFirmKeysNew3DS() {
+void LoadNativeFirmKeysNew3DS(KeyState& state) {
     // The first 0x10 bytes of the secret_sector are used as a key to decrypt a KeyX from the
     // native_firm
     const std::string filepath =
@@ -328,9 +299,9 @@ void LoadNativeFirmKeysNew3DS() {
     d.SetKey(secret_key.data(), secret_key.size());
     d.ProcessData(keyX_slot0x15.data(), arm9_header.enc_key_x.data(), arm9_header.enc_key_x.size());
 
-    key_slots.at(0x15).SetKeyX(keyX_slot0x15);
-    key_slots.at(0x15).SetKeyY(arm9_header.key_y);
-    auto normal_key_slot0x15 = key_slots.at(0x15).normal;
+    state.key_slots.at(0x15).SetKeyX(keyX_slot0x15);
+    state.key_slots.at(0x15).SetKeyY(arm9_header.key_y);
+    auto normal_key_slot0x15 = state.key_slots.at(0x15).normal;
     if (!normal_key_slot0x15) {
         LOG_ERROR(HW_AES, "Failed to get normal key for slot id 0x15");
         return;
@@ -353,7 +324,7 @@ void LoadNativeFirmKeysNew3DS() {
     AESKey key;
     constexpr std::size_t SLOT_0x31_KEY_Y_OFFSET = 517368;
     std::memcpy(key.data(), arm9_binary.data() + SLOT_0x31_KEY_Y_OFFSET, sizeof(key));
-    key_slots.at(0x31).SetKeyY(key);
+    state.key_slots.at(0x31).SetKeyY(key);
     LOG_DEBUG(HW_AES, "Loaded Slot0x31 KeyY: {}", KeyToString(key));
 
     auto LoadCommonKey = [&arm9_binary](std::size_t key_slot) -> AESKey {
@@ -366,12 +337,12 @@ void LoadNativeFirmKeysNew3DS() {
 
     for (std::size_t key_slot{0}; key_slot < 6; ++key_slot) {
         AESKey key = LoadCommonKey(key_slot);
-        common_key_y_slots[key_slot] = key;
+        state.common_key_y_slots[key_slot] = key;
         LOG_DEBUG(HW_AES, "Loaded common key{}: {}", key_slot, KeyToString(key));
     }
 }
 
-void LoadPresetKeys() {
+void LoadPresetKeys(KeyState& state) {
     const std::string filepath = FileUtil::GetUserPath(FileUtil::UserPath::SysDataDir) + AES_KEYS;
     FileUtil::CreateFullPath(filepath); // Create path if not already created
     std::ifstream file;
@@ -401,10 +372,10 @@ void LoadPresetKeys() {
 
         std::size_t common_key_index;
         if (std::sscanf(name.c_str(), "common%zd", &common_key_index) == 1) {
-            if (common_key_index >= common_key_y_slots.size()) {
+            if (common_key_index >= state.common_key_y_slots.size()) {
                 LOG_ERROR(HW_AES, "Invalid common key index {}", common_key_index);
             } else {
-                common_key_y_slots[common_key_index] = key;
+                state.common_key_y_slots[common_key_index] = key;
             }
             continue;
         }
@@ -423,13 +394,13 @@ void LoadPresetKeys() {
 
         switch (key_type) {
         case 'X':
-            key_slots.at(slot_id).SetKeyX(key);
+            state.key_slots.at(slot_id).SetKeyX(key);
             break;
         case 'Y':
-            key_slots.at(slot_id).SetKeyY(key);
+            state.key_slots.at(slot_id).SetKeyY(key);
             break;
         case 'N':
-            key_slots.at(slot_id).SetNormalKey(key);
+            state.key_slots.at(slot_id).SetNormalKey(key);
             break;
         default:
             LOG_ERROR(HW_AES, "Invalid key type {}", key_type);
@@ -440,39 +411,80 @@ void LoadPresetKeys() {
 
 } // namespace
 
+void KeySlot::SetKeyX(std::optional<AESKey> key) {
+    x = key;
+    GenerateNormalKey();
+}
+
+void KeySlot::SetKeyY(std::optional<AESKey> key) {
+    y = key;
+    GenerateNormalKey();
+}
+
+void KeySlot::SetNormalKey(std::optional<AESKey> key) {
+    normal = key;
+}
+
+void KeySlot::GenerateNormalKey() {
+    if (x && y) {
+        normal = Lrot128(Add128(Xor128(Lrot128(*x, 2), *y), generator_constant), 87);
+    } else {
+        normal = {};
+    }
+}
+
+void KeySlot::Clear() {
+    x.reset();
+    y.reset();
+    normal.reset();
+}
+
 void InitKeys() {
-    static bool initialized = false;
-    if (initialized)
+    KeyState& keys = GetKeyState();
+    if (keys.initialized)
         return;
-    LoadBootromKeys();
-    LoadNativeFirmKeysOld3DS();
-    LoadNativeFirmKeysNew3DS();
-    LoadPresetKeys();
-    initialized = true;
+    // Loading the firmware keys opens NCCH containers, which initialize the keys again
+    keys.initialized = true;
+
+    // Systems booting on several threads share the keys read from disk
+    static std::mutex loaded_keys_mutex;
+    static std::optional<KeyState> loaded_keys;
+    std::lock_guard<std::mutex> lock(loaded_keys_mutex);
+    if (loaded_keys) {
+        keys = *loaded_keys;
+        return;
+    }
+
+    LoadBootromKeys(keys);
+    LoadNativeFirmKeysOld3DS(keys);
+    LoadNativeFirmKeysNew3DS(keys);
+    LoadPresetKeys(keys);
+    loaded_keys = keys;
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
-    key_slots.at(slot_id).SetKeyX(key);
+    GetKeyState().key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
-    key_slots.at(slot_id).SetKeyY(key);
+    GetKeyState().key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
-    key_slots.at(slot_id).SetNormalKey(key);
+    GetKeyState().key_slots.at(slot_id).SetNormalKey(key);
 }
 
 bool IsNormalKeyAvailable(std::size_t slot_id) {
-    return key_slots.at(slot_id).normal.has_value();
+    return GetKeyState().key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
-    return key_slots.at(slot_id).normal.value_or(AESKey{});
+    return GetKeyState().key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
 void SelectCommonKeyIndex(u8 index) {
-    key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
+    KeyState& state = GetKeyState();
+    state.key_slots[KeySlotID::TicketCommonKey].SetKeyY(state.common_key_y_slots.at(index));
 }
 
 } // namespace AES
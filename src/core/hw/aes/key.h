@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include "common/common_types.h"
 
 namespace HW {
@@ -38,6 +39,29 @@ constexpr std::size_t AES_BLOCK_SIZE = 16;
 
 using AESKey = std::array<u8, AES_BLOCK_SIZE>;
 
+struct KeySlot {
+    std::optional<AESKey> x;
+    std::optional<AESKey> y;
+    std::optional<AESKey> normal;
+
+    void SetKeyX(std::optional<AESKey> key);
+    void SetKeyY(std::optional<AESKey> key);
+    void SetNormalKey(std::optional<AESKey> key);
+    void GenerateNormalKey();
+    void Clear();
+};
+
+/// Key slots of one emulated system, which the titles it runs select and update
+struct KeyState {
+    std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
+    std::array<std::optional<AESKey>, 6> common_key_y_slots;
+    bool initialized = false;
+};
+
+/**
+ * Loads the keys into the slots of the System bound to the calling thread. The key files are only
+ * read by the first System, later ones start from a copy of what it loaded.
+ */
 void InitKeys();
 
 void SetGeneratorConstant(const AESKey& key);
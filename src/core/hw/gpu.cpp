@@ -5,12 +5,14 @@
 #include <cstring>
 #include <numeric>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
@@ -19,6 +21,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
@@ -26,13 +29,20 @@
 
 namespace GPU {
 
-Regs g_regs;
-Memory::MemorySystem* g_memory;
-
 /// 268MHz CPU clocks / 60Hz frames per second
 const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / SCREEN_REFRESH_RATE);
-/// Event id for CoreTiming
-static Core::TimingEventType* vblank_event;
+
+static HW::InstanceState& GetState() {
+    return Core::System::GetInstance().HardwareState();
+}
+
+static Memory::MemorySystem& GetMemory() {
+    return *GetState().memory;
+}
+
+Regs& GetRegs() {
+    return GetState().gpu_regs;
+}
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -45,7 +55,18 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
-    var = g_regs[addr / 4];
+    // The transfer registers only report completion once the queued work has been executed
+    constexpr u32 memory_fill_begin = GPU_REG_INDEX(memory_fill_config);
+    constexpr u32 memory_fill_end = memory_fill_begin + sizeof(Regs::memory_fill_config) / 4;
+    constexpr u32 display_transfer_begin = GPU_REG_INDEX(display_transfer_config);
+    constexpr u32 display_transfer_end =
+        display_transfer_begin + sizeof(Regs::display_transfer_config) / 4;
+    if ((index >= memory_fill_begin && index < memory_fill_end) ||
+        (index >= display_transfer_begin && index < display_transfer_end)) {
+        FinishTransfers();
+    }
+
+    var = GetRegs()[addr / 4];
 }
 
 static Math::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
@@ -79,12 +100,12 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     const PAddr end_addr = config.GetEndAddress();
 
     // TODO: do hwtest with these cases
-    if (!g_memory->IsValidPhysicalAddress(start_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(start_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid start address {:#010X}", start_addr);
         return;
     }
 
-    if (!g_memory->IsValidPhysicalAddress(end_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(end_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid end address {:#010X}", end_addr);
         return;
     }
@@ -95,10 +116,10 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
         return;
     }
 
-    u8* start = g_memory->GetPhysicalPointer(start_addr);
-    u8* end = g_memory->GetPhysicalPointer(end_addr);
+    u8* start = GetMemory().GetPhysicalPointer(start_addr);
+    u8* end = GetMemory().GetPhysicalPointer(end_addr);
 
-    if (VideoCore::g_renderer->Rasterizer()->AccelerateFill(config))
+    if (VideoCore::GetRenderer()->Rasterizer()->AccelerateFill(config))
         return;
 
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
@@ -132,12 +153,12 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     const PAddr dst_addr = config.GetPhysicalOutputAddress();
 
     // TODO: do hwtest with these cases
-    if (!g_memory->IsValidPhysicalAddress(src_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(src_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid input address {:#010X}", src_addr);
         return;
     }
 
-    if (!g_memory->IsValidPhysicalAddress(dst_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(dst_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid output address {:#010X}", dst_addr);
         return;
     }
@@ -162,11 +183,11 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
         return;
     }
 
-    if (VideoCore::g_renderer->Rasterizer()->AccelerateDisplayTransfer(config))
+    if (VideoCore::GetRenderer()->Rasterizer()->AccelerateDisplayTransfer(config))
         return;
 
-    u8* src_pointer = g_memory->GetPhysicalPointer(src_addr);
-    u8* dst_pointer = g_memory->GetPhysicalPointer(dst_addr);
+    u8* src_pointer = GetMemory().GetPhysicalPointer(src_addr);
+    u8* dst_pointer = GetMemory().GetPhysicalPointer(dst_addr);
 
     if (config.scaling > config.ScaleXY) {
         LOG_CRITICAL(HW_GPU, "Unimplemented display transfer scaling mode {}",
@@ -308,21 +329,21 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     const PAddr dst_addr = config.GetPhysicalOutputAddress();
 
     // TODO: do hwtest with invalid addresses
-    if (!g_memory->IsValidPhysicalAddress(src_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(src_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid input address {:#010X}", src_addr);
         return;
     }
 
-    if (!g_memory->IsValidPhysicalAddress(dst_addr)) {
+    if (!GetMemory().IsValidPhysicalAddress(dst_addr)) {
         LOG_CRITICAL(HW_GPU, "invalid output address {:#010X}", dst_addr);
         return;
     }
 
-    if (VideoCore::g_renderer->Rasterizer()->AccelerateTextureCopy(config))
+    if (VideoCore::GetRenderer()->Rasterizer()->AccelerateTextureCopy(config))
         return;
 
-    u8* src_pointer = g_memory->GetPhysicalPointer(src_addr);
-    u8* dst_pointer = g_memory->GetPhysicalPointer(dst_addr);
+    u8* src_pointer = GetMemory().GetPhysicalPointer(src_addr);
+    u8* dst_pointer = GetMemory().GetPhysicalPointer(dst_addr);
 
     u32 remaining_size = Common::AlignDown(config.texture_copy.size, 16);
 
@@ -385,6 +406,54 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     }
 }
 
+/**
+ * Executes GPU work on the GPU thread if it is enabled, or in place otherwise.
+ * @returns The fence of the queued work, or 0 if it has already been executed.
+ */
+template <typename Func>
+static u64 ExecuteGPUCommand(Func&& command) {
+    if (VideoCore::GetGPUThread()) {
+        return VideoCore::GetGPUThread()->PushCommand([command = std::forward<Func>(command)] {
+            Core::PerfStats::SubsystemScope subsystem_scope{
+                Core::System::GetInstance().perf_stats, Core::PerfStats::Subsystem::GPU};
+            command();
+        });
+    }
+
+    Core::PerfStats::SubsystemScope subsystem_scope{Core::System::GetInstance().perf_stats,
+                                                    Core::PerfStats::Subsystem::GPU};
+    command();
+    return 0;
+}
+
+static void FinishMemoryFill(std::size_t index) {
+    // Reset "trigger" flag and set the "finish" flag
+    // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
+    auto& config = GetRegs().memory_fill_config[index];
+    config.trigger.Assign(0);
+    config.finished.Assign(1);
+}
+
+static void FinishDisplayTransfer() {
+    GetRegs().display_transfer_config.trigger = 0;
+}
+
+void FinishTransfers() {
+    HW::InstanceState& state = GetState();
+    for (std::size_t i = 0; i < state.memory_fill_fences.size(); ++i) {
+        if (state.memory_fill_fences[i] != 0) {
+            VideoCore::GetGPUThread()->WaitForFence(state.memory_fill_fences[i]);
+            state.memory_fill_fences[i] = 0;
+            FinishMemoryFill(i);
+        }
+    }
+    if (state.display_transfer_fence != 0) {
+        VideoCore::GetGPUThread()->WaitForFence(state.display_transfer_fence);
+        state.display_transfer_fence = 0;
+        FinishDisplayTransfer();
+    }
+}
+
 template <typename T>
 inline void Write(u32 addr, const T data) {
     addr -= HW::VADDR_GPU;
@@ -396,7 +465,7 @@ inline void Write(u32 addr, const T data) {
         return;
     }
 
-    g_regs[index] = static_cast<u32>(data);
+    GetRegs()[index] = static_cast<u32>(data);
 
     switch (index) {
 
@@ -404,83 +473,106 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX_WORKAROUND(memory_fill_config[0].trigger, 0x00004 + 0x3):
     case GPU_REG_INDEX_WORKAROUND(memory_fill_config[1].trigger, 0x00008 + 0x3): {
         const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
-        auto& config = g_regs.memory_fill_config[is_second_filler];
+        auto& config = GetRegs().memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+            const u64 fence = ExecuteGPUCommand([config = config, is_second_filler] {
+                MemoryFill(config);
+                LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}",
+                          config.GetStartAddress(), config.GetEndAddress());
+
+                // It seems that it won't signal interrupt if "address_start" is zero.
+                // TODO: hwtest this
+                if (config.GetStartAddress() != 0) {
+                    if (!is_second_filler) {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+                    } else {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+                    }
                 }
-            }
+            });
 
-            // Reset "trigger" flag and set the "finish" flag
-            // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
-            config.trigger.Assign(0);
-            config.finished.Assign(1);
+            // A fill still queued on the GPU thread keeps "trigger" set until the CPU waits for it
+            GetState().memory_fill_fences[is_second_filler] = fence;
+            if (fence == 0) {
+                FinishMemoryFill(is_second_filler);
+            }
         }
         break;
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
-        const auto& config = g_regs.display_transfer_config;
+        const auto& config = GetRegs().display_transfer_config;
         if (config.trigger & 1) {
+            const u64 fence = ExecuteGPUCommand([config = config] {
+                MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+                if (Pica::g_debug_context)
+                    Pica::g_debug_context->OnEvent(
+                        Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
+
+                if (config.is_texture_copy) {
+                    TextureCopy(config);
+                    LOG_TRACE(HW_GPU,
+                              "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                              "{:#010X}({}+{}), flags {:#010X}",
+                              config.texture_copy.size, config.GetPhysicalInputAddress(),
+                              config.texture_copy.input_width * 16,
+                              config.texture_copy.input_gap * 16,
+                              config.GetPhysicalOutputAddress(),
+                              config.texture_copy.output_width * 16,
+                              config.texture_copy.output_gap * 16, config.flags);
+                } else {
+                    DisplayTransfer(config);
+                    LOG_TRACE(HW_GPU,
+                              "DisplayTransfer: {:#010X}({}x{})-> "
+                              "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                              config.GetPhysicalInputAddress(), config.input_width.Value(),
+                              config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                              config.output_width.Value(), config.output_height.Value(),
+                              static_cast<u32>(config.output_format.Value()), config.flags);
+                }
 
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
-            } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
-            }
+                Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+            });
 
-            g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+            GetState().display_transfer_fence = fence;
+            if (fence == 0) {
+                FinishDisplayTransfer();
+            }
         }
         break;
     }
 
     // Seems like writing to this register triggers processing
     case GPU_REG_INDEX(command_processor_config.trigger): {
-        const auto& config = g_regs.command_processor_config;
+        const auto& config = GetRegs().command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
-            u32* buffer = (u32*)g_memory->GetPhysicalPointer(config.GetPhysicalAddress());
+            u32* buffer = (u32*)GetMemory().GetPhysicalPointer(config.GetPhysicalAddress());
 
             if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
                 Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, config.size,
                                                                 config.GetPhysicalAddress());
             }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            if (VideoCore::GetGPUThread()) {
+                // The application is free to reuse the buffer once the list has been submitted
+                std::vector<u32> list(buffer, buffer + config.size / sizeof(u32));
+                VideoCore::GetGPUThread()->PushCommand([list = std::move(list)] {
+                    MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                    Core::PerfStats::SubsystemScope subsystem_scope{
+                        Core::System::GetInstance().perf_stats, Core::PerfStats::Subsystem::GPU};
+                    Pica::CommandProcessor::ProcessCommandList(
+                        list.data(), static_cast<u32>(list.size() * sizeof(u32)));
+                });
+            } else {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                Core::PerfStats::SubsystemScope subsystem_scope{
+                    Core::System::GetInstance().perf_stats, Core::PerfStats::Subsystem::GPU};
+                Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            }
 
-            g_regs.command_processor_config.trigger = 0;
+            GetRegs().command_processor_config.trigger = 0;
         }
         break;
     }
@@ -510,9 +602,25 @@ template void Write<u32>(u32 addr, const u32 data);
 template void Write<u16>(u32 addr, const u16 data);
 template void Write<u8>(u32 addr, const u8 data);
 
+/// Presents the current frame, measuring the time spent doing so
+static void SwapBuffers() {
+    Core::PerfStats::SubsystemScope subsystem_scope{Core::System::GetInstance().perf_stats,
+                                                    Core::PerfStats::Subsystem::Rendering};
+    VideoCore::GetRenderer()->SwapBuffers();
+}
+
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    if (VideoCore::GetGPUThread()) {
+        // Let the CPU run at most one frame ahead of presentation, which also applies the frame
+        // limiter of the GPU thread to emulation.
+        HW::InstanceState& state = GetState();
+        VideoCore::GetGPUThread()->WaitForFence(state.swap_fence);
+        VideoCore::GetRenderer()->GetRenderWindow().PollEvents();
+        state.swap_fence = VideoCore::GetGPUThread()->PushCommand(SwapBuffers);
+    } else {
+        SwapBuffers();
+    }
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -523,16 +631,18 @@ static void VBlankCallback(u64 userdata, s64 cycles_late) {
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
 
     // Reschedule recurrent event
-    Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late, vblank_event);
+    Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late,
+                                                           GetState().vblank_event);
 }
 
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory) {
-    g_memory = &memory;
-    memset(&g_regs, 0, sizeof(g_regs));
+    HW::InstanceState& state = GetState();
+    state.memory = &memory;
+    memset(&state.gpu_regs, 0, sizeof(state.gpu_regs));
 
-    auto& framebuffer_top = g_regs.framebuffer_config[0];
-    auto& framebuffer_sub = g_regs.framebuffer_config[1];
+    auto& framebuffer_top = state.gpu_regs.framebuffer_config[0];
+    auto& framebuffer_sub = state.gpu_regs.framebuffer_config[1];
 
     // Setup default framebuffer addresses (located in VRAM)
     // .. or at least these are the ones used by system applets.
@@ -557,9 +667,13 @@ void Init(Memory::MemorySystem& memory) {
     framebuffer_sub.color_format.Assign(Regs::PixelFormat::RGB8);
     framebuffer_sub.active_fb = 0;
 
+    state.swap_fence = 0;
+    state.memory_fill_fences = {};
+    state.display_transfer_fence = 0;
+
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
-    vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
-    timing.ScheduleEvent(frame_ticks, vblank_event);
+    state.vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    timing.ScheduleEvent(frame_ticks, state.vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
 }
@@ -321,7 +321,8 @@ ASSERT_REG_POSITION(command_processor_config, 0x00638);
 // anyway.
 static_assert(sizeof(Regs) == 0x1000 * sizeof(u32), "Invalid total size of register set");
 
-extern Regs g_regs;
+/// Gets the registers of the System bound to the calling thread
+Regs& GetRegs();
 
 template <typename T>
 void Read(T& var, const u32 addr);
@@ -329,6 +330,12 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Waits for the memory fills and display transfers queued on the GPU thread and reports them as
+ * finished in the registers.
+ */
+void FinishTransfers();
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
@@ -4,7 +4,15 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
+#include "core/hw/aes/key.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
+
+namespace Core {
+struct TimingEventType;
+}
 
 namespace Memory {
 class MemorySystem;
@@ -12,6 +20,23 @@ class MemorySystem;
 
 namespace HW {
 
+/// Hardware state of one emulated system, owned by its Core::System
+struct InstanceState {
+    GPU::Regs gpu_regs{};
+    LCD::Regs lcd_regs{};
+    AES::KeyState aes_keys;
+
+    Memory::MemorySystem* memory = nullptr;
+    /// Event id of the GPU VBlank for CoreTiming
+    Core::TimingEventType* vblank_event = nullptr;
+    /// Fence of the last frame presented by the GPU thread
+    u64 swap_fence = 0;
+    /// Fences of the memory fills and the display transfer queued on the GPU thread, which are
+    /// reported as finished in the registers once the CPU has waited for them. 0 if none.
+    std::array<u64, 2> memory_fill_fences{};
+    u64 display_transfer_fence = 0;
+};
+
 /// Beginnings of IO register regions, in the user VA space.
 enum : u32 {
     VADDR_HASH = 0x1EC01000,
@@ -5,6 +5,7 @@
 #include <cstring>
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
 #include "core/tracer/recorder.h"
@@ -12,7 +13,9 @@
 
 namespace LCD {
 
-Regs g_regs;
+Regs& GetRegs() {
+    return Core::System::GetInstance().HardwareState().lcd_regs;
+}
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -25,7 +28,7 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
-    var = g_regs[index];
+    var = GetRegs()[index];
 }
 
 template <typename T>
@@ -39,7 +42,7 @@ inline void Write(u32 addr, const T data) {
         return;
     }
 
-    g_regs[index] = static_cast<u32>(data);
+    GetRegs()[index] = static_cast<u32>(data);
 
     // Notify tracer about the register write
     // This is happening *after* handling the write to make sure we properly catch all memory reads.
@@ -64,7 +67,7 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Initialize hardware
 void Init() {
-    memset(&g_regs, 0, sizeof(g_regs));
+    memset(&GetRegs(), 0, sizeof(GetRegs()));
     LOG_DEBUG(HW_LCD, "initialized OK");
 }
 
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <cstring>
+#include <mutex>
 #include "audio_core/dsp_interface.h"
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -15,6 +16,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -364,6 +366,20 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    const auto& gpu_thread = VideoCore::GetGPUThread();
+    if (gpu_thread && gpu_thread->IsGPUThread()) {
+        // The CPU reads the page tables without locking, so they are only changed on its thread.
+        // Wait for pages to become cached before the surface is loaded from them, otherwise CPU
+        // writes in between would skip invalidating it.
+        gpu_thread->RunOnEmulationThread(
+            [this, start, size, cached] { MarkRegionCached(start, size, cached); }, cached);
+        return;
+    }
+
+    MarkRegionCached(start, size, cached);
+}
+
+void MemorySystem::MarkRegionCached(PAddr start, u32 size, bool cached) {
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -410,35 +426,47 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
 }
 
 void RasterizerFlushRegion(PAddr start, u32 size) {
-    if (VideoCore::g_renderer == nullptr) {
+    if (VideoCore::GetRenderer() == nullptr) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
+    // The CPU is about to read the region, so the flush has to complete before returning
+    VideoCore::RunOnRendererThread(
+        [start, size] { VideoCore::GetRenderer()->Rasterizer()->FlushRegion(start, size); });
 }
 
 void RasterizerInvalidateRegion(PAddr start, u32 size) {
-    if (VideoCore::g_renderer == nullptr) {
+    if (VideoCore::GetRenderer() == nullptr) {
+        return;
+    }
+
+    if (VideoCore::GetGPUThread()) {
+        // Invalidations only need to be ordered with the GPU work queued so far
+        VideoCore::GetGPUThread()->PushCommand([start, size] {
+            VideoCore::GetRenderer()->Rasterizer()->InvalidateRegion(start, size);
+        });
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
+    VideoCore::GetRenderer()->Rasterizer()->InvalidateRegion(start, size);
 }
 
 void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
     // Since pages are unmapped on shutdown after video core is shutdown, the renderer may be
     // null here
-    if (VideoCore::g_renderer == nullptr) {
+    if (VideoCore::GetRenderer() == nullptr) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
+    VideoCore::RunOnRendererThread([start, size] {
+        VideoCore::GetRenderer()->Rasterizer()->FlushAndInvalidateRegion(start, size);
+    });
 }
 
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
     // Since pages are unmapped on shutdown after video core is shutdown, the renderer may be
     // null here
-    if (VideoCore::g_renderer == nullptr) {
+    if (VideoCore::GetRenderer() == nullptr) {
         return;
     }
 
@@ -455,16 +483,15 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         PAddr physical_start = paddr_region_start + (overlap_start - region_start);
         u32 overlap_size = overlap_end - overlap_start;
 
-        auto* rasterizer = VideoCore::g_renderer->Rasterizer();
         switch (mode) {
         case FlushMode::Flush:
-            rasterizer->FlushRegion(physical_start, overlap_size);
+            RasterizerFlushRegion(physical_start, overlap_size);
             break;
         case FlushMode::Invalidate:
-            rasterizer->InvalidateRegion(physical_start, overlap_size);
+            RasterizerInvalidateRegion(physical_start, overlap_size);
             break;
         case FlushMode::FlushAndInvalidate:
-            rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+            RasterizerFlushAndInvalidateRegion(physical_start, overlap_size);
             break;
         }
     };
@@ -277,7 +277,8 @@ public:
     u8* GetFCRAMPointer(u32 offset);
 
     /**
-     * Mark each page touching the region as cached.
+     * Mark each page touching the region as cached. Calls from the GPU thread are run on the
+     * emulation thread, and wait for it when marking the region as cached.
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
@@ -288,6 +289,9 @@ public:
     void UnregisterPageTable(PageTable* page_table);
 
 private:
+    /// Switches the page type of each page touching the region, in every registered page table
+    void MarkRegionCached(PAddr start, u32 size, bool cached);
+
     template <typename T>
     T Read(const VAddr vaddr);
 
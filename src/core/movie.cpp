@@ -2,14 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
 #include <cryptopp/hex.h>
 #include "common/bit_field.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
 #include "common/string_util.h"
@@ -23,7 +26,9 @@
 
 namespace Core {
 
-/*static*/ Movie Movie::s_instance;
+/*static*/ Movie& Movie::GetInstance() {
+    return System::GetInstance().Movie();
+}
 
 enum class PlayMode { None, Recording, Playing };
 
@@ -108,6 +113,19 @@ static_assert(sizeof(ControllerState) == 7, "ControllerState should be 7 bytes")
 #pragma pack(pop)
 
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'T', 'M', 0x1B}};
+constexpr std::array<u8, 4> block_magic_bytes{{'C', 'T', 'M', 'B'}};
+constexpr std::array<u8, 4> index_magic_bytes{{'C', 'T', 'M', 'I'}};
+
+/**
+ * Version 0 movies are a header followed by all input states, written at the end of the
+ * recording. Version 1 movies are written as they are recorded, in hashed blocks that each start
+ * at a frame boundary, followed by an index of the blocks once the recording is finished.
+ */
+constexpr u32 CTM_VERSION = 1;
+
+/// Pad states per block, about one second of input as the pad is updated 234 times per second.
+/// This bounds both the input lost if the emulator crashes and the states replayed by a seek.
+constexpr u64 KEYFRAME_INTERVAL = 234;
 
 #pragma pack(push, 1)
 struct CTMHeader {
@@ -115,10 +133,33 @@ struct CTMHeader {
     u64_le program_id;           /// ID of the ROM being executed. Also called title_id
     std::array<u8, 20> revision; /// Git hash of the revision this movie was created with
     u64_le clock_init_time;      /// The init time of the system clock
+    u32_le version;              /// Layout of the data following the header
+    u64_le frame_count;          /// Number of pad states in the movie, 0 if not finished
+    u64_le index_offset;         /// Offset of the block index, 0 if not finished
 
-    std::array<u8, 216> reserved; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 196> reserved; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CTMHeader) == 256, "CTMHeader should be 256 bytes");
+
+struct CTMBlockHeader {
+    std::array<u8, 4> magic; /// Always "CTMB"
+    u32_le size;             /// Size of the input states following the header
+    u64_le first_frame;      /// Number of pad states in the movie before this block
+    u64_le hash;             /// Hash of the input states following the header
+};
+static_assert(sizeof(CTMBlockHeader) == 24, "CTMBlockHeader should be 24 bytes");
+
+struct CTMIndexHeader {
+    std::array<u8, 4> magic; /// Always "CTMI"
+    u32_le num_entries;      /// Number of CTMIndexEntry following the header, one per block
+};
+static_assert(sizeof(CTMIndexHeader) == 8, "CTMIndexHeader should be 8 bytes");
+
+struct CTMIndexEntry {
+    u64_le first_frame; /// Number of pad states in the movie before the block
+    u64_le offset;      /// Offset of the block in the file
+};
+static_assert(sizeof(CTMIndexEntry) == 16, "CTMIndexEntry should be 16 bytes");
 #pragma pack(pop)
 
 bool Movie::IsPlayingInput() const {
@@ -129,7 +170,7 @@ bool Movie::IsRecordingInput() const {
 }
 
 void Movie::CheckInputEnd() {
-    if (current_byte + sizeof(ControllerState) > recorded_input.size()) {
+    if (current_block >= blocks.size()) {
         LOG_INFO(Movie, "Playback finished");
         play_mode = PlayMode::None;
         init_time = 0;
@@ -137,10 +178,66 @@ void Movie::CheckInputEnd() {
     }
 }
 
+void Movie::ReadState(ControllerState& state) {
+    std::memcpy(&state, block_data + current_byte, sizeof(ControllerState));
+    current_byte += sizeof(ControllerState);
+
+    if (state.type == ControllerStateType::PadAndCircle) {
+        ++current_frame;
+        states_since_frame = 0;
+    } else {
+        ++states_since_frame;
+    }
+
+    if (current_byte + sizeof(ControllerState) > block_size) {
+        OpenBlock(current_block + 1);
+    }
+}
+
+bool Movie::OpenBlock(std::size_t index) {
+    current_block = index;
+    current_byte = 0;
+    block_data = nullptr;
+    block_size = 0;
+    if (index >= blocks.size()) {
+        return false;
+    }
+
+    const u8* file_data = playback_file.Data();
+    const std::size_t file_size = playback_file.Size();
+    const u64 offset = blocks[index].offset;
+    if (playback_version == 0) {
+        block_data = file_data + offset;
+        block_size = file_size - offset;
+    } else {
+        CTMBlockHeader header{};
+        if (offset + sizeof(CTMBlockHeader) <= file_size) {
+            std::memcpy(&header, file_data + offset, sizeof(CTMBlockHeader));
+        }
+        const u8* data = file_data + offset + sizeof(CTMBlockHeader);
+        if (header.magic != block_magic_bytes || header.first_frame != blocks[index].first_frame ||
+            header.size > file_size - offset - sizeof(CTMBlockHeader) ||
+            header.hash != Common::ComputeHash64(data, header.size)) {
+            LOG_ERROR(Movie, "Movie block {} is corrupted, playback will end there", index);
+            blocks.resize(index);
+            return false;
+        }
+        block_data = data;
+        block_size = header.size;
+    }
+
+    // Ignore a partial state at the end of the block
+    block_size -= block_size % sizeof(ControllerState);
+    if (block_size == 0) {
+        blocks.resize(index);
+        return false;
+    }
+    return true;
+}
+
 void Movie::Play(Service::HID::PadState& pad_state, s16& circle_pad_x, s16& circle_pad_y) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::PadAndCircle) {
         LOG_ERROR(Movie,
@@ -168,8 +265,7 @@ void Movie::Play(Service::HID::PadState& pad_state, s16& circle_pad_x, s16& circ
 
 void Movie::Play(Service::HID::TouchDataEntry& touch_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::Touch) {
         LOG_ERROR(Movie,
@@ -185,8 +281,7 @@ void Movie::Play(Service::HID::TouchDataEntry& touch_data) {
 
 void Movie::Play(Service::HID::AccelerometerDataEntry& accelerometer_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::Accelerometer) {
         LOG_ERROR(Movie,
@@ -202,8 +297,7 @@ void Movie::Play(Service::HID::AccelerometerDataEntry& accelerometer_data) {
 
 void Movie::Play(Service::HID::GyroscopeDataEntry& gyroscope_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::Gyroscope) {
         LOG_ERROR(Movie,
@@ -219,8 +313,7 @@ void Movie::Play(Service::HID::GyroscopeDataEntry& gyroscope_data) {
 
 void Movie::Play(Service::IR::PadState& pad_state, s16& c_stick_x, s16& c_stick_y) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::IrRst) {
         LOG_ERROR(Movie,
@@ -237,8 +330,7 @@ void Movie::Play(Service::IR::PadState& pad_state, s16& c_stick_x, s16& c_stick_
 
 void Movie::Play(Service::IR::ExtraHIDResponse& extra_hid_response) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadState(s);
 
     if (s.type != ControllerStateType::ExtraHidResponse) {
         LOG_ERROR(
@@ -259,9 +351,20 @@ void Movie::Play(Service::IR::ExtraHIDResponse& extra_hid_response) {
 }
 
 void Movie::Record(const ControllerState& controller_state) {
-    recorded_input.resize(current_byte + sizeof(ControllerState));
-    std::memcpy(&recorded_input[current_byte], &controller_state, sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    if (controller_state.type == ControllerStateType::PadAndCircle) {
+        // Blocks are cut right before a pad state, so that each one starts at a frame boundary
+        if (current_frame - block_first_frame >= KEYFRAME_INTERVAL) {
+            WriteBlock();
+        }
+        ++current_frame;
+        states_since_frame = 0;
+    } else {
+        ++states_since_frame;
+    }
+
+    const std::size_t size = block_input.size();
+    block_input.resize(size + sizeof(ControllerState));
+    std::memcpy(&block_input[size], &controller_state, sizeof(ControllerState));
 }
 
 void Movie::Record(const Service::HID::PadState& pad_state, const s16& circle_pad_x,
@@ -358,6 +461,12 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
         return ValidationResult::Invalid;
     }
 
+    if (header.version > CTM_VERSION) {
+        LOG_ERROR(Movie, "Playback file has version {}, which is newer than the supported {}",
+                  static_cast<u32>(header.version), CTM_VERSION);
+        return ValidationResult::Invalid;
+    }
+
     std::string revision = fmt::format("{:02x}", fmt::join(header.revision, ""));
 
     if (!program_id)
@@ -376,18 +485,13 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
     return ValidationResult::OK;
 }
 
-void Movie::SaveMovie() {
-    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
-    FileUtil::IOFile save_record(record_movie_file, "wb");
-
-    if (!save_record.IsGood()) {
-        LOG_ERROR(Movie, "Unable to open file to save movie");
-        return;
-    }
-
+void Movie::WriteHeader(u64 frame_count, u64 index_offset) {
     CTMHeader header = {};
     header.filetype = header_magic_bytes;
     header.clock_init_time = init_time;
+    header.version = CTM_VERSION;
+    header.frame_count = frame_count;
+    header.index_offset = index_offset;
 
     Core::System::GetInstance().GetAppLoader().ReadProgramId(header.program_id);
 
@@ -396,39 +500,177 @@ void Movie::SaveMovie() {
                            new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
     std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(CTMHeader::revision));
 
-    save_record.WriteBytes(&header, sizeof(CTMHeader));
-    save_record.WriteBytes(recorded_input.data(), recorded_input.size());
+    record_file.Seek(0, SEEK_SET);
+    record_file.WriteObject(header);
+}
+
+void Movie::WriteBlock() {
+    if (block_input.empty()) {
+        return;
+    }
+
+    CTMBlockHeader header;
+    header.magic = block_magic_bytes;
+    header.size = static_cast<u32>(block_input.size());
+    header.first_frame = block_first_frame;
+    header.hash = Common::ComputeHash64(block_input.data(), block_input.size());
+
+    blocks.push_back({block_first_frame, record_file.Tell()});
+    record_file.WriteObject(header);
+    record_file.WriteBytes(block_input.data(), block_input.size());
+    // Hand the block over to the OS right away, so that it is kept if the emulator crashes
+    record_file.Flush();
+
+    block_input.clear();
+    block_first_frame = current_frame;
+}
+
+void Movie::FinishRecording() {
+    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
+    WriteBlock();
+
+    const u64 index_offset = record_file.Tell();
+    CTMIndexHeader index_header;
+    index_header.magic = index_magic_bytes;
+    index_header.num_entries = static_cast<u32>(blocks.size());
+    record_file.WriteObject(index_header);
+
+    std::vector<CTMIndexEntry> entries(blocks.size());
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        entries[i].first_frame = blocks[i].first_frame;
+        entries[i].offset = blocks[i].offset;
+    }
+    record_file.WriteArray(entries.data(), entries.size());
+
+    // Only point the header at the index once the index is complete
+    record_file.Flush();
+    WriteHeader(current_frame, index_offset);
 
-    if (!save_record.IsGood()) {
+    if (!record_file.IsGood()) {
         LOG_ERROR(Movie, "Error saving movie");
     }
+    record_file.Close();
+}
+
+bool Movie::ReadBlockIndex(u64 index_offset) {
+    const u8* file_data = playback_file.Data();
+    const std::size_t file_size = playback_file.Size();
+    if (index_offset < sizeof(CTMHeader) || index_offset + sizeof(CTMIndexHeader) > file_size) {
+        return false;
+    }
+
+    CTMIndexHeader index_header;
+    std::memcpy(&index_header, file_data + index_offset, sizeof(CTMIndexHeader));
+    const u64 entries_offset = index_offset + sizeof(CTMIndexHeader);
+    if (index_header.magic != index_magic_bytes ||
+        index_header.num_entries > (file_size - entries_offset) / sizeof(CTMIndexEntry)) {
+        return false;
+    }
+
+    std::vector<CTMIndexEntry> entries(index_header.num_entries);
+    std::memcpy(entries.data(), file_data + entries_offset, entries.size() * sizeof(CTMIndexEntry));
+    blocks.clear();
+    for (const CTMIndexEntry& entry : entries) {
+        // Blocks have to be in order for seeking to find them
+        if (entry.offset < sizeof(CTMHeader) || entry.offset >= index_offset ||
+            (!blocks.empty() && (entry.offset <= blocks.back().offset ||
+                                 entry.first_frame < blocks.back().first_frame))) {
+            blocks.clear();
+            return false;
+        }
+        blocks.push_back({entry.first_frame, entry.offset});
+    }
+    return true;
+}
+
+void Movie::RebuildBlockIndex() {
+    const u8* file_data = playback_file.Data();
+    const std::size_t file_size = playback_file.Size();
+
+    blocks.clear();
+    u64 offset = sizeof(CTMHeader);
+    while (offset + sizeof(CTMBlockHeader) <= file_size) {
+        CTMBlockHeader header;
+        std::memcpy(&header, file_data + offset, sizeof(CTMBlockHeader));
+        const u8* data = file_data + offset + sizeof(CTMBlockHeader);
+        if (header.magic != block_magic_bytes ||
+            header.size > file_size - offset - sizeof(CTMBlockHeader) ||
+            header.hash != Common::ComputeHash64(data, header.size)) {
+            // The emulator stopped while this block was being written
+            LOG_WARNING(Movie, "Ignoring incomplete movie data at offset {}", offset);
+            break;
+        }
+        blocks.push_back({header.first_frame, offset});
+        offset += sizeof(CTMBlockHeader) + header.size;
+    }
+}
+
+bool Movie::LoadBlocks(const CTMHeader& header) {
+    blocks.clear();
+    if (playback_version == 0) {
+        blocks.push_back({0, sizeof(CTMHeader)});
+        return true;
+    }
+
+    if (header.index_offset != 0 && ReadBlockIndex(header.index_offset)) {
+        LOG_INFO(Movie, "Movie has {} frames in {} blocks", static_cast<u64>(header.frame_count),
+                 blocks.size());
+        return true;
+    }
+
+    LOG_WARNING(Movie, "Movie has no valid index, it was not closed properly. Rebuilding it");
+    RebuildBlockIndex();
+    return !blocks.empty();
 }
 
 void Movie::StartPlayback(const std::string& movie_file,
                           std::function<void()> completion_callback) {
     LOG_INFO(Movie, "Loading Movie for playback");
-    FileUtil::IOFile save_record(movie_file, "rb");
-    const u64 size = save_record.GetSize();
+    FileUtil::MappedFile file(movie_file);
 
-    if (save_record.IsGood() && size > sizeof(CTMHeader)) {
-        CTMHeader header;
-        save_record.ReadArray(&header, 1);
-        if (ValidateHeader(header) != ValidationResult::Invalid) {
-            play_mode = PlayMode::Playing;
-            recorded_input.resize(size - sizeof(CTMHeader));
-            save_record.ReadArray(recorded_input.data(), recorded_input.size());
-            current_byte = 0;
-            playback_completion_callback = completion_callback;
-        }
-    } else {
+    if (!file.IsOpen() || file.Size() <= sizeof(CTMHeader)) {
         LOG_ERROR(Movie, "Failed to playback movie: Unable to open '{}'", movie_file);
+        return;
+    }
+
+    CTMHeader header;
+    std::memcpy(&header, file.Data(), sizeof(CTMHeader));
+    if (ValidateHeader(header) == ValidationResult::Invalid) {
+        return;
+    }
+
+    playback_file = std::move(file);
+    playback_version = header.version;
+    current_frame = 0;
+    states_since_frame = 0;
+    if (!LoadBlocks(header) || !OpenBlock(0)) {
+        LOG_ERROR(Movie, "Failed to playback movie: '{}' contains no input", movie_file);
+        playback_file.Close();
+        return;
     }
+
+    play_mode = PlayMode::Playing;
+    playback_completion_callback = completion_callback;
 }
 
 void Movie::StartRecording(const std::string& movie_file) {
     LOG_INFO(Movie, "Enabling Movie recording");
+    if (!record_file.Open(movie_file, "wb")) {
+        LOG_ERROR(Movie, "Unable to open file to save movie");
+        return;
+    }
+
+    // The header is written again with the location of the index when the recording ends
+    WriteHeader(0, 0);
+    record_file.Flush();
+
     play_mode = PlayMode::Recording;
     record_movie_file = movie_file;
+    blocks.clear();
+    block_input.clear();
+    block_first_frame = 0;
+    current_frame = 0;
+    states_since_frame = 0;
 }
 
 static boost::optional<CTMHeader> ReadHeader(const std::string& movie_file) {
@@ -482,20 +724,92 @@ u64 Movie::GetMovieProgramID(const std::string& movie_file) const {
 
 void Movie::Shutdown() {
     if (IsRecordingInput()) {
-        SaveMovie();
+        FinishRecording();
     }
 
     play_mode = PlayMode::None;
-    recorded_input.resize(0);
     record_movie_file.clear();
-    current_byte = 0;
+    block_input.clear();
+    blocks.clear();
+    playback_file.Close();
+    OpenBlock(0);
+    block_first_frame = 0;
+    current_frame = 0;
+    states_since_frame = 0;
     init_time = 0;
 }
 
+u64 Movie::GetCurrentFrame() const {
+    return current_frame;
+}
+
+bool Movie::SeekToFrame(u64 frame) {
+    if (!IsPlayingInput()) {
+        return false;
+    }
+
+    // Start from the last block that begins before the pad state of the previous frame, so that
+    // the states following that pad state are counted
+    const auto block = std::upper_bound(
+        blocks.begin(), blocks.end(), frame,
+        [](u64 value, const Block& block) { return value <= block.first_frame; });
+    const std::size_t index =
+        block == blocks.begin() ? 0 : static_cast<std::size_t>(block - blocks.begin() - 1);
+    current_frame = blocks[index].first_frame;
+    states_since_frame = 0;
+    OpenBlock(index);
+
+    ControllerState state;
+    while (current_block < blocks.size()) {
+        const auto next_type = static_cast<ControllerStateType>(block_data[current_byte]);
+        if (current_frame == frame && next_type == ControllerStateType::PadAndCircle) {
+            return true;
+        }
+        ReadState(state);
+    }
+
+    LOG_ERROR(Movie, "Cannot seek to frame {}, the movie only has {} frames", frame,
+              current_frame);
+    CheckInputEnd();
+    return false;
+}
+
+void Movie::DoState(PointerWrap& p) {
+    auto s = p.Section("Movie", 1);
+    if (!s)
+        return;
+
+    u64 frame = current_frame;
+    u32 states = states_since_frame;
+    p.Do(frame);
+    p.Do(states);
+
+    if (p.GetMode() != PointerWrap::MODE_READ || !IsPlayingInput()) {
+        return;
+    }
+
+    // Go back to the pad state of the saved frame, then skip it and the states that followed it
+    u32 skipped_states = states;
+    if (frame == 0) {
+        current_frame = 0;
+        states_since_frame = 0;
+        OpenBlock(0);
+    } else if (SeekToFrame(frame - 1)) {
+        ++skipped_states;
+    } else {
+        return;
+    }
+    ControllerState state;
+    for (u32 i = 0; i < skipped_states && current_block < blocks.size(); ++i) {
+        ReadState(state);
+    }
+    CheckInputEnd();
+}
+
 template <typename... Targs>
 void Movie::Handle(Targs&... Fargs) {
     if (IsPlayingInput()) {
-        ASSERT(current_byte + sizeof(ControllerState) <= recorded_input.size());
+        ASSERT(current_block < blocks.size());
         Play(Fargs...);
         CheckInputEnd();
     } else if (IsRecordingInput()) {
@@ -5,7 +5,13 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/mapped_file.h"
+
+class PointerWrap;
 
 namespace Service {
 namespace HID {
@@ -34,12 +40,10 @@ public:
         Invalid,
     };
     /**
-     * Gets the instance of the Movie singleton class.
-     * @returns Reference to the instance of the Movie singleton class.
+     * Gets the Movie of the System bound to the calling thread.
+     * @returns Reference to the Movie of System::GetInstance().
      */
-    static Movie& GetInstance() {
-        return s_instance;
-    }
+    static Movie& GetInstance();
 
     void StartPlayback(const std::string& movie_file,
                        std::function<void()> completion_callback = [] {});
@@ -59,6 +63,22 @@ public:
 
     void Shutdown();
 
+    /// Returns the number of pad states (one per HID pad update) played back or recorded so far.
+    u64 GetCurrentFrame() const;
+
+    /**
+     * Moves playback to the start of a frame, right before its pad state. The closest keyframe is
+     * looked up in the movie's index, so only the states of about one block are skipped through.
+     * @returns false if no movie is being played back or it ends before that frame.
+     */
+    bool SeekToFrame(u64 frame);
+
+    /**
+     * Saves or restores the movie position. Loading a state during playback moves playback to
+     * where the state was saved, so a movie can be resumed from a checkpoint.
+     */
+    void DoState(PointerWrap& p);
+
     /**
      * When recording: Takes a copy of the given input states so they can be used for playback
      * When playing: Replaces the given input states with the ones stored in the playback file
@@ -99,10 +119,25 @@ public:
     bool IsRecordingInput() const;
 
 private:
-    static Movie s_instance;
+    /// A run of input states starting at a frame boundary, flushed to the movie file as one piece
+    struct Block {
+        u64 first_frame; ///< Number of pad states in the movie before this block
+        u64 offset;      ///< Offset of the block in the movie file
+    };
 
     void CheckInputEnd();
 
+    /// Reads the next input state of the movie being played back
+    void ReadState(ControllerState& state);
+
+    /// Makes `index` the block playback reads from. Returns false past the end of the movie.
+    bool OpenBlock(std::size_t index);
+
+    /// Fills `blocks` from the index of a movie being played back, or from its blocks if needed.
+    bool LoadBlocks(const CTMHeader& header);
+    bool ReadBlockIndex(u64 index_offset);
+    void RebuildBlockIndex();
+
     template <typename... Targs>
     void Handle(Targs&... Fargs);
 
@@ -124,13 +159,28 @@ private:
 
     ValidationResult ValidateHeader(const CTMHeader& header, u64 program_id = 0) const;
 
-    void SaveMovie();
+    void WriteHeader(u64 frame_count, u64 index_offset);
+    /// Appends the states recorded since the last block to the movie file
+    void WriteBlock();
+    /// Writes the keyframe index, which completes the movie file
+    void FinishRecording();
 
-    PlayMode play_mode;
+    PlayMode play_mode{};
     std::string record_movie_file;
-    std::vector<u8> recorded_input;
-    u64 init_time;
+    FileUtil::IOFile record_file;
+    std::vector<u8> block_input; ///< States recorded but not written yet
+    FileUtil::MappedFile playback_file;
+    u32 playback_version = 0;
+    std::vector<Block> blocks; ///< Blocks written so far, or all blocks of the played movie
+    u64 init_time = 0;
     std::function<void()> playback_completion_callback;
-    std::size_t current_byte = 0;
+
+    std::size_t current_block = 0;
+    const u8* block_data = nullptr; ///< States of the block being played back
+    std::size_t block_size = 0;
+    std::size_t current_byte = 0; ///< Position in the block being played back
+    u64 block_first_frame = 0;    ///< First frame of the block being recorded
+    u64 current_frame = 0;
+    u32 states_since_frame = 0; ///< States handled after the pad state of the current frame
 };
 } // namespace Core
\ No newline at end of file
@@ -17,6 +17,54 @@ using std::chrono::microseconds;
 
 namespace Core {
 
+namespace {
+
+/// Subsystem being measured on the current thread
+struct SubsystemTimingState {
+    PerfStats* perf_stats = nullptr;
+    PerfStats::Subsystem subsystem = PerfStats::Subsystem::Other;
+    PerfStats::Clock::time_point since;
+};
+
+thread_local SubsystemTimingState subsystem_timing_state;
+
+} // anonymous namespace
+
+PerfStats::SubsystemScope::SubsystemScope(PerfStats& perf_stats, Subsystem subsystem)
+    : active(perf_stats.benchmarking.load(std::memory_order_relaxed)) {
+    if (!active) {
+        return;
+    }
+
+    auto& state = subsystem_timing_state;
+    const auto now = Clock::now();
+    if (state.perf_stats != nullptr) {
+        state.perf_stats->subsystem_times[static_cast<std::size_t>(state.subsystem)].fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - state.since).count(),
+            std::memory_order_relaxed);
+    }
+    previous_perf_stats = state.perf_stats;
+    previous_subsystem = state.subsystem;
+    state.perf_stats = &perf_stats;
+    state.subsystem = subsystem;
+    state.since = now;
+}
+
+PerfStats::SubsystemScope::~SubsystemScope() {
+    if (!active) {
+        return;
+    }
+
+    auto& state = subsystem_timing_state;
+    const auto now = Clock::now();
+    state.perf_stats->subsystem_times[static_cast<std::size_t>(state.subsystem)].fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - state.since).count(),
+        std::memory_order_relaxed);
+    state.perf_stats = previous_perf_stats;
+    state.subsystem = previous_subsystem;
+    state.since = now;
+}
+
 void PerfStats::BeginSystemFrame() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -31,6 +79,11 @@ void PerfStats::EndSystemFrame() {
     system_frames += 1;
 
     previous_frame_length = frame_end - previous_frame_end;
+    if (benchmarking) {
+        benchmark_system_frames += 1;
+        benchmark_frame_lengths.push_back(frame_end -
+                                          std::max(previous_frame_end, benchmark_begin));
+    }
     previous_frame_end = frame_end;
 }
 
@@ -38,6 +91,9 @@ void PerfStats::EndGameFrame() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
     game_frames += 1;
+    if (benchmarking) {
+        benchmark_game_frames += 1;
+    }
 }
 
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
@@ -55,6 +111,17 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    results.skipped_upload_bytes =
+        static_cast<double>(skipped_upload_bytes.exchange(0)) / static_cast<double>(system_frames);
+    results.surface_flushes =
+        static_cast<double>(surface_flushes.exchange(0)) / static_cast<double>(system_frames);
+    results.stalled_surface_flushes = static_cast<double>(stalled_surface_flushes.exchange(0)) /
+                                      static_cast<double>(system_frames);
+    results.surface_cache_bytes = static_cast<double>(surface_cache_bytes.load());
+    results.uploaded_vertex_bytes = static_cast<double>(uploaded_vertex_bytes.exchange(0)) /
+                                    static_cast<double>(system_frames);
+    results.reused_vertex_bytes =
+        static_cast<double>(reused_vertex_bytes.exchange(0)) / static_cast<double>(system_frames);
 
     // Reset counters
     reset_point = now;
@@ -66,6 +133,60 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     return results;
 }
 
+void PerfStats::AddSkippedUploadBytes(u64 bytes) {
+    skipped_upload_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PerfStats::AddSurfaceFlush(bool stalled) {
+    surface_flushes.fetch_add(1, std::memory_order_relaxed);
+    if (stalled) {
+        stalled_surface_flushes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PerfStats::SetSurfaceCacheBytes(u64 bytes) {
+    surface_cache_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+void PerfStats::AddVertexBytes(u64 uploaded_bytes, u64 reused_bytes) {
+    uploaded_vertex_bytes.fetch_add(uploaded_bytes, std::memory_order_relaxed);
+    reused_vertex_bytes.fetch_add(reused_bytes, std::memory_order_relaxed);
+}
+
+void PerfStats::BeginBenchmark(microseconds current_system_time_us) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    benchmark_begin = Clock::now();
+    benchmark_begin_system_us = current_system_time_us;
+    benchmark_system_frames = 0;
+    benchmark_game_frames = 0;
+    benchmark_frame_lengths.clear();
+    for (auto& time : subsystem_times) {
+        time = 0;
+    }
+    benchmarking = true;
+}
+
+PerfStats::BenchmarkResults PerfStats::GetBenchmarkResults(microseconds current_system_time_us) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    BenchmarkResults results{};
+    results.walltime = duration_cast<DoubleSecs>(Clock::now() - benchmark_begin).count();
+    results.emulated_time =
+        duration_cast<DoubleSecs>(current_system_time_us - benchmark_begin_system_us).count();
+    results.system_frames = benchmark_system_frames;
+    results.game_frames = benchmark_game_frames;
+    results.frame_times.reserve(benchmark_frame_lengths.size());
+    for (const auto& length : benchmark_frame_lengths) {
+        results.frame_times.push_back(duration_cast<DoubleSecs>(length).count());
+    }
+    for (std::size_t i = 0; i < subsystem_times.size(); ++i) {
+        results.subsystem_times[i] =
+            duration_cast<DoubleSecs>(std::chrono::nanoseconds(subsystem_times[i])).count();
+    }
+    return results;
+}
+
 double PerfStats::GetLastFrameTimeScale() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 #include "common/thread.h"
 
@@ -29,6 +31,59 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Texture bytes per system frame the renderer didn't upload as they were unchanged
+        double skipped_upload_bytes;
+        /// Surfaces read back to guest memory per system frame
+        double surface_flushes;
+        /// Part of these flushes which waited for the GPU, as no readback completed ahead of them
+        double stalled_surface_flushes;
+        /// Host memory used by the textures of the renderer's surface cache, in bytes
+        double surface_cache_bytes;
+        /// Vertex data bytes per system frame the renderer uploaded, and drew from its cache
+        double uploaded_vertex_bytes;
+        double reused_vertex_bytes;
+    };
+
+    /// Parts of the emulator whose walltime is measured while benchmarking
+    enum class Subsystem : std::size_t {
+        Other,     ///< Everything else done by System::RunLoop, like scheduling
+        CPU,       ///< Execution of guest code
+        Kernel,    ///< SVCs, including the HLE services
+        GPU,       ///< Command lists, display transfers and memory fills
+        Rendering, ///< Presentation of frames by the renderer
+        Audio,     ///< Audio frames processed by the DSP
+        NumSubsystems,
+    };
+
+    /**
+     * Measures the walltime spent by the current thread in a subsystem until destroyed, if
+     * benchmarking. Nested scopes pause the enclosing ones, so each subsystem is only charged for
+     * its own time.
+     */
+    class SubsystemScope {
+    public:
+        SubsystemScope(PerfStats& perf_stats, Subsystem subsystem);
+        ~SubsystemScope();
+
+    private:
+        bool active;
+        PerfStats* previous_perf_stats;
+        Subsystem previous_subsystem;
+    };
+
+    struct BenchmarkResults {
+        /// Walltime elapsed since the benchmark began, in seconds
+        double walltime;
+        /// Emulated time elapsed since the benchmark began, in seconds
+        double emulated_time;
+        /// Number of system frames (LCD VBlanks)
+        u32 system_frames;
+        /// Number of game frames (GSP frame submissions)
+        u32 game_frames;
+        /// Walltime of each system frame, in seconds, including any waits
+        std::vector<double> frame_times;
+        /// Walltime spent in each subsystem, in seconds, summed over all threads
+        std::array<double, static_cast<std::size_t>(Subsystem::NumSubsystems)> subsystem_times;
     };
 
     void BeginSystemFrame();
@@ -37,6 +92,24 @@ public:
 
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
+    /// Counts texture bytes the renderer didn't have to upload again.
+    void AddSkippedUploadBytes(u64 bytes);
+
+    /// Counts a surface the renderer read back to guest memory, and whether it waited for the GPU.
+    void AddSurfaceFlush(bool stalled);
+
+    /// Sets the memory used by the textures of the renderer's surface cache.
+    void SetSurfaceCacheBytes(u64 bytes);
+
+    /// Counts vertex data the renderer uploaded, and the vertex data it reused from its cache.
+    void AddVertexBytes(u64 uploaded_bytes, u64 reused_bytes);
+
+    /// Starts recording the length of each system frame and the time spent in each subsystem.
+    void BeginBenchmark(std::chrono::microseconds current_system_time_us);
+
+    /// Returns the measurements since BeginBenchmark was called.
+    BenchmarkResults GetBenchmarkResults(std::chrono::microseconds current_system_time_us);
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -57,6 +130,16 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative number of texture bytes not uploaded since last reset
+    std::atomic<u64> skipped_upload_bytes{0};
+    /// Cumulative number of surface flushes, and of the ones which stalled, since last reset
+    std::atomic<u64> surface_flushes{0};
+    std::atomic<u64> stalled_surface_flushes{0};
+    /// Memory used by the surface cache as of the last presented frame
+    std::atomic<u64> surface_cache_bytes{0};
+    /// Cumulative number of vertex bytes uploaded and reused since last reset
+    std::atomic<u64> uploaded_vertex_bytes{0};
+    std::atomic<u64> reused_vertex_bytes{0};
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -64,6 +147,21 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+
+    /// Whether a benchmark is running
+    std::atomic<bool> benchmarking{false};
+    /// Point when the benchmark began
+    Clock::time_point benchmark_begin;
+    /// System time when the benchmark began
+    std::chrono::microseconds benchmark_begin_system_us{0};
+    /// Number of system and game frames since the benchmark began
+    u32 benchmark_system_frames = 0;
+    u32 benchmark_game_frames = 0;
+    /// Visible duration of each system frame since the benchmark began
+    std::vector<Clock::duration> benchmark_frame_lengths;
+    /// Time spent in each subsystem since the benchmark began, in nanoseconds
+    std::array<std::atomic<s64>, static_cast<std::size_t>(Subsystem::NumSubsystems)>
+        subsystem_times{};
 };
 
 class FrameLimiter {
@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <array>
 #include <functional>
+#include <vector>
 #include "common/common_types.h"
 
 namespace RPC {
@@ -14,6 +14,18 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    // Version 2
+    ReadMemoryGather,   ///< Reads several (address, size) ranges in one request
+    WriteMemoryScatter, ///< Writes several (address, size, data) ranges in one request
+    SetWatchList,       ///< Sets the (address, size) ranges published after each frame
+    WatchListUpdate,    ///< Published after a frame with the watched ranges that changed
+};
+
+/// Reply of version 2 to the requests that don't return data. Version 1 replies are empty.
+enum class ReplyStatus : u32 {
+    Success = 0,
+    InvalidRequest,     ///< The request is malformed or exceeds the size limits
+    AddressNotWritable, ///< A range to write isn't within the regions scripts may write to
 };
 
 struct PacketHeader {
@@ -23,15 +35,23 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+constexpr u32 CURRENT_VERSION = 2;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
+// Version 1 limits, still enforced for requests made with that version
 constexpr u32 MAX_PACKET_DATA_SIZE = 32;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
+// Version 2 limits, allowing block transfers and batched requests
+constexpr u32 MAX_PACKET_DATA_SIZE_V2 = 0x100000;
+constexpr u32 MAX_PACKET_SIZE_V2 = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE_V2;
+constexpr u32 MAX_READ_SIZE_V2 = MAX_PACKET_DATA_SIZE_V2;
+/// Maximum number of ranges in a gather, scatter or watch list request
+constexpr u32 MAX_REQUEST_RANGES = 0x1000;
 
 class Packet {
 public:
-    Packet(const PacketHeader& header, u8* data, std::function<void(Packet&)> send_reply_callback);
+    Packet(const PacketHeader& header, const u8* data,
+           std::function<void(Packet&)> send_reply_callback);
 
     u32 GetVersion() const {
         return header.version;
@@ -53,12 +73,18 @@ public:
         return header;
     }
 
-    std::array<u8, MAX_PACKET_DATA_SIZE>& GetPacketData() {
+    std::vector<u8>& GetPacketData() {
+        return packet_data;
+    }
+
+    const std::vector<u8>& GetPacketData() const {
         return packet_data;
     }
 
+    /// Sets the size of the reply data, resizing the data buffer to match.
     void SetPacketDataSize(u32 size) {
         header.packet_size = size;
+        packet_data.resize(size);
     }
 
     void SendReply() {
@@ -70,7 +96,7 @@ private:
     void HandleWriteMemory(u32 address, const u8* data, u32 data_size);
 
     struct PacketHeader header;
-    std::array<u8, MAX_PACKET_DATA_SIZE> packet_data;
+    std::vector<u8> packet_data;
 
     std::function<void(Packet&)> send_reply_callback;
 };
@@ -1,3 +1,4 @@
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -24,72 +25,261 @@ RPCServer::~RPCServer() {
     LOG_INFO(RPC_Server, "RPC stopped.");
 }
 
-void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
-    if (data_size > MAX_READ_SIZE) {
-        return;
+/// Returns whether scripts are allowed to write to all of [address, address + size)
+static bool IsWritableRange(u32 address, u32 size) {
+    const auto is_within = [address, size](u32 region_start, u32 region_end) {
+        return address >= region_start && address < region_end && size <= region_end - address;
+    };
+    return is_within(Memory::PROCESS_IMAGE_VADDR, Memory::PROCESS_IMAGE_VADDR_END) ||
+           is_within(Memory::HEAP_VADDR, Memory::HEAP_VADDR_END) ||
+           is_within(Memory::N3DS_EXTRA_RAM_VADDR, Memory::N3DS_EXTRA_RAM_VADDR_END);
+}
+
+/// Replies to a request that doesn't return data
+static void SendStatusReply(Packet& packet, ReplyStatus status) {
+    if (packet.GetVersion() < 2) {
+        packet.SetPacketDataSize(0);
+    } else {
+        packet.SetPacketDataSize(sizeof(status));
+        std::memcpy(packet.GetPacketData().data(), &status, sizeof(status));
+    }
+    packet.SendReply();
+}
+
+bool RPCServer::ParseMemoryRanges(const std::vector<u8>& data, std::vector<MemoryRange>& ranges,
+                                  u32 max_total_size) {
+    u32 count = 0;
+    if (data.size() < sizeof(count)) {
+        return false;
+    }
+    std::memcpy(&count, data.data(), sizeof(count));
+    if (count > MAX_REQUEST_RANGES || data.size() != sizeof(count) + count * sizeof(u32) * 2) {
+        return false;
+    }
+
+    u64 total_size = 0;
+    ranges.resize(count);
+    for (u32 i = 0; i < count; ++i) {
+        const u8* entry = data.data() + sizeof(count) + i * sizeof(u32) * 2;
+        std::memcpy(&ranges[i].address, entry, sizeof(u32));
+        std::memcpy(&ranges[i].size, entry + sizeof(u32), sizeof(u32));
+        total_size += ranges[i].size;
+        if (ranges[i].size == 0 || total_size > max_total_size) {
+            return false;
+        }
     }
+    return true;
+}
 
+void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
     // Note: Memory read occurs asynchronously from the state of the emulator
+    packet.SetPacketDataSize(data_size);
     Core::System::GetInstance().Memory().ReadBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), address,
         packet.GetPacketData().data(), data_size);
-    packet.SetPacketDataSize(data_size);
     packet.SendReply();
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size) {
     // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
-        // Note: Memory write occurs asynchronously from the state of the emulator
-        Core::System::GetInstance().Memory().WriteBlock(
-            *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
-        // If the memory happens to be executable code, make sure the changes become visible
-        Core::CPU().InvalidateCacheRange(address, data_size);
+    if (!IsWritableRange(address, data_size)) {
+        SendStatusReply(packet, ReplyStatus::AddressNotWritable);
+        return;
+    }
+    // Note: Memory write occurs asynchronously from the state of the emulator
+    Core::System::GetInstance().Memory().WriteBlock(
+        *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
+    // If the memory happens to be executable code, make sure the changes become visible
+    Core::CPU().InvalidateCacheRange(address, data_size);
+    SendStatusReply(packet, ReplyStatus::Success);
+}
+
+void RPCServer::HandleReadMemoryGather(Packet& packet, const std::vector<MemoryRange>& ranges) {
+    u32 total_size = 0;
+    for (const auto& range : ranges) {
+        total_size += range.size;
+    }
+
+    // The reply holds the contents of all the ranges, back to back
+    // Note: Memory read occurs asynchronously from the state of the emulator
+    packet.SetPacketDataSize(total_size);
+    auto& system = Core::System::GetInstance();
+    u8* reply_data = packet.GetPacketData().data();
+    for (const auto& range : ranges) {
+        system.Memory().ReadBlock(*system.Kernel().GetCurrentProcess(), range.address, reply_data,
+                                  range.size);
+        reply_data += range.size;
     }
-    packet.SetPacketDataSize(0);
     packet.SendReply();
 }
 
-bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
-    if (packet_header.version <= CURRENT_VERSION) {
-        switch (packet_header.packet_type) {
-        case PacketType::ReadMemory:
-        case PacketType::WriteMemory:
-            if (packet_header.packet_size >= (sizeof(u32) * 2)) {
-                return true;
-            }
-            break;
-        default:
-            break;
+bool RPCServer::HandleWriteMemoryScatter(Packet& packet) {
+    // The request holds a u32 count followed by (address, size, data) entries. Validate all of
+    // them before writing anything.
+    const std::vector<u8>& data = packet.GetPacketData();
+    u32 count = 0;
+    std::memcpy(&count, data.data(), sizeof(count));
+    if (count > MAX_REQUEST_RANGES) {
+        return false;
+    }
+
+    std::vector<MemoryRange> ranges(count);
+    std::vector<const u8*> contents(count);
+    std::size_t offset = sizeof(count);
+    for (u32 i = 0; i < count; ++i) {
+        if (data.size() - offset < sizeof(u32) * 2) {
+            return false;
+        }
+        std::memcpy(&ranges[i].address, data.data() + offset, sizeof(u32));
+        std::memcpy(&ranges[i].size, data.data() + offset + sizeof(u32), sizeof(u32));
+        offset += sizeof(u32) * 2;
+        if (data.size() - offset < ranges[i].size) {
+            return false;
+        }
+        contents[i] = data.data() + offset;
+        offset += ranges[i].size;
+    }
+    if (offset != data.size()) {
+        return false;
+    }
+    for (const auto& range : ranges) {
+        if (range.size != 0 && !IsWritableRange(range.address, range.size)) {
+            SendStatusReply(packet, ReplyStatus::AddressNotWritable);
+            return true;
+        }
+    }
+
+    auto& system = Core::System::GetInstance();
+    for (u32 i = 0; i < count; ++i) {
+        if (ranges[i].size == 0) {
+            continue;
         }
+        // Note: Memory write occurs asynchronously from the state of the emulator
+        system.Memory().WriteBlock(*system.Kernel().GetCurrentProcess(), ranges[i].address,
+                                   contents[i], ranges[i].size);
+        Core::CPU().InvalidateCacheRange(ranges[i].address, ranges[i].size);
+    }
+    SendStatusReply(packet, ReplyStatus::Success);
+    return true;
+}
+
+void RPCServer::HandleSetWatchList(Packet& packet, const std::vector<MemoryRange>& ranges) {
+    {
+        std::lock_guard<std::mutex> lock(watch_list_mutex);
+        watch_list.clear();
+        for (const auto& range : ranges) {
+            watch_list.push_back({range, {}});
+        }
+    }
+    SendStatusReply(packet, ReplyStatus::Success);
+}
+
+void RPCServer::EndGameFrame() {
+    std::lock_guard<std::mutex> lock(watch_list_mutex);
+    ++frame_number;
+    if (watch_list.empty()) {
+        return;
+    }
+
+    // The update holds a u32 count followed by (address, size, data) entries for the ranges which
+    // changed, all of them on the first frame after the watch list was set
+    auto& system = Core::System::GetInstance();
+    std::vector<u8> update(sizeof(u32));
+    std::vector<u8> contents;
+    u32 num_changed = 0;
+    for (auto& watched : watch_list) {
+        contents.resize(watched.range.size);
+        system.Memory().ReadBlock(*system.Kernel().GetCurrentProcess(), watched.range.address,
+                                  contents.data(), watched.range.size);
+        if (contents == watched.data) {
+            continue;
+        }
+        watched.data.swap(contents);
+
+        const std::size_t offset = update.size();
+        update.resize(offset + sizeof(u32) * 2 + watched.range.size);
+        std::memcpy(update.data() + offset, &watched.range.address, sizeof(u32));
+        std::memcpy(update.data() + offset + sizeof(u32), &watched.range.size, sizeof(u32));
+        std::memcpy(update.data() + offset + sizeof(u32) * 2, watched.data.data(),
+                    watched.range.size);
+        ++num_changed;
+    }
+    if (num_changed == 0) {
+        return;
+    }
+    std::memcpy(update.data(), &num_changed, sizeof(num_changed));
+
+    const PacketHeader header{CURRENT_VERSION, frame_number, PacketType::WatchListUpdate,
+                              static_cast<u32>(update.size())};
+    Packet packet(header, update.data(), [](Packet&) {});
+    server.Publish(packet);
+}
+
+bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
+    if (packet_header.version > CURRENT_VERSION) {
+        return false;
+    }
+    if (packet_header.version < 2 && packet_header.packet_size > MAX_PACKET_DATA_SIZE) {
+        return false;
+    }
+
+    switch (packet_header.packet_type) {
+    case PacketType::ReadMemory:
+    case PacketType::WriteMemory:
+        return packet_header.packet_size >= (sizeof(u32) * 2);
+    case PacketType::ReadMemoryGather:
+    case PacketType::WriteMemoryScatter:
+    case PacketType::SetWatchList:
+        return packet_header.version >= 2 && packet_header.packet_size >= sizeof(u32);
+    default:
+        return false;
     }
-    return false;
 }
 
 void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
-        u32 address = 0;
-        u32 data_size = 0;
-        std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
-        std::memcpy(&data_size, request_packet->GetPacketData().data() + sizeof(address),
-                    sizeof(data_size));
+        const bool is_v1 = request_packet->GetVersion() < 2;
+        const u32 max_data_size = is_v1 ? MAX_PACKET_DATA_SIZE : MAX_PACKET_DATA_SIZE_V2;
+        const u32 max_read_size = is_v1 ? MAX_READ_SIZE : MAX_READ_SIZE_V2;
+        std::vector<MemoryRange> ranges;
 
         switch (request_packet->GetPacketType()) {
         case PacketType::ReadMemory:
-            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
-                HandleReadMemory(*request_packet, address, data_size);
+        case PacketType::WriteMemory: {
+            // These request types use the address/data_size wire format
+            u32 address = 0;
+            u32 data_size = 0;
+            std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
+            std::memcpy(&data_size, request_packet->GetPacketData().data() + sizeof(address),
+                        sizeof(data_size));
+
+            if (request_packet->GetPacketType() == PacketType::ReadMemory) {
+                if (data_size > 0 && data_size <= max_read_size) {
+                    HandleReadMemory(*request_packet, address, data_size);
+                    success = true;
+                }
+            } else if (data_size > 0 && data_size <= max_data_size - (sizeof(u32) * 2) &&
+                       data_size <= request_packet->GetPacketDataSize() - (sizeof(u32) * 2)) {
+                const u8* data = request_packet->GetPacketData().data() + (sizeof(u32) * 2);
+                HandleWriteMemory(*request_packet, address, data, data_size);
                 success = true;
             }
             break;
-        case PacketType::WriteMemory:
-            if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
-                const u8* data = request_packet->GetPacketData().data() + (sizeof(u32) * 2);
-                HandleWriteMemory(*request_packet, address, data, data_size);
+        }
+        case PacketType::ReadMemoryGather:
+            if (ParseMemoryRanges(request_packet->GetPacketData(), ranges, max_read_size)) {
+                HandleReadMemoryGather(*request_packet, ranges);
+                success = true;
+            }
+            break;
+        case PacketType::WriteMemoryScatter:
+            success = HandleWriteMemoryScatter(*request_packet);
+            break;
+        case PacketType::SetWatchList:
+            if (ParseMemoryRanges(request_packet->GetPacketData(), ranges, max_read_size)) {
+                HandleSetWatchList(*request_packet, ranges);
                 success = true;
             }
             break;
@@ -99,9 +289,18 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     }
 
     if (!success) {
-        // Send an empty reply, so as not to hang the client
-        request_packet->SetPacketDataSize(0);
-        request_packet->SendReply();
+        // Reply anyway, so as not to hang the client
+        switch (request_packet->GetPacketType()) {
+        case PacketType::WriteMemory:
+        case PacketType::WriteMemoryScatter:
+        case PacketType::SetWatchList:
+            SendStatusReply(*request_packet, ReplyStatus::InvalidRequest);
+            break;
+        default:
+            request_packet->SetPacketDataSize(0);
+            request_packet->SendReply();
+            break;
+        }
     }
 }
 
@@ -8,6 +8,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include "common/threadsafe_queue.h"
 #include "core/rpc/server.h"
 
@@ -20,11 +21,37 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /**
+     * Publishes the watched memory ranges which changed since the previous frame. Called by the
+     * emulation thread at the end of each game frame, so the published data is consistent.
+     */
+    void EndGameFrame();
+
 private:
+    struct MemoryRange {
+        u32 address;
+        u32 size;
+    };
+
+    struct WatchedRange {
+        MemoryRange range;
+        std::vector<u8> data; ///< Contents at the last publication, empty before the first one
+    };
+
     void Start();
     void Stop();
+    /**
+     * Parses a list of memory ranges, stored as a u32 count followed by (address, size) u32 pairs.
+     * Fails if the list is malformed, contains empty ranges, or if the sizes add up to more than
+     * max_total_size.
+     */
+    static bool ParseMemoryRanges(const std::vector<u8>& data, std::vector<MemoryRange>& ranges,
+                                  u32 max_total_size);
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadMemoryGather(Packet& packet, const std::vector<MemoryRange>& ranges);
+    bool HandleWriteMemoryScatter(Packet& packet);
+    void HandleSetWatchList(Packet& packet, const std::vector<MemoryRange>& ranges);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
@@ -32,6 +59,10 @@ private:
     Server server;
     Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+
+    std::mutex watch_list_mutex;
+    std::vector<WatchedRange> watch_list;
+    u32 frame_number = 0;
 };
 
 } // namespace RPC
@@ -21,6 +21,11 @@ void Server::Start() {
 }
 
 void Server::Stop() {
+    if (!zmq_server) {
+        // The ZeroMQ worker sends the end packet when it stops, do it in its place
+        NewRequestCallback(nullptr);
+        return;
+    }
     zmq_server.reset();
 }
 
@@ -35,4 +40,10 @@ void Server::NewRequestCallback(std::unique_ptr<RPC::Packet> new_request) {
     rpc_server.QueueRequest(std::move(new_request));
 }
 
+void Server::Publish(Packet& packet) {
+    if (zmq_server) {
+        zmq_server->Publish(packet);
+    }
+}
+
 }; // namespace RPC
@@ -18,6 +18,8 @@ public:
     void Start();
     void Stop();
     void NewRequestCallback(std::unique_ptr<RPC::Packet> new_request);
+    /// Sends the packet to all the subscribers of the publisher socket.
+    void Publish(Packet& packet);
 
 private:
     RPCServer& rpc_server;
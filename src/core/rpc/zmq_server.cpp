@@ -1,3 +1,4 @@
+#include <vector>
 #include "common/common_types.h"
 #include "core/core.h"
 #include "core/rpc/packet.h"
@@ -5,15 +6,30 @@
 
 namespace RPC {
 
+static std::vector<u8> SerializePacket(Packet& packet) {
+    std::vector<u8> buffer(MIN_PACKET_SIZE + packet.GetPacketDataSize());
+    const auto header = packet.GetHeader();
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + MIN_PACKET_SIZE, packet.GetPacketData().data(),
+                packet.GetPacketDataSize());
+    return buffer;
+}
+
 ZMQServer::ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback)
     : zmq_context(std::move(std::make_unique<zmq::context_t>(1))),
       zmq_socket(std::move(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_REP))),
+      zmq_publisher(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_PUB)),
       new_request_callback(std::move(new_request_callback)) {
     // Use a random high port
     // TODO: Make configurable or increment port number on failure
     zmq_socket->bind("tcp://127.0.0.1:45987");
     LOG_INFO(RPC_Server, "ZeroMQ listening on port 45987");
 
+    // Don't keep undelivered updates around when shutting down
+    zmq_publisher->setsockopt(ZMQ_LINGER, 0);
+    zmq_publisher->bind("tcp://127.0.0.1:45988");
+    LOG_INFO(RPC_Server, "ZeroMQ publishing on port 45988");
+
     worker_thread = std::thread(&ZMQServer::WorkerLoop, this);
 }
 
@@ -21,6 +37,10 @@ ZMQServer::~ZMQServer() {
     // Triggering the zmq_context destructor will cancel
     // any blocking calls to zmq_socket->recv()
     running = false;
+    {
+        std::lock_guard<std::mutex> lock(publisher_mutex);
+        zmq_publisher.reset();
+    }
     zmq_context.reset();
     worker_thread.join();
 
@@ -32,7 +52,7 @@ void ZMQServer::WorkerLoop() {
     while (running) {
         try {
             if (zmq_socket->recv(&request, 0)) {
-                if (request.size() >= MIN_PACKET_SIZE && request.size() <= MAX_PACKET_SIZE) {
+                if (request.size() >= MIN_PACKET_SIZE && request.size() <= MAX_PACKET_SIZE_V2) {
                     u8* request_buffer = static_cast<u8*>(request.data());
                     PacketHeader header;
                     std::memcpy(&header, request_buffer, sizeof(header));
@@ -60,15 +80,8 @@ void ZMQServer::WorkerLoop() {
 
 void ZMQServer::SendReply(Packet& reply_packet) {
     if (running) {
-        auto reply_buffer =
-            std::make_unique<u8[]>(MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
-        auto reply_header = reply_packet.GetHeader();
-
-        std::memcpy(reply_buffer.get(), &reply_header, sizeof(reply_header));
-        std::memcpy(reply_buffer.get() + (4 * sizeof(u32)), reply_packet.GetPacketData().data(),
-                    reply_packet.GetPacketDataSize());
-
-        zmq_socket->send(reply_buffer.get(), MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
+        const auto reply_buffer = SerializePacket(reply_packet);
+        zmq_socket->send(reply_buffer.data(), reply_buffer.size());
 
         LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
                  reply_packet.GetVersion(), reply_packet.GetId(),
@@ -76,4 +89,13 @@ void ZMQServer::SendReply(Packet& reply_packet) {
     }
 }
 
+void ZMQServer::Publish(Packet& packet) {
+    std::lock_guard<std::mutex> lock(publisher_mutex);
+    if (zmq_publisher) {
+        const auto buffer = SerializePacket(packet);
+        // Updates are dropped rather than queued when a subscriber can't keep up
+        zmq_publisher->send(buffer.data(), buffer.size(), ZMQ_DONTWAIT);
+    }
+}
+
 }; // namespace RPC
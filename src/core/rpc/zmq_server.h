@@ -5,6 +5,7 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 #include <thread>
 #define ZMQ_STATIC
 #include <zmq.hpp>
@@ -18,6 +19,9 @@ public:
     explicit ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback);
     ~ZMQServer();
 
+    /// Sends the packet to all subscribers. May be called from any thread.
+    void Publish(Packet& packet);
+
 private:
     void WorkerLoop();
     void SendReply(Packet& request);
@@ -27,6 +31,9 @@ private:
 
     std::unique_ptr<zmq::context_t> zmq_context;
     std::unique_ptr<zmq::socket_t> zmq_socket;
+    /// Socket pushing watch list updates to subscribers
+    std::unique_ptr<zmq::socket_t> zmq_publisher;
+    std::mutex publisher_mutex;
 
     std::function<void(std::unique_ptr<Packet>)> new_request_callback;
 };
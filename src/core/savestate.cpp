@@ -0,0 +1,585 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include "audio_core/dsp_interface.h"
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/movie.h"
+#include "core/savestate.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace Core {
+
+constexpr std::array<u8, 4> header_magic_bytes{{'C', 'S', 'T', 0x1B}};
+
+/// Bump this whenever the layout of any DoState function changes.
+constexpr u32 SAVESTATE_VERSION = 3;
+
+#pragma pack(push, 1)
+struct SnapshotHeader {
+    std::array<u8, 4> filetype; /// Unique Identifier to check the file type (always "CST"0x1B)
+    u32_le version;             /// Version of the snapshot layout
+    u64_le program_id;          /// ID of the ROM being executed
+    u64_le snapshot_id;         /// Random ID of this snapshot
+    u64_le parent_id;           /// For delta snapshots, the snapshot this one applies on top of
+    u64_le payload_size;        /// Size of the data following the header
+    u64_le payload_hash;        /// Hash of the data following the header
+    u8 mode;                    /// SnapshotMode of this snapshot
+
+    std::array<u8, 15> reserved; /// Make heading 64 bytes so it has consistent size
+};
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader should be 64 bytes");
+#pragma pack(pop)
+
+/// Raw register contents of an ARM_Interface::ThreadContext
+struct ThreadContextData {
+    std::array<u32, 16> cpu_registers;
+    std::array<u32, 64> fpu_registers;
+    u32 cpsr;
+    u32 fpscr;
+    u32 fpexc;
+};
+
+static ThreadContextData SaveContextData(const ARM_Interface::ThreadContext& context) {
+    ThreadContextData data{};
+    for (std::size_t i = 0; i < data.cpu_registers.size(); ++i) {
+        data.cpu_registers[i] = context.GetCpuRegister(i);
+    }
+    for (std::size_t i = 0; i < data.fpu_registers.size(); ++i) {
+        data.fpu_registers[i] = context.GetFpuRegister(i);
+    }
+    data.cpsr = context.GetCpsr();
+    data.fpscr = context.GetFpscr();
+    data.fpexc = context.GetFpexc();
+    return data;
+}
+
+static void LoadContextData(ARM_Interface::ThreadContext& context, const ThreadContextData& data) {
+    for (std::size_t i = 0; i < data.cpu_registers.size(); ++i) {
+        context.SetCpuRegister(i, data.cpu_registers[i]);
+    }
+    for (std::size_t i = 0; i < data.fpu_registers.size(); ++i) {
+        context.SetFpuRegister(i, data.fpu_registers[i]);
+    }
+    context.SetCpsr(data.cpsr);
+    context.SetFpscr(data.fpscr);
+    context.SetFpexc(data.fpexc);
+}
+
+/// Per-thread scheduling state, used both for restoring and for validating the thread set
+struct SaveStateManager::ThreadData {
+    u32 thread_id;
+    u32 status;
+    u32 nominal_priority;
+    u32 current_priority;
+    u64 last_running_ticks;
+    VAddr wait_address;
+    ThreadContextData context;
+};
+
+static const std::array<u8, Memory::PAGE_SIZE> zero_page{};
+
+static u64 HashPage(const u8* page) {
+    return Common::ComputeHash64(page, Memory::PAGE_SIZE);
+}
+
+static bool IsZeroPage(const u8* page, u64 hash) {
+    static const u64 zero_page_hash = HashPage(zero_page.data());
+    return hash == zero_page_hash && std::memcmp(page, zero_page.data(), Memory::PAGE_SIZE) == 0;
+}
+
+/// Returns the program ID of the running title, 0 when running without one
+static u64 GetProgramId(const System& system) {
+    u64 program_id = 0;
+    if (system.HasAppLoader()) {
+        system.GetAppLoader().ReadProgramId(program_id);
+    }
+    return program_id;
+}
+
+static u64 GenerateSnapshotId() {
+    std::random_device device;
+    return (static_cast<u64>(device()) << 32) | device();
+}
+
+struct SaveStateManager::MemoryRegion {
+    const char* name;
+    u8* pointer;
+    u32 num_pages;
+
+    /// Page hashes of the memory as of the current snapshot
+    std::vector<u64> page_hashes;
+    /// Page hashes of the snapshot being saved or loaded, committed once it succeeds
+    std::vector<u64> pending_hashes;
+    /// Pages to be stored in the snapshot being saved
+    std::vector<u32> pending_pages;
+};
+
+SaveStateManager::SaveStateManager(System& system) : system(system) {
+    Memory::MemorySystem& memory = system.Memory();
+    const auto add_region = [this](const char* name, u8* pointer, u32 size) {
+        regions.push_back(MemoryRegion{name, pointer, size / Memory::PAGE_SIZE, {}, {}, {}});
+    };
+    add_region("FCRAM", memory.GetFCRAMPointer(0), Memory::FCRAM_N3DS_SIZE);
+    add_region("VRAM", memory.GetPhysicalPointer(Memory::VRAM_PADDR), Memory::VRAM_SIZE);
+    add_region("N3DSRAM", memory.GetPhysicalPointer(Memory::N3DS_EXTRA_RAM_PADDR),
+               Memory::N3DS_EXTRA_RAM_SIZE);
+    add_region("DSPRAM", system.DSP().GetDspMemory().data(), Memory::DSP_RAM_SIZE);
+}
+
+SaveStateManager::~SaveStateManager() = default;
+
+void SaveStateManager::CollectDirtyPages(SnapshotMode mode) {
+    for (MemoryRegion& region : regions) {
+        region.pending_pages.clear();
+        region.pending_hashes.resize(region.num_pages);
+
+        for (u32 page = 0; page < region.num_pages; ++page) {
+            const u8* pointer = region.pointer + page * Memory::PAGE_SIZE;
+            const u64 hash = HashPage(pointer);
+            region.pending_hashes[page] = hash;
+
+            const bool store = mode == SnapshotMode::Delta ? hash != region.page_hashes[page]
+                                                           : !IsZeroPage(pointer, hash);
+            if (store) {
+                region.pending_pages.push_back(page);
+            }
+        }
+    }
+}
+
+void SaveStateManager::DoKernel(PointerWrap& p) {
+    auto s = p.Section("KernelThreads", 1);
+    if (!s)
+        return;
+
+    Kernel::ThreadManager& thread_manager = system.Kernel().GetThreadManager();
+    const auto& thread_list = thread_manager.GetThreadList();
+    const Kernel::Thread* current_thread = thread_manager.GetCurrentThread();
+
+    u32 current_thread_id = current_thread ? current_thread->thread_id : 0;
+    u32 num_threads = static_cast<u32>(thread_list.size());
+    p.Do(current_thread_id);
+    p.Do(num_threads);
+
+    std::vector<ThreadData> threads(num_threads);
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (std::size_t i = 0; i < thread_list.size(); ++i) {
+            const Kernel::Thread& thread = *thread_list[i];
+            threads[i] = ThreadData{thread.thread_id,
+                                    static_cast<u32>(thread.status),
+                                    thread.nominal_priority,
+                                    thread.current_priority,
+                                    thread.last_running_ticks,
+                                    thread.wait_address,
+                                    SaveContextData(*thread.context)};
+        }
+    }
+    if (num_threads > 0) {
+        p.DoVoid(threads.data(), static_cast<int>(num_threads * sizeof(ThreadData)));
+    }
+
+    if (p.GetMode() != PointerWrap::MODE_READ)
+        return;
+
+    // Wait lists, mutexes and the ready queue are not serialized, so only accept states whose
+    // threads are in the same scheduling state as the running ones.
+    const auto matches = [&](const ThreadData& data, const Kernel::Thread& thread) {
+        return data.thread_id == thread.thread_id &&
+               data.status == static_cast<u32>(thread.status) &&
+               data.nominal_priority == thread.nominal_priority &&
+               data.current_priority == thread.current_priority;
+    };
+    const u32 live_current_thread_id = current_thread ? current_thread->thread_id : 0;
+    if (num_threads != thread_list.size() || current_thread_id != live_current_thread_id ||
+        !std::equal(threads.begin(), threads.end(), thread_list.begin(),
+                    [&](const ThreadData& data, const auto& thread) {
+                        return matches(data, *thread);
+                    })) {
+        LOG_ERROR(Core, "Save state thread set does not match the running session");
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+
+    loaded_threads = std::move(threads);
+}
+
+void SaveStateManager::ApplyKernel() {
+    const auto& thread_list = system.Kernel().GetThreadManager().GetThreadList();
+    for (std::size_t i = 0; i < thread_list.size(); ++i) {
+        Kernel::Thread& thread = *thread_list[i];
+        thread.last_running_ticks = loaded_threads[i].last_running_ticks;
+        thread.wait_address = loaded_threads[i].wait_address;
+        LoadContextData(*thread.context, loaded_threads[i].context);
+    }
+    loaded_threads.clear();
+}
+
+void SaveStateManager::DoCPU(PointerWrap& p) {
+    auto s = p.Section("CPU", 1);
+    if (!s)
+        return;
+
+    ARM_Interface& cpu = system.CPU();
+    auto context = cpu.NewContext();
+
+    ThreadContextData data{};
+    u32 thread_uro = 0;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        cpu.SaveContext(context);
+        data = SaveContextData(*context);
+        thread_uro = cpu.GetCP15Register(CP15_THREAD_URO);
+    }
+
+    p.DoVoid(&data, sizeof(data));
+    p.Do(thread_uro);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        LoadContextData(*context, data);
+        cpu.LoadContext(context);
+        cpu.SetCP15Register(CP15_THREAD_URO, thread_uro);
+    }
+}
+
+void SaveStateManager::DoMemory(PointerWrap& p) {
+    auto s = p.Section("Memory", 1);
+    if (!s)
+        return;
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        // Only check the page lists for now, the pages are copied in by ApplyMemory once every
+        // section that can reject the state has been read
+        loaded_memory = *p.GetPPtr();
+    }
+    DoPages(p, p.GetMode() != PointerWrap::MODE_READ);
+}
+
+void SaveStateManager::DoPages(PointerWrap& p, bool copy_pages) {
+    for (MemoryRegion& region : regions) {
+        u32 num_pages = static_cast<u32>(region.pending_pages.size());
+        p.Do(num_pages);
+
+        if (p.GetMode() == PointerWrap::MODE_READ && copy_pages) {
+            if (current_mode == SnapshotMode::Full) {
+                // Pages that aren't part of a full snapshot are zero
+                std::memset(region.pointer, 0, region.num_pages * Memory::PAGE_SIZE);
+                region.pending_hashes.assign(region.num_pages, HashPage(zero_page.data()));
+            } else {
+                region.pending_hashes = region.page_hashes;
+            }
+            stats.pages_stored += num_pages;
+        }
+
+        for (u32 i = 0; i < num_pages; ++i) {
+            u32 page = p.GetMode() == PointerWrap::MODE_READ ? 0 : region.pending_pages[i];
+            p.Do(page);
+            if (page >= region.num_pages) {
+                LOG_ERROR(Core, "Save state contains invalid page {} for {}", page, region.name);
+                p.SetError(PointerWrap::ERROR_FAILURE);
+                return;
+            }
+
+            if (!copy_pages) {
+                *p.GetPPtr() += Memory::PAGE_SIZE;
+                continue;
+            }
+
+            u8* pointer = region.pointer + page * Memory::PAGE_SIZE;
+            p.DoVoid(pointer, Memory::PAGE_SIZE);
+
+            if (p.GetMode() == PointerWrap::MODE_READ) {
+                region.pending_hashes[page] = HashPage(pointer);
+            }
+        }
+    }
+}
+
+void SaveStateManager::ApplyMemory() {
+    u8* ptr = loaded_memory;
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    DoPages(p, true);
+    loaded_memory = nullptr;
+}
+
+void SaveStateManager::DoState(PointerWrap& p) {
+    // Everything that can reject a state is read before the running system is modified: the
+    // kernel threads and memory pages are only checked here, and Core::Timing applies its queue
+    // once it has been read completely. The sections after it can only fail on a malformed
+    // payload.
+    DoKernel(p);
+    DoMemory(p);
+    system.CoreTiming().DoState(p);
+    if (p.error == PointerWrap::ERROR_FAILURE)
+        return;
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        state_modified = true;
+        ApplyKernel();
+        ApplyMemory();
+    }
+
+    system.DSP().DoState(p);
+    DoCPU(p);
+    Pica::GetState().DoState(p);
+
+    auto s = p.Section("HW", 1);
+    if (!s)
+        return;
+    // Loaded registers must not be overwritten by the completion of transfers queued before
+    GPU::FinishTransfers();
+    HW::InstanceState& hardware = system.HardwareState();
+    p.DoVoid(&hardware.gpu_regs, sizeof(hardware.gpu_regs));
+    p.DoVoid(&hardware.lcd_regs, sizeof(hardware.lcd_regs));
+
+    system.Movie().DoState(p);
+}
+
+std::vector<u8> SaveStateManager::Save(SnapshotMode mode) {
+    const auto start_time = std::chrono::steady_clock::now();
+
+    if (mode == SnapshotMode::Delta && !has_baseline) {
+        LOG_WARNING(Core, "No previous snapshot to base a delta on, saving a full snapshot");
+        mode = SnapshotMode::Full;
+    }
+
+    // Write back anything the renderer holds so that memory is up to date. This also drains the
+    // GPU thread, which must stay idle while the PICA state is serialized.
+    if (VideoCore::GetRenderer()) {
+        VideoCore::RunOnRendererThread([] { VideoCore::GetRenderer()->Rasterizer()->FlushAll(); });
+    }
+
+    CollectDirtyPages(mode);
+
+    // Measure the payload first so that it can be written in one go
+    u8* ptr = nullptr;
+    PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+    DoState(p_measure);
+    if (p_measure.error == PointerWrap::ERROR_FAILURE) {
+        LOG_ERROR(Core, "Failed to save state");
+        return {};
+    }
+    const std::size_t payload_size = reinterpret_cast<std::size_t>(ptr);
+
+    std::vector<u8> buffer(sizeof(SnapshotHeader) + payload_size);
+    ptr = buffer.data() + sizeof(SnapshotHeader);
+    PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+    DoState(p_write);
+    ASSERT(ptr == buffer.data() + buffer.size());
+
+    SnapshotHeader header{};
+    header.filetype = header_magic_bytes;
+    header.version = SAVESTATE_VERSION;
+    header.program_id = GetProgramId(system);
+    header.snapshot_id = GenerateSnapshotId();
+    header.parent_id = mode == SnapshotMode::Delta ? current_snapshot_id : 0;
+    header.payload_size = payload_size;
+    header.payload_hash =
+        Common::ComputeHash64(buffer.data() + sizeof(SnapshotHeader), payload_size);
+    header.mode = static_cast<u8>(mode);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    stats.pages_stored = 0;
+    stats.pages_total = 0;
+    for (MemoryRegion& region : regions) {
+        stats.pages_stored += region.pending_pages.size();
+        stats.pages_total += region.num_pages;
+        region.page_hashes = std::move(region.pending_hashes);
+        region.pending_hashes.clear();
+        region.pending_pages.clear();
+    }
+
+    current_snapshot_id = header.snapshot_id;
+    has_baseline = true;
+    baseline_ticks = system.CoreTiming().GetTicks();
+
+    stats.snapshot_size = buffer.size();
+    stats.save_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    LOG_INFO(Core, "Saved {} snapshot {:016X}: {} bytes, {}/{} pages, {} us",
+             mode == SnapshotMode::Delta ? "delta" : "full", current_snapshot_id,
+             stats.snapshot_size, stats.pages_stored, stats.pages_total,
+             stats.save_time.count());
+    return buffer;
+}
+
+bool SaveStateManager::Load(const std::vector<u8>& data) {
+    const auto start_time = std::chrono::steady_clock::now();
+
+    if (data.size() < sizeof(SnapshotHeader)) {
+        LOG_ERROR(Core, "Save state is too small");
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.filetype != header_magic_bytes) {
+        LOG_ERROR(Core, "Save state has an invalid header");
+        return false;
+    }
+    if (header.version != SAVESTATE_VERSION) {
+        LOG_ERROR(Core, "Save state version {} is not supported (expected {})",
+                  static_cast<u32>(header.version), SAVESTATE_VERSION);
+        return false;
+    }
+
+    if (header.program_id != GetProgramId(system)) {
+        LOG_ERROR(Core, "Save state was made for another title ({:016X})",
+                  static_cast<u64>(header.program_id));
+        return false;
+    }
+
+    const u8* payload = data.data() + sizeof(SnapshotHeader);
+    const std::size_t payload_size = data.size() - sizeof(SnapshotHeader);
+    if (header.payload_size != payload_size ||
+        header.payload_hash != Common::ComputeHash64(payload, payload_size)) {
+        LOG_ERROR(Core, "Save state is truncated or corrupted");
+        return false;
+    }
+
+    if (header.mode > static_cast<u8>(SnapshotMode::Delta)) {
+        LOG_ERROR(Core, "Save state has an invalid mode {}", header.mode);
+        return false;
+    }
+    const auto mode = static_cast<SnapshotMode>(header.mode);
+    if (mode == SnapshotMode::Delta && (!has_baseline || header.parent_id != current_snapshot_id)) {
+        LOG_ERROR(Core, "Delta save state applies to snapshot {:016X}, which is not loaded",
+                  static_cast<u64>(header.parent_id));
+        return false;
+    }
+    // Only the pages that changed since the parent are stored, so the others must still hold
+    // what they held when the parent was saved or loaded
+    if (mode == SnapshotMode::Delta && system.CoreTiming().GetTicks() != baseline_ticks) {
+        LOG_ERROR(Core, "Emulation has run since snapshot {:016X}, cannot apply a delta to it",
+                  current_snapshot_id);
+        return false;
+    }
+
+    // Subsystems that can't be serialized (such as the LLE DSP) fail to measure, which rejects
+    // the state before anything is touched
+    u8* measure_ptr = nullptr;
+    PointerWrap p_measure(&measure_ptr, PointerWrap::MODE_MEASURE);
+    DoState(p_measure);
+    if (p_measure.error == PointerWrap::ERROR_FAILURE) {
+        LOG_ERROR(Core, "The running session can't be restored from a save state");
+        return false;
+    }
+
+    // Write back anything the renderer holds before memory gets replaced, so that a rejected
+    // state doesn't lose GPU-side data
+    if (VideoCore::GetRenderer()) {
+        VideoCore::RunOnRendererThread([] { VideoCore::GetRenderer()->Rasterizer()->FlushAll(); });
+    }
+
+    current_mode = mode;
+    stats.pages_stored = 0;
+    state_modified = false;
+    u8* ptr = const_cast<u8*>(payload);
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    DoState(p);
+    loaded_threads.clear();
+    loaded_memory = nullptr;
+    if (p.error == PointerWrap::ERROR_FAILURE) {
+        if (state_modified) {
+            // The running state is partially replaced, so it can't go on
+            LOG_CRITICAL(Core, "Failed to load state after it was partially applied");
+            system.SetStatus(System::ResultStatus::ErrorUnknown, "Save state");
+        } else {
+            LOG_ERROR(Core, "Failed to load state");
+        }
+        return false;
+    }
+
+    // Drop everything that was derived from the replaced state
+    if (VideoCore::GetRenderer()) {
+        VideoCore::RunOnRendererThread([] {
+            auto* rasterizer = VideoCore::GetRenderer()->Rasterizer();
+            rasterizer->InvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+            rasterizer->InvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+            for (u32 id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+                rasterizer->NotifyPicaRegisterChanged(id);
+            }
+        });
+    }
+    system.CPU().ClearInstructionCache();
+
+    stats.pages_total = 0;
+    for (MemoryRegion& region : regions) {
+        stats.pages_total += region.num_pages;
+        region.page_hashes = std::move(region.pending_hashes);
+        region.pending_hashes.clear();
+    }
+
+    current_snapshot_id = header.snapshot_id;
+    has_baseline = true;
+    baseline_ticks = system.CoreTiming().GetTicks();
+
+    stats.snapshot_size = data.size();
+    stats.load_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    stats.load_to_first_frame = {};
+    first_frame_start = start_time;
+    LOG_INFO(Core, "Loaded snapshot {:016X}: {} bytes, {}/{} pages, {} us", current_snapshot_id,
+             stats.snapshot_size, stats.pages_stored, stats.pages_total, stats.load_time.count());
+    return true;
+}
+
+void SaveStateManager::EndGameFrame() {
+    if (!first_frame_start)
+        return;
+
+    stats.load_to_first_frame = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - *first_frame_start);
+    first_frame_start.reset();
+    LOG_INFO(Core, "First frame of snapshot {:016X} ({} bytes) ended {} us after loading it",
+             current_snapshot_id, stats.snapshot_size, stats.load_to_first_frame.count());
+}
+
+bool SaveStateManager::SaveToFile(const std::string& path, SnapshotMode mode) {
+    const std::vector<u8> data = Save(mode);
+    if (data.empty())
+        return false;
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Unable to open '{}' for writing", path);
+        return false;
+    }
+    file.WriteBytes(data.data(), data.size());
+    return file.IsGood();
+}
+
+bool SaveStateManager::LoadFromFile(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Unable to open save state '{}'", path);
+        return false;
+    }
+
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Core, "Unable to read save state '{}'", path);
+        return false;
+    }
+    return Load(data);
+}
+
+} // namespace Core
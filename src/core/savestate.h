@@ -0,0 +1,127 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+class PointerWrap;
+
+namespace Core {
+
+class System;
+
+/**
+ * Captures and restores snapshots of the emulated console.
+ *
+ * A full snapshot stores every non-zero page of emulated physical memory together with the CPU
+ * registers, the Core::Timing event queue, the kernel thread contexts, the PICA state, the GPU/LCD
+ * registers, the HLE DSP state and the position of the movie being played back or recorded. A
+ * delta snapshot stores the same non-memory state, but only those memory pages that changed since
+ * the snapshot last saved or loaded through this manager, and can only be loaded on top of that
+ * snapshot.
+ *
+ * Kernel objects other than threads (processes, handles, sessions, service state) are not
+ * serialized. Loading therefore requires the running session to have the same set of threads as
+ * the one that was saved, which holds when rewinding within a session; mismatching states are
+ * rejected before anything is modified. So are delta snapshots once emulation has run since their
+ * parent was saved or loaded, as memory no longer matches the parent then.
+ */
+class SaveStateManager {
+public:
+    enum class SnapshotMode : u8 {
+        Full,  ///< All non-zero memory pages are stored
+        Delta, ///< Only pages changed since the previous snapshot are stored
+    };
+
+    struct Stats {
+        std::size_t snapshot_size = 0; ///< Size in bytes of the last saved or loaded snapshot
+        std::size_t pages_stored = 0;  ///< Memory pages contained in the last snapshot
+        std::size_t pages_total = 0;   ///< Memory pages covered by a snapshot
+        std::chrono::microseconds save_time{}; ///< Host time spent in the last Save
+        std::chrono::microseconds load_time{}; ///< Host time spent in the last Load
+        /// Host time from the start of the last Load to the end of the next game frame, zero
+        /// until that frame ends
+        std::chrono::microseconds load_to_first_frame{};
+    };
+
+    explicit SaveStateManager(System& system);
+    ~SaveStateManager();
+
+    /**
+     * Captures a snapshot of the running system.
+     * @param mode Whether to store all memory or only the pages changed since the last snapshot.
+     *             A delta request falls back to a full snapshot if there is no previous one.
+     * @returns The serialized snapshot, or an empty vector on failure.
+     */
+    std::vector<u8> Save(SnapshotMode mode);
+
+    /**
+     * Restores a snapshot previously produced by Save.
+     * @returns true on success. States that don't match the running session are rejected without
+     *          modifying it. A payload that turns out to be malformed after the state has been
+     *          partially applied stops emulation with ResultStatus::ErrorUnknown.
+     */
+    bool Load(const std::vector<u8>& data);
+
+    bool SaveToFile(const std::string& path, SnapshotMode mode);
+    bool LoadFromFile(const std::string& path);
+
+    /// Called at the end of each game frame, to measure how long a loaded state takes to show up
+    void EndGameFrame();
+
+    /// Returns the id of the snapshot last saved or loaded, which delta snapshots are based on.
+    u64 GetCurrentSnapshotId() const {
+        return current_snapshot_id;
+    }
+
+    const Stats& GetStats() const {
+        return stats;
+    }
+
+private:
+    struct MemoryRegion;
+    struct ThreadData;
+
+    void DoState(PointerWrap& p);
+    void DoKernel(PointerWrap& p);
+    void DoCPU(PointerWrap& p);
+    void DoMemory(PointerWrap& p);
+    void DoPages(PointerWrap& p, bool copy_pages);
+
+    /// Restores the thread contexts read by DoKernel.
+    void ApplyKernel();
+    /// Copies in the memory pages checked by DoMemory.
+    void ApplyMemory();
+
+    /// Hashes every page and collects the ones that need to be stored in the next snapshot.
+    void CollectDirtyPages(SnapshotMode mode);
+
+    System& system;
+    std::vector<MemoryRegion> regions;
+
+    SnapshotMode current_mode = SnapshotMode::Full;
+    u64 current_snapshot_id = 0;
+    bool has_baseline = false;
+    /// Core::Timing ticks when the current snapshot was saved or loaded
+    u64 baseline_ticks = 0;
+
+    /// Thread contexts and memory pages of the state being loaded, applied after validation
+    std::vector<ThreadData> loaded_threads;
+    u8* loaded_memory = nullptr;
+    /// Whether the state being loaded has started replacing the running one
+    bool state_modified = false;
+
+    /// When the last successful Load started, if no game frame has ended since
+    std::optional<std::chrono::steady_clock::time_point> first_frame_start;
+
+    Stats stats;
+};
+
+} // namespace Core
@@ -22,14 +22,18 @@ void Apply() {
     GDBStub::SetServerPort(values.gdbstub_port);
     GDBStub::ToggleServer(values.use_gdbstub);
 
-    VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
+    VideoCore::g_hw_renderer_enabled =
+        values.use_hw_renderer && values.renderer_backend == RendererBackend::OpenGL;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
     VideoCore::g_hw_shader_enabled = values.use_hw_shader;
     VideoCore::g_hw_shader_accurate_gs = values.shaders_accurate_gs;
     VideoCore::g_hw_shader_accurate_mul = values.shaders_accurate_mul;
+    VideoCore::g_sw_rasterizer_threads = values.sw_rasterizer_threads;
+    VideoCore::g_vertex_cache_size = values.vertex_cache_size;
+    VideoCore::g_surface_cache_budget = values.surface_cache_budget;
 
-    if (VideoCore::g_renderer) {
-        VideoCore::g_renderer->UpdateCurrentFramebufferLayout();
+    if (VideoCore::GetRenderer()) {
+        VideoCore::GetRenderer()->UpdateCurrentFramebufferLayout();
     }
 
     VideoCore::g_renderer_bg_color_update_requested = true;
@@ -67,11 +71,18 @@ void LogSetting(const std::string& name, const T& value) {
 void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
+    LogSetting("Core_IdleFastForward", Settings::values.idle_fast_forward);
+    LogSetting("Renderer_Backend", static_cast<int>(Settings::values.renderer_backend));
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_UseGpuThread", Settings::values.use_gpu_thread);
+    LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_SwRasterizerThreads", Settings::values.sw_rasterizer_threads);
+    LogSetting("Renderer_VertexCacheSize", Settings::values.vertex_cache_size);
+    LogSetting("Renderer_SurfaceCacheBudget", Settings::values.surface_cache_budget);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_VsyncEnabled", Settings::values.vsync_enabled);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
@@ -18,6 +18,12 @@ enum class InitClock {
     FixedTime = 1,
 };
 
+enum class RendererBackend {
+    OpenGL,
+    Null,     ///< Emulates the GPU in software without presenting frames
+    Software, ///< Emulates the GPU in software and converts the screens to RGBA8 images
+};
+
 enum class LayoutOption {
     Default,
     SingleScreen,
@@ -115,6 +121,7 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    bool idle_fast_forward;
 
     // Data Storage
     bool use_virtual_sd;
@@ -125,11 +132,17 @@ struct Values {
     u64 init_time;
 
     // Renderer
+    RendererBackend renderer_backend;
     bool use_hw_renderer;
     bool use_hw_shader;
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    bool use_gpu_thread;
+    bool use_disk_shader_cache;
+    u16 sw_rasterizer_threads;
+    u32 vertex_cache_size;
+    u32 surface_cache_budget;
     u16 resolution_factor;
     bool vsync_enabled;
     bool use_frame_limit;
@@ -171,6 +184,8 @@ struct Values {
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
+    bool log_deferred_formatting;
+    bool log_binary_file;
     std::unordered_map<std::string, bool> lle_modules;
 
     // WebService
@@ -0,0 +1,198 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/logging/log.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/pica_state.h"
+#include "video_core/pica_types.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace CiTrace {
+
+bool Player::Open(const std::string& filename) {
+    frame_count = 0;
+    current_element = 0;
+    if (!file.Open(filename) || file.Size() < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "Unable to read CiTrace {}", filename);
+        return false;
+    }
+
+    std::memcpy(&header, file.Data(), sizeof(CTHeader));
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), 4) != 0 ||
+        header.version != CTHeader::ExpectedVersion()) {
+        LOG_ERROR(HW_GPU, "{} is not a CiTrace of version {}", filename,
+                  CTHeader::ExpectedVersion());
+        return false;
+    }
+
+    const u64 stream_end =
+        header.stream_offset + static_cast<u64>(header.stream_size) * sizeof(CTStreamElement);
+    if (stream_end > file.Size()) {
+        LOG_ERROR(HW_GPU, "CiTrace {} is truncated", filename);
+        return false;
+    }
+
+    for (u32 i = 0; i < header.stream_size; ++i) {
+        CTStreamElementType type;
+        std::memcpy(&type, file.Data() + header.stream_offset + i * sizeof(CTStreamElement),
+                    sizeof(type));
+        if (type == FrameMarker) {
+            ++frame_count;
+        }
+    }
+    return true;
+}
+
+/// Copies up to `count` words of the initial state stored at `offset`, as long as they are in the
+/// file, and returns the number of words copied.
+static std::size_t ReadInitialState(const FileUtil::MappedFile& file, u32 offset, u32 size,
+                                    u32* out, std::size_t count) {
+    if (offset > file.Size()) {
+        return 0;
+    }
+    count = std::min<std::size_t>({count, size, (file.Size() - offset) / sizeof(u32)});
+    std::memcpy(out, file.Data() + offset, count * sizeof(u32));
+    return count;
+}
+
+template <typename Regs>
+static void ReadRegisters(const FileUtil::MappedFile& file, u32 offset, u32 size, Regs& regs) {
+    std::vector<u32> values(Regs::NumIds());
+    const std::size_t count = ReadInitialState(file, offset, size, values.data(), values.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        regs[i] = values[i];
+    }
+}
+
+template <std::size_t N>
+static void ReadFloats(const FileUtil::MappedFile& file, u32 offset, u32 size,
+                       Math::Vec4<Pica::float24> (&vectors)[N]) {
+    std::array<u32, N * 4> values;
+    const std::size_t count = ReadInitialState(file, offset, size, values.data(), values.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        vectors[i / 4][i % 4] = Pica::float24::FromRaw(values[i]);
+    }
+}
+
+static void ReadShader(const FileUtil::MappedFile& file, u32 program_offset, u32 program_size,
+                       u32 swizzle_offset, u32 swizzle_size, u32 uniforms_offset,
+                       u32 uniforms_size, Pica::Shader::ShaderSetup& setup) {
+    ReadInitialState(file, program_offset, program_size, setup.program_code.data(),
+                     setup.program_code.size());
+    ReadInitialState(file, swizzle_offset, swizzle_size, setup.swizzle_data.data(),
+                     setup.swizzle_data.size());
+    ReadFloats(file, uniforms_offset, uniforms_size, setup.uniforms.f);
+    setup.MarkProgramCodeDirty();
+    setup.MarkSwizzleDataDirty();
+}
+
+void Player::Rewind() {
+    const auto& offsets = header.initial_state_offsets;
+    ReadRegisters(file, offsets.gpu_registers, offsets.gpu_registers_size, GPU::GetRegs());
+    ReadRegisters(file, offsets.lcd_registers, offsets.lcd_registers_size, LCD::GetRegs());
+
+    Pica::State& state = Pica::GetState();
+    ReadInitialState(file, offsets.pica_registers, offsets.pica_registers_size,
+                     state.regs.reg_array.data(), state.regs.reg_array.size());
+    ReadFloats(file, offsets.default_attributes, offsets.default_attributes_size,
+               state.input_default_attributes.attr);
+    ReadShader(file, offsets.vs_program_binary, offsets.vs_program_binary_size,
+               offsets.vs_swizzle_data, offsets.vs_swizzle_data_size, offsets.vs_float_uniforms,
+               offsets.vs_float_uniforms_size, state.vs);
+    ReadShader(file, offsets.gs_program_binary, offsets.gs_program_binary_size,
+               offsets.gs_swizzle_data, offsets.gs_swizzle_data_size, offsets.gs_float_uniforms,
+               offsets.gs_float_uniforms_size, state.gs);
+
+    // The registers were replaced without going through the command processor
+    VideoCore::RunOnRendererThread([] {
+        auto* rasterizer = VideoCore::GetRenderer()->Rasterizer();
+        for (u32 id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+            rasterizer->NotifyPicaRegisterChanged(id);
+        }
+    });
+
+    current_element = 0;
+}
+
+bool Player::PlayFrame() {
+    while (current_element < header.stream_size) {
+        CTStreamElement element;
+        std::memcpy(&element,
+                    file.Data() + header.stream_offset + current_element * sizeof(CTStreamElement),
+                    sizeof(CTStreamElement));
+        ++current_element;
+
+        switch (element.type) {
+        case FrameMarker:
+            VideoCore::RunOnRendererThread([] { VideoCore::GetRenderer()->SwapBuffers(); });
+            return true;
+        case MemoryLoad:
+            LoadMemory(element.memory_load);
+            break;
+        case RegisterWrite:
+            WriteRegister(element.register_write);
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown CiTrace element type {:#X}",
+                      static_cast<u32>(element.type));
+            break;
+        }
+    }
+    return false;
+}
+
+void Player::LoadMemory(const CTMemoryLoad& memory_load) {
+    u8* dest = VideoCore::GetMemory().GetPhysicalPointer(memory_load.physical_address);
+    if (dest == nullptr || static_cast<u64>(memory_load.file_offset) + memory_load.size >
+                               file.Size()) {
+        LOG_ERROR(HW_GPU, "Invalid memory load of {:#X} bytes to {:#010X}", memory_load.size,
+                  memory_load.physical_address);
+        return;
+    }
+
+    // Textures and vertices are recorded for every draw that uses them. Only replace the memory
+    // if it changed, so that the renderer doesn't reload everything on each draw.
+    const u8* source = file.Data() + memory_load.file_offset;
+    if (std::memcmp(dest, source, memory_load.size) == 0) {
+        return;
+    }
+    std::memcpy(dest, source, memory_load.size);
+    VideoCore::RunOnRendererThread([&memory_load] {
+        VideoCore::GetRenderer()->Rasterizer()->InvalidateRegion(memory_load.physical_address,
+                                                                 memory_load.size);
+    });
+}
+
+void Player::WriteRegister(const CTRegisterWrite& register_write) {
+    const u32 address =
+        register_write.physical_address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR;
+    switch (register_write.size) {
+    case CTRegisterWrite::SIZE_8:
+        HW::Write<u8>(address, static_cast<u8>(register_write.value));
+        break;
+    case CTRegisterWrite::SIZE_16:
+        HW::Write<u16>(address, static_cast<u16>(register_write.value));
+        break;
+    case CTRegisterWrite::SIZE_32:
+        HW::Write<u32>(address, static_cast<u32>(register_write.value));
+        break;
+    case CTRegisterWrite::SIZE_64:
+        HW::Write<u64>(address, register_write.value);
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Invalid register write size {:#X}",
+                  static_cast<u32>(register_write.size));
+        break;
+    }
+}
+
+} // namespace CiTrace
@@ -0,0 +1,48 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+#include "common/mapped_file.h"
+#include "core/tracer/citrace.h"
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace on the System bound to the calling thread, which has to be initialized without
+ * an application. Register writes go through the emulated GPU and LCD as if the CPU made them, so
+ * the recorded command lists, memory fills and display transfers are executed by the renderer.
+ */
+class Player {
+public:
+    /// Opens a trace. Returns false if the file can't be read or isn't a valid CiTrace.
+    bool Open(const std::string& filename);
+
+    /// Returns the number of frames of the trace.
+    std::size_t GetFrameCount() const {
+        return frame_count;
+    }
+
+    /// Restores the state recorded at the start of the trace and goes back to its first frame.
+    void Rewind();
+
+    /**
+     * Replays the trace up to the end of the next frame, which is then presented.
+     * @returns false if the trace ended before the frame was complete.
+     */
+    bool PlayFrame();
+
+private:
+    void LoadMemory(const CTMemoryLoad& memory_load);
+    void WriteRegister(const CTRegisterWrite& register_write);
+
+    FileUtil::MappedFile file;
+    CTHeader header;
+    std::size_t frame_count = 0;
+    u32 current_element = 0;
+};
+
+} // namespace CiTrace
@@ -0,0 +1,94 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <iostream>
+#include <string>
+
+#ifdef _MSC_VER
+#include <getopt.h>
+#else
+#include <getopt.h>
+#include <unistd.h>
+#endif
+
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/filter.h"
+#include "common/logging/text_formatter.h"
+#include "common/scm_rev.h"
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "Prints the messages of a binary log file written by Citra as text.\n"
+                 "-f, --filter=FILTER  Only print the messages passing a log filter,\n"
+                 "                     e.g. \"*:Warning Service.FS:Debug\"\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra log decoder " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    Log::Filter filter(Log::Level::Trace);
+    std::string filename;
+
+    static struct option long_options[] = {
+        {"filter", required_argument, 0, 'f'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "f:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'f':
+                filter.ParseFilterString(optarg);
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return -1;
+            }
+        } else {
+            filename = argv[optind];
+            optind++;
+        }
+    }
+
+    if (filename.empty()) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Log::BinaryLogReader reader(filename);
+    if (!reader.IsValid()) {
+        std::cerr << "Could not read " << filename << " as a binary log file\n";
+        return -1;
+    }
+
+    Log::Entry entry;
+    while (reader.ReadEntry(entry)) {
+        if (filter.CheckMessage(entry.log_class, entry.log_level)) {
+            std::cout << Log::FormatLogMessage(entry) << '\n';
+        }
+    }
+    if (reader.IsCorrupt()) {
+        std::cerr << "The rest of " << filename << " is corrupt, the log may have been cut off\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/deferred_message.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+
+namespace Log {
+
+template <typename... Args>
+static std::string FormatDeferred(std::string_view format, const Args&... args) {
+    const std::array<DeferredArgument, sizeof...(Args)> arguments{{MakeDeferredArgument(args)...}};
+    return FormatDeferredMessage(format, arguments.data(), arguments.size());
+}
+
+TEST_CASE("FormatDeferredMessage matches fmt", "[common]") {
+    const std::string string = "string";
+    const int pointee = 0;
+    const void* const pointer = &pointee;
+
+    REQUIRE(FormatDeferred("no fields {{}}") == fmt::format("no fields {{}}"));
+    REQUIRE(FormatDeferred("{} {} {}", true, 'c', -42) == fmt::format("{} {} {}", true, 'c', -42));
+    REQUIRE(FormatDeferred("{:08X} {:#x} {:>5}", 0xBEEFu, u64{1} << 40, u8{7}) ==
+            fmt::format("{:08X} {:#x} {:>5}", 0xBEEFu, u64{1} << 40, u8{7}));
+    REQUIRE(FormatDeferred("{:.3f} {}", 1.5f, 2.25) == fmt::format("{:.3f} {}", 1.5f, 2.25));
+    REQUIRE(FormatDeferred("{1}-{0}", "a", string) == fmt::format("{1}-{0}", "a", string));
+    REQUIRE(FormatDeferred("{}", pointer) == fmt::format("{}", pointer));
+    REQUIRE(FormatDeferred("{:<10}|", std::string_view("view")) ==
+            fmt::format("{:<10}|", std::string_view("view")));
+}
+
+TEST_CASE("FormatDeferredMessage keeps invalid fields", "[common]") {
+    REQUIRE(FormatDeferred("{} {}", 1) == "1 {}");
+    REQUIRE(FormatDeferred("{:d}", "text") == "{:d}");
+    REQUIRE(FormatDeferred("{:{}}", 1, 2) == "{:{}}");
+    REQUIRE(FormatDeferred("unterminated {", 1) == "unterminated {");
+}
+
+TEST_CASE("DeferredMessageRing keeps the messages of each producer in order", "[common]") {
+    constexpr std::size_t NUM_PRODUCERS = 4;
+    constexpr u32 MESSAGES_PER_PRODUCER = 20000;
+    DeferredMessageRing ring(16 * 1024);
+
+    std::vector<std::thread> producers;
+    for (u32 producer = 0; producer < NUM_PRODUCERS; ++producer) {
+        producers.emplace_back([&ring, producer] {
+            std::vector<u8> message;
+            for (u32 i = 0; i < MESSAGES_PER_PRODUCER; ++i) {
+                // Vary the size to wrap around the buffer in the middle of messages
+                message.assign(9 + (i * 37) % 300, static_cast<u8>(i));
+                std::memcpy(message.data(), &producer, sizeof(producer));
+                std::memcpy(message.data() + sizeof(producer), &i, sizeof(i));
+                while (!ring.Push(message.data(), message.size())) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::array<u32, NUM_PRODUCERS> next{};
+    std::vector<u8> message;
+    for (std::size_t received = 0; received < NUM_PRODUCERS * MESSAGES_PER_PRODUCER;) {
+        if (!ring.Pop(message)) {
+            std::this_thread::yield();
+            continue;
+        }
+        u32 producer, i;
+        std::memcpy(&producer, message.data(), sizeof(producer));
+        std::memcpy(&i, message.data() + sizeof(producer), sizeof(i));
+        REQUIRE(producer < NUM_PRODUCERS);
+        REQUIRE(i == next[producer]++);
+        REQUIRE(message.size() == 9 + (i * 37) % 300);
+        REQUIRE(message.back() == static_cast<u8>(i));
+        ++received;
+    }
+    for (std::thread& thread : producers) {
+        thread.join();
+    }
+    REQUIRE(ring.Empty());
+    REQUIRE(!ring.Pop(message));
+}
+
+namespace {
+/// Collects the messages written by the logging thread
+class CollectingBackend : public Backend {
+public:
+    static const char* Name() {
+        return "collecting";
+    }
+    const char* GetName() const override {
+        return Name();
+    }
+    void Write(const Entry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(entry.message);
+    }
+
+    std::vector<std::string> TakeMessages() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::move(messages);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> messages;
+};
+} // Anonymous namespace
+
+TEST_CASE("Deferred logging keeps the order of messages when the ring is full", "[common]") {
+    // Enough messages to fill the ring several times over
+    constexpr u32 NUM_MESSAGES = 100000;
+
+    auto backend = std::make_unique<CollectingBackend>();
+    CollectingBackend* collector = backend.get();
+    AddBackend(std::move(backend));
+    SetGlobalFilter(Filter(Level::Info));
+    SetDeferredFormatting(true);
+
+    for (u32 i = 0; i < NUM_MESSAGES; ++i) {
+        LOG_INFO(Common, "message {} with some padding to use more of the ring", i);
+    }
+
+    std::vector<std::string> messages;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (messages.size() < NUM_MESSAGES && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (std::string& message : collector->TakeMessages()) {
+            messages.push_back(std::move(message));
+        }
+    }
+    SetDeferredFormatting(false);
+    RemoveBackend(CollectingBackend::Name());
+
+    REQUIRE(messages.size() == NUM_MESSAGES);
+    for (u32 i = 0; i < NUM_MESSAGES; ++i) {
+        REQUIRE(messages[i] ==
+                fmt::format("message {} with some padding to use more of the ring", i));
+    }
+}
+
+TEST_CASE("Deferred logging keeps long messages whole and in order", "[common]") {
+    const std::string long_string(3 * MAX_DEFERRED_MESSAGE_SIZE, 'x');
+
+    auto backend = std::make_unique<CollectingBackend>();
+    CollectingBackend* collector = backend.get();
+    AddBackend(std::move(backend));
+    SetGlobalFilter(Filter(Level::Info));
+    SetDeferredFormatting(true);
+
+    LOG_INFO(Common, "first");
+    LOG_INFO(Common, "deferred {}", long_string);
+    LOG_INFO(Common, "second");
+    // Formatted when logged, as done for formats that aren't literals
+    FmtLogMessageImpl(Class::Common, Level::Info, __FILE__, __LINE__, __func__, "eager {}",
+                      fmt::make_format_args(long_string));
+    LOG_INFO(Common, "third");
+
+    const std::vector<std::string> expected{"first", "deferred " + long_string, "second",
+                                            "eager " + long_string, "third"};
+    std::vector<std::string> messages;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (messages.size() < expected.size() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (std::string& message : collector->TakeMessages()) {
+            messages.push_back(std::move(message));
+        }
+    }
+    SetDeferredFormatting(false);
+    RemoveBackend(CollectingBackend::Name());
+
+    REQUIRE(messages == expected);
+}
+
+TEST_CASE("BinaryFileBackend round trips through BinaryLogReader", "[common]") {
+    const std::string path = "binary_log_test.bin";
+    static const char filename[] = "/home/user/citra/src/core/core.cpp";
+    static const char function[] = "RunLoop";
+    static const char format[] = "{} frames in {:.1f} ms from {}";
+
+    const std::array<DeferredArgument, 3> arguments{{MakeDeferredArgument(-12),
+                                                     MakeDeferredArgument(16.75),
+                                                     MakeDeferredArgument("thread")}};
+    std::array<u8, MAX_DEFERRED_MESSAGE_SIZE> encoded;
+    EncodeDeferredMessage(encoded.data(), std::chrono::microseconds(1000), Class::Core,
+                          Level::Info, filename, 42, function, format, arguments.data(),
+                          arguments.size());
+    DeferredMessage message;
+    DecodeDeferredMessage(encoded.data(), message);
+    const Entry deferred_entry = message.ToEntry();
+    const Entry eager_entry = CreateEntry(Class::Service_FS, Level::Error, filename, 7, function,
+                                          "already formatted {}");
+
+    {
+        BinaryFileBackend backend(path);
+        REQUIRE(backend.WriteDeferred(message));
+        backend.Write(eager_entry);
+        REQUIRE(backend.WriteDeferred(message));
+    }
+
+    BinaryLogReader reader(path);
+    REQUIRE(reader.IsValid());
+    for (const Entry* expected : {&deferred_entry, &eager_entry, &deferred_entry}) {
+        Entry entry;
+        REQUIRE(reader.ReadEntry(entry));
+        REQUIRE(entry.timestamp == expected->timestamp);
+        REQUIRE(entry.log_class == expected->log_class);
+        REQUIRE(entry.log_level == expected->log_level);
+        REQUIRE(entry.filename == expected->filename);
+        REQUIRE(entry.line_num == expected->line_num);
+        REQUIRE(entry.function == expected->function);
+        REQUIRE(entry.message == expected->message);
+    }
+    Entry entry;
+    REQUIRE(!reader.ReadEntry(entry));
+    REQUIRE(!reader.IsCorrupt());
+    REQUIRE(deferred_entry.message == "-12 frames in 16.8 ms from thread");
+
+    FileUtil::Delete(path);
+}
+
+} // namespace Log
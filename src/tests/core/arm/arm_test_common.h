@@ -81,6 +81,7 @@ private:
     std::vector<WriteRecord> write_records;
 
     Kernel::KernelSystem* kernel;
+    Memory::PageTable* page_table = nullptr;
 };
 
 } // namespace ArmTests
@@ -0,0 +1,126 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace ArmTests {
+
+constexpr u32 ADD_R0_1 = 0xE2800001; // add r0, r0, #1
+constexpr u32 MOV_R0_1 = 0xE3A00001; // mov r0, #1
+constexpr u32 MOV_R0_2 = 0xE3A00002; // mov r0, #2
+constexpr u32 B_SELF = 0xEAFFFFFE;   // b +#0
+
+/// Encodes an unconditional branch from `address` to `target`
+static u32 Branch(u32 address, u32 target) {
+    return 0xEA000000 | (((target - address - 8) >> 2) & 0xFFFFFF);
+}
+
+TEST_CASE("BlockCache finds blocks until their page is invalidated", "[arm_dyncom]") {
+    BlockCache cache;
+    REQUIRE(cache.Find(0x00100000) == BlockCache::NO_BLOCK);
+
+    cache.Insert(0x00100000, 0);
+    cache.Insert(0x00100002, 64);
+    cache.Insert(0x00101FFC, 128);
+    cache.Insert(0xFFFFFFFE, 192);
+    REQUIRE(cache.Find(0x00100000) == 0);
+    REQUIRE(cache.Find(0x00100002) == 64);
+    REQUIRE(cache.Find(0x00100004) == BlockCache::NO_BLOCK);
+    REQUIRE(cache.Find(0x00101FFC) == 128);
+    REQUIRE(cache.Find(0xFFFFFFFE) == 192);
+
+    // Invalidation covers whole pages, and only the pages overlapping the range
+    cache.InvalidateRange(0x00100FFF, 1);
+    REQUIRE(cache.Find(0x00100000) == BlockCache::NO_BLOCK);
+    REQUIRE(cache.Find(0x00100002) == BlockCache::NO_BLOCK);
+    REQUIRE(cache.Find(0x00101FFC) == 128);
+
+    cache.InvalidateRange(0x00100000, 0);
+    cache.InvalidateRange(0xFFFFF000, 0x2000);
+    REQUIRE(cache.Find(0xFFFFFFFE) == BlockCache::NO_BLOCK);
+    REQUIRE(cache.Find(0x00101FFC) == 128);
+
+    // Reused page tables start empty
+    cache.Insert(0x00200010, 256);
+    REQUIRE(cache.Find(0x00200010) == 256);
+    REQUIRE(cache.Find(0x00200000) == BlockCache::NO_BLOCK);
+
+    cache.Clear();
+    REQUIRE(cache.Find(0x00101FFC) == BlockCache::NO_BLOCK);
+    REQUIRE(cache.Find(0x00200010) == BlockCache::NO_BLOCK);
+}
+
+TEST_CASE("ARM_DynCom retranslates invalidated code", "[arm_dyncom]") {
+    TestEnvironment test_env(false);
+    test_env.SetMemory32(0x1000, MOV_R0_1);
+    test_env.SetMemory32(0x1004, B_SELF);
+
+    ARM_DynCom dyncom(Core::System::GetInstance(), USER32MODE);
+    Core::Timing& timing = Core::System::GetInstance().CoreTiming();
+
+    dyncom.SetPC(0x1000);
+    timing.Advance();
+    dyncom.Run();
+    REQUIRE(dyncom.GetReg(0) == 1);
+
+    // Modified code keeps running from the cache until its page is invalidated
+    test_env.SetMemory32(0x1000, MOV_R0_2);
+    dyncom.InvalidateCacheRange(0x2000, 0x1000);
+    dyncom.SetPC(0x1000);
+    timing.Advance();
+    dyncom.Run();
+    REQUIRE(dyncom.GetReg(0) == 1);
+
+    dyncom.InvalidateCacheRange(0x1000, sizeof(u32));
+    dyncom.SetPC(0x1000);
+    timing.Advance();
+    dyncom.Run();
+    REQUIRE(dyncom.GetReg(0) == 2);
+}
+
+TEST_CASE("ARM_DynCom block dispatch benchmark", "[.][benchmark][arm_dyncom]") {
+    // A ring of two-instruction blocks spread over several pages, so that execution goes through
+    // the block lookup every other instruction
+    constexpr u32 CODE_ADDRESS = 0x100000;
+    constexpr u32 NUM_BLOCKS = 4096;
+    TestEnvironment test_env(false);
+    for (u32 i = 0; i < NUM_BLOCKS; ++i) {
+        const u32 address = CODE_ADDRESS + i * 8;
+        const u32 next = i + 1 < NUM_BLOCKS ? address + 8 : CODE_ADDRESS;
+        test_env.SetMemory32(address, ADD_R0_1);
+        test_env.SetMemory32(address + 4, Branch(address + 4, next));
+    }
+
+    ARM_DynCom dyncom(Core::System::GetInstance(), USER32MODE);
+    Core::Timing& timing = Core::System::GetInstance().CoreTiming();
+    dyncom.SetPC(CODE_ADDRESS);
+
+    // Also measure with a page of the code invalidated every slice, like CRO patching does
+    for (const bool invalidate : {false, true}) {
+        constexpr int slices = 2000;
+        const u64 start_ticks = timing.GetTicks();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < slices; ++i) {
+            if (invalidate) {
+                dyncom.InvalidateCacheRange(CODE_ADDRESS + (i % 8) * 0x1000, sizeof(u32));
+            }
+            timing.Advance();
+            dyncom.Run();
+        }
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+        const double instructions = static_cast<double>(timing.GetTicks() - start_ticks);
+        WARN((invalidate ? "with" : "without") << " invalidation: "
+                                               << instructions / time.count() / 1e6
+                                               << " million instructions/s");
+    }
+}
+
+} // namespace ArmTests
@@ -0,0 +1,229 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/scope_exit.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/service/gsp/gsp_gpu.h"
+#include "core/hle/service/sm/sm.h"
+#include "core/hw/aes/key.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "tests/core/arm/arm_test_common.h"
+#include "video_core/pica_state.h"
+#include "video_core/video_core.h"
+
+namespace ArmTests {
+
+constexpr u32 CODE_ADDRESS = 0x1000;
+constexpr u32 B_BACK = 0xEAFFFFFD; // b -#4, back to the previous instruction
+
+/// Encodes "add r0, r0, #value"
+static u32 AddR0(u8 value) {
+    return 0xE2800000 | value;
+}
+
+/// What an instance observed, checked on the main thread as Catch isn't thread-safe
+struct InstanceResult {
+    bool bound = false;
+    bool pica_state_owned = false;
+    bool gpu_regs_owned = false;
+    u32 pica_value = 0;
+    u32 r0 = 0;
+};
+
+/**
+ * Runs a loop adding `increment` to r0 on a System of its own, with code at the same address as
+ * the other instances.
+ */
+static void RunInstance(Core::System& system, u8 increment, u32 pica_value,
+                        InstanceResult& result) {
+    Core::System::InstanceScope instance_scope{system};
+    result.bound = &Core::System::GetInstance() == &system && !system.IsDefaultInstance();
+    result.pica_state_owned = &Pica::GetState() == system.VideoState().pica_state.get();
+    result.gpu_regs_owned = &GPU::GetRegs() == &system.HardwareState().gpu_regs;
+
+    Pica::GetState().regs.reg_array[0] = pica_value;
+
+    TestEnvironment test_env(false);
+    test_env.SetMemory32(CODE_ADDRESS, AddR0(increment));
+    test_env.SetMemory32(CODE_ADDRESS + 4, B_BACK);
+
+    ARM_DynCom dyncom(system, USER32MODE);
+    Core::Timing& timing = system.CoreTiming();
+    for (int slice = 0; slice < 500; ++slice) {
+        // Start over every few slices, so that blocks are translated while the other thread runs
+        if (slice % 50 == 0) {
+            dyncom.ClearInstructionCache();
+            dyncom.SetPC(CODE_ADDRESS);
+        }
+        timing.Advance();
+        dyncom.Run();
+    }
+
+    result.pica_value = Pica::GetState().regs.reg_array[0];
+    result.r0 = dyncom.GetReg(0);
+}
+
+TEST_CASE("Systems bound on separate threads don't share state", "[core]") {
+    constexpr std::array<u8, 2> increments{3, 5};
+    std::array<Core::System, 2> systems;
+    std::array<InstanceResult, 2> results;
+
+    std::array<std::thread, 2> threads;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i] = std::thread([&, i] {
+            RunInstance(systems[i], increments[i], 0x100 + static_cast<u32>(i), results[i]);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        REQUIRE(results[i].bound);
+        REQUIRE(results[i].pica_state_owned);
+        REQUIRE(results[i].gpu_regs_owned);
+        REQUIRE(results[i].pica_value == 0x100 + i);
+        REQUIRE(results[i].r0 != 0);
+        REQUIRE(results[i].r0 % increments[i] == 0);
+    }
+
+    // The calling thread is still bound to the default instance
+    REQUIRE(Core::System::GetInstance().IsDefaultInstance());
+    REQUIRE(&Pica::GetState() != systems[0].VideoState().pica_state.get());
+}
+
+/// Window for Systems that don't present frames
+class NullWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+};
+
+/// Blocks the instances until all of them have reached it, so that they run concurrently
+class Rendezvous {
+public:
+    explicit Rendezvous(std::size_t count) : remaining(count) {}
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (--remaining == 0) {
+            cv.notify_all();
+            return;
+        }
+        cv.wait(lock, [this] { return remaining == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t remaining;
+};
+
+/// What a fully initialized instance observed, checked on the main thread
+struct SystemResult {
+    bool initialized = false;
+    bool object_ids_consecutive = false;
+    bool memory_kept = false;
+    bool key_kept = false;
+    const void* gsp_service = nullptr;
+};
+
+/**
+ * Initializes a System with its kernel, memory and services, and modifies each of them while the
+ * other instance does the same.
+ */
+static void RunSystem(Core::System& system, u8 tag, Rendezvous& rendezvous,
+                      SystemResult& result) {
+    Core::System::InstanceScope instance_scope{system};
+    NullWindow window;
+    result.initialized =
+        system.InitWithoutApplication(window) == Core::System::ResultStatus::Success;
+    if (!result.initialized) {
+        rendezvous.Wait();
+        return;
+    }
+
+    std::vector<Kernel::SharedPtr<Kernel::Event>> events;
+    std::vector<u32> object_ids;
+    for (int i = 0; i < 100; ++i) {
+        events.push_back(system.Kernel().CreateEvent(Kernel::ResetType::OneShot));
+        object_ids.push_back(events.back()->GetObjectId());
+    }
+
+    u8* fcram = system.Memory().GetFCRAMPointer(0);
+    std::fill(fcram, fcram + Memory::PAGE_SIZE, tag);
+
+    HW::AES::AESKey key{};
+    key.fill(tag);
+    HW::AES::SetNormalKey(HW::AES::KeySlotID::SSLKey, key);
+
+    result.gsp_service =
+        system.ServiceManager().GetService<Service::GSP::GSP_GPU>("gsp::Gpu").get();
+
+    // Check the state only once the other instance has written its own
+    rendezvous.Wait();
+
+    result.object_ids_consecutive = true;
+    for (std::size_t i = 1; i < object_ids.size(); ++i) {
+        result.object_ids_consecutive &= object_ids[i] == object_ids[0] + i;
+    }
+    result.memory_kept =
+        std::all_of(fcram, fcram + Memory::PAGE_SIZE, [tag](u8 value) { return value == tag; });
+    result.key_kept = HW::AES::GetNormalKey(HW::AES::KeySlotID::SSLKey) == key;
+
+    events.clear();
+    system.Shutdown();
+}
+
+TEST_CASE("Fully initialized Systems on separate threads don't share state", "[core]") {
+    // Later tests in the binary must see the settings they started with
+    const Settings::Values saved_settings = Settings::values;
+    SCOPE_EXIT({ Settings::values = saved_settings; });
+    Settings::values.renderer_backend = Settings::RendererBackend::Null;
+    Settings::values.use_gpu_thread = false;
+    Settings::values.use_cpu_jit = false;
+    Settings::values.enable_dsp_lle = false;
+    Settings::values.sink_id = "null";
+
+    std::array<Core::System, 2> systems;
+    std::array<SystemResult, 2> results;
+    Rendezvous rendezvous(systems.size());
+
+    std::array<std::thread, 2> threads;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i] = std::thread([&, i] {
+            RunSystem(systems[i], static_cast<u8>(0x10 + i), rendezvous, results[i]);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (const SystemResult& result : results) {
+        REQUIRE(result.initialized);
+        REQUIRE(result.object_ids_consecutive);
+        REQUIRE(result.memory_kept);
+        REQUIRE(result.key_kept);
+        REQUIRE(result.gsp_service != nullptr);
+    }
+    REQUIRE(results[0].gsp_service != results[1].gsp_service);
+}
+
+} // namespace ArmTests
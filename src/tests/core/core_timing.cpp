@@ -4,9 +4,15 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <random>
 #include <string>
+#include <tuple>
+#include <vector>
+#include "common/chunk_file.h"
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -226,3 +232,319 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
 }
+
+TEST_CASE("CoreTiming[DoState]", "[core]") {
+    std::vector<u8> state;
+    {
+        Core::Timing timing;
+
+        Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+        Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+        Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+        // Enter slice 0
+        timing.Advance();
+
+        timing.ScheduleEvent(300, cb_c, CB_IDS[2]);
+        timing.ScheduleEvent(100, cb_a, CB_IDS[0]);
+        timing.ScheduleEvent(200, cb_b, CB_IDS[1]);
+
+        u8* ptr = nullptr;
+        PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+        timing.DoState(p_measure);
+        state.resize(reinterpret_cast<std::size_t>(ptr));
+
+        ptr = state.data();
+        PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+        timing.DoState(p_write);
+        REQUIRE(ptr == state.data() + state.size());
+    }
+
+    Core::Timing timing;
+    timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    u8* ptr = state.data();
+    PointerWrap p_read(&ptr, PointerWrap::MODE_READ);
+    timing.DoState(p_read);
+    REQUIRE(p_read.error == PointerWrap::ERROR_NONE);
+    REQUIRE(100 == timing.GetDowncount());
+
+    AdvanceAndCheck(timing, 0, 100);
+    AdvanceAndCheck(timing, 1, 100);
+    AdvanceAndCheck(timing, 2, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[DoStateUnknownEvent]", "[core]") {
+    std::vector<u8> state;
+    {
+        Core::Timing timing;
+        Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+        timing.Advance();
+        timing.ScheduleEvent(100, cb_a, CB_IDS[0]);
+
+        u8* ptr = nullptr;
+        PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+        timing.DoState(p_measure);
+        state.resize(reinterpret_cast<std::size_t>(ptr));
+
+        ptr = state.data();
+        PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+        timing.DoState(p_write);
+    }
+
+    Core::Timing timing;
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    timing.Advance();
+    timing.ScheduleEvent(500, cb_b, CB_IDS[1]);
+
+    u8* ptr = state.data();
+    PointerWrap p_read(&ptr, PointerWrap::MODE_READ);
+    timing.DoState(p_read);
+    REQUIRE(p_read.error == PointerWrap::ERROR_FAILURE);
+
+    // The existing queue must be left untouched
+    REQUIRE(500 == timing.GetDowncount());
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[UnscheduleByHandle]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.Advance();
+
+    const auto handle_a = timing.ScheduleEvent(100, cb_a, CB_IDS[0]);
+    const auto handle_b = timing.ScheduleEvent(200, cb_b, CB_IDS[1]);
+    REQUIRE(timing.UnscheduleEvent(handle_a));
+    REQUIRE(!timing.UnscheduleEvent(handle_a));
+
+    // The event reusing the storage of A isn't affected by the stale handle
+    timing.ScheduleEvent(300, cb_a, CB_IDS[0]);
+    REQUIRE(!timing.UnscheduleEvent(handle_a));
+
+    AdvanceAndCheck(timing, 1, 100, 0, -100);
+    REQUIRE(!timing.UnscheduleEvent(handle_b));
+    AdvanceAndCheck(timing, 0, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[FastForward]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.Advance();
+
+    timing.ScheduleEvent(100000, cb_a, CB_IDS[0]);
+    timing.ScheduleEvent(100010, cb_b, CB_IDS[1]);
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
+
+    // Run part of the slice, then skip past the following slices up to A
+    timing.AddTicks(1000);
+    timing.FastForwardToNextEvent();
+    REQUIRE(100000 == timing.GetTicks());
+    REQUIRE(99000 == timing.GetIdleTicks());
+    REQUIRE(100000 - MAX_SLICE_LENGTH == timing.GetFastForwardedTicks());
+    REQUIRE(1 == timing.GetFastForwardCount());
+    AdvanceAndCheck(timing, 0, 10);
+
+    // B is the end of the slice already, so this is only idling
+    timing.FastForwardToNextEvent();
+    REQUIRE(1 == timing.GetFastForwardCount());
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+
+    // Without any event, the time moves by a bounded amount
+    constexpr u64 MAX_FAST_FORWARD_LENGTH = BASE_CLOCK_RATE_ARM11 / 60; // Copied as well
+    const u64 ticks = timing.GetTicks();
+    timing.FastForwardToNextEvent();
+    REQUIRE(ticks + MAX_SLICE_LENGTH + MAX_FAST_FORWARD_LENGTH == timing.GetTicks());
+    REQUIRE(2 == timing.GetFastForwardCount());
+}
+
+namespace WheelOrderTest {
+struct Fired {
+    u64 id;
+    s64 ticks;
+    int cycles_late;
+
+    /// Whether the event ran at or after `time`, with a matching (truncated) lateness
+    bool RanLateBy(s64 time) const {
+        return ticks >= time && static_cast<int>(ticks - time) == cycles_late;
+    }
+};
+static std::vector<Fired> fired;
+static Core::Timing* current_timing = nullptr;
+
+static void RecordCallback(u64 userdata, int cycles_late) {
+    // The lateness is truncated to an int when jumping far ahead, so keep the time as well
+    fired.push_back({userdata, static_cast<s64>(current_timing->GetTicks()), cycles_late});
+}
+} // namespace WheelOrderTest
+
+TEST_CASE("CoreTiming[WheelOrder]", "[core]") {
+    using namespace WheelOrderTest;
+
+    // Runs the same randomized schedule twice, the events must run in (time, scheduling order)
+    // both times, whatever the distance to their time.
+    std::vector<Fired> previous_run;
+    for (int run = 0; run < 2; ++run) {
+        Core::Timing timing;
+        current_timing = &timing;
+        fired.clear();
+        Core::TimingEventType* cb = timing.RegisterEvent("callback", RecordCallback);
+        Core::TimingEventType* cb_removed = timing.RegisterEvent("removed", [](u64, s64) {});
+        timing.Advance();
+
+        std::mt19937_64 rng(1234);
+        std::vector<std::tuple<s64, u64>> expected; // (time, id), ids are in scheduling order
+        std::vector<Core::Timing::EventHandle> handles;
+        for (u64 id = 0; id < 4000; ++id) {
+            // Mix near events, far events, shared times and events of all wheel levels
+            const int shift = static_cast<int>(rng() % 48);
+            const s64 delay =
+                id % 7 == 0 ? 1000 : static_cast<s64>(rng() & ((u64{1} << shift) - 1));
+            const s64 time = static_cast<s64>(timing.GetTicks()) + delay;
+            if (id % 11 == 0) {
+                timing.ScheduleEvent(delay, cb_removed, id);
+                continue;
+            }
+            handles.push_back(timing.ScheduleEvent(delay, cb, id));
+            expected.emplace_back(time, id);
+
+            // Let time pass every now and then, so events are added at many wheel positions
+            if (id % 64 == 0) {
+                timing.AddTicks(static_cast<u64>(rng() % 100000));
+                timing.Advance();
+            }
+        }
+        timing.RemoveEvent(cb_removed);
+
+        // Unschedule a few events by handle, some of which have already run
+        for (std::size_t i = 0; i < handles.size(); i += 13) {
+            const u64 id = std::get<1>(expected[i]);
+            const bool ran = std::any_of(fired.begin(), fired.end(),
+                                         [id](const Fired& f) { return f.id == id; });
+            REQUIRE(timing.UnscheduleEvent(handles[i]) == !ran);
+            if (!ran) {
+                std::get<1>(expected[i]) = ~u64{0};
+            }
+        }
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [](const auto& e) { return std::get<1>(e) == ~u64{0}; }),
+                       expected.end());
+        std::sort(expected.begin(), expected.end());
+
+        // Jump ahead by random amounts, including big ones making many events late at once
+        while (fired.size() < expected.size()) {
+            const u64 jump = rng() % 4 == 0 ? rng() % (u64{1} << 44) : rng() % 50000;
+            timing.AddTicks(timing.GetDowncount() + jump);
+            timing.Advance();
+        }
+
+        REQUIRE(fired.size() == expected.size());
+        for (std::size_t i = 0; i < fired.size(); ++i) {
+            REQUIRE(fired[i].RanLateBy(std::get<0>(expected[i])));
+            REQUIRE(fired[i].id == std::get<1>(expected[i]));
+        }
+        if (run == 1) {
+            REQUIRE(std::equal(fired.begin(), fired.end(), previous_run.begin(),
+                               [](const Fired& a, const Fired& b) {
+                                   return a.id == b.id && a.ticks == b.ticks;
+                               }));
+        }
+        previous_run = fired;
+    }
+    current_timing = nullptr;
+}
+
+TEST_CASE("CoreTiming[DoStateWheel]", "[core]") {
+    using namespace WheelOrderTest;
+
+    // Events spread over all the wheel levels survive a save state in order
+    std::vector<u8> state;
+    std::vector<std::tuple<s64, u64>> expected;
+    {
+        Core::Timing timing;
+        Core::TimingEventType* cb = timing.RegisterEvent("callback", RecordCallback);
+        timing.Advance();
+        for (u64 id = 0; id < 40; ++id) {
+            const s64 delay = s64{1} << id;
+            timing.ScheduleEvent(delay, cb, id);
+            expected.emplace_back(static_cast<s64>(timing.GetTicks()) + delay, id);
+        }
+
+        u8* ptr = nullptr;
+        PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+        timing.DoState(p_measure);
+        state.resize(reinterpret_cast<std::size_t>(ptr));
+        ptr = state.data();
+        PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+        timing.DoState(p_write);
+    }
+
+    Core::Timing timing;
+    current_timing = &timing;
+    fired.clear();
+    timing.RegisterEvent("callback", RecordCallback);
+    u8* ptr = state.data();
+    PointerWrap p_read(&ptr, PointerWrap::MODE_READ);
+    timing.DoState(p_read);
+    REQUIRE(p_read.error == PointerWrap::ERROR_NONE);
+
+    while (fired.size() < expected.size()) {
+        timing.AddTicks(timing.GetDowncount() + (u64{1} << 30));
+        timing.Advance();
+    }
+    for (std::size_t i = 0; i < fired.size(); ++i) {
+        REQUIRE(fired[i].RanLateBy(std::get<0>(expected[i])));
+        REQUIRE(fired[i].id == std::get<1>(expected[i]));
+    }
+    current_timing = nullptr;
+}
+
+TEST_CASE("CoreTiming scheduling benchmark", "[.][benchmark][core]") {
+    // Periodic events rescheduling themselves with different periods, like the audio, HID and GPU
+    // callbacks do, along with events that get unscheduled before they run, like timeouts.
+    constexpr u64 NUM_PERIODIC = 64;
+    constexpr u64 NUM_TIMEOUTS = 256;
+    Core::Timing timing;
+    u64 events_run = 0;
+    Core::TimingEventType* periodic = nullptr;
+    periodic = timing.RegisterEvent("periodic", [&](u64 userdata, s64 cycles_late) {
+        ++events_run;
+        timing.ScheduleEvent(static_cast<s64>(1000 + userdata * 397) - cycles_late, periodic,
+                             userdata);
+    });
+    Core::TimingEventType* timeout = timing.RegisterEvent("timeout", [](u64, s64) {});
+
+    timing.Advance();
+    for (u64 i = 0; i < NUM_PERIODIC; ++i) {
+        timing.ScheduleEvent(static_cast<s64>(i * 100), periodic, i);
+    }
+    std::vector<Core::Timing::EventHandle> timeouts(NUM_TIMEOUTS);
+    for (u64 i = 0; i < NUM_TIMEOUTS; ++i) {
+        timeouts[i] = timing.ScheduleEvent(static_cast<s64>(100000 + i * 7919), timeout, i);
+    }
+
+    constexpr int slices = 2000000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < slices; ++i) {
+        // Replace one pending timeout per slice
+        const u64 index = static_cast<u64>(i) % NUM_TIMEOUTS;
+        timing.UnscheduleEvent(timeouts[index]);
+        timeouts[index] = timing.ScheduleEvent(static_cast<s64>(100000 + index * 7919), timeout,
+                                               index);
+        timing.AddTicks(timing.GetDowncount());
+        timing.Advance();
+    }
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    WARN(events_run / time.count() / 1e6 << " million events/s, " << slices / time.count() / 1e6
+                                         << " million slices/s");
+}
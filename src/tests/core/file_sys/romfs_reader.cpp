@@ -0,0 +1,128 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "core/file_sys/romfs_reader.h"
+
+namespace FileSys {
+
+constexpr std::size_t FILE_OFFSET = 0x200;
+constexpr std::size_t CRYPTO_OFFSET = 0x1000;
+constexpr std::size_t DATA_SIZE = 100 * RomFSReader::BLOCK_SIZE + 0x123;
+constexpr std::array<u8, 16> KEY{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+constexpr std::array<u8, 16> CTR{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                                 0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+
+/// Path of a file in the temporary directory, which is deleted when leaving the scope
+struct TempFile {
+    explicit TempFile(const std::string& name) : path(FileUtil::GetTempDir() + DIR_SEP + name) {
+        // Don't read what an earlier crashed run left behind
+        FileUtil::Delete(path);
+    }
+
+    ~TempFile() {
+        FileUtil::Delete(path);
+    }
+
+    const std::string path;
+};
+
+/// Writes an encrypted RomFS image with random contents after some padding.
+class EncryptedRomFS {
+public:
+    EncryptedRomFS() : data(DATA_SIZE) {
+        std::mt19937 rng(42);
+        for (u8& byte : data) {
+            byte = static_cast<u8>(rng());
+        }
+
+        std::vector<u8> encrypted(data);
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(KEY.data(), KEY.size(), CTR.data());
+        e.Seek(CRYPTO_OFFSET);
+        e.ProcessData(encrypted.data(), encrypted.data(), encrypted.size());
+
+        FileUtil::IOFile file(file_path.path, "wb");
+        const std::vector<u8> padding(FILE_OFFSET, 0xCC);
+        file.WriteBytes(padding.data(), padding.size());
+        file.WriteBytes(encrypted.data(), encrypted.size());
+    }
+
+    RomFSReader Open() const {
+        return RomFSReader(FileUtil::IOFile(file_path.path, "rb"), FILE_OFFSET, DATA_SIZE, KEY, CTR,
+                           CRYPTO_OFFSET);
+    }
+
+    // Declared first, so that the file is also deleted if writing it fails
+    const TempFile file_path{"citra_romfs_reader_test.bin"};
+    std::vector<u8> data;
+};
+
+TEST_CASE("RomFSReader returns the decrypted data", "[core][file_sys]") {
+    const EncryptedRomFS romfs;
+    RomFSReader reader = romfs.Open();
+    REQUIRE(reader.GetSize() == DATA_SIZE);
+
+    std::mt19937 rng(1234);
+    std::vector<u8> buffer(DATA_SIZE);
+    for (int i = 0; i < 2000; ++i) {
+        const std::size_t offset = rng() % DATA_SIZE;
+        // Mostly small reads, some of them large enough to bypass the cache
+        const std::size_t max_length = i % 10 == 0 ? DATA_SIZE : 0x1000;
+        const std::size_t length = 1 + rng() % max_length;
+
+        const std::size_t expected_length = std::min(length, DATA_SIZE - offset);
+        REQUIRE(reader.ReadFile(offset, length, buffer.data()) == expected_length);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected_length,
+                           romfs.data.begin() + offset));
+    }
+
+    REQUIRE(reader.ReadFile(DATA_SIZE, 16, buffer.data()) == 0);
+    REQUIRE(reader.ReadFile(0, 0, buffer.data()) == 0);
+}
+
+TEST_CASE("RomFSReader caches blocks and reads ahead", "[core][file_sys]") {
+    const EncryptedRomFS romfs;
+    RomFSReader reader = romfs.Open();
+    constexpr std::size_t BLOCK_SIZE = RomFSReader::BLOCK_SIZE;
+    constexpr std::size_t READ_AHEAD_SIZE = RomFSReader::READ_AHEAD_BLOCKS * BLOCK_SIZE;
+
+    // Sequential small reads only hit the file once per read-ahead window
+    std::vector<u8> buffer(DATA_SIZE);
+    for (std::size_t offset = 0; offset < READ_AHEAD_SIZE; offset += 0x100) {
+        REQUIRE(reader.ReadFile(offset, 0x100, buffer.data() + offset) == 0x100);
+    }
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + READ_AHEAD_SIZE, romfs.data.begin()));
+    REQUIRE(reader.GetStats().cache_misses == 1);
+    REQUIRE(reader.GetStats().bytes_loaded == READ_AHEAD_SIZE);
+    REQUIRE(reader.GetStats().bytes_decrypted == READ_AHEAD_SIZE);
+
+    // Random small reads within cached blocks don't touch the file
+    const u64 hits = reader.GetStats().cache_hits;
+    REQUIRE(reader.ReadFile(3 * BLOCK_SIZE + 5, 10, buffer.data()) == 10);
+    REQUIRE(reader.ReadFile(BLOCK_SIZE - 5, 10, buffer.data()) == 10);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 10, romfs.data.begin() + BLOCK_SIZE - 5));
+    REQUIRE(reader.GetStats().cache_hits == hits + 3);
+    REQUIRE(reader.GetStats().bytes_loaded == READ_AHEAD_SIZE);
+
+    // A non-sequential miss only loads a single block
+    REQUIRE(reader.ReadFile(15 * BLOCK_SIZE, 1, buffer.data()) == 1);
+    REQUIRE(reader.GetStats().bytes_loaded == READ_AHEAD_SIZE + BLOCK_SIZE);
+
+    // Large reads bypass the cache
+    REQUIRE(reader.ReadFile(0, READ_AHEAD_SIZE, buffer.data()) == READ_AHEAD_SIZE);
+    REQUIRE(reader.GetStats().bytes_loaded == 2 * READ_AHEAD_SIZE + BLOCK_SIZE);
+    REQUIRE(reader.GetStats().cache_misses == 2);
+    REQUIRE(reader.GetStats().reads == READ_AHEAD_SIZE / 0x100 + 4);
+    REQUIRE(reader.GetStats().GetHitRate() > 0.9);
+}
+
+} // namespace FileSys
@@ -0,0 +1,204 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace Kernel {
+
+/// A kernel whose threads can be created and put to wait without running them
+class WaitEnvironment {
+public:
+    WaitEnvironment() {
+        // Threads get their context from the CPU core
+        Core::System& system = Core::System::GetInstance();
+        system.cpu_core = std::make_unique<ARM_DynCom>(system, USER32MODE);
+    }
+
+    ~WaitEnvironment() {
+        Core::System::GetInstance().cpu_core.reset();
+    }
+
+    SharedPtr<Thread> CreateThread(u32 priority) {
+        return kernel.CreateThread("waiter", 0x1000, priority, 0, ThreadProcessorId0,
+                                   Memory::HEAP_VADDR_END, *kernel.GetCurrentProcess())
+            .Unwrap();
+    }
+
+    /// Makes the thread wait like svcWaitSynchronizationN does
+    static void Wait(const SharedPtr<Thread>& thread, std::vector<SharedPtr<WaitObject>> objects,
+                     ThreadStatus status = ThreadStatus::WaitSynchAny) {
+        thread->status = status;
+        for (const auto& object : objects) {
+            object->AddWaitingThread(thread);
+        }
+        thread->wait_objects = std::move(objects);
+    }
+
+    ArmTests::TestEnvironment test_env{true};
+    KernelSystem& kernel = *Core::System::GetInstance().kernel;
+};
+
+/// Returns the index of the only thread that was woken up, or -1, and marks it as handled
+static int TakeWokenThread(const std::vector<SharedPtr<Thread>>& threads) {
+    int woken = -1;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        if (threads[i]->status == ThreadStatus::Ready) {
+            REQUIRE(woken == -1);
+            woken = static_cast<int>(i);
+            threads[i]->status = ThreadStatus::Dormant;
+        }
+    }
+    return woken;
+}
+
+TEST_CASE("WaitObject wakes up threads by priority, then in wait order", "[core][kernel]") {
+    WaitEnvironment env;
+    auto event = env.kernel.CreateEvent(ResetType::OneShot, "event");
+
+    std::vector<SharedPtr<Thread>> threads;
+    for (const u32 priority : {30, 20, 30, 10, 20, 40}) {
+        threads.push_back(env.CreateThread(priority));
+        WaitEnvironment::Wait(threads.back(), {event});
+    }
+    REQUIRE(event->GetHighestWaitingPriority() == 10u);
+
+    // Changing the priority of a waiting thread keeps its place among the threads of the new one
+    threads[5]->SetPriority(20);
+    threads[3]->SetPriority(25);
+    REQUIRE(event->GetHighestWaitingPriority() == 20u);
+
+    // A one shot event wakes up a single thread per signal
+    std::vector<int> order;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        event->Signal();
+        order.push_back(TakeWokenThread(threads));
+    }
+    REQUIRE(order == std::vector<int>{1, 4, 5, 3, 0, 2});
+    REQUIRE(!event->GetHighestWaitingPriority());
+    REQUIRE(event->GetWaitingThreads().empty());
+}
+
+TEST_CASE("WaitObject skips threads that aren't ready", "[core][kernel]") {
+    WaitEnvironment env;
+    auto event_a = env.kernel.CreateEvent(ResetType::Sticky, "a");
+    auto event_b = env.kernel.CreateEvent(ResetType::Sticky, "b");
+
+    auto wait_all = env.CreateThread(5);
+    auto wait_any = env.CreateThread(10);
+    WaitEnvironment::Wait(wait_all, {event_a, event_b}, ThreadStatus::WaitSynchAll);
+    WaitEnvironment::Wait(wait_any, {event_a});
+    REQUIRE(event_a->GetWaitingThreads() == std::vector<SharedPtr<Thread>>{wait_all, wait_any});
+
+    event_a->Signal();
+    REQUIRE(wait_all->status == ThreadStatus::WaitSynchAll);
+    REQUIRE(wait_any->status == ThreadStatus::Ready);
+
+    event_b->Signal();
+    REQUIRE(wait_all->status == ThreadStatus::Ready);
+    REQUIRE(event_a->GetWaitingThreads().empty());
+    REQUIRE(event_b->GetWaitingThreads().empty());
+}
+
+TEST_CASE("AddressArbiter wakes up the threads of the signaled address", "[core][kernel]") {
+    constexpr VAddr ADDRESS_A = 0x10000000;
+    constexpr VAddr ADDRESS_B = 0x10000004;
+    WaitEnvironment env;
+    env.test_env.SetMemory32(ADDRESS_A, 0);
+    env.test_env.SetMemory32(ADDRESS_B, 0);
+    auto arbiter = env.kernel.CreateAddressArbiter("arbiter");
+
+    std::vector<SharedPtr<Thread>> threads;
+    for (const u32 priority : {30, 20, 30, 20, 0}) {
+        threads.push_back(env.CreateThread(priority));
+    }
+    for (std::size_t i = 0; i < 4; ++i) {
+        REQUIRE(arbiter->ArbitrateAddress(threads[i], ArbitrationType::WaitIfLessThan, ADDRESS_A,
+                                          1, 0) == RESULT_SUCCESS);
+    }
+    REQUIRE(arbiter->ArbitrateAddress(threads[4], ArbitrationType::WaitIfLessThan, ADDRESS_B, 1,
+                                      0) == RESULT_SUCCESS);
+
+    // A thread timing out is no longer considered
+    auto timed_out = env.CreateThread(0);
+    REQUIRE(arbiter->ArbitrateAddress(timed_out, ArbitrationType::WaitIfLessThanWithTimeout,
+                                      ADDRESS_A, 1, 1000) == RESULT_TIMEOUT);
+    Core::Timing& timing = Core::System::GetInstance().CoreTiming();
+    timing.AddTicks(timing.GetDowncount() + nsToCycles(1000));
+    timing.Advance();
+    REQUIRE(timed_out->status == ThreadStatus::Ready);
+
+    // The priority is the one when signaled, ties are broken by wait order
+    threads[2]->SetPriority(10);
+    std::vector<int> order;
+    for (int i = 0; i < 3; ++i) {
+        arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, ADDRESS_A, 1, 0);
+        order.push_back(TakeWokenThread(threads));
+    }
+    REQUIRE(order == std::vector<int>{2, 1, 3});
+
+    arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, ADDRESS_A, -1, 0);
+    REQUIRE(TakeWokenThread(threads) == 0);
+    arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, ADDRESS_A, -1, 0);
+    REQUIRE(TakeWokenThread(threads) == -1);
+
+    arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, ADDRESS_B, 2, 0);
+    REQUIRE(TakeWokenThread(threads) == 4);
+}
+
+TEST_CASE("Kernel wakeup benchmark", "[.][benchmark][kernel]") {
+    // Dozens of worker threads blocked on one event or address, woken up all at once
+    constexpr int NUM_THREADS = 48;
+    constexpr int ITERATIONS = 5000;
+    constexpr VAddr ADDRESS = 0x10000000;
+    WaitEnvironment env;
+    env.test_env.SetMemory32(ADDRESS, 0);
+    auto event = env.kernel.CreateEvent(ResetType::Sticky, "event");
+    auto arbiter = env.kernel.CreateAddressArbiter("arbiter");
+
+    std::vector<SharedPtr<Thread>> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.push_back(env.CreateThread(20 + i % 8));
+    }
+
+    for (const bool use_arbiter : {false, true}) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            for (const auto& thread : threads) {
+                if (use_arbiter) {
+                    arbiter->ArbitrateAddress(thread, ArbitrationType::WaitIfLessThan, ADDRESS, 1,
+                                              0);
+                } else {
+                    WaitEnvironment::Wait(thread, {event});
+                }
+            }
+            if (use_arbiter) {
+                // Wake them up one by one, like a semaphore being released
+                arbiter->ArbitrateAddress(nullptr, ArbitrationType::Signal, ADDRESS,
+                                          NUM_THREADS, 0);
+            } else {
+                event->Signal();
+                event->Clear();
+            }
+        }
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+        REQUIRE(threads.back()->status == ThreadStatus::Ready);
+        WARN((use_arbiter ? "arbiter: " : "event: ")
+             << NUM_THREADS * ITERATIONS / time.count() / 1e6 << " million wakeups/s");
+    }
+}
+
+} // namespace Kernel
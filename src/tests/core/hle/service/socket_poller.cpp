@@ -0,0 +1,231 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/hle/service/socket_poller.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket(x) close(x)
+#endif
+
+namespace Service::SOC {
+
+/// Completions reported by the socket worker, which can be waited for on the test thread
+class Completions {
+public:
+    void Push(u64 id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.insert(id);
+        cv.notify_all();
+    }
+
+    /// Waits for a request to complete, with a generous timeout to fail instead of hanging
+    bool Wait(u64 id) {
+        std::unique_lock<std::mutex> lock(mutex);
+        const bool completed =
+            cv.wait_for(lock, std::chrono::seconds(10), [&] { return ids.count(id) != 0; });
+        ids.erase(id);
+        return completed;
+    }
+
+    bool Contains(u64 id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ids.count(id) != 0;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::set<u64> ids;
+};
+
+/// A connected pair of loopback TCP sockets, the server end being non-blocking
+class LoopbackConnection {
+public:
+    LoopbackConnection() {
+#ifdef _WIN32
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        const u32 listener = static_cast<u32>(::socket(AF_INET, SOCK_STREAM, 0));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        REQUIRE(::bind(listener, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0);
+        REQUIRE(::listen(listener, 1) == 0);
+        REQUIRE(::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0);
+
+        client = static_cast<u32>(::socket(AF_INET, SOCK_STREAM, 0));
+        REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0);
+        server = static_cast<u32>(::accept(listener, nullptr, nullptr));
+        REQUIRE(static_cast<s32>(server) != -1);
+        REQUIRE(SetNonBlocking(server));
+        closesocket(listener);
+    }
+
+    ~LoopbackConnection() {
+        closesocket(client);
+        closesocket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    void Send(const void* data, std::size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            const int chunk = static_cast<int>(std::min<std::size_t>(size, 1 << 20));
+            const auto sent = ::send(client, bytes, chunk, 0);
+            REQUIRE(sent > 0);
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+    }
+
+    /// Reads what is available on the server end, returning the number of bytes read
+    std::size_t Receive(std::vector<char>& buffer) {
+        std::size_t received = 0;
+        while (true) {
+            const auto ret = ::recv(server, buffer.data() + received,
+                                    static_cast<int>(buffer.size() - received), 0);
+            if (ret <= 0) {
+                return received;
+            }
+            received += static_cast<std::size_t>(ret);
+            if (received == buffer.size()) {
+                return received;
+            }
+        }
+    }
+
+    u32 client;
+    u32 server;
+};
+
+TEST_CASE("SocketPoller runs operations once their socket is ready", "[core][soc]") {
+    LoopbackConnection connection;
+    Completions completions;
+    SocketPoller poller([&completions](u64 id) { completions.Push(id); });
+
+    std::vector<char> buffer(16);
+    std::size_t received = 0;
+    int attempts = 0;
+    const u64 id = poller.Submit({{connection.server, POLLIN}}, [&] {
+        ++attempts;
+        received = connection.Receive(buffer);
+        return received != 0;
+    });
+    REQUIRE(id != 0);
+    REQUIRE(!completions.Contains(id));
+
+    connection.Send("ping", 4);
+    REQUIRE(completions.Wait(id));
+    REQUIRE(received == 4);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 4, "ping"));
+    REQUIRE(attempts >= 1);
+
+    // A completed request can't be cancelled anymore
+    REQUIRE(!poller.Cancel(id));
+}
+
+TEST_CASE("SocketPoller drops cancelled requests", "[core][soc]") {
+    LoopbackConnection connection;
+    Completions completions;
+    SocketPoller poller([&completions](u64 id) { completions.Push(id); });
+
+    bool ran = false;
+    const auto operation = [&ran] {
+        ran = true;
+        return true;
+    };
+    const u64 first = poller.Submit({{connection.server, POLLIN}}, operation);
+    const u64 second = poller.Submit({{connection.server, POLLIN}}, operation);
+    const u64 other = poller.Submit({{connection.client, POLLIN}}, operation);
+    REQUIRE(poller.Cancel(first));
+    REQUIRE(!poller.Cancel(first));
+    REQUIRE(poller.CancelSocket(connection.server) == std::vector<u64>{second});
+    REQUIRE(poller.CancelSocket(connection.server).empty());
+
+    // The remaining request still completes
+    const char byte = 0;
+    REQUIRE(::send(connection.server, &byte, 1, 0) == 1);
+    REQUIRE(completions.Wait(other));
+    REQUIRE(ran);
+    REQUIRE(!completions.Contains(first));
+    REQUIRE(!completions.Contains(second));
+}
+
+TEST_CASE("SocketPoller benchmark", "[.][benchmark][soc]") {
+    LoopbackConnection connection;
+    Completions completions;
+    SocketPoller poller([&completions](u64 id) { completions.Push(id); });
+    std::vector<char> buffer(64 * 1024);
+    std::size_t received = 0;
+    const auto receive = [&] {
+        received = connection.Receive(buffer);
+        return received != 0;
+    };
+
+    // Wakeup latency: time from a byte being sent until the worker completed the receive
+    constexpr int ITERATIONS = 2000;
+    std::vector<double> latencies_us;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        const u64 id = poller.Submit({{connection.server, POLLIN}}, receive);
+        const auto start = std::chrono::steady_clock::now();
+        connection.Send("x", 1);
+        REQUIRE(completions.Wait(id));
+        latencies_us.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count());
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    double total_us = 0.0;
+    for (const double latency : latencies_us) {
+        total_us += latency;
+    }
+    WARN("wakeup latency: mean " << total_us / ITERATIONS << "us, p50 "
+                                 << latencies_us[ITERATIONS / 2] << "us, p99 "
+                                 << latencies_us[ITERATIONS * 99 / 100] << "us");
+
+    // Throughput: the client streams data while every chunk is received through the worker
+    constexpr std::size_t TOTAL_SIZE = 256 * 1024 * 1024;
+    const auto start = std::chrono::steady_clock::now();
+    std::thread sender([&connection] {
+        const std::vector<char> data(1024 * 1024);
+        for (std::size_t sent = 0; sent < TOTAL_SIZE; sent += data.size()) {
+            connection.Send(data.data(), data.size());
+        }
+    });
+    std::size_t total_received = 0;
+    u64 requests = 0;
+    while (total_received < TOTAL_SIZE) {
+        const u64 id = poller.Submit({{connection.server, POLLIN}}, receive);
+        REQUIRE(completions.Wait(id));
+        total_received += received;
+        ++requests;
+    }
+    sender.join();
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(total_received == TOTAL_SIZE);
+    WARN("throughput: " << TOTAL_SIZE / time.count() / (1024 * 1024) << " MiB/s in " << requests
+                        << " requests");
+}
+
+} // namespace Service::SOC
@@ -2,13 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
+#include <thread>
 #include <catch2/catch.hpp>
+#include "common/scope_exit.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/shared_page.h"
 #include "core/memory.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/video_core.h"
 
 TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
     // HACK: see comments of member timing
@@ -55,3 +61,65 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+namespace {
+class NullWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+};
+} // Anonymous namespace
+
+TEST_CASE("Memory::RasterizerMarkRegionCached on the GPU thread", "[core][memory]") {
+    // HACK: see comments of member timing
+    Core::System::GetInstance().timing = std::make_unique<Core::Timing>();
+    Core::System::GetInstance().memory = std::make_unique<Memory::MemorySystem>();
+    Memory::MemorySystem& memory = *Core::System::GetInstance().memory;
+    Kernel::KernelSystem kernel(memory, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    Memory::PageTable& page_table = process->vm_manager.page_table;
+    memory.SetCurrentPageTable(&page_table);
+    const std::size_t page = Memory::VRAM_VADDR >> Memory::PAGE_BITS;
+
+    NullWindow window;
+    auto& gpu_thread = VideoCore::GetGPUThread();
+    gpu_thread = std::make_unique<VideoCore::GPUThread>(window);
+    SCOPE_EXIT({ gpu_thread.reset(); });
+
+    SECTION("writes right after a surface registers go through the rasterizer") {
+        std::atomic<bool> registered{false};
+        bool cached_when_registered = false;
+        gpu_thread->PushCommand([&] {
+            memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::PAGE_SIZE, true);
+            // The surface is loaded from here on
+            cached_when_registered =
+                page_table.attributes[page] == Memory::PageType::RasterizerCachedMemory;
+            registered = true;
+        });
+
+        // Stands in for the emulation loop, which runs the work of the GPU thread between slices
+        while (!registered) {
+            gpu_thread->RunEmulationThreadWork();
+            std::this_thread::yield();
+        }
+        CHECK(cached_when_registered);
+        CHECK(page_table.pointers[page] == nullptr);
+
+        memory.Write32(Memory::VRAM_VADDR, 0x12345678);
+        CHECK(memory.Read32(Memory::VRAM_VADDR) == 0x12345678);
+    }
+
+    SECTION("uncached regions are mapped again once the fence is reached") {
+        const u64 fence = gpu_thread->PushCommand([&] {
+            memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::PAGE_SIZE, true);
+            memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::PAGE_SIZE, false);
+        });
+        gpu_thread->WaitForFence(fence);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+        CHECK(page_table.pointers[page] != nullptr);
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "core/perf_stats.h"
+
+using Core::PerfStats;
+using namespace std::chrono_literals;
+
+static double GetSubsystemTime(const PerfStats::BenchmarkResults& results,
+                               PerfStats::Subsystem subsystem) {
+    return results.subsystem_times[static_cast<std::size_t>(subsystem)];
+}
+
+TEST_CASE("PerfStats only measures subsystems while benchmarking", "[core]") {
+    PerfStats perf_stats;
+    {
+        PerfStats::SubsystemScope scope{perf_stats, PerfStats::Subsystem::CPU};
+        std::this_thread::sleep_for(1ms);
+    }
+    perf_stats.BeginBenchmark(0us);
+    const auto results = perf_stats.GetBenchmarkResults(0us);
+    for (const double time : results.subsystem_times) {
+        REQUIRE(time == 0.0);
+    }
+}
+
+TEST_CASE("PerfStats charges nested subsystems exclusively", "[core]") {
+    PerfStats perf_stats;
+    perf_stats.BeginBenchmark(0us);
+
+    const auto begin = std::chrono::steady_clock::now();
+    {
+        PerfStats::SubsystemScope cpu_scope{perf_stats, PerfStats::Subsystem::CPU};
+        std::this_thread::sleep_for(5ms);
+        {
+            PerfStats::SubsystemScope kernel_scope{perf_stats, PerfStats::Subsystem::Kernel};
+            std::this_thread::sleep_for(5ms);
+            PerfStats::SubsystemScope gpu_scope{perf_stats, PerfStats::Subsystem::GPU};
+            std::this_thread::sleep_for(5ms);
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    const auto results = perf_stats.GetBenchmarkResults(0us);
+    const double cpu = GetSubsystemTime(results, PerfStats::Subsystem::CPU);
+    const double kernel = GetSubsystemTime(results, PerfStats::Subsystem::Kernel);
+    const double gpu = GetSubsystemTime(results, PerfStats::Subsystem::GPU);
+    REQUIRE(cpu >= 0.010);
+    REQUIRE(kernel >= 0.005);
+    REQUIRE(gpu >= 0.005);
+    REQUIRE(cpu + kernel + gpu <= elapsed.count());
+    REQUIRE(GetSubsystemTime(results, PerfStats::Subsystem::Other) == 0.0);
+}
+
+TEST_CASE("PerfStats records each frame of a benchmark", "[core]") {
+    PerfStats perf_stats;
+    perf_stats.BeginSystemFrame();
+    perf_stats.EndSystemFrame();
+    perf_stats.EndGameFrame();
+
+    perf_stats.BeginBenchmark(1'000'000us);
+    for (int i = 0; i < 3; ++i) {
+        perf_stats.BeginSystemFrame();
+        std::this_thread::sleep_for(1ms);
+        perf_stats.EndSystemFrame();
+    }
+    perf_stats.EndGameFrame();
+
+    const auto results = perf_stats.GetBenchmarkResults(1'050'000us);
+    REQUIRE(results.system_frames == 3);
+    REQUIRE(results.game_frames == 1);
+    REQUIRE(results.frame_times.size() == 3);
+    for (const double frame_time : results.frame_times) {
+        REQUIRE(frame_time >= 0.001);
+    }
+    REQUIRE(results.emulated_time == Approx(0.05));
+    REQUIRE(results.walltime >= 0.003);
+}
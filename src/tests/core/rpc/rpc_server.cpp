@@ -0,0 +1,154 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <future>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/scope_exit.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "core/rpc/packet.h"
+#include "core/rpc/rpc_server.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace RPC {
+
+namespace {
+
+struct Reply {
+    u32 version;
+    std::vector<u8> data;
+};
+
+/// Appends u32 values to the data of a request
+void Append(std::vector<u8>& data, std::initializer_list<u32> values) {
+    for (const u32 value : values) {
+        const std::size_t offset = data.size();
+        data.resize(offset + sizeof(value));
+        std::memcpy(data.data() + offset, &value, sizeof(value));
+    }
+}
+
+/// Queues a request to the server, as the ZeroMQ worker does, and waits for its reply
+Reply SendRequest(RPCServer& server, u32 version, PacketType type, const std::vector<u8>& data) {
+    std::promise<Reply> reply;
+    const PacketHeader header{version, 1, type, static_cast<u32>(data.size())};
+    server.QueueRequest(std::make_unique<Packet>(header, data.data(), [&reply](Packet& packet) {
+        reply.set_value({packet.GetVersion(), packet.GetPacketData()});
+    }));
+    return reply.get_future().get();
+}
+
+std::vector<u8> StatusReply(ReplyStatus status) {
+    std::vector<u8> data;
+    Append(data, {static_cast<u32>(status)});
+    return data;
+}
+
+std::vector<u8> ReadMemory(RPCServer& server, u32 address, u32 size) {
+    std::vector<u8> request;
+    Append(request, {address, size});
+    return SendRequest(server, CURRENT_VERSION, PacketType::ReadMemory, request).data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RPCServer only writes within the writable regions", "[core][rpc]") {
+    ArmTests::TestEnvironment test_env(true);
+    Core::System::GetInstance().cpu_core =
+        std::make_unique<ARM_DynCom>(Core::System::GetInstance(), USER32MODE);
+    SCOPE_EXIT({ Core::System::GetInstance().cpu_core.reset(); });
+    RPCServer server;
+
+    const std::vector<u8> contents{0x11, 0x22, 0x33, 0x44};
+    // Straddles the end of the heap
+    const u32 unwritable_address = Memory::HEAP_VADDR_END - 2;
+    const std::vector<u8> unwritable_before = ReadMemory(server, unwritable_address, 4);
+
+    SECTION("WriteMemory") {
+        std::vector<u8> request;
+        Append(request, {Memory::HEAP_VADDR, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        Reply reply = SendRequest(server, CURRENT_VERSION, PacketType::WriteMemory, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::Success));
+        CHECK(ReadMemory(server, Memory::HEAP_VADDR, 4) == contents);
+
+        request.clear();
+        Append(request, {unwritable_address, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        reply = SendRequest(server, CURRENT_VERSION, PacketType::WriteMemory, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::AddressNotWritable));
+        CHECK(ReadMemory(server, unwritable_address, 4) == unwritable_before);
+    }
+
+    SECTION("WriteMemoryScatter writes nothing if any range isn't writable") {
+        std::vector<u8> request;
+        Append(request, {2, Memory::HEAP_VADDR, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        Append(request, {unwritable_address, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        const std::vector<u8> heap_before = ReadMemory(server, Memory::HEAP_VADDR, 4);
+
+        Reply reply = SendRequest(server, CURRENT_VERSION, PacketType::WriteMemoryScatter, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::AddressNotWritable));
+        CHECK(ReadMemory(server, Memory::HEAP_VADDR, 4) == heap_before);
+        CHECK(ReadMemory(server, unwritable_address, 4) == unwritable_before);
+
+        request.clear();
+        Append(request, {1, Memory::HEAP_VADDR, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        reply = SendRequest(server, CURRENT_VERSION, PacketType::WriteMemoryScatter, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::Success));
+        CHECK(ReadMemory(server, Memory::HEAP_VADDR, 4) == contents);
+    }
+
+    SECTION("SetWatchList reports malformed lists") {
+        std::vector<u8> request;
+        Append(request, {1, Memory::HEAP_VADDR, 4});
+        Reply reply = SendRequest(server, CURRENT_VERSION, PacketType::SetWatchList, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::Success));
+
+        // The count doesn't match the ranges
+        request.clear();
+        Append(request, {2, Memory::HEAP_VADDR, 4});
+        reply = SendRequest(server, CURRENT_VERSION, PacketType::SetWatchList, request);
+        CHECK(reply.data == StatusReply(ReplyStatus::InvalidRequest));
+    }
+
+    SECTION("version 1 requests keep their limits and empty write replies") {
+        std::vector<u8> request;
+        Append(request, {Memory::HEAP_VADDR, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        Reply reply = SendRequest(server, 1, PacketType::WriteMemory, request);
+        CHECK(reply.version == 1);
+        CHECK(reply.data.empty());
+        CHECK(ReadMemory(server, Memory::HEAP_VADDR, 4) == contents);
+
+        request.clear();
+        Append(request, {unwritable_address, 4});
+        request.insert(request.end(), contents.begin(), contents.end());
+        reply = SendRequest(server, 1, PacketType::WriteMemory, request);
+        CHECK(reply.data.empty());
+        CHECK(ReadMemory(server, unwritable_address, 4) == unwritable_before);
+
+        // Larger than the data of a version 1 packet
+        request.clear();
+        Append(request, {Memory::HEAP_VADDR, MAX_PACKET_DATA_SIZE});
+        request.resize(request.size() + MAX_PACKET_DATA_SIZE);
+        reply = SendRequest(server, 1, PacketType::WriteMemory, request);
+        CHECK(reply.data.empty());
+        CHECK(ReadMemory(server, Memory::HEAP_VADDR, 4) == contents);
+
+        // Version 2 request types are rejected
+        request.clear();
+        Append(request, {1, Memory::HEAP_VADDR, 4});
+        reply = SendRequest(server, 1, PacketType::SetWatchList, request);
+        CHECK(reply.data.empty());
+    }
+}
+
+} // namespace RPC
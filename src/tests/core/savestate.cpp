@@ -0,0 +1,146 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/scope_exit.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+#include "core/settings.h"
+
+namespace Core {
+
+namespace {
+
+class NullWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+};
+
+/// Size of the SnapshotHeader in front of the payload
+constexpr std::size_t HEADER_SIZE = 64;
+/// Offset of SnapshotHeader::payload_size
+constexpr std::size_t PAYLOAD_SIZE_OFFSET = 32;
+
+bool PageFilledWith(const u8* page, u8 value) {
+    return std::all_of(page, page + Memory::PAGE_SIZE, [value](u8 byte) { return byte == value; });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SaveStateManager round trips", "[core]") {
+    const Settings::Values saved_settings = Settings::values;
+    SCOPE_EXIT({ Settings::values = saved_settings; });
+    Settings::values.renderer_backend = Settings::RendererBackend::Null;
+    Settings::values.use_gpu_thread = false;
+    Settings::values.use_cpu_jit = false;
+    Settings::values.enable_dsp_lle = false;
+    Settings::values.sink_id = "null";
+
+    System system;
+    System::InstanceScope instance_scope{system};
+    NullWindow window;
+    REQUIRE(system.InitWithoutApplication(window) == System::ResultStatus::Success);
+    SCOPE_EXIT({ system.Shutdown(); });
+
+    SaveStateManager& save_states = system.SaveStates();
+    u8* fcram = system.Memory().GetFCRAMPointer(0);
+    u8* vram = system.Memory().GetPhysicalPointer(Memory::VRAM_PADDR);
+    u8* fcram_page = fcram + 3 * Memory::PAGE_SIZE;
+    u8* vram_page = vram + Memory::PAGE_SIZE;
+
+    std::memset(fcram_page, 0x11, Memory::PAGE_SIZE);
+    std::memset(vram_page, 0x22, Memory::PAGE_SIZE);
+    const std::vector<u8> full = save_states.Save(SaveStateManager::SnapshotMode::Full);
+    REQUIRE(!full.empty());
+    const SaveStateManager::Stats full_stats = save_states.GetStats();
+    CHECK(full_stats.snapshot_size == full.size());
+    CHECK(full_stats.pages_stored >= 2);
+    CHECK(full_stats.pages_stored < full_stats.pages_total);
+
+    SECTION("full snapshot") {
+        std::memset(fcram_page, 0x33, Memory::PAGE_SIZE);
+        std::memset(vram_page, 0, Memory::PAGE_SIZE);
+        // Pages that weren't stored are zero once the snapshot is loaded
+        std::memset(fcram, 0x44, Memory::PAGE_SIZE);
+
+        REQUIRE(save_states.Load(full));
+        CHECK(PageFilledWith(fcram_page, 0x11));
+        CHECK(PageFilledWith(vram_page, 0x22));
+        CHECK(PageFilledWith(fcram, 0));
+        CHECK(save_states.GetStats().snapshot_size == full.size());
+        CHECK(save_states.GetStats().pages_stored == full_stats.pages_stored);
+    }
+
+    SECTION("delta snapshot") {
+        std::memset(fcram_page, 0x55, Memory::PAGE_SIZE);
+        const std::vector<u8> delta = save_states.Save(SaveStateManager::SnapshotMode::Delta);
+        REQUIRE(!delta.empty());
+        CHECK(delta.size() < full.size());
+        CHECK(save_states.GetStats().pages_stored == 1);
+
+        std::memset(fcram_page, 0x66, Memory::PAGE_SIZE);
+        std::memset(vram_page, 0x66, Memory::PAGE_SIZE);
+        REQUIRE(save_states.Load(full));
+        CHECK(PageFilledWith(fcram_page, 0x11));
+        REQUIRE(save_states.Load(delta));
+        CHECK(PageFilledWith(fcram_page, 0x55));
+        CHECK(PageFilledWith(vram_page, 0x22));
+        CHECK(save_states.GetStats().snapshot_size == delta.size());
+        CHECK(save_states.GetStats().pages_stored == 1);
+
+        // The delta is now the current snapshot, so it isn't its own parent
+        CHECK(!save_states.Load(delta));
+        // Nor can it be applied on top of the full snapshot after memory moved on from it
+        std::memset(fcram_page, 0x77, Memory::PAGE_SIZE);
+        REQUIRE(save_states.Load(full));
+        system.CoreTiming().AddTicks(1000);
+        CHECK(!save_states.Load(delta));
+    }
+
+    SECTION("mismatching snapshots are rejected without modifying memory") {
+        std::memset(fcram_page, 0x33, Memory::PAGE_SIZE);
+        const u64 snapshot_id = save_states.GetCurrentSnapshotId();
+
+        std::vector<u8> truncated = full;
+        truncated.resize(full.size() - Memory::PAGE_SIZE);
+        CHECK(!save_states.Load(truncated));
+
+        std::vector<u8> header_only = full;
+        header_only.resize(PAYLOAD_SIZE_OFFSET);
+        CHECK(!save_states.Load(header_only));
+
+        // The header claims a smaller payload than the snapshot has
+        std::vector<u8> wrong_size = full;
+        u64 payload_size;
+        std::memcpy(&payload_size, wrong_size.data() + PAYLOAD_SIZE_OFFSET, sizeof(payload_size));
+        CHECK(payload_size == full.size() - HEADER_SIZE);
+        payload_size -= Memory::PAGE_SIZE;
+        std::memcpy(wrong_size.data() + PAYLOAD_SIZE_OFFSET, &payload_size, sizeof(payload_size));
+        CHECK(!save_states.Load(wrong_size));
+
+        std::vector<u8> corrupted = full;
+        corrupted.back() ^= 0xFF;
+        CHECK(!save_states.Load(corrupted));
+
+        std::vector<u8> bad_magic = full;
+        bad_magic[0] = 'X';
+        CHECK(!save_states.Load(bad_magic));
+
+        CHECK(PageFilledWith(fcram_page, 0x33));
+        CHECK(PageFilledWith(vram_page, 0x22));
+        CHECK(save_states.GetCurrentSnapshotId() == snapshot_id);
+        CHECK(save_states.Load(full));
+        CHECK(PageFilledWith(fcram_page, 0x11));
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,140 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/network.h"
+#include "network/verify_user.h"
+
+namespace Network {
+
+constexpr u16 TEST_ROOM_PORT = DefaultRoomPort + 1;
+
+/// Polls the condition until it is met or a timeout expires.
+static bool WaitFor(const std::function<bool()>& condition) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/// Hosts a room on localhost and connects the given number of members to it.
+class RoomFixture {
+public:
+    struct Client {
+        RoomMember member;
+        RoomMember::CallbackHandle<WifiPacket> callback;
+        std::atomic<u32> packets_received{};
+        std::atomic<u64> bytes_received{};
+    };
+
+    explicit RoomFixture(std::size_t num_members) {
+        REQUIRE(Network::Init());
+        REQUIRE(room.Create("Test Room", "", "127.0.0.1", TEST_ROOM_PORT, "", 32, "", "", 0,
+                            std::make_unique<VerifyUser::NullBackend>()));
+
+        for (std::size_t i = 0; i < num_members; ++i) {
+            auto client = std::make_unique<Client>();
+            Client& c = *client;
+            c.callback = c.member.BindOnWifiPacketReceived([&c](const WifiPacket& packet) {
+                c.bytes_received += packet.data.size();
+                ++c.packets_received;
+            });
+            c.member.Join("member_" + std::to_string(i), "console_" + std::to_string(i),
+                          "127.0.0.1", TEST_ROOM_PORT);
+            REQUIRE(WaitFor([&c] { return c.member.GetState() == RoomMember::State::Joined; }));
+            clients.push_back(std::move(client));
+        }
+    }
+
+    ~RoomFixture() {
+        for (auto& client : clients) {
+            client->member.Unbind(client->callback);
+            client->member.Leave();
+        }
+        clients.clear();
+        room.Destroy();
+        Network::Shutdown();
+    }
+
+    void Send(std::size_t sender, const MacAddress& destination, std::size_t size) {
+        WifiPacket packet{};
+        packet.type = WifiPacket::PacketType::Data;
+        packet.data.assign(size, static_cast<u8>(sender));
+        packet.transmitter_address = clients[sender]->member.GetMacAddress();
+        packet.destination_address = destination;
+        clients[sender]->member.SendWifiPacket(packet);
+    }
+
+    Room room;
+    std::vector<std::unique_ptr<Client>> clients;
+};
+
+TEST_CASE("Room relays WiFi packets to their destination", "[network]") {
+    RoomFixture fixture(3);
+    auto& clients = fixture.clients;
+
+    // Broadcasts reach everyone except the sender
+    fixture.Send(0, BroadcastMac, 100);
+    REQUIRE(WaitFor([&] { return clients[1]->packets_received == 1; }));
+    REQUIRE(WaitFor([&] { return clients[2]->packets_received == 1; }));
+    REQUIRE(clients[1]->bytes_received == 100);
+
+    // Unicasts only reach the member with the destination MAC address
+    fixture.Send(0, clients[2]->member.GetMacAddress(), 50);
+    REQUIRE(WaitFor([&] { return clients[2]->packets_received == 2; }));
+    REQUIRE(clients[2]->bytes_received == 150);
+
+    // The packets of each sender arrive in order, so this broadcast is received after anything
+    // the room could have wrongly relayed before
+    fixture.Send(2, BroadcastMac, 10);
+    REQUIRE(WaitFor([&] { return clients[0]->packets_received == 1; }));
+    REQUIRE(WaitFor([&] { return clients[1]->packets_received == 2; }));
+    REQUIRE(clients[0]->bytes_received == 10);
+    REQUIRE(clients[1]->bytes_received == 110);
+}
+
+TEST_CASE("Room relay load generator", "[.][benchmark][network]") {
+    constexpr std::size_t num_members = 16;
+    constexpr std::size_t packets_per_member = 500;
+    constexpr std::size_t packet_size = 512;
+
+    RoomFixture fixture(num_members);
+    auto& clients = fixture.clients;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < packets_per_member; ++i) {
+        for (std::size_t sender = 0; sender < num_members; ++sender) {
+            fixture.Send(sender, BroadcastMac, packet_size);
+        }
+    }
+
+    constexpr u32 expected = packets_per_member * (num_members - 1);
+    REQUIRE(WaitFor([&] {
+        for (const auto& client : clients) {
+            if (client->packets_received < expected) {
+                return false;
+            }
+        }
+        return true;
+    }));
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    const double relayed = static_cast<double>(expected) * num_members;
+    WARN(num_members << " members: " << packets_per_member * num_members << " packets in, "
+                     << relayed << " packets out in " << time.count() << "s ("
+                     << relayed / time.count() << " packets/s relayed)");
+}
+
+} // namespace Network
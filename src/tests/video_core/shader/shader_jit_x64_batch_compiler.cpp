@@ -0,0 +1,239 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+#include "video_core/shader/shader_jit_x64_compiler.h"
+
+using float24 = Pica::float24;
+using JitShader = Pica::Shader::JitShader;
+using JitBatchShader = Pica::Shader::JitBatchShader;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+struct ShaderBinary {
+    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
+    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+};
+
+static std::unique_ptr<ShaderBinary> Assemble(std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    auto binary = std::make_unique<ShaderBinary>();
+    std::transform(shbin.program.begin(), shbin.program.end(), binary->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   binary->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    return binary;
+}
+
+/// Compares the results of running a program per vertex and in batches.
+class BatchShaderTest {
+public:
+    explicit BatchShaderTest(std::initializer_list<nihstro::InlineAsm> code)
+        : binary(Assemble(code)), shader(std::make_unique<JitShader>()),
+          batch_shader(std::make_unique<JitBatchShader>()) {
+        shader->Compile(&binary->program_code, &binary->swizzle_data);
+        batch_shader->Compile(&binary->program_code, &binary->swizzle_data);
+        setup.uniforms.f[0] =
+            Math::MakeVec(float24::FromFloat32(0.5f), float24::FromFloat32(-2.f),
+                          float24::FromFloat32(0.f), float24::FromFloat32(8.f));
+    }
+
+    /// Runs the program on vertices whose first input register is filled with `values`, and
+    /// checks that the first `num_outputs` output registers match.
+    void Check(const std::vector<float>& values, unsigned num_outputs) {
+        const unsigned batch_size = batch_shader->GetBatchSize();
+        auto batch_state = std::make_unique<Pica::Shader::BatchUnitState>();
+        batch_state->address_registers[2] = 0;
+
+        for (std::size_t start = 0; start < values.size(); start += batch_size) {
+            for (unsigned lane = 0; lane < batch_size; ++lane) {
+                for (unsigned comp = 0; comp < 4; ++comp) {
+                    batch_state->registers.input[0][comp][lane] =
+                        Input(values, start + lane, comp);
+                    batch_state->registers.input[1][comp][lane] = 1.5f - comp;
+                }
+            }
+            batch_shader->Run(setup, *batch_state, 0);
+
+            for (unsigned lane = 0; lane < batch_size && start + lane < values.size(); ++lane) {
+                Pica::Shader::UnitState unit;
+                unit.address_registers[2] = 0;
+                for (unsigned comp = 0; comp < 4; ++comp) {
+                    unit.registers.input[0][comp] =
+                        float24::FromFloat32(Input(values, start + lane, comp));
+                    unit.registers.input[1][comp] = float24::FromFloat32(1.5f - comp);
+                }
+                shader->Run(setup, unit, 0);
+
+                for (unsigned reg = 0; reg < num_outputs; ++reg) {
+                    for (unsigned comp = 0; comp < 4; ++comp) {
+                        const float expected = unit.registers.output[reg][comp].ToFloat32();
+                        const float result = batch_state->registers.output[reg][comp][lane];
+                        INFO("input " << values[start + lane] << ", output " << reg << "."
+                                      << comp);
+                        REQUIRE(((std::isnan(expected) && std::isnan(result)) ||
+                                 expected == result));
+                    }
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<ShaderBinary> binary;
+    std::unique_ptr<JitShader> shader;
+    std::unique_ptr<JitBatchShader> batch_shader;
+    Pica::Shader::ShaderSetup setup;
+
+private:
+    /// Spreads the test values over the components of the input register
+    static float Input(const std::vector<float>& values, std::size_t index, unsigned comp) {
+        return values[(index + comp) % values.size()];
+    }
+};
+
+static const std::vector<float> test_values = {
+    NAN, -1.f, 0.f, -0.f, 4.f, 1.e24f, -800.f, 2.f, 6.f, 800.f, 0.5f, 0.25f, -3.75f, 1.5f, 64.f,
+    -INFINITY, INFINITY, 1.e-30f, 79.7262742773f};
+
+TEST_CASE("Batch LG2 and EX2", "[video_core][shader][shader_jit]") {
+    if (!JitBatchShader::IsSupported())
+        return;
+
+    const auto sh_input = SourceRegister::MakeInput(0);
+
+    BatchShaderTest test({
+        // clang-format off
+        {OpCode::Id::LG2, DestRegister::MakeOutput(0), sh_input},
+        {OpCode::Id::EX2, DestRegister::MakeOutput(1), sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(JitBatchShader::CanRunEntryPoint(test.binary->program_code, 0));
+    test.Check(test_values, 2);
+}
+
+TEST_CASE("Batch arithmetic", "[video_core][shader][shader_jit]") {
+    if (!JitBatchShader::IsSupported())
+        return;
+
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_uniform = SourceRegister::MakeFloat(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+
+    BatchShaderTest test({
+        // clang-format off
+        {OpCode::Id::MUL, DestRegister::MakeTemporary(0), sh_input, sh_uniform},
+        {OpCode::Id::ADD, DestRegister::MakeOutput(0), sh_temp, sh_input2},
+        {OpCode::Id::DP3, DestRegister::MakeOutput(1), sh_input, sh_input2},
+        {OpCode::Id::DP4, DestRegister::MakeOutput(2), sh_temp, sh_input},
+        {OpCode::Id::DPH, DestRegister::MakeOutput(3), sh_input, sh_uniform},
+        {OpCode::Id::MAX, DestRegister::MakeOutput(4), sh_input, sh_input2},
+        {OpCode::Id::MIN, DestRegister::MakeOutput(5), sh_input, sh_uniform},
+        {OpCode::Id::SGE, DestRegister::MakeOutput(6), sh_input, sh_input2},
+        {OpCode::Id::SLT, DestRegister::MakeOutput(7), sh_input, sh_uniform},
+        {OpCode::Id::FLR, DestRegister::MakeOutput(8), sh_temp},
+        {OpCode::Id::RCP, DestRegister::MakeOutput(9), sh_input},
+        {OpCode::Id::RSQ, DestRegister::MakeOutput(10), sh_input},
+        {OpCode::Id::MOV, DestRegister::MakeOutput(11), sh_uniform},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(JitBatchShader::CanRunEntryPoint(test.binary->program_code, 0));
+    test.Check(test_values, 12);
+}
+
+TEST_CASE("Batch entry point support", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto binary = Assemble({
+        // clang-format off
+        {OpCode::Id::MOV, sh_output, sh_input},
+        {OpCode::Id::MOV, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+    // Replace the first instruction by a MOVA, which sets the per-vertex address registers
+    binary->program_code[0] = static_cast<u32>(OpCode::Id::MOVA) << 26;
+
+    // The MOVA is only reachable when starting at the first instruction
+    REQUIRE(!JitBatchShader::CanRunEntryPoint(binary->program_code, 0));
+    REQUIRE(JitBatchShader::CanRunEntryPoint(binary->program_code, 1));
+}
+
+TEST_CASE("Batch shader benchmark", "[.][benchmark][video_core][shader][shader_jit]") {
+    if (!JitBatchShader::IsSupported())
+        return;
+
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_uniform = SourceRegister::MakeFloat(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+
+    // Transform-like workload: dot products against uniforms followed by some lighting math
+    BatchShaderTest test({
+        // clang-format off
+        {OpCode::Id::DP4, DestRegister::MakeTemporary(0), sh_input, sh_uniform},
+        {OpCode::Id::DP4, DestRegister::MakeOutput(0), sh_temp, sh_uniform},
+        {OpCode::Id::DP3, DestRegister::MakeTemporary(1), sh_input2, sh_uniform},
+        {OpCode::Id::MUL, DestRegister::MakeTemporary(0), sh_temp, sh_input2},
+        {OpCode::Id::MAX, DestRegister::MakeTemporary(0), sh_temp, sh_uniform},
+        {OpCode::Id::LG2, DestRegister::MakeTemporary(1), sh_temp},
+        {OpCode::Id::MUL, DestRegister::MakeTemporary(1), sh_temp, sh_uniform},
+        {OpCode::Id::EX2, DestRegister::MakeOutput(1), sh_temp},
+        {OpCode::Id::ADD, DestRegister::MakeOutput(2), sh_temp, sh_input},
+        {OpCode::Id::MOV, DestRegister::MakeOutput(3), sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    constexpr unsigned NUM_VERTICES = 1 << 20;
+    const unsigned batch_size = test.batch_shader->GetBatchSize();
+    auto batch_state = std::make_unique<Pica::Shader::BatchUnitState>();
+    batch_state->address_registers[2] = 0;
+    Pica::Shader::UnitState unit;
+    unit.address_registers[2] = 0;
+    for (unsigned comp = 0; comp < 4; ++comp) {
+        unit.registers.input[0][comp] = float24::FromFloat32(0.5f + comp);
+        unit.registers.input[1][comp] = float24::FromFloat32(1.5f - comp);
+        for (unsigned lane = 0; lane < Pica::Shader::MAX_BATCH_SIZE; ++lane) {
+            batch_state->registers.input[0][comp][lane] = 0.5f + comp + lane;
+            batch_state->registers.input[1][comp][lane] = 1.5f - comp;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    const auto single_start = Clock::now();
+    for (unsigned i = 0; i < NUM_VERTICES; ++i) {
+        test.shader->Run(test.setup, unit, 0);
+    }
+    const auto single_time = Clock::now() - single_start;
+
+    const auto batch_start = Clock::now();
+    for (unsigned i = 0; i < NUM_VERTICES; i += batch_size) {
+        test.batch_shader->Run(test.setup, *batch_state, 0);
+    }
+    const auto batch_time = Clock::now() - batch_start;
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    WARN("Per-vertex JIT: " << duration_cast<microseconds>(single_time).count() << "us, "
+                            << batch_size << "-wide batch JIT: "
+                            << duration_cast<microseconds>(batch_time).count() << "us for "
+                            << NUM_VERTICES << " vertices");
+}
@@ -0,0 +1,141 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/video_core.h"
+
+using Pica::float24;
+using Pica::FramebufferRegs;
+using Pica::Rasterizer::Vertex;
+
+constexpr u32 FB_WIDTH = 240;
+constexpr u32 FB_HEIGHT = 400;
+constexpr u32 FB_SIZE = FB_WIDTH * FB_HEIGHT * 4;
+
+/// Sets up the PICA state to draw vertex colors into a RGBA8 framebuffer in VRAM with alpha
+/// blending, so that the result depends on the order in which triangles are drawn.
+class RasterizerFixture {
+public:
+    RasterizerFixture() : saved_regs(Pica::GetState().regs) {
+        VideoCore::GetInstanceState().memory = &memory;
+
+        auto& regs = Pica::GetState().regs;
+        std::memset(&regs, 0, sizeof(regs));
+        regs.lighting.disable.Assign(1);
+
+        auto& framebuffer = regs.framebuffer.framebuffer;
+        framebuffer.color_buffer_address.Assign(Memory::VRAM_PADDR / 8);
+        framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+        framebuffer.width.Assign(FB_WIDTH);
+        framebuffer.height.Assign(FB_HEIGHT - 1);
+        framebuffer.allow_color_write.Assign(0xF);
+
+        auto& output_merger = regs.framebuffer.output_merger;
+        output_merger.alphablend_enable.Assign(1);
+        output_merger.alpha_blending.blend_equation_rgb.Assign(FramebufferRegs::BlendEquation::Add);
+        output_merger.alpha_blending.blend_equation_a.Assign(FramebufferRegs::BlendEquation::Add);
+        output_merger.alpha_blending.factor_source_rgb.Assign(
+            FramebufferRegs::BlendFactor::SourceAlpha);
+        output_merger.alpha_blending.factor_dest_rgb.Assign(
+            FramebufferRegs::BlendFactor::OneMinusSourceAlpha);
+        output_merger.alpha_blending.factor_source_a.Assign(FramebufferRegs::BlendFactor::One);
+        output_merger.alpha_blending.factor_dest_a.Assign(FramebufferRegs::BlendFactor::Zero);
+        output_merger.red_enable.Assign(1);
+        output_merger.green_enable.Assign(1);
+        output_merger.blue_enable.Assign(1);
+        output_merger.alpha_enable.Assign(1);
+    }
+
+    ~RasterizerFixture() {
+        Pica::Rasterizer::SetNumThreads(1);
+        Pica::GetState().regs = saved_regs;
+        VideoCore::GetInstanceState().memory = nullptr;
+    }
+
+    u8* Framebuffer() {
+        return memory.GetPhysicalPointer(Memory::VRAM_PADDR);
+    }
+
+    /// Draws the triangles with the given number of threads and returns the framebuffer contents.
+    std::vector<u8> Draw(const std::vector<Vertex>& vertices, unsigned num_threads) {
+        std::memset(Framebuffer(), 0, FB_SIZE);
+        Pica::Rasterizer::SetNumThreads(num_threads);
+        for (std::size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            Pica::Rasterizer::ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+        }
+        Pica::Rasterizer::FlushTriangles();
+        return std::vector<u8>(Framebuffer(), Framebuffer() + FB_SIZE);
+    }
+
+private:
+    Memory::MemorySystem memory;
+    Pica::Regs saved_regs;
+};
+
+/// Generates random overlapping triangles covering the framebuffer.
+static std::vector<Vertex> GenerateTriangles(std::size_t count, float max_size) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position_x(0.f, FB_WIDTH - 1);
+    std::uniform_real_distribution<float> position_y(0.f, FB_HEIGHT - 1);
+    std::uniform_real_distribution<float> offset(-max_size, max_size);
+    std::uniform_real_distribution<float> channel(0.f, 1.f);
+
+    std::vector<Vertex> vertices;
+    for (std::size_t i = 0; i < count; ++i) {
+        const float center_x = position_x(rng);
+        const float center_y = position_y(rng);
+        Pica::Shader::OutputVertex output{};
+        output.pos.w = float24::FromFloat32(1.f);
+        output.color = Math::MakeVec(float24::FromFloat32(channel(rng)),
+                                     float24::FromFloat32(channel(rng)),
+                                     float24::FromFloat32(channel(rng)),
+                                     float24::FromFloat32(0.25f + channel(rng) / 2));
+
+        for (int corner = 0; corner < 3; ++corner) {
+            const float x = std::clamp(center_x + offset(rng), 0.f, FB_WIDTH - 1.f);
+            const float y = std::clamp(center_y + offset(rng), 0.f, FB_HEIGHT - 1.f);
+            Vertex vertex(output);
+            vertex.screenpos = Math::MakeVec(float24::FromFloat32(x), float24::FromFloat32(y),
+                                             float24::FromFloat32(0.5f));
+            vertices.push_back(vertex);
+        }
+    }
+    return vertices;
+}
+
+TEST_CASE("Tile-parallel rasterization matches serial rasterization",
+          "[video_core][swrasterizer]") {
+    RasterizerFixture fixture;
+    const auto vertices = GenerateTriangles(300, 80.f);
+
+    const auto expected = fixture.Draw(vertices, 1);
+    for (unsigned num_threads : {2, 3, 8}) {
+        INFO(num_threads << " threads");
+        REQUIRE(fixture.Draw(vertices, num_threads) == expected);
+    }
+}
+
+TEST_CASE("Software rasterizer scaling benchmark", "[.][benchmark][video_core][swrasterizer]") {
+    RasterizerFixture fixture;
+    const auto vertices = GenerateTriangles(2000, 60.f);
+
+    using Clock = std::chrono::steady_clock;
+    for (unsigned num_threads : {1, 2, 4, 8}) {
+        const auto start = Clock::now();
+        fixture.Draw(vertices, num_threads);
+        const auto time = Clock::now() - start;
+
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        WARN(num_threads << " threads: " << duration_cast<microseconds>(time).count() << "us");
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/texture/etc1.h"
+#include "video_core/texture/texture_decode.h"
+
+using namespace Pica::Texture;
+
+TEST_CASE("ETC1 tile decoders match texel lookups", "[video_core]") {
+    std::mt19937 rng(1234);
+    std::vector<SimdLevel> levels{SimdLevel::None};
+    if (GetHostSimdLevel() >= SimdLevel::SSE41) {
+        levels.push_back(SimdLevel::SSE41);
+    }
+    if (GetHostSimdLevel() >= SimdLevel::AVX2) {
+        levels.push_back(SimdLevel::AVX2);
+    }
+
+    for (const bool has_alpha : {false, true}) {
+        TextureInfo info{};
+        info.format = has_alpha ? Pica::TexturingRegs::TextureFormat::ETC1A4
+                                : Pica::TexturingRegs::TextureFormat::ETC1;
+
+        for (int i = 0; i < 1000; ++i) {
+            std::array<u8, 4 * 16> tile;
+            for (u8& byte : tile) {
+                byte = static_cast<u8>(rng());
+            }
+
+            std::array<u8, 8 * 8 * 4> expected;
+            for (unsigned y = 0; y < 8; ++y) {
+                for (unsigned x = 0; x < 8; ++x) {
+                    auto texel = LookupTexelInTile(tile.data(), x, y, info, false);
+                    std::memcpy(&expected[(y * 8 + x) * 4], texel.AsArray(), 4);
+                }
+            }
+
+            for (const SimdLevel level : levels) {
+                INFO("alpha " << has_alpha << ", level " << static_cast<int>(level));
+                std::array<u8, 8 * 8 * 4> actual{};
+                GetETC1TileDecodeFn(level)(tile.data(), has_alpha, actual.data());
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("ETC1 tile decoder benchmark", "[.][benchmark][video_core]") {
+    constexpr std::size_t num_tiles = 128 * 128;
+    std::mt19937 rng(42);
+    std::vector<u8> tiles(num_tiles * 4 * 16);
+    for (u8& byte : tiles) {
+        byte = static_cast<u8>(rng());
+    }
+
+    std::array<u8, 8 * 8 * 4> texels;
+    for (const auto level : {SimdLevel::None, SimdLevel::SSE41, SimdLevel::AVX2}) {
+        if (level > GetHostSimdLevel()) {
+            continue;
+        }
+        const ETC1TileDecodeFn decode_tile = GetETC1TileDecodeFn(level);
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < num_tiles; ++i) {
+            decode_tile(&tiles[i * 4 * 16], true, texels.data());
+        }
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        WARN("level " << static_cast<int>(level) << ": " << num_tiles * 64 / time.count() / 1e6
+                      << " Mtexels/s (last texel " << static_cast<int>(texels[255]) << ")");
+    }
+}
@@ -0,0 +1,130 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/texture/morton.h"
+
+using namespace Pica::Texture;
+
+constexpr MortonLayout LAYOUTS[] = {MortonLayout::Bytes2, MortonLayout::Bytes3,
+                                    MortonLayout::Bytes4, MortonLayout::D24, MortonLayout::D24S8};
+
+/// Returns the instruction set extensions to test, which are the ones supported by the host.
+static std::vector<SimdLevel> GetSimdLevels() {
+    std::vector<SimdLevel> levels{SimdLevel::None};
+    if (GetHostSimdLevel() >= SimdLevel::SSE41) {
+        levels.push_back(SimdLevel::SSE41);
+    }
+    if (GetHostSimdLevel() >= SimdLevel::AVX2) {
+        levels.push_back(SimdLevel::AVX2);
+    }
+    return levels;
+}
+
+static std::vector<u8> RandomBytes(std::size_t size, std::mt19937& rng) {
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(rng());
+    }
+    return bytes;
+}
+
+TEST_CASE("Morton tile copies match the scalar implementation", "[video_core]") {
+    // The tile is copied in the middle of a 3x3 tiles image, to check that nothing around it is
+    // overwritten
+    constexpr u32 stride = 24;
+    std::mt19937 rng(1234);
+
+    for (const MortonLayout layout : LAYOUTS) {
+        const u32 bytes_per_pixel = GetMortonBytesPerPixel(layout);
+        const u32 linear_bytes_per_pixel = GetLinearBytesPerPixel(layout);
+        const std::size_t linear_offset = (8 * stride + 8) * linear_bytes_per_pixel;
+
+        for (const SimdLevel level : GetSimdLevels()) {
+            INFO("layout " << static_cast<int>(layout) << ", level " << static_cast<int>(level));
+            for (int i = 0; i < 10; ++i) {
+                const std::vector<u8> tile = RandomBytes(64 * bytes_per_pixel, rng);
+                const std::vector<u8> linear = RandomBytes(64 * 9 * linear_bytes_per_pixel, rng);
+
+                std::vector<u8> expected_tile = tile, actual_tile = tile;
+                std::vector<u8> expected_linear = linear, actual_linear = linear;
+                GetMortonCopyTileFn(layout, true, SimdLevel::None)(
+                    stride, expected_tile.data(), expected_linear.data() + linear_offset);
+                GetMortonCopyTileFn(layout, true, level)(stride, actual_tile.data(),
+                                                         actual_linear.data() + linear_offset);
+                REQUIRE(actual_linear == expected_linear);
+                REQUIRE(actual_tile == tile);
+
+                expected_linear = actual_linear = linear;
+                GetMortonCopyTileFn(layout, false, SimdLevel::None)(
+                    stride, expected_tile.data(), expected_linear.data() + linear_offset);
+                GetMortonCopyTileFn(layout, false, level)(stride, actual_tile.data(),
+                                                          actual_linear.data() + linear_offset);
+                REQUIRE(actual_tile == expected_tile);
+                REQUIRE(actual_linear == linear);
+            }
+        }
+    }
+}
+
+TEST_CASE("Morton tile copy round trip", "[video_core]") {
+    constexpr u32 stride = 8;
+    std::mt19937 rng(5678);
+
+    for (const MortonLayout layout : LAYOUTS) {
+        for (const SimdLevel level : GetSimdLevels()) {
+            INFO("layout " << static_cast<int>(layout) << ", level " << static_cast<int>(level));
+            const std::vector<u8> tile = RandomBytes(64 * GetMortonBytesPerPixel(layout), rng);
+            std::vector<u8> linear(64 * GetLinearBytesPerPixel(layout));
+            std::vector<u8> result(tile.size());
+
+            std::vector<u8> source = tile;
+            GetMortonCopyTileFn(layout, true, level)(stride, source.data(), linear.data());
+            GetMortonCopyTileFn(layout, false, level)(stride, result.data(), linear.data());
+            REQUIRE(result == tile);
+        }
+    }
+}
+
+TEST_CASE("Morton tile copy benchmark", "[.][benchmark][video_core]") {
+    constexpr u32 width = 1024;
+    constexpr u32 height = 1024;
+    std::mt19937 rng(42);
+
+    for (const MortonLayout layout : LAYOUTS) {
+        const u32 bytes_per_pixel = GetMortonBytesPerPixel(layout);
+        std::vector<u8> tiled = RandomBytes(width * height * bytes_per_pixel, rng);
+        std::vector<u8> linear(width * height * GetLinearBytesPerPixel(layout));
+
+        for (const SimdLevel level : GetSimdLevels()) {
+            for (const bool to_linear : {true, false}) {
+                const MortonCopyTileFn copy_tile = GetMortonCopyTileFn(layout, to_linear, level);
+                constexpr int iterations = 20;
+
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i) {
+                    u8* tile = tiled.data();
+                    for (u32 y = 0; y < height; y += 8) {
+                        for (u32 x = 0; x < width; x += 8) {
+                            copy_tile(width, tile,
+                                      &linear[((height - 8 - y) * width + x) *
+                                              GetLinearBytesPerPixel(layout)]);
+                            tile += 64 * bytes_per_pixel;
+                        }
+                    }
+                }
+                const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+                const double megabytes = iterations * tiled.size() / (1024.0 * 1024.0);
+                WARN("layout " << static_cast<int>(layout) << ", level "
+                               << static_cast<int>(level)
+                               << (to_linear ? ", to linear: " : ", to Morton: ")
+                               << megabytes / time.count() << " MiB/s");
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/vertex_cache.h"
+
+using Pica::float24;
+using Pica::VertexCache;
+using Pica::Shader::AttributeBuffer;
+
+constexpr unsigned CHUNK_SIZE = 32;
+
+/// Runs an indexed draw through the cache, "shading" each vertex by storing its index in the
+/// output, and checks that every index resolves to the output of its own vertex.
+static void Draw(VertexCache& cache, const std::vector<u32>& indices) {
+    std::array<u32, CHUNK_SIZE> shaded_vertices;
+    std::array<AttributeBuffer, CHUNK_SIZE> shaded_outputs;
+    std::array<VertexCache::LookupResult, CHUNK_SIZE> results;
+
+    cache.BeginDraw();
+    for (std::size_t start = 0; start < indices.size(); start += CHUNK_SIZE) {
+        const unsigned chunk_size =
+            static_cast<unsigned>(std::min<std::size_t>(CHUNK_SIZE, indices.size() - start));
+        cache.BeginChunk(chunk_size);
+
+        unsigned num_shaded = 0;
+        for (unsigned i = 0; i < chunk_size; ++i) {
+            const unsigned first_miss = num_shaded;
+            results[i] = cache.Lookup(indices[start + i], num_shaded);
+            if (num_shaded != first_miss) {
+                shaded_vertices[first_miss] = indices[start + i];
+            }
+        }
+
+        for (unsigned i = 0; i < num_shaded; ++i) {
+            shaded_outputs[i].attr[0].x =
+                float24::FromFloat32(static_cast<float>(shaded_vertices[i]));
+        }
+
+        for (unsigned i = 0; i < chunk_size; ++i) {
+            const AttributeBuffer& output = results[i].output != nullptr
+                                                ? *results[i].output
+                                                : shaded_outputs[results[i].shaded_index];
+            REQUIRE(output.attr[0].x.ToFloat32() == static_cast<float>(indices[start + i]));
+        }
+        cache.Store(shaded_outputs.data(), num_shaded);
+    }
+}
+
+TEST_CASE("VertexCache returns the output of each vertex", "[video_core]") {
+    std::mt19937 rng(1234);
+    std::vector<u32> indices(5000);
+
+    for (std::size_t size : {1, 16, 256, 0x10000}) {
+        INFO("cache size " << size);
+        VertexCache cache;
+        cache.SetSize(size);
+        REQUIRE(cache.GetSize() == size);
+
+        // Random indices, mostly close to each other like in a mesh
+        u32 base = 0;
+        for (u32& index : indices) {
+            base = (base + rng() % 4) % 0x10000;
+            index = (base + rng() % 64) % 0x10000;
+        }
+        Draw(cache, indices);
+        REQUIRE(cache.GetStats().hits + cache.GetStats().misses == indices.size());
+
+        // A second draw can't reuse the outputs of the first one
+        Draw(cache, {1, 2, 3});
+        REQUIRE(cache.GetStats().misses == 3);
+    }
+}
+
+TEST_CASE("VertexCache shades each vertex once if it fits", "[video_core]") {
+    VertexCache cache;
+    cache.SetSize(VertexCache::MAX_SIZE);
+
+    std::mt19937 rng(5678);
+    std::vector<u32> indices(5000);
+    std::set<u32> unique_vertices;
+    for (u32& index : indices) {
+        index = rng() % 1000;
+        unique_vertices.insert(index);
+    }
+
+    Draw(cache, indices);
+    REQUIRE(cache.GetStats().misses == unique_vertices.size());
+}
@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include "common/assert.h"
@@ -25,6 +27,7 @@
 #include "video_core/regs_texturing.h"
 #include "video_core/renderer_base.h"
 #include "video_core/shader/shader.h"
+#include "video_core/vertex_cache.h"
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
@@ -32,15 +35,6 @@ namespace Pica {
 
 namespace CommandProcessor {
 
-static int vs_float_regs_counter = 0;
-static u32 vs_uniform_write_buffer[4];
-
-static int gs_float_regs_counter = 0;
-static u32 gs_uniform_write_buffer[4];
-
-static int default_attr_counter = 0;
-static u32 default_attr_write_buffer[3];
-
 // Expand a 4-bit mask to 4-byte mask, e.g. 0b0101 -> 0x00FF00FF
 static const u32 expand_bits_to_bytes[] = {
     0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff, 0x00ff0000, 0x00ff00ff, 0x00ffff00, 0x00ffffff,
@@ -49,11 +43,38 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Reports the host time spent on a draw to the draw callback, if there is one
+class DrawTimer {
+public:
+    DrawTimer(const DrawCallback& callback, u32 num_vertices, bool is_indexed)
+        : callback(callback), info{num_vertices, is_indexed, false, {}} {
+        if (callback) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~DrawTimer() {
+        if (callback) {
+            info.duration = std::chrono::steady_clock::now() - start;
+            callback(info);
+        }
+    }
+
+    void SetAccelerated() {
+        info.accelerated = true;
+    }
+
+private:
+    const DrawCallback& callback;
+    DrawInfo info;
+    std::chrono::steady_clock::time_point start;
+};
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
-    if (&setup == &g_state.vs) {
+    if (&setup == &GetState().vs) {
         return "vertex shader";
     }
-    if (&setup == &g_state.gs) {
+    if (&setup == &GetState().gs) {
         return "geometry shader";
     }
     return "unknown shader";
@@ -120,7 +141,8 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
 }
 
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
-    auto& regs = g_state.regs;
+    State& state = GetState();
+    auto& regs = state.regs;
 
     if (id >= Regs::NUM_REGS) {
         LOG_ERROR(
@@ -153,33 +175,34 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
-        g_state.primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
+        state.primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
         break;
 
     case PICA_REG_INDEX(pipeline.restart_primitive):
-        g_state.primitive_assembler.Reset();
+        state.primitive_assembler.Reset();
         break;
 
     case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index):
-        g_state.immediate.current_attribute = 0;
-        g_state.immediate.reset_geometry_pipeline = true;
-        default_attr_counter = 0;
+        state.immediate.current_attribute = 0;
+        state.immediate.reset_geometry_pipeline = true;
+        state.buffered_writes.default_attr_counter = 0;
         break;
 
     // Load default vertex input attributes
     case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[0], 0x233):
     case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[1], 0x234):
     case PICA_REG_INDEX_WORKAROUND(pipeline.vs_default_attributes_setup.set_value[2], 0x235): {
+        auto& buffered_writes = state.buffered_writes;
         // TODO: Does actual hardware indeed keep an intermediate buffer or does
         //       it directly write the values?
-        default_attr_write_buffer[default_attr_counter++] = value;
+        buffered_writes.default_attr_write_buffer[buffered_writes.default_attr_counter++] = value;
 
         // Default attributes are written in a packed format such that four float24 values are
         // encoded in
         // three 32-bit numbers. We write to internal memory once a full such vector is
         // written.
-        if (default_attr_counter >= 3) {
-            default_attr_counter = 0;
+        if (buffered_writes.default_attr_counter >= 3) {
+            buffered_writes.default_attr_counter = 0;
 
             auto& setup = regs.pipeline.vs_default_attributes_setup;
 
@@ -191,12 +214,13 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             Math::Vec4<float24> attribute;
 
             // NOTE: The destination component order indeed is "backwards"
-            attribute.w = float24::FromRaw(default_attr_write_buffer[0] >> 8);
-            attribute.z = float24::FromRaw(((default_attr_write_buffer[0] & 0xFF) << 16) |
-                                           ((default_attr_write_buffer[1] >> 16) & 0xFFFF));
-            attribute.y = float24::FromRaw(((default_attr_write_buffer[1] & 0xFFFF) << 8) |
-                                           ((default_attr_write_buffer[2] >> 24) & 0xFF));
-            attribute.x = float24::FromRaw(default_attr_write_buffer[2] & 0xFFFFFF);
+            const u32* const buffer = buffered_writes.default_attr_write_buffer;
+            attribute.w = float24::FromRaw(buffer[0] >> 8);
+            attribute.z =
+                float24::FromRaw(((buffer[0] & 0xFF) << 16) | ((buffer[1] >> 16) & 0xFFFF));
+            attribute.y =
+                float24::FromRaw(((buffer[1] & 0xFFFF) << 8) | ((buffer[2] >> 24) & 0xFF));
+            attribute.x = float24::FromRaw(buffer[2] & 0xFFFFFF);
 
             LOG_TRACE(HW_GPU, "Set default VS attribute {:x} to ({} {} {} {})", (int)setup.index,
                       attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
@@ -204,15 +228,15 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
             // TODO: Verify that this actually modifies the register!
             if (setup.index < 15) {
-                g_state.input_default_attributes.attr[setup.index] = attribute;
+                state.input_default_attributes.attr[setup.index] = attribute;
                 setup.index++;
             } else {
                 // Put each attribute into an immediate input buffer.  When all specified immediate
                 // attributes are present, the Vertex Shader is invoked and everything is sent to
                 // the primitive assembler.
 
-                auto& immediate_input = g_state.immediate.input_vertex;
-                auto& immediate_attribute_id = g_state.immediate.current_attribute;
+                auto& immediate_input = state.immediate.input_vertex;
+                auto& immediate_attribute_id = state.immediate.current_attribute;
 
                 immediate_input.attr[immediate_attribute_id] = attribute;
 
@@ -225,7 +249,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
 
                     auto* shader_engine = Shader::GetEngine();
-                    shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+                    shader_engine->SetupBatch(state.vs, regs.vs.main_offset);
 
                     // Send to vertex shader
                     if (g_debug_context)
@@ -235,22 +259,22 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     Shader::AttributeBuffer output{};
 
                     shader_unit.LoadInput(regs.vs, immediate_input);
-                    shader_engine->Run(g_state.vs, shader_unit);
+                    shader_engine->Run(state.vs, shader_unit);
                     shader_unit.WriteOutput(regs.vs, output);
 
                     // Send to geometry pipeline
-                    if (g_state.immediate.reset_geometry_pipeline) {
-                        g_state.geometry_pipeline.Reconfigure();
-                        g_state.immediate.reset_geometry_pipeline = false;
+                    if (state.immediate.reset_geometry_pipeline) {
+                        state.geometry_pipeline.Reconfigure();
+                        state.immediate.reset_geometry_pipeline = false;
                     }
-                    ASSERT(!g_state.geometry_pipeline.NeedIndexInput());
-                    g_state.geometry_pipeline.Setup(shader_engine);
-                    g_state.geometry_pipeline.SubmitVertex(output);
+                    ASSERT(!state.geometry_pipeline.NeedIndexInput());
+                    state.geometry_pipeline.Setup(shader_engine);
+                    state.geometry_pipeline.SubmitVertex(output);
 
                     // TODO: If drawing after every immediate mode triangle kills performance,
                     // change it to flush triangles whenever a drawing config register changes
                     // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
-                    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+                    VideoCore::GetRenderer()->Rasterizer()->DrawTriangles();
                     if (g_debug_context) {
                         g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
                                                  nullptr);
@@ -269,10 +293,10 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(pipeline.command_buffer.trigger[1], 0x23d): {
         unsigned index =
             static_cast<unsigned>(id - PICA_REG_INDEX(pipeline.command_buffer.trigger[0]));
-        u32* head_ptr = (u32*)VideoCore::g_memory->GetPhysicalPointer(
+        u32* head_ptr = (u32*)VideoCore::GetMemory().GetPhysicalPointer(
             regs.pipeline.command_buffer.GetPhysicalAddress(index));
-        g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
-        g_state.cmd_list.length = regs.pipeline.command_buffer.GetSize(index) / sizeof(u32);
+        state.cmd_list.head_ptr = state.cmd_list.current_ptr = head_ptr;
+        state.cmd_list.length = regs.pipeline.command_buffer.GetSize(index) / sizeof(u32);
         break;
     }
 
@@ -280,6 +304,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
         MICROPROFILE_SCOPE(GPU_Drawing);
+        DrawTimer draw_timer{state.draw_callback, regs.pipeline.num_vertices,
+                             id == PICA_REG_INDEX(pipeline.trigger_draw_indexed)};
 
 #if PICA_LOG_TEV
         DebugUtils::DumpTevStageConfig(regs.GetTevStages());
@@ -287,7 +313,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_debug_context)
             g_debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
 
-        PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
+        PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = state.primitive_assembler;
 
         bool accelerate_draw = VideoCore::g_hw_shader_enabled && primitive_assembler.IsEmpty();
 
@@ -312,7 +338,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
 
         if (accelerate_draw &&
-            VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+            VideoCore::GetRenderer()->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+            draw_timer.SetAccelerated();
             if (g_debug_context) {
                 g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
             }
@@ -329,7 +356,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         // Load vertices
         const auto& index_info = regs.pipeline.index_array;
         const u8* index_address_8 =
-            VideoCore::g_memory->GetPhysicalPointer(base_address + index_info.offset);
+            VideoCore::GetMemory().GetPhysicalPointer(base_address + index_info.offset);
         const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
         bool index_u16 = index_info.format != 0;
 
@@ -340,7 +367,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     continue;
 
                 u8* texture_data =
-                    VideoCore::g_memory->GetPhysicalPointer(texture.config.GetPhysicalAddress());
+                    VideoCore::GetMemory().GetPhysicalPointer(texture.config.GetPhysicalAddress());
                 g_debug_context->recorder->MemoryAccessed(
                     texture_data,
                     Pica::TexturingRegs::NibblesPerPixel(texture.format) * texture.config.width /
@@ -351,86 +378,119 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::AttributeBuffer vs_output;
-
-        unsigned int vertex_cache_pos = 0;
+        if (is_indexed) {
+            state.vertex_cache.SetSize(VideoCore::g_vertex_cache_size);
+            state.vertex_cache.BeginDraw();
+        }
 
         auto* shader_engine = Shader::GetEngine();
         Shader::UnitState shader_unit;
 
-        shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+        shader_engine->SetupBatch(state.vs, regs.vs.main_offset);
 
-        g_state.geometry_pipeline.Reconfigure();
-        g_state.geometry_pipeline.Setup(shader_engine);
-        if (g_state.geometry_pipeline.NeedIndexInput())
+        state.geometry_pipeline.Reconfigure();
+        state.geometry_pipeline.Setup(shader_engine);
+        if (state.geometry_pipeline.NeedIndexInput()) {
             ASSERT(is_indexed);
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                unsigned int vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+                state.geometry_pipeline.SubmitIndex(vertex);
+            }
+        }
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
-
-            bool vertex_cache_hit = false;
+        // Vertices are processed in chunks: the vertices missing from the cache are loaded and
+        // shaded together, which lets the shader engine run several of them at once.
+        const unsigned int VERTEX_CHUNK_SIZE = 4 * Shader::MAX_BATCH_SIZE;
+        // Cached output for each vertex of the chunk, or null if it is shaded by this chunk
+        std::array<const Shader::AttributeBuffer*, VERTEX_CHUNK_SIZE> chunk_cached_outputs;
+        // Index into the shaded vertices for each vertex of the chunk which isn't cached
+        std::array<unsigned int, VERTEX_CHUNK_SIZE> chunk_shaded_index;
+        std::array<u32, VERTEX_CHUNK_SIZE> shaded_vertices;
+        std::array<Shader::AttributeBuffer, VERTEX_CHUNK_SIZE> shader_inputs;
+        std::array<Shader::AttributeBuffer, VERTEX_CHUNK_SIZE> shader_outputs;
+
+        const unsigned int num_vertices =
+            state.geometry_pipeline.NeedIndexInput() ? 0 : regs.pipeline.num_vertices;
+        for (unsigned int chunk_start = 0; chunk_start < num_vertices;
+             chunk_start += VERTEX_CHUNK_SIZE) {
+            const unsigned int chunk_size = std::min(VERTEX_CHUNK_SIZE, num_vertices - chunk_start);
+            unsigned int num_shaded = 0;
 
             if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
-                }
-
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
-                }
+                // Look up all the indices of the chunk first, so that vertices which are repeated
+                // within the chunk are only shaded once
+                state.vertex_cache.BeginChunk(chunk_size);
+                for (unsigned int i = 0; i < chunk_size; ++i) {
+                    const unsigned int index = chunk_start + i;
+                    const u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+                    if (g_debug_context && Pica::g_debug_context->recorder) {
+                        int size = index_u16 ? 2 : 1;
+                        memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                                  size);
+                    }
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                    const unsigned int first_miss = num_shaded;
+                    const auto result = state.vertex_cache.Lookup(vertex, num_shaded);
+                    chunk_cached_outputs[i] = result.output;
+                    chunk_shaded_index[i] = result.shaded_index;
+                    if (num_shaded != first_miss) {
+                        shaded_vertices[first_miss] = vertex;
                     }
                 }
+            } else {
+                // Non-indexed rendering never repeats vertices
+                for (unsigned int i = 0; i < chunk_size; ++i) {
+                    chunk_cached_outputs[i] = nullptr;
+                    chunk_shaded_index[i] = i;
+                    shaded_vertices[i] = chunk_start + i + regs.pipeline.vertex_offset;
+                }
+                num_shaded = chunk_size;
             }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+            // Initialize data for the vertices to shade
+            loader.LoadVertices(base_address, shaded_vertices.data(), num_shaded,
+                                shader_inputs.data(), memory_accesses);
 
-                // Send to vertex shader
-                if (g_debug_context)
+            // Send to vertex shader
+            if (g_debug_context) {
+                // Breakpoints on a vertex expect the vertices before it to be shaded already, so
+                // the vertices aren't batched while debugging
+                for (unsigned int i = 0; i < num_shaded; ++i) {
                     g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
-
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                                             (void*)&shader_inputs[i]);
+                    shader_engine->RunBatch(state.vs, regs.vs, shader_unit, &shader_inputs[i],
+                                            &shader_outputs[i], 1);
                 }
+            } else {
+                shader_engine->RunBatch(state.vs, regs.vs, shader_unit, shader_inputs.data(),
+                                        shader_outputs.data(), num_shaded);
             }
 
             // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+            for (unsigned int i = 0; i < chunk_size; ++i) {
+                if (chunk_cached_outputs[i] != nullptr) {
+                    state.geometry_pipeline.SubmitVertex(*chunk_cached_outputs[i]);
+                } else {
+                    state.geometry_pipeline.SubmitVertex(shader_outputs[chunk_shaded_index[i]]);
+                }
+            }
+
+            if (is_indexed) {
+                state.vertex_cache.Store(shader_outputs.data(), num_shaded);
+            }
+        }
+
+        if (is_indexed) {
+            MICROPROFILE_META_CPU("Vertex cache hits", state.vertex_cache.GetStats().hits);
+            MICROPROFILE_META_CPU("Vertex cache misses", state.vertex_cache.GetStats().misses);
         }
 
         for (auto& range : memory_accesses.ranges) {
             g_debug_context->recorder->MemoryAccessed(
-                VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
+                VideoCore::GetMemory().GetPhysicalPointer(range.first), range.second, range.first);
         }
 
-        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+        VideoCore::GetRenderer()->Rasterizer()->DrawTriangles();
         if (g_debug_context) {
             g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
         }
@@ -439,7 +499,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     }
 
     case PICA_REG_INDEX(gs.bool_uniforms):
-        WriteUniformBoolReg(g_state.gs, g_state.regs.gs.bool_uniforms.Value());
+        WriteUniformBoolReg(state.gs, state.regs.gs.bool_uniforms.Value());
         break;
 
     case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281):
@@ -448,7 +508,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[3], 0x284): {
         unsigned index = (id - PICA_REG_INDEX_WORKAROUND(gs.int_uniforms[0], 0x281));
         auto values = regs.gs.int_uniforms[index];
-        WriteUniformIntReg(g_state.gs, index,
+        WriteUniformIntReg(state.gs, index,
                            Math::Vec4<u8>(values.x, values.y, values.z, values.w));
         break;
     }
@@ -461,8 +521,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[5], 0x296):
     case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[6], 0x297):
     case PICA_REG_INDEX_WORKAROUND(gs.uniform_setup.set_value[7], 0x298): {
-        WriteUniformFloatReg(g_state.regs.gs, g_state.gs, gs_float_regs_counter,
-                             gs_uniform_write_buffer, value);
+        WriteUniformFloatReg(state.regs.gs, state.gs, state.buffered_writes.gs_float_regs_counter,
+                             state.buffered_writes.gs_uniform_write_buffer, value);
         break;
     }
 
@@ -474,12 +534,12 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[5], 0x2a1):
     case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[6], 0x2a2):
     case PICA_REG_INDEX_WORKAROUND(gs.program.set_word[7], 0x2a3): {
-        u32& offset = g_state.regs.gs.program.offset;
+        u32& offset = state.regs.gs.program.offset;
         if (offset >= 4096) {
             LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
         } else {
-            g_state.gs.program_code[offset] = value;
-            g_state.gs.MarkProgramCodeDirty();
+            state.gs.program_code[offset] = value;
+            state.gs.MarkProgramCodeDirty();
             offset++;
         }
         break;
@@ -493,12 +553,12 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[5], 0x2ab):
     case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[6], 0x2ac):
     case PICA_REG_INDEX_WORKAROUND(gs.swizzle_patterns.set_word[7], 0x2ad): {
-        u32& offset = g_state.regs.gs.swizzle_patterns.offset;
-        if (offset >= g_state.gs.swizzle_data.size()) {
+        u32& offset = state.regs.gs.swizzle_patterns.offset;
+        if (offset >= state.gs.swizzle_data.size()) {
             LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
         } else {
-            g_state.gs.swizzle_data[offset] = value;
-            g_state.gs.MarkSwizzleDataDirty();
+            state.gs.swizzle_data[offset] = value;
+            state.gs.MarkSwizzleDataDirty();
             offset++;
         }
         break;
@@ -506,7 +566,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
     case PICA_REG_INDEX(vs.bool_uniforms):
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        WriteUniformBoolReg(g_state.vs, g_state.regs.vs.bool_uniforms.Value());
+        WriteUniformBoolReg(state.vs, state.regs.vs.bool_uniforms.Value());
         break;
 
     case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1):
@@ -516,7 +576,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
         unsigned index = (id - PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1));
         auto values = regs.vs.int_uniforms[index];
-        WriteUniformIntReg(g_state.vs, index,
+        WriteUniformIntReg(state.vs, index,
                            Math::Vec4<u8>(values.x, values.y, values.z, values.w));
         break;
     }
@@ -530,8 +590,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[6], 0x2c7):
     case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8): {
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        WriteUniformFloatReg(g_state.regs.vs, g_state.vs, vs_float_regs_counter,
-                             vs_uniform_write_buffer, value);
+        WriteUniformFloatReg(state.regs.vs, state.vs, state.buffered_writes.vs_float_regs_counter,
+                             state.buffered_writes.vs_uniform_write_buffer, value);
         break;
     }
 
@@ -543,15 +603,15 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[5], 0x2d1):
     case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[6], 0x2d2):
     case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[7], 0x2d3): {
-        u32& offset = g_state.regs.vs.program.offset;
+        u32& offset = state.regs.vs.program.offset;
         if (offset >= 512) {
             LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
         } else {
-            g_state.vs.program_code[offset] = value;
-            g_state.vs.MarkProgramCodeDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.program_code[offset] = value;
-                g_state.gs.MarkProgramCodeDirty();
+            state.vs.program_code[offset] = value;
+            state.vs.MarkProgramCodeDirty();
+            if (!state.regs.pipeline.gs_unit_exclusive_configuration) {
+                state.gs.program_code[offset] = value;
+                state.gs.MarkProgramCodeDirty();
             }
             offset++;
         }
@@ -566,15 +626,15 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[5], 0x2db):
     case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[6], 0x2dc):
     case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[7], 0x2dd): {
-        u32& offset = g_state.regs.vs.swizzle_patterns.offset;
-        if (offset >= g_state.vs.swizzle_data.size()) {
+        u32& offset = state.regs.vs.swizzle_patterns.offset;
+        if (offset >= state.vs.swizzle_data.size()) {
             LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
         } else {
-            g_state.vs.swizzle_data[offset] = value;
-            g_state.vs.MarkSwizzleDataDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.swizzle_data[offset] = value;
-                g_state.gs.MarkSwizzleDataDirty();
+            state.vs.swizzle_data[offset] = value;
+            state.vs.MarkSwizzleDataDirty();
+            if (!state.regs.pipeline.gs_unit_exclusive_configuration) {
+                state.gs.swizzle_data[offset] = value;
+                state.gs.MarkSwizzleDataDirty();
             }
             offset++;
         }
@@ -593,7 +653,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
 
-        g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
+        state.lighting.luts[lut_config.type][lut_config.index].raw = value;
         lut_config.index.Assign(lut_config.index + 1);
         break;
     }
@@ -606,7 +666,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[5], 0xed):
     case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[6], 0xee):
     case PICA_REG_INDEX_WORKAROUND(texturing.fog_lut_data[7], 0xef): {
-        g_state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
+        state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
         regs.texturing.fog_lut_offset.Assign(regs.texturing.fog_lut_offset + 1);
         break;
     }
@@ -620,7 +680,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[6], 0xb6):
     case PICA_REG_INDEX_WORKAROUND(texturing.proctex_lut_data[7], 0xb7): {
         auto& index = regs.texturing.proctex_lut_config.index;
-        auto& pt = g_state.proctex;
+        auto& pt = state.proctex;
 
         switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
         case TexturingRegs::ProcTexLutTable::Noise:
@@ -646,31 +706,36 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
 
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    VideoCore::GetRenderer()->Rasterizer()->NotifyPicaRegisterChanged(id);
 
     if (g_debug_context)
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
                                  reinterpret_cast<void*>(&id));
 }
 
+void SetDrawCallback(DrawCallback callback) {
+    GetState().draw_callback = std::move(callback);
+}
+
 void ProcessCommandList(const u32* list, u32 size) {
-    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
-    g_state.cmd_list.length = size / sizeof(u32);
+    auto& cmd_list = GetState().cmd_list;
+    cmd_list.head_ptr = cmd_list.current_ptr = list;
+    cmd_list.length = size / sizeof(u32);
 
-    while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
+    while (cmd_list.current_ptr < cmd_list.head_ptr + cmd_list.length) {
 
         // Align read pointer to 8 bytes
-        if ((g_state.cmd_list.head_ptr - g_state.cmd_list.current_ptr) % 2 != 0)
-            ++g_state.cmd_list.current_ptr;
+        if ((cmd_list.head_ptr - cmd_list.current_ptr) % 2 != 0)
+            ++cmd_list.current_ptr;
 
-        u32 value = *g_state.cmd_list.current_ptr++;
-        const CommandHeader header = {*g_state.cmd_list.current_ptr++};
+        u32 value = *cmd_list.current_ptr++;
+        const CommandHeader header = {*cmd_list.current_ptr++};
 
         WritePicaReg(header.cmd_id, value, header.parameter_mask);
 
         for (unsigned i = 0; i < header.extra_data_length; ++i) {
             u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
-            WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
+            WritePicaReg(cmd, *cmd_list.current_ptr++, header.parameter_mask);
         }
     }
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <type_traits>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -36,6 +38,24 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(const u32* list, u32 size);
 
+/// Describes a draw that has been executed, for profiling
+struct DrawInfo {
+    u32 num_vertices;
+    bool is_indexed;
+    /// Whether the rasterizer drew the batch itself instead of the software vertex pipeline
+    bool accelerated;
+    /// Host time from the draw being triggered until the rasterizer returned
+    std::chrono::nanoseconds duration;
+};
+
+using DrawCallback = std::function<void(const DrawInfo&)>;
+
+/**
+ * Sets a function called after every draw of the bound System, on the thread executing the
+ * command lists. Timing is only measured while a callback is set; pass nullptr to remove it.
+ */
+void SetDrawCallback(DrawCallback callback);
+
 } // namespace CommandProcessor
 
 } // namespace Pica
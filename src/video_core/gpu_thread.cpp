@@ -0,0 +1,152 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/gpu_thread.h"
+
+namespace VideoCore {
+
+GPUThread::GPUThread(EmuWindow& emu_window)
+    : emu_window(emu_window), system(Core::System::GetInstance()) {
+    // Hand the graphics context over to the GPU thread
+    emu_window.DoneCurrent();
+    thread = std::thread(&GPUThread::ThreadLoop, this);
+}
+
+GPUThread::~GPUThread() {
+    // Queued commands may need the emulation thread, which isn't running anymore
+    WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stop_requested = true;
+    }
+    queue_cv.notify_one();
+    thread.join();
+
+    emu_window.MakeCurrent();
+}
+
+u64 GPUThread::PushCommand(std::function<void()> command) {
+    if (IsGPUThread()) {
+        // Commands issued by the GPU thread itself are already ordered after the queued work
+        command();
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return completed_fence;
+    }
+
+    u64 fence;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        fence = ++last_fence;
+        queue.push_back({std::move(command), fence});
+    }
+    queue_cv.notify_one();
+    return fence;
+}
+
+void GPUThread::SyncCommand(std::function<void()> command) {
+    WaitForFence(PushCommand(std::move(command)));
+}
+
+void GPUThread::WaitForFence(u64 fence) {
+    if (IsGPUThread())
+        return;
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (true) {
+        // The command may be waiting for the emulation thread to run some work
+        fence_cv.wait(lock, [this, fence] {
+            return completed_fence >= fence || !emulation_work.empty();
+        });
+        RunEmulationThreadWork(lock);
+        if (completed_fence >= fence)
+            break;
+    }
+}
+
+void GPUThread::WaitIdle() {
+    u64 fence;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        fence = last_fence;
+    }
+    WaitForFence(fence);
+}
+
+bool GPUThread::IsGPUThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void GPUThread::RunOnEmulationThread(std::function<void()> work, bool wait) {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    emulation_work.push_back(std::move(work));
+    const u64 work_id = ++posted_work;
+    has_emulation_work.store(true, std::memory_order_release);
+    // Wake the emulation thread if it's waiting for a fence
+    fence_cv.notify_all();
+
+    if (wait) {
+        emulation_work_cv.wait(lock, [this, work_id] { return completed_work >= work_id; });
+    }
+}
+
+void GPUThread::RunEmulationThreadWork() {
+    if (!has_emulation_work.load(std::memory_order_acquire))
+        return;
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    RunEmulationThreadWork(lock);
+}
+
+void GPUThread::RunEmulationThreadWork(std::unique_lock<std::mutex>& lock) {
+    while (!emulation_work.empty()) {
+        std::deque<std::function<void()>> work;
+        work.swap(emulation_work);
+        has_emulation_work.store(false, std::memory_order_relaxed);
+
+        lock.unlock();
+        for (const auto& function : work) {
+            function();
+        }
+        lock.lock();
+
+        completed_work += work.size();
+        emulation_work_cv.notify_all();
+    }
+}
+
+void GPUThread::ThreadLoop() {
+    Common::SetCurrentThreadName("GPUThread");
+    Core::System::InstanceScope instance_scope{system};
+    MicroProfileOnThreadCreate("GPUThread");
+    emu_window.MakeCurrent();
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (true) {
+        queue_cv.wait(lock, [this] { return !queue.empty() || stop_requested; });
+        if (queue.empty())
+            break;
+
+        Command command = std::move(queue.front());
+        queue.pop_front();
+
+        lock.unlock();
+        command.function();
+        lock.lock();
+
+        completed_fence = command.fence;
+        fence_cv.notify_all();
+    }
+    lock.unlock();
+
+    emu_window.DoneCurrent();
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+} // namespace VideoCore
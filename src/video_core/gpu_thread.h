@@ -0,0 +1,109 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "common/common_types.h"
+
+class EmuWindow;
+
+namespace Core {
+class System;
+}
+
+namespace VideoCore {
+
+/**
+ * Host thread that executes GPU work (PICA command lists, memory fills, display transfers and
+ * presentation) asynchronously to the emulated ARM11, so that both can run on separate cores.
+ *
+ * The thread owns the render window's graphics context while it is running, so every access to
+ * the renderer has to be funneled through it. Commands are executed in submission order and each
+ * one is identified by a monotonically increasing fence; operations whose results the CPU needs to
+ * observe, such as flushing cached surfaces back to emulated memory, wait for their fence.
+ */
+class GPUThread {
+public:
+    /// Starts the thread. The caller must currently own the graphics context of `emu_window`.
+    explicit GPUThread(EmuWindow& emu_window);
+
+    /// Executes all pending commands, stops the thread and hands the context back to the caller.
+    ~GPUThread();
+
+    /**
+     * Queues a command for execution on the GPU thread.
+     * @returns The fence that is signalled once the command has been executed.
+     */
+    u64 PushCommand(std::function<void()> command);
+
+    /**
+     * Executes a command on the GPU thread after all previously queued work and waits for it to
+     * finish. Runs the command in place when called from the GPU thread itself.
+     */
+    void SyncCommand(std::function<void()> command);
+
+    /**
+     * Blocks until the command identified by `fence` has been executed, running the work the
+     * command posted with RunOnEmulationThread meanwhile. Must be called on the emulation thread.
+     */
+    void WaitForFence(u64 fence);
+
+    /// Blocks until all queued commands have been executed.
+    void WaitIdle();
+
+    /// Returns whether the caller is running on the GPU thread.
+    bool IsGPUThread() const;
+
+    /**
+     * Posts work, such as changes to the page tables the CPU reads without locking, to the
+     * emulation thread. It runs the next time the emulation thread waits for a fence or calls
+     * RunEmulationThreadWork, in the order it was posted. Must be called on the GPU thread.
+     * @param wait Whether to block until the work, and all the work posted before it, has run
+     */
+    void RunOnEmulationThread(std::function<void()> work, bool wait);
+
+    /// Runs the work posted by the GPU thread. Must be called on the emulation thread.
+    void RunEmulationThreadWork();
+
+private:
+    struct Command {
+        std::function<void()> function;
+        u64 fence;
+    };
+
+    void ThreadLoop();
+
+    /// Runs the posted work with `lock` on queue_mutex held, releasing it while the work runs
+    void RunEmulationThreadWork(std::unique_lock<std::mutex>& lock);
+
+    EmuWindow& emu_window;
+    /// The System the thread renders for, bound on the thread
+    Core::System& system;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv; ///< Signalled when a command is queued
+    /// Signalled when a command has been executed or work is posted to the emulation thread
+    std::condition_variable fence_cv;
+    std::condition_variable emulation_work_cv; ///< Signalled when posted work has run
+    std::deque<Command> queue;
+    u64 last_fence = 0;      ///< Fence of the last queued command
+    u64 completed_fence = 0; ///< Fence of the last executed command
+    bool stop_requested = false;
+
+    std::deque<std::function<void()>> emulation_work;
+    u64 posted_work = 0;    ///< Number of pieces of work posted to the emulation thread
+    u64 completed_work = 0; ///< Number of pieces of work the emulation thread has run
+    /// Lets the emulation loop check for work without locking
+    std::atomic<bool> has_emulation_work{false};
+
+    std::thread thread;
+};
+
+} // namespace VideoCore
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
@@ -11,10 +12,13 @@
 
 namespace Pica {
 
-State g_state;
+State& GetState() {
+    return *VideoCore::GetInstanceState().pica_state;
+}
 
 void Init() {
-    g_state.Reset();
+    Shader::Init();
+    GetState().Reset();
 }
 
 void Shutdown() {
@@ -31,7 +35,7 @@ State::State() : geometry_pipeline(*this) {
         using Pica::Shader::OutputVertex;
         auto AddTriangle = [this](const OutputVertex& v0, const OutputVertex& v1,
                                   const OutputVertex& v2) {
-            VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
+            VideoCore::GetRenderer()->Rasterizer()->AddTriangle(v0, v1, v2);
         };
         primitive_assembler.SubmitVertex(
             Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, vertex), AddTriangle);
@@ -39,16 +43,66 @@ State::State() : geometry_pipeline(*this) {
 
     auto SetWinding = [this]() { primitive_assembler.SetWinding(); };
 
-    g_state.gs_unit.SetVertexHandler(SubmitVertex, SetWinding);
-    g_state.geometry_pipeline.SetVertexHandler(SubmitVertex);
+    gs_unit.SetVertexHandler(SubmitVertex, SetWinding);
+    geometry_pipeline.SetVertexHandler(SubmitVertex);
 }
 
 void State::Reset() {
     Zero(regs);
     Zero(vs);
     Zero(gs);
+    Zero(input_default_attributes);
+    Zero(proctex);
+    Zero(lighting);
+    Zero(fog);
     Zero(cmd_list);
+    Zero(buffered_writes);
     Zero(immediate);
     primitive_assembler.Reconfigure(PipelineRegs::TriangleTopology::List);
 }
+
+static void DoShaderSetup(PointerWrap& p, Shader::ShaderSetup& setup) {
+    p.DoVoid(&setup.uniforms, sizeof(setup.uniforms));
+    p.Do(setup.program_code);
+    p.Do(setup.swizzle_data);
+    p.Do(setup.engine_data.entry_point);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        // The engine looks the compiled program up again by hash on the next batch
+        setup.engine_data.cached_shader = nullptr;
+        setup.engine_data.cached_batch_shader = nullptr;
+        setup.MarkProgramCodeDirty();
+        setup.MarkSwizzleDataDirty();
+    }
+}
+
+void State::DoState(PointerWrap& p) {
+    auto s = p.Section("PicaState", 1);
+    if (!s)
+        return;
+
+    p.Do(regs.reg_array);
+
+    DoShaderSetup(p, vs);
+    DoShaderSetup(p, gs);
+
+    p.DoVoid(&input_default_attributes, sizeof(input_default_attributes));
+    p.DoVoid(&proctex, sizeof(proctex));
+    p.DoVoid(&lighting, sizeof(lighting));
+    p.DoVoid(&fog, sizeof(fog));
+
+    p.DoVoid(&immediate.input_vertex, sizeof(immediate.input_vertex));
+    p.Do(immediate.current_attribute);
+    p.Do(immediate.reset_geometry_pipeline);
+
+    p.DoVoid(&gs_unit.registers, sizeof(gs_unit.registers));
+    p.Do(gs_unit.conditional_code);
+    p.Do(gs_unit.address_registers);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        // Command list pointers refer to host memory of the session that wrote the state
+        Zero(cmd_list);
+        primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
+    }
+}
 } // namespace Pica
@@ -8,10 +8,14 @@
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
+#include "video_core/command_processor.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/primitive_assembly.h"
 #include "video_core/regs.h"
 #include "video_core/shader/shader.h"
+#include "video_core/vertex_cache.h"
+
+class PointerWrap;
 
 namespace Pica {
 
@@ -20,6 +24,12 @@ struct State {
     State();
     void Reset();
 
+    /**
+     * Serializes or deserializes the register file, shader setups and lookup tables. The geometry
+     * pipeline and primitive assembler are not included, so this must be called between draws.
+     */
+    void DoState(PointerWrap& p);
+
     /// Pica registers
     Regs regs;
 
@@ -133,6 +143,18 @@ struct State {
         u32 length;
     } cmd_list;
 
+    /// Values which are written over several register writes, until they are complete
+    struct {
+        int vs_float_regs_counter;
+        u32 vs_uniform_write_buffer[4];
+
+        int gs_float_regs_counter;
+        u32 gs_uniform_write_buffer[4];
+
+        int default_attr_counter;
+        u32 default_attr_write_buffer[3];
+    } buffered_writes;
+
     /// Struct used to describe immediate mode rendering state
     struct ImmediateModeState {
         // Used to buffer partial vertices for immediate-mode rendering.
@@ -152,8 +174,15 @@ struct State {
 
     // This is constructed with a dummy triangle topology
     PrimitiveAssembler<Shader::OutputVertex> primitive_assembler;
+
+    /// Shader outputs of the vertices of the current indexed draw
+    VertexCache vertex_cache;
+
+    /// Profiling hook, see CommandProcessor::SetDrawCallback
+    CommandProcessor::DrawCallback draw_callback;
 };
 
-extern State g_state; ///< Current Pica state
+/// Gets the Pica state of the System bound to the calling thread
+State& GetState();
 
 } // namespace Pica
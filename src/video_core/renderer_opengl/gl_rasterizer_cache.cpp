@@ -7,6 +7,7 @@
 #include <atomic>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <unordered_set>
@@ -17,18 +18,20 @@
 #include "common/alignment.h"
 #include "common/bit_field.h"
 #include "common/color.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_state.h"
-#include "video_core/utils.h"
+#include "video_core/texture/morton.h"
 #include "video_core/video_core.h"
 
 namespace OpenGL {
@@ -77,30 +80,22 @@ constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
-template <bool morton_to_gl, PixelFormat format>
-static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
-    constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
-    constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
-    for (u32 y = 0; y < 8; ++y) {
-        for (u32 x = 0; x < 8; ++x) {
-            u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
-            u8* gl_ptr = gl_buffer + ((7 - y) * stride + x) * gl_bytes_per_pixel;
-            if (morton_to_gl) {
-                if (format == PixelFormat::D24S8) {
-                    gl_ptr[0] = tile_ptr[3];
-                    std::memcpy(gl_ptr + 1, tile_ptr, 3);
-                } else {
-                    std::memcpy(gl_ptr, tile_ptr, bytes_per_pixel);
-                }
-            } else {
-                if (format == PixelFormat::D24S8) {
-                    std::memcpy(tile_ptr, gl_ptr + 1, 3);
-                    tile_ptr[3] = gl_ptr[0];
-                } else {
-                    std::memcpy(tile_ptr, gl_ptr, bytes_per_pixel);
-                }
-            }
-        }
+static constexpr Pica::Texture::MortonLayout GetMortonLayout(PixelFormat format) {
+    using Pica::Texture::MortonLayout;
+    switch (format) {
+    case PixelFormat::RGB8:
+        return MortonLayout::Bytes3;
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::D16:
+        return MortonLayout::Bytes2;
+    case PixelFormat::D24:
+        return MortonLayout::D24;
+    case PixelFormat::D24S8:
+        return MortonLayout::D24S8;
+    default:
+        return MortonLayout::Bytes4;
     }
 }
 
@@ -110,8 +105,11 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
     constexpr u32 tile_size = bytes_per_pixel * 64;
 
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
-    static_assert(gl_bytes_per_pixel >= bytes_per_pixel, "");
-    gl_buffer += gl_bytes_per_pixel - bytes_per_pixel;
+    constexpr auto layout = GetMortonLayout(format);
+    static_assert(Pica::Texture::GetMortonBytesPerPixel(layout) == bytes_per_pixel, "");
+    static_assert(Pica::Texture::GetLinearBytesPerPixel(layout) == gl_bytes_per_pixel, "");
+
+    static const auto copy_tile = Pica::Texture::GetMortonCopyTileFn(layout, morton_to_gl);
 
     const PAddr aligned_down_start = base + Common::AlignDown(start - base, tile_size);
     const PAddr aligned_start = base + Common::AlignUp(start - base, tile_size);
@@ -134,11 +132,11 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
         }
     };
 
-    u8* tile_buffer = VideoCore::g_memory->GetPhysicalPointer(start);
+    u8* tile_buffer = VideoCore::GetMemory().GetPhysicalPointer(start);
 
     if (start < aligned_start && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
+        copy_tile(stride, &tmp_buf[0], gl_buffer);
         std::memcpy(tile_buffer, &tmp_buf[start - aligned_down_start],
                     std::min(aligned_start, end) - start);
 
@@ -151,12 +149,12 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
     while (tile_buffer < buffer_end) {
         // Pokemon Super Mystery Dungeon will try to use textures that go beyond
         // the end address of VRAM. Stop reading if reaches invalid address
-        if (!VideoCore::g_memory->IsValidPhysicalAddress(current_paddr) ||
-            !VideoCore::g_memory->IsValidPhysicalAddress(current_paddr + tile_size)) {
+        if (!VideoCore::GetMemory().IsValidPhysicalAddress(current_paddr) ||
+            !VideoCore::GetMemory().IsValidPhysicalAddress(current_paddr + tile_size)) {
             LOG_ERROR(Render_OpenGL, "Out of bound texture");
             break;
         }
-        MortonCopyTile<morton_to_gl, format>(stride, tile_buffer, gl_buffer);
+        copy_tile(stride, tile_buffer, gl_buffer);
         tile_buffer += tile_size;
         current_paddr += tile_size;
         glbuf_next_tile();
@@ -164,7 +162,7 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
 
     if (end > std::max(aligned_start, aligned_end) && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
+        copy_tile(stride, &tmp_buf[0], gl_buffer);
         std::memcpy(tile_buffer, &tmp_buf[0], end - aligned_end);
     }
 }
@@ -634,7 +632,7 @@ MICROPROFILE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 19
 void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
     ASSERT(type != SurfaceType::Fill);
 
-    const u8* const texture_src_data = VideoCore::g_memory->GetPhysicalPointer(addr);
+    const u8* const texture_src_data = VideoCore::GetMemory().GetPhysicalPointer(addr);
     if (texture_src_data == nullptr)
         return;
 
@@ -672,12 +670,26 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            // Decode whole tiles, the texture is upside down relative to gl_buffer
+            const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+            const u32 first_row = height - rect.top;
+            const u32 last_row = height - rect.bottom;
+            std::array<u8, 8 * 8 * 4> tile;
+            for (u32 tile_y = first_row / 8 * 8; tile_y < last_row; tile_y += 8) {
+                for (u32 tile_x = rect.left / 8 * 8; tile_x < rect.right; tile_x += 8) {
+                    Pica::Texture::DecodeTile(texture_src_data + tile_y / 8 * tex_info.stride +
+                                                  tile_x / 8 * tile_size,
+                                              tex_info, tile.data());
+
+                    const u32 x_begin = std::max(rect.left, tile_x);
+                    const u32 x_end = std::min(rect.right, tile_x + 8);
+                    const u32 y_begin = std::max(first_row, tile_y);
+                    const u32 y_end = std::min(last_row, tile_y + 8);
+                    for (u32 y = y_begin; y < y_end; ++y) {
+                        std::memcpy(&gl_buffer[(x_begin + width * (height - 1 - y)) * 4],
+                                    &tile[((y - tile_y) * 8 + x_begin - tile_x) * 4],
+                                    (x_end - x_begin) * 4);
+                    }
                 }
             }
         } else {
@@ -689,7 +701,7 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
 
 MICROPROFILE_DEFINE(OpenGL_SurfaceFlush, "OpenGL", "Surface Flush", MP_RGB(128, 192, 64));
 void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
-    u8* const dst_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+    u8* const dst_buffer = VideoCore::GetMemory().GetPhysicalPointer(addr);
     if (dst_buffer == nullptr)
         return;
 
@@ -796,6 +808,42 @@ void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint
     InvalidateAllWatcher();
 }
 
+CachedSurface::~CachedSurface() {
+    if (texture_pool != nullptr && texture.handle != 0) {
+        texture_pool->Recycle(pixel_format, GetScaledWidth(), GetScaledHeight(), GetTextureBytes(),
+                              std::move(texture));
+    }
+}
+
+OGLTexture SurfaceTexturePool::Take(SurfaceParams::PixelFormat format, u32 width, u32 height) {
+    const auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return entry.format == format && entry.width == width && entry.height == height;
+    });
+    if (it == entries.end())
+        return {};
+
+    OGLTexture texture = std::move(it->texture);
+    bytes -= it->bytes;
+    entries.erase(it);
+    return texture;
+}
+
+void SurfaceTexturePool::Recycle(SurfaceParams::PixelFormat format, u32 width, u32 height,
+                                 u64 texture_bytes, OGLTexture texture) {
+    bytes += texture_bytes;
+    entries.push_front(
+        Entry{format, width, height, texture_bytes, current_frame, std::move(texture)});
+}
+
+void SurfaceTexturePool::Trim(u64 frame, u64 max_age, u64 max_bytes) {
+    current_frame = frame;
+    while (!entries.empty() &&
+           (entries.back().recycled_frame + max_age < current_frame || bytes > max_bytes)) {
+        bytes -= entries.back().bytes;
+        entries.pop_back();
+    }
+}
+
 MICROPROFILE_DEFINE(OpenGL_TextureDL, "OpenGL", "Texture Download", MP_RGB(128, 192, 64));
 void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
                                       GLuint draw_fb_handle) {
@@ -809,6 +857,13 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         gl_buffer.reset(new u8[gl_buffer_size]);
     }
 
+    std::size_t buffer_offset =
+        (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
+    ReadGLTexture(rect, read_fb_handle, draw_fb_handle, &gl_buffer[buffer_offset]);
+}
+
+void CachedSurface::ReadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
+                                  GLuint draw_fb_handle, GLvoid* pixels) {
     OpenGLState state = OpenGLState::GetCurState();
     OpenGLState prev_state = state;
     SCOPE_EXIT({ prev_state.Apply(); });
@@ -818,8 +873,6 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
     // Ensure no bad interactions with GL_PACK_ALIGNMENT
     ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
     glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
-    std::size_t buffer_offset =
-        (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
 
     // If not 1x scale, blit scaled texture to a new 1x texture and use that to flush
     if (res_scale != 1) {
@@ -841,7 +894,7 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         state.Apply();
 
         glActiveTexture(GL_TEXTURE0);
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, pixels);
     } else {
         state.ResetTexture(texture.handle);
         state.draw.read_framebuffer = read_fb_handle;
@@ -864,7 +917,7 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         }
         glReadPixels(static_cast<GLint>(rect.left), static_cast<GLint>(rect.bottom),
                      static_cast<GLsizei>(rect.GetWidth()), static_cast<GLsizei>(rect.GetHeight()),
-                     tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+                     tuple.format, tuple.type, pixels);
     }
 
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
@@ -1026,6 +1079,16 @@ void main() {
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
     FlushAll();
+    LOG_DEBUG(Render_OpenGL,
+              "{} surface readbacks, flushes: {} overlapped, {} stalled, {} synchronous",
+              readback_stats.readbacks, readback_stats.overlapped_flushes,
+              readback_stats.stalled_flushes, readback_stats.synchronous_flushes);
+    LOG_DEBUG(Render_OpenGL, "{} texture uploads, {} skipped saving {} bytes",
+              upload_stats.uploads, upload_stats.skipped_uploads, upload_stats.skipped_bytes);
+    LOG_DEBUG(Render_OpenGL,
+              "{} surfaces evicted freeing {} bytes, {} textures recycled, {} allocated",
+              cache_stats.evicted_surfaces, cache_stats.evicted_bytes,
+              cache_stats.recycled_textures, cache_stats.allocated_textures);
     while (!surface_cache.empty())
         UnregisterSurface(*surface_cache.begin()->second.begin());
 }
@@ -1041,6 +1104,7 @@ bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
         return false;
 
     dst_surface->InvalidateAllWatcher();
+    dst_surface->memory_hash.reset();
 
     return BlitTextures(src_surface->texture.handle, src_rect, dst_surface->texture.handle,
                         dst_rect, src_surface->type, read_framebuffer.handle,
@@ -1142,7 +1206,9 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         }
         SurfaceParams new_params = params;
         new_params.res_scale = target_res_scale;
-        surface = CreateSurface(new_params);
+        surface = TakeInvalidatedSurface(new_params);
+        if (surface == nullptr)
+            surface = CreateSurface(new_params);
         RegisterSurface(surface);
     }
 
@@ -1150,6 +1216,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         ValidateSurface(surface, params.addr, params.size);
     }
 
+    Touch(surface);
     return surface;
 }
 
@@ -1229,6 +1296,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams&
         ValidateSurface(surface, aligned_params.addr, aligned_params.size);
     }
 
+    Touch(surface);
     return std::make_tuple(surface, surface->GetScaledSubRect(params));
 }
 
@@ -1358,7 +1426,7 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
 
 SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
     bool using_color_fb, bool using_depth_fb, const MathUtil::Rectangle<s32>& viewport_rect) {
-    const auto& regs = Pica::g_state.regs;
+    const auto& regs = Pica::GetState().regs;
     const auto& config = regs.framebuffer.framebuffer;
 
     // update resolution_scale_factor and reset cache if changed
@@ -1493,6 +1561,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetTexCopySurface(const SurfaceParams&
         rect = match_surface->GetScaledSubRect(match_subrect);
     }
 
+    Touch(match_surface);
     return std::make_tuple(match_surface, rect);
 }
 
@@ -1517,6 +1586,79 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
     }
 }
 
+/// Hashes the guest memory backing a surface, unless it spans the bounds of VRAM
+static std::optional<u64> HashSurfaceMemory(const CachedSurface& surface) {
+    // Surfaces that cross the end of a memory region can't be read through a single pointer
+    Memory::MemorySystem& memory = VideoCore::GetMemory();
+    const u8* const data = memory.GetPhysicalPointer(surface.addr);
+    // GetPhysicalPointer accepts the end of a region as an open right bound
+    const u8* const end = memory.GetPhysicalPointer(surface.end);
+    if (data == nullptr || end != data + surface.size)
+        return {};
+
+    return Common::ComputeHash64(data, surface.size);
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceHash, "OpenGL", "Surface Hash", MP_RGB(128, 192, 64));
+bool RasterizerCacheOpenGL::RevalidateUnchangedSurface(const Surface& surface) {
+    if (!surface->memory_hash || surface->invalid_regions.empty())
+        return false;
+
+    // Guest memory doesn't hold the data of regions other surfaces marked dirty yet
+    if (!RangeFromInterval(dirty_regions, surface->GetInterval()).empty()) {
+        surface->memory_hash.reset();
+        return false;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceHash);
+    if (HashSurfaceMemory(*surface) != surface->memory_hash) {
+        // Parts of the texture are about to be updated, it no longer matches the old data
+        surface->memory_hash.reset();
+        return false;
+    }
+
+    const u32 invalid_size = static_cast<u32>(boost::icl::length(surface->invalid_regions));
+    const u64 skipped_bytes = u64{surface->PixelsInBytes(invalid_size)} *
+                              CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    surface->invalid_regions.clear();
+
+    ++upload_stats.skipped_uploads;
+    upload_stats.skipped_bytes += skipped_bytes;
+    Core::System::GetInstance().perf_stats.AddSkippedUploadBytes(skipped_bytes);
+    return true;
+}
+
+Surface RasterizerCacheOpenGL::TakeInvalidatedSurface(const SurfaceParams& params) {
+    const auto it = std::find_if(invalidated_surfaces.begin(), invalidated_surfaces.end(),
+                                 [&params](const Surface& surface) {
+                                     return surface->ExactMatch(params) &&
+                                            surface->res_scale == params.res_scale;
+                                 });
+    if (it == invalidated_surfaces.end())
+        return nullptr;
+
+    Surface surface = *it;
+    invalidated_surfaces.erase(it);
+    invalidated_bytes -= surface->GetTextureBytes();
+    return surface;
+}
+
+void RasterizerCacheOpenGL::KeepInvalidatedSurface(const Surface& surface) {
+    surface->invalid_regions.insert(surface->GetInterval());
+    invalidated_surfaces.push_front(surface);
+    invalidated_bytes += surface->GetTextureBytes();
+    if (invalidated_surfaces.size() > MAX_INVALIDATED_SURFACES)
+        DropInvalidatedSurface();
+}
+
+void RasterizerCacheOpenGL::DropInvalidatedSurface() {
+    const Surface& surface = invalidated_surfaces.back();
+    invalidated_bytes -= surface->GetTextureBytes();
+    // Release the memory rather than keeping the texture around
+    surface->texture_pool = nullptr;
+    invalidated_surfaces.pop_back();
+}
+
 void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr, u32 size) {
     if (size == 0)
         return;
@@ -1529,6 +1671,11 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         return;
     }
 
+    if (!surface->IsRegionValid(validate_interval) && RevalidateUnchangedSurface(surface)) {
+        return;
+    }
+
+    bool loaded = false;
     while (true) {
         const auto it = surface->invalid_regions.find(validate_interval);
         if (it == surface->invalid_regions.end())
@@ -1574,6 +1721,15 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
                                  draw_framebuffer.handle);
         surface->invalid_regions.erase(params.GetInterval());
+        ++upload_stats.uploads;
+        loaded = true;
+    }
+
+    // Remember what the texture was loaded from, once it matches guest memory as a whole
+    if (loaded && surface->invalid_regions.empty() &&
+        RangeFromInterval(dirty_regions, surface->GetInterval()).empty()) {
+        MICROPROFILE_SCOPE(OpenGL_SurfaceHash);
+        surface->memory_hash = HashSurfaceMemory(*surface);
     }
 }
 
@@ -1599,8 +1755,13 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
 
         if (surface->type != SurfaceType::Fill) {
             SurfaceParams params = surface->FromInterval(interval);
-            surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                       draw_framebuffer.handle);
+            const auto rect = surface->GetSubRect(params);
+            if (!FinishReadback(surface, rect)) {
+                surface->DownloadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle);
+                ++readback_stats.synchronous_flushes;
+                Core::System::GetInstance().perf_stats.AddSurfaceFlush(true);
+            }
+            surface->read_by_cpu = true;
         }
         surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
         flushed_intervals += interval;
@@ -1613,6 +1774,156 @@ void RasterizerCacheOpenGL::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+void RasterizerCacheOpenGL::EndFrame() {
+    ++current_frame;
+
+    const u64 budget = u64{VideoCore::g_surface_cache_budget} * 1024 * 1024;
+    if (budget == 0) {
+        texture_pool.Trim(current_frame, TEXTURE_POOL_MAX_AGE, std::numeric_limits<u64>::max());
+        return;
+    }
+
+    // Surfaces kept for their hash go first, they aren't in use
+    while (!invalidated_surfaces.empty() && cache_stats.surface_bytes + invalidated_bytes > budget)
+        DropInvalidatedSurface();
+
+    if (cache_stats.surface_bytes > budget)
+        EvictSurfaces(budget);
+
+    const u64 used_bytes = cache_stats.surface_bytes + invalidated_bytes;
+    const u64 pool_budget = used_bytes < budget ? budget - used_bytes : 0;
+    texture_pool.Trim(current_frame, TEXTURE_POOL_MAX_AGE, pool_budget);
+}
+
+RasterizerCacheOpenGL::CacheStats RasterizerCacheOpenGL::GetCacheStats() const {
+    CacheStats stats = cache_stats;
+    stats.pooled_textures = texture_pool.GetCount();
+    stats.pooled_bytes = texture_pool.GetBytes();
+    return stats;
+}
+
+MICROPROFILE_DEFINE(OpenGL_Readback, "OpenGL", "Surface Readback", MP_RGB(128, 192, 64));
+void RasterizerCacheOpenGL::StartReadback(const Surface& surface) {
+    if (!surface->read_by_cpu || surface->type == SurfaceType::Fill)
+        return;
+
+    // Read back the bounds of the regions marked dirty by the surface
+    SurfaceRegions dirty;
+    for (auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        if (pair.second == surface)
+            dirty += pair.first & surface->GetInterval();
+    }
+    if (dirty.empty())
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_Readback);
+
+    const auto rect = surface->GetSubRect(surface->FromInterval(boost::icl::hull(dirty)));
+
+    const std::size_t slot_index = next_readback_slot;
+    next_readback_slot = (next_readback_slot + 1) % READBACK_RING_SIZE;
+    ReadbackSlot& slot = readback_ring[slot_index];
+
+    // The oldest readback gets overwritten, whether or not it was used
+    if (auto previous = slot.surface.lock()) {
+        if (previous->readback_slot == slot_index)
+            previous->readback_slot.reset();
+    }
+    DiscardReadback(surface);
+
+    const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    const GLsizeiptr size = rect.GetHeight() * surface->stride * bytes_per_pixel;
+    slot.buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.handle);
+    if (slot.buffer_size < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.buffer_size = size;
+    }
+
+    surface->ReadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence.Release();
+    slot.fence.Create();
+    slot.surface = surface;
+    slot.rect = rect;
+    surface->readback_slot = slot_index;
+    ++readback_stats.readbacks;
+}
+
+MICROPROFILE_DEFINE(OpenGL_ReadbackWait, "OpenGL", "Readback Wait", MP_RGB(192, 64, 64));
+bool RasterizerCacheOpenGL::FinishReadback(const Surface& surface,
+                                           const MathUtil::Rectangle<u32>& rect) {
+    if (!surface->readback_slot)
+        return false;
+
+    ReadbackSlot& slot = readback_ring[*surface->readback_slot];
+    if (slot.surface.lock() != surface || rect.left < slot.rect.left ||
+        rect.right > slot.rect.right || rect.bottom < slot.rect.bottom ||
+        rect.top > slot.rect.top) {
+        return false;
+    }
+
+    GLenum status = glClientWaitSync(slot.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    const bool stalled = status == GL_TIMEOUT_EXPIRED;
+    if (stalled) {
+        MICROPROFILE_SCOPE(OpenGL_ReadbackWait);
+        ++readback_stats.stalled_flushes;
+        do {
+            status = glClientWaitSync(slot.fence.handle, 0, 1000000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    } else {
+        ++readback_stats.overlapped_flushes;
+    }
+    if (status == GL_WAIT_FAILED) {
+        DiscardReadback(surface);
+        return false;
+    }
+    Core::System::GetInstance().perf_stats.AddSurfaceFlush(stalled);
+
+    if (surface->gl_buffer == nullptr) {
+        surface->gl_buffer_size = surface->width * surface->height *
+                                  CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+        surface->gl_buffer.reset(new u8[surface->gl_buffer_size]);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.handle);
+    const u8* mapped = static_cast<const u8*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.buffer_size, GL_MAP_READ_BIT));
+    if (mapped == nullptr) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        DiscardReadback(surface);
+        return false;
+    }
+
+    // Both buffers are laid out with a row length of stride, the readback starting at its rect
+    const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    const std::size_t row_size = rect.GetWidth() * bytes_per_pixel;
+    for (u32 y = rect.bottom; y < rect.top; ++y) {
+        const std::size_t src_offset =
+            ((y - slot.rect.bottom) * surface->stride + rect.left - slot.rect.left) *
+            bytes_per_pixel;
+        const std::size_t dst_offset = (y * surface->stride + rect.left) * bytes_per_pixel;
+        std::memcpy(&surface->gl_buffer[dst_offset], mapped + src_offset, row_size);
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void RasterizerCacheOpenGL::DiscardReadback(const Surface& surface) {
+    if (!surface->readback_slot)
+        return;
+
+    ReadbackSlot& slot = readback_ring[*surface->readback_slot];
+    if (slot.surface.lock() == surface) {
+        slot.surface.reset();
+        slot.fence.Release();
+    }
+    surface->readback_slot.reset();
+}
+
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     if (size == 0)
         return;
@@ -1625,6 +1936,9 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        // The texture no longer holds what was loaded from guest memory
+        region_owner->memory_hash.reset();
+        DiscardReadback(region_owner);
     }
 
     for (auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
@@ -1636,7 +1950,11 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
             // to (likely) mark the memory pages as uncached
             if (region_owner == nullptr && size <= 8) {
                 FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
-                remove_surfaces.emplace(cached_surface);
+                if (remove_surfaces.emplace(cached_surface).second &&
+                    cached_surface->memory_hash) {
+                    // Games often write the same texture again, keep it to compare its hash
+                    KeepInvalidatedSurface(cached_surface);
+                }
                 continue;
             }
 
@@ -1678,12 +1996,21 @@ Surface RasterizerCacheOpenGL::CreateSurface(const SurfaceParams& params) {
     Surface surface = std::make_shared<CachedSurface>();
     static_cast<SurfaceParams&>(*surface) = params;
 
-    surface->texture.Create();
-
     surface->gl_buffer_size = 0;
     surface->invalid_regions.insert(surface->GetInterval());
-    AllocateSurfaceTexture(surface->texture.handle, GetFormatTuple(surface->pixel_format),
-                           surface->GetScaledWidth(), surface->GetScaledHeight());
+
+    // The contents don't matter, the whole surface starts invalid
+    surface->texture = texture_pool.Take(surface->pixel_format, surface->GetScaledWidth(),
+                                         surface->GetScaledHeight());
+    if (surface->texture.handle == 0) {
+        surface->texture.Create();
+        AllocateSurfaceTexture(surface->texture.handle, GetFormatTuple(surface->pixel_format),
+                               surface->GetScaledWidth(), surface->GetScaledHeight());
+        ++cache_stats.allocated_textures;
+    } else {
+        ++cache_stats.recycled_textures;
+    }
+    surface->texture_pool = &texture_pool;
 
     return surface;
 }
@@ -1695,6 +2022,9 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
     surface->registered = true;
     surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
     UpdatePagesCachedCount(surface->addr, surface->size, 1);
+    ++cache_stats.surfaces;
+    cache_stats.surface_bytes += surface->GetTextureBytes();
+    Touch(surface);
 }
 
 void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
@@ -1704,6 +2034,43 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
     surface->registered = false;
     UpdatePagesCachedCount(surface->addr, surface->size, -1);
     surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+    --cache_stats.surfaces;
+    cache_stats.surface_bytes -= surface->GetTextureBytes();
+}
+
+void RasterizerCacheOpenGL::EvictSurfaces(u64 max_bytes) {
+    SurfaceSet surfaces;
+    for (const auto& pair : surface_cache) {
+        surfaces.insert(pair.second.begin(), pair.second.end());
+    }
+
+    std::vector<Surface> candidates;
+    for (const Surface& surface : surfaces) {
+        if (surface->last_used_frame + 1 >= current_frame)
+            continue;
+
+        // Dirty surfaces hold the only copy of their data
+        const auto dirty = RangeFromInterval(dirty_regions, surface->GetInterval());
+        if (std::any_of(dirty.begin(), dirty.end(),
+                        [&surface](const auto& pair) { return pair.second == surface; })) {
+            continue;
+        }
+        candidates.push_back(surface);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Surface& a, const Surface& b) {
+        return a->last_used_frame < b->last_used_frame;
+    });
+
+    for (const Surface& surface : candidates) {
+        if (cache_stats.surface_bytes <= max_bytes)
+            break;
+
+        ++cache_stats.evicted_surfaces;
+        cache_stats.evicted_bytes += surface->GetTextureBytes();
+        // Release the memory rather than keeping the texture around
+        surface->texture_pool = nullptr;
+        UnregisterSurface(surface);
+    }
 }
 
 void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
@@ -1727,10 +2094,10 @@ void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int del
         const u32 interval_size = interval_end_addr - interval_start_addr;
 
         if (delta > 0 && count == delta)
-            VideoCore::g_memory->RasterizerMarkRegionCached(interval_start_addr, interval_size,
+            VideoCore::GetMemory().RasterizerMarkRegionCached(interval_start_addr, interval_size,
                                                             true);
         else if (delta < 0 && count == -delta)
-            VideoCore::g_memory->RasterizerMarkRegionCached(interval_start_addr, interval_size,
+            VideoCore::GetMemory().RasterizerMarkRegionCached(interval_start_addr, interval_size,
                                                             false);
         else
             ASSERT(count >= 0);
@@ -7,6 +7,7 @@
 #include <array>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
 #include <tuple>
 #ifdef __GNUC__
@@ -335,7 +336,11 @@ private:
     bool valid = false;
 };
 
+class SurfaceTexturePool;
+
 struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface> {
+    ~CachedSurface();
+
     bool CanFill(const SurfaceParams& dest_surface, SurfaceInterval fill_interval) const;
     bool CanCopy(const SurfaceParams& dest_surface, SurfaceInterval copy_interval) const;
 
@@ -377,6 +382,28 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     void DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
                            GLuint draw_fb_handle);
 
+    /// Reads rect of the texture to `pixels`, laid out like gl_buffer starting at the first pixel
+    /// of rect. `pixels` is an offset into the GL_PIXEL_PACK_BUFFER when one is bound.
+    void ReadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
+                       GLuint draw_fb_handle, GLvoid* pixels);
+
+    /// Set once the CPU read back the surface, it's then likely to be read again
+    bool read_by_cpu = false;
+    /// Readback ring slot holding a copy of the texture, until the surface is drawn to again
+    std::optional<std::size_t> readback_slot;
+    /// Hash of the guest memory the texture was last validated against, see HashSurfaceMemory
+    std::optional<u64> memory_hash;
+
+    /// Frame in which the surface was last used, to evict the least recently used ones first
+    u64 last_used_frame = 0;
+    /// Pool taking back the texture once the surface is destroyed, if any
+    SurfaceTexturePool* texture_pool = nullptr;
+
+    /// Estimate of the memory used by the texture
+    u64 GetTextureBytes() const {
+        return u64{GetScaledWidth()} * GetScaledHeight() * GetGLBytesPerPixel(pixel_format);
+    }
+
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
         watchers.push_front(watcher);
@@ -395,6 +422,44 @@ private:
     std::list<std::weak_ptr<SurfaceWatcher>> watchers;
 };
 
+/// Textures of destroyed surfaces, reused by new surfaces of the same format and size
+class SurfaceTexturePool : NonCopyable {
+public:
+    /// Takes a texture of the format and scaled size, or returns an empty one if there's none
+    OGLTexture Take(SurfaceParams::PixelFormat format, u32 width, u32 height);
+
+    /// Keeps the texture of a destroyed surface
+    void Recycle(SurfaceParams::PixelFormat format, u32 width, u32 height, u64 bytes,
+                 OGLTexture texture);
+
+    /// Releases the textures kept for more than max_age frames, then the oldest ones until at
+    /// most max_bytes are kept
+    void Trim(u64 current_frame, u64 max_age, u64 max_bytes);
+
+    std::size_t GetCount() const {
+        return entries.size();
+    }
+
+    u64 GetBytes() const {
+        return bytes;
+    }
+
+private:
+    struct Entry {
+        SurfaceParams::PixelFormat format;
+        u32 width;
+        u32 height;
+        u64 bytes;
+        u64 recycled_frame;
+        OGLTexture texture;
+    };
+
+    /// Most recently recycled first
+    std::list<Entry> entries;
+    u64 bytes = 0;
+    u64 current_frame = 0;
+};
+
 struct CachedTextureCube {
     OGLTexture texture;
     u16 res_scale = 1;
@@ -408,6 +473,30 @@ struct CachedTextureCube {
 
 class RasterizerCacheOpenGL : NonCopyable {
 public:
+    struct ReadbackStats {
+        u64 readbacks = 0;           ///< Readbacks started ahead of a flush
+        u64 overlapped_flushes = 0;  ///< Flushes whose readback had already completed
+        u64 stalled_flushes = 0;     ///< Flushes which waited for their readback to complete
+        u64 synchronous_flushes = 0; ///< Flushes without a readback, reading the texture in place
+    };
+
+    struct CacheStats {
+        std::size_t surfaces = 0;        ///< Surfaces in the cache
+        u64 surface_bytes = 0;           ///< Estimated memory used by their textures
+        u64 evicted_surfaces = 0;        ///< Clean surfaces evicted to stay within the budget
+        u64 evicted_bytes = 0;           ///< Memory freed by these evictions
+        std::size_t pooled_textures = 0; ///< Textures of destroyed surfaces kept for reuse
+        u64 pooled_bytes = 0;            ///< Memory used by the kept textures
+        u64 recycled_textures = 0;       ///< New surfaces which reused a kept texture
+        u64 allocated_textures = 0;      ///< New surfaces which had to allocate their texture
+    };
+
+    struct UploadStats {
+        u64 uploads = 0;         ///< Regions loaded from guest memory and uploaded to a texture
+        u64 skipped_uploads = 0; ///< Revalidations skipped as the guest memory was unchanged
+        u64 skipped_bytes = 0;   ///< Texture bytes not uploaded thanks to skipped revalidations
+    };
+
     RasterizerCacheOpenGL();
     ~RasterizerCacheOpenGL();
 
@@ -457,12 +546,49 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Evicts the least recently used clean surfaces if the cache is over its memory budget
+    void EndFrame();
+
+    /// Start reading back the regions surface marked dirty if the CPU read it before, so that the
+    /// next flush of the surface doesn't have to wait for the GPU
+    void StartReadback(const Surface& surface);
+
+    CacheStats GetCacheStats() const;
+
 private:
+    struct ReadbackSlot {
+        OGLBuffer buffer;
+        GLsizeiptr buffer_size = 0;
+        OGLSync fence;
+        std::weak_ptr<CachedSurface> surface;
+        MathUtil::Rectangle<u32> rect; ///< Unscaled rect of the surface held by the buffer
+    };
+
+    /// Copies rect from the readback of surface to its gl_buffer, waiting for the readback to
+    /// complete if needed. Returns false if there's no readback of rect.
+    bool FinishReadback(const Surface& surface, const MathUtil::Rectangle<u32>& rect);
+
+    /// Drops the readback of surface, as its texture is about to change
+    void DiscardReadback(const Surface& surface);
+
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
     /// Update surface's texture for given region when necessary
     void ValidateSurface(const Surface& surface, PAddr addr, u32 size);
 
+    /// Validates the whole texture surface without uploading it if the guest memory still hashes
+    /// to memory_hash. Returns whether it did.
+    bool RevalidateUnchangedSurface(const Surface& surface);
+
+    /// Takes back a surface removed by a CPU write to its memory, if one matches params
+    Surface TakeInvalidatedSurface(const SurfaceParams& params);
+
+    /// Keeps a surface removed by a CPU write, in case the same data is written again
+    void KeepInvalidatedSurface(const Surface& surface);
+
+    /// Destroys the least recently kept surface, releasing its texture
+    void DropInvalidatedSurface();
+
     /// Create a new surface
     Surface CreateSurface(const SurfaceParams& params);
 
@@ -475,6 +601,19 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Marks the surface as used in the current frame
+    void Touch(const Surface& surface) {
+        if (surface != nullptr)
+            surface->last_used_frame = current_frame;
+    }
+
+    /// Unregisters the least recently used surfaces without dirty regions until at most
+    /// max_bytes are used, sparing those used in the last frame
+    void EvictSurfaces(u64 max_bytes);
+
+    // Declared first so that it outlives every surface returning its texture to it
+    SurfaceTexturePool texture_pool;
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
@@ -490,6 +629,24 @@ private:
     GLint d24s8_abgr_tbo_size_u_id;
     GLint d24s8_abgr_viewport_u_id;
 
+    /// Enough slots for the framebuffers of both screens and a couple more render targets
+    static constexpr std::size_t READBACK_RING_SIZE = 4;
+    std::array<ReadbackSlot, READBACK_RING_SIZE> readback_ring;
+    std::size_t next_readback_slot = 0;
+    ReadbackStats readback_stats;
+
+    /// Surfaces removed from the cache by CPU writes, kept in case the same data is written again.
+    /// Their textures count towards the surface cache budget.
+    static constexpr std::size_t MAX_INVALIDATED_SURFACES = 32;
+    std::list<Surface> invalidated_surfaces;
+    u64 invalidated_bytes = 0;
+    UploadStats upload_stats;
+
+    /// Frames a texture is kept for reuse once its surface is destroyed
+    static constexpr u64 TEXTURE_POOL_MAX_AGE = 60;
+    u64 current_frame = 1;
+    CacheStats cache_stats;
+
     std::unordered_map<TextureCubeConfig, CachedTextureCube> texture_cube_cache;
 };
 } // namespace OpenGL
@@ -70,12 +70,23 @@ void OGLShader::Release() {
     handle = 0;
 }
 
-void OGLProgram::Create(bool separable_program, const std::vector<GLuint>& shaders) {
+void OGLProgram::Create(bool separable_program, const std::vector<GLuint>& shaders,
+                        bool retrievable_binary) {
     if (handle != 0)
         return;
 
     MICROPROFILE_SCOPE(OpenGL_ResourceCreation);
-    handle = LoadProgram(separable_program, shaders);
+    handle = LoadProgram(separable_program, shaders, retrievable_binary);
+}
+
+bool OGLProgram::CreateFromBinary(bool separable_program, GLenum binary_format,
+                                  const std::vector<u8>& binary) {
+    if (handle != 0)
+        return true;
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceCreation);
+    handle = LoadProgramBinary(separable_program, binary_format, binary);
+    return handle != 0;
 }
 
 void OGLProgram::Create(const char* vert_shader, const char* frag_shader) {
@@ -169,4 +180,21 @@ void OGLFramebuffer::Release() {
     handle = 0;
 }
 
+void OGLSync::Create() {
+    if (handle != nullptr)
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceCreation);
+    handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void OGLSync::Release() {
+    if (handle == nullptr)
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
+    glDeleteSync(handle);
+    handle = nullptr;
+}
+
 } // namespace OpenGL
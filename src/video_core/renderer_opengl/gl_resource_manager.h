@@ -102,7 +102,12 @@ public:
     }
 
     /// Creates a new program from given shader objects
-    void Create(bool separable_program, const std::vector<GLuint>& shaders);
+    void Create(bool separable_program, const std::vector<GLuint>& shaders,
+                bool retrievable_binary = false);
+
+    /// Creates a new program from a driver binary, returns false if the binary was rejected
+    bool CreateFromBinary(bool separable_program, GLenum binary_format,
+                          const std::vector<u8>& binary);
 
     /// Creates a new program from given shader soruce code
     void Create(const char* vert_shader, const char* frag_shader);
@@ -212,4 +217,29 @@ public:
     GLuint handle = 0;
 };
 
+class OGLSync : private NonCopyable {
+public:
+    OGLSync() = default;
+
+    OGLSync(OGLSync&& o) : handle(std::exchange(o.handle, nullptr)) {}
+
+    ~OGLSync() {
+        Release();
+    }
+
+    OGLSync& operator=(OGLSync&& o) {
+        Release();
+        handle = std::exchange(o.handle, nullptr);
+        return *this;
+    }
+
+    /// Inserts a new fence into the command stream and stores the handle
+    void Create();
+
+    /// Deletes the internal OpenGL resource
+    void Release();
+
+    GLsync handle = nullptr;
+};
+
 } // namespace OpenGL
@@ -0,0 +1,183 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace OpenGL {
+
+static std::string GetDriverIdentity(bool separable) {
+    const auto get_string = [](GLenum name) {
+        const GLubyte* str = glGetString(name);
+        return str != nullptr ? reinterpret_cast<const char*>(str) : "";
+    };
+    return fmt::format("{}\n{}\n{}\n{}", get_string(GL_VENDOR), get_string(GL_RENDERER),
+                       get_string(GL_VERSION), separable ? "separable" : "linked");
+}
+
+class ShaderDiskCache::Reader : public LinearDiskCacheReader<ShaderDiskCacheKey, u8> {
+public:
+    explicit Reader(ShaderDiskCache& cache) : cache(cache) {}
+
+    void Read(const ShaderDiskCacheKey& key, const u8* value, u32 value_size) override {
+        cache.ReadEntry(key, value, value_size);
+    }
+
+private:
+    ShaderDiskCache& cache;
+};
+
+ShaderDiskCache::ShaderDiskCache(u64 title_id, bool separable)
+    : path(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) +
+           fmt::format("{:016X}.bin", title_id)),
+      identity(GetDriverIdentity(separable)) {
+    GLint num_binary_formats = 0;
+    if (GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_binary_formats);
+    }
+    binaries_supported = num_binary_formats > 0;
+}
+
+ShaderDiskCache::~ShaderDiskCache() {
+    file.Close();
+}
+
+void ShaderDiskCache::Load() {
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create the shader cache directory for {}", path);
+        return;
+    }
+
+    Reader reader(*this);
+    const u32 num_entries = file.OpenAndRead(path.c_str(), reader);
+    if (num_entries != 0 && identity_matches) {
+        LOG_INFO(Render_OpenGL, "Loaded {} shaders and {} program binaries from {}",
+                 sources.size(), binaries.size(), path);
+        return;
+    }
+
+    if (num_entries != 0) {
+        LOG_INFO(Render_OpenGL, "Discarding {}, written by another driver", path);
+    }
+    // Start over with a file only holding the identity of the current driver
+    file.Close();
+    FileUtil::Delete(path);
+    file.OpenAndRead(path.c_str(), reader);
+    Append(ShaderDiskCacheEntryType::Identity, 0, identity.data(), identity.size());
+}
+
+const ShaderDiskCacheBinary* ShaderDiskCache::FindBinary(
+    const ShaderDiskCacheStages& stages) const {
+    const auto iter = binaries.find(Common::ComputeStructHash64(stages));
+    return iter != binaries.end() ? &iter->second : nullptr;
+}
+
+void ShaderDiskCache::ReleaseLoadedEntries() {
+    sources = {};
+    binaries = {};
+}
+
+void ShaderDiskCache::SaveSource(ShaderDiskCacheEntryType type, const void* config,
+                                 std::size_t config_size, const std::string& code) {
+    const u32 size = static_cast<u32>(config_size);
+    std::vector<u8> value(sizeof(size) + config_size + code.size());
+    std::memcpy(value.data(), &size, sizeof(size));
+    std::memcpy(value.data() + sizeof(size), config, config_size);
+    std::memcpy(value.data() + sizeof(size) + config_size, code.data(), code.size());
+    Append(type, Common::ComputeHash64(config, config_size), value.data(), value.size());
+}
+
+void ShaderDiskCache::SaveBinary(const ShaderDiskCacheStages& stages, GLuint program) {
+    if (!binaries_supported || program == 0) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    constexpr std::size_t header_size = sizeof(ShaderDiskCacheStages) + sizeof(u32);
+    std::vector<u8> value(header_size + length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, value.data() + header_size);
+    if (written <= 0) {
+        return;
+    }
+
+    const u32 format_value = static_cast<u32>(format);
+    std::memcpy(value.data(), &stages, sizeof(stages));
+    std::memcpy(value.data() + sizeof(stages), &format_value, sizeof(format_value));
+    value.resize(header_size + written);
+    Append(ShaderDiskCacheEntryType::ProgramBinary, Common::ComputeStructHash64(stages),
+           value.data(), value.size());
+}
+
+void ShaderDiskCache::ReadEntry(const ShaderDiskCacheKey& key, const u8* value, u32 value_size) {
+    if (num_read_entries++ == 0) {
+        identity_matches =
+            key.type == ShaderDiskCacheEntryType::Identity &&
+            std::string(reinterpret_cast<const char*>(value), value_size) == identity;
+        return;
+    }
+    if (!identity_matches) {
+        return;
+    }
+
+    switch (key.type) {
+    case ShaderDiskCacheEntryType::VertexShader:
+    case ShaderDiskCacheEntryType::GeometryShader:
+    case ShaderDiskCacheEntryType::FixedGeometryShader:
+    case ShaderDiskCacheEntryType::FragmentShader: {
+        u32 config_size;
+        if (value_size < sizeof(config_size)) {
+            break;
+        }
+        std::memcpy(&config_size, value, sizeof(config_size));
+        if (value_size - sizeof(config_size) < config_size) {
+            break;
+        }
+        const u8* config = value + sizeof(config_size);
+        const u8* code = config + config_size;
+
+        ShaderDiskCacheSource source;
+        source.type = key.type;
+        source.config.assign(config, code);
+        source.code.assign(reinterpret_cast<const char*>(code), value + value_size - code);
+        sources.push_back(std::move(source));
+        break;
+    }
+    case ShaderDiskCacheEntryType::ProgramBinary: {
+        constexpr std::size_t header_size = sizeof(ShaderDiskCacheStages) + sizeof(u32);
+        if (value_size < header_size) {
+            break;
+        }
+
+        ShaderDiskCacheBinary binary;
+        u32 format;
+        std::memcpy(&binary.stages, value, sizeof(binary.stages));
+        std::memcpy(&format, value + sizeof(binary.stages), sizeof(format));
+        binary.format = static_cast<GLenum>(format);
+        binary.data.assign(value + header_size, value + value_size);
+        binaries.insert_or_assign(key.hash, std::move(binary));
+        break;
+    }
+    default:
+        LOG_WARNING(Render_OpenGL, "Unknown shader cache entry type {}",
+                    static_cast<u32>(key.type));
+        break;
+    }
+}
+
+void ShaderDiskCache::Append(ShaderDiskCacheEntryType type, u64 hash, const void* value,
+                             std::size_t size) {
+    file.Append({type, 0, hash}, static_cast<const u8*>(value), static_cast<u32>(size));
+    file.Sync();
+}
+
+} // namespace OpenGL
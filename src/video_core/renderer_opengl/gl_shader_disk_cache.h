@@ -0,0 +1,115 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/linear_disk_cache.h"
+
+namespace OpenGL {
+
+enum class ShaderDiskCacheEntryType : u32 {
+    /// Describes the driver and the shader mode the file was written with, always comes first
+    Identity,
+    VertexShader,
+    GeometryShader,
+    FixedGeometryShader,
+    FragmentShader,
+    ProgramBinary,
+};
+
+struct ShaderDiskCacheKey {
+    ShaderDiskCacheEntryType type;
+    u32 reserved;
+    u64 hash;
+};
+
+/// Hashes of the source code of the stages a program was built from, zero for unused stages
+struct ShaderDiskCacheStages {
+    u64 vs = 0;
+    u64 gs = 0;
+    u64 fs = 0;
+};
+
+/// A generated shader, along with the raw bytes of the configuration it was generated from
+struct ShaderDiskCacheSource {
+    ShaderDiskCacheEntryType type;
+    std::vector<u8> config;
+    std::string code;
+};
+
+/// A program binary retrieved from the driver with glGetProgramBinary
+struct ShaderDiskCacheBinary {
+    ShaderDiskCacheStages stages;
+    GLenum format;
+    std::vector<u8> data;
+};
+
+/**
+ * Per-title file storing the shaders generated from PICA configurations, so that they don't need to
+ * be generated and compiled again in the next session. Program binaries are stored as well when the
+ * driver supports them. The file is built on LinearDiskCache, whose header already invalidates it
+ * when the emulator version changes; the first entry additionally identifies the driver.
+ */
+class ShaderDiskCache {
+public:
+    /// Has to be constructed on the thread owning the GL context, to query the driver.
+    ShaderDiskCache(u64 title_id, bool separable);
+    ~ShaderDiskCache();
+
+    /**
+     * Reads the cache file, discarding it if it was written by another driver or shader mode. This
+     * doesn't call OpenGL, so it can be run on a worker thread.
+     */
+    void Load();
+
+    const std::vector<ShaderDiskCacheSource>& GetSources() const {
+        return sources;
+    }
+
+    const std::unordered_map<u64, ShaderDiskCacheBinary>& GetBinaries() const {
+        return binaries;
+    }
+
+    /// Returns the loaded binary of the program built from the given stages, or nullptr if none.
+    const ShaderDiskCacheBinary* FindBinary(const ShaderDiskCacheStages& stages) const;
+
+    /// Frees the loaded entries once they have been precompiled.
+    void ReleaseLoadedEntries();
+
+    void SaveSource(ShaderDiskCacheEntryType type, const void* config, std::size_t config_size,
+                    const std::string& code);
+
+    /// Retrieves and saves the binary of a program, if the driver supports it.
+    void SaveBinary(const ShaderDiskCacheStages& stages, GLuint program);
+
+    bool AreBinariesSupported() const {
+        return binaries_supported;
+    }
+
+private:
+    class Reader;
+
+    void ReadEntry(const ShaderDiskCacheKey& key, const u8* value, u32 value_size);
+    void Append(ShaderDiskCacheEntryType type, u64 hash, const void* value, std::size_t size);
+
+    std::string path;
+    std::string identity;
+    bool binaries_supported = false;
+
+    LinearDiskCache<ShaderDiskCacheKey, u8> file;
+    u32 num_read_entries = 0;
+    bool identity_matches = false;
+
+    std::vector<ShaderDiskCacheSource> sources;
+    std::unordered_map<u64, ShaderDiskCacheBinary> binaries;
+};
+
+} // namespace OpenGL
@@ -3,9 +3,18 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <optional>
 #include <unordered_map>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
 namespace OpenGL {
@@ -87,6 +96,25 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+/// Returns the stages of a separable program holding only a shader of the given type.
+static ShaderDiskCacheStages GetSeparableStages(GLenum type, u64 code_hash) {
+    ShaderDiskCacheStages stages;
+    switch (type) {
+    case GL_VERTEX_SHADER:
+        stages.vs = code_hash;
+        break;
+    case GL_GEOMETRY_SHADER:
+        stages.gs = code_hash;
+        break;
+    case GL_FRAGMENT_SHADER:
+        stages.fs = code_hash;
+        break;
+    default:
+        UNREACHABLE();
+    }
+    return stages;
+}
+
 /**
  * An object representing a shader program staging. It can be either a shader object or a program
  * object, depending on whether separable program is used.
@@ -101,14 +129,28 @@ public:
         }
     }
 
-    void Create(const char* source, GLenum type) {
+    /**
+     * Compiles the shader. When a disk cache is given, separable programs are loaded from a cached
+     * binary when possible, and the binaries of newly linked ones are saved to it.
+     */
+    void Create(const std::string& source, GLenum type, ShaderDiskCache* disk_cache = nullptr) {
+        code_hash = Common::ComputeHash64(source.data(), source.size());
         if (shader_or_program.which() == 0) {
-            boost::get<OGLShader>(shader_or_program).Create(source, type);
+            boost::get<OGLShader>(shader_or_program).Create(source.c_str(), type);
         } else {
-            OGLShader shader;
-            shader.Create(source, type);
             OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
-            program.Create(true, {shader.handle});
+            const ShaderDiskCacheStages stages = GetSeparableStages(type, code_hash);
+            const ShaderDiskCacheBinary* binary =
+                disk_cache != nullptr ? disk_cache->FindBinary(stages) : nullptr;
+            if (binary == nullptr ||
+                !program.CreateFromBinary(true, binary->format, binary->data)) {
+                OGLShader shader;
+                shader.Create(source.c_str(), type);
+                program.Create(true, {shader.handle}, disk_cache != nullptr);
+                if (disk_cache != nullptr) {
+                    disk_cache->SaveBinary(stages, program.handle);
+                }
+            }
             SetShaderUniformBlockBindings(program.handle);
             SetShaderSamplerBindings(program.handle);
         }
@@ -122,35 +164,66 @@ public:
         }
     }
 
+    /// Hash of the source code, identifying the shader in the disk cache
+    u64 GetCodeHash() const {
+        return code_hash;
+    }
+
 private:
     boost::variant<OGLShader, OGLProgram> shader_or_program;
+    u64 code_hash = 0;
 };
 
 class TrivialVertexShader {
 public:
     explicit TrivialVertexShader(bool separable) : program(separable) {
-        program.Create(GenerateTrivialVertexShader(separable).c_str(), GL_VERTEX_SHADER);
+        program.Create(GenerateTrivialVertexShader(separable), GL_VERTEX_SHADER);
     }
-    GLuint Get() const {
-        return program.GetHandle();
+    const OGLShaderStage& Get() const {
+        return program;
     }
 
 private:
     OGLShaderStage program;
 };
 
+/// Copies a configuration read from the disk cache, returns false if its size doesn't match.
+template <typename KeyConfigType>
+static bool ReadDiskCacheConfig(KeyConfigType& config, const std::vector<u8>& data) {
+    if (data.size() != sizeof(config.state)) {
+        return false;
+    }
+    std::memcpy(&config.state, data.data(), sizeof(config.state));
+    return true;
+}
+
 template <typename KeyConfigType, std::string (*CodeGenerator)(const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheEntryType DiskCacheType>
 class ShaderCache {
 public:
     explicit ShaderCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& config) {
+    const OGLShaderStage& Get(const KeyConfigType& config, ShaderDiskCache* disk_cache) {
         auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(CodeGenerator(config, separable).c_str(), ShaderType);
+            const std::string code = CodeGenerator(config, separable);
+            cached_shader.Create(code, ShaderType, disk_cache);
+            if (disk_cache != nullptr) {
+                disk_cache->SaveSource(DiskCacheType, &config.state, sizeof(config.state), code);
+            }
+        }
+        return cached_shader;
+    }
+
+    /// Adds a shader loaded from the disk cache
+    const OGLShaderStage& Inject(const KeyConfigType& config, const std::string& code,
+                                 ShaderDiskCache* disk_cache) {
+        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
+        OGLShaderStage& cached_shader = iter->second;
+        if (new_shader) {
+            cached_shader.Create(code, ShaderType, disk_cache);
         }
-        return cached_shader.GetHandle();
+        return cached_shader;
     }
 
 private:
@@ -166,34 +239,41 @@ private:
 template <typename KeyConfigType,
           std::optional<std::string> (*CodeGenerator)(const Pica::Shader::ShaderSetup&,
                                                       const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheEntryType DiskCacheType>
 class ShaderDoubleCache {
 public:
     explicit ShaderDoubleCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup) {
+    const OGLShaderStage* Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup,
+                              ShaderDiskCache* disk_cache) {
         auto map_it = shader_map.find(key);
         if (map_it == shader_map.end()) {
             auto program_opt = CodeGenerator(setup, key, separable);
             if (!program_opt) {
                 shader_map[key] = nullptr;
-                return 0;
+                return nullptr;
             }
 
-            std::string& program = *program_opt;
-            auto [iter, new_shader] = shader_cache.emplace(program, OGLShaderStage{separable});
-            OGLShaderStage& cached_shader = iter->second;
-            if (new_shader) {
-                cached_shader.Create(program.c_str(), ShaderType);
+            const std::string& program = *program_opt;
+            const OGLShaderStage& cached_shader = Inject(key, program, disk_cache);
+            if (disk_cache != nullptr) {
+                disk_cache->SaveSource(DiskCacheType, &key.state, sizeof(key.state), program);
             }
-            shader_map[key] = &cached_shader;
-            return cached_shader.GetHandle();
+            return &cached_shader;
         }
 
-        if (map_it->second == nullptr) {
-            return 0;
-        }
+        return map_it->second;
+    }
 
-        return map_it->second->GetHandle();
+    /// Adds a shader loaded from the disk cache
+    const OGLShaderStage& Inject(const KeyConfigType& key, const std::string& program,
+                                 ShaderDiskCache* disk_cache) {
+        auto [iter, new_shader] = shader_cache.emplace(program, OGLShaderStage{separable});
+        OGLShaderStage& cached_shader = iter->second;
+        if (new_shader) {
+            cached_shader.Create(program, ShaderType, disk_cache);
+        }
+        shader_map[key] = &cached_shader;
+        return cached_shader;
     }
 
 private:
@@ -203,15 +283,19 @@ private:
 };
 
 using ProgrammableVertexShaders =
-    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER>;
+    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER,
+                      ShaderDiskCacheEntryType::VertexShader>;
 
 using ProgrammableGeometryShaders =
-    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER,
+                      ShaderDiskCacheEntryType::GeometryShader>;
 
 using FixedGeometryShaders =
-    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER,
+                ShaderDiskCacheEntryType::FixedGeometryShader>;
 
-using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER,
+                                    ShaderDiskCacheEntryType::FragmentShader>;
 
 class ShaderProgramManager::Impl {
 public:
@@ -221,6 +305,17 @@ public:
           fixed_geometry_shaders(separable), fragment_shaders(separable) {
         if (separable)
             pipeline.Create();
+
+        u64 title_id = 0;
+        if (Settings::values.use_disk_shader_cache &&
+            Core::System::GetInstance().GetAppLoader().ReadProgramId(title_id) ==
+                Loader::ResultStatus::Success) {
+            // Compile the cached shaders while the title is loading, so that they don't stall
+            // the frames which first use them
+            disk_cache = std::make_unique<ShaderDiskCache>(title_id, separable);
+            disk_cache->Load();
+            PrecompileDiskCache();
+        }
     }
 
     struct ShaderTuple {
@@ -247,9 +342,89 @@ public:
         };
     };
 
+    /// Compiles all the shaders and programs stored in the disk cache.
+    void PrecompileDiskCache() {
+        // Handles of the precompiled shaders by code hash, to find the stages of linked programs
+        std::unordered_map<u64, GLuint> stage_handles;
+        const auto add_stage = [&stage_handles](const OGLShaderStage& stage) {
+            stage_handles.emplace(stage.GetCodeHash(), stage.GetHandle());
+        };
+        add_stage(trivial_vertex_shader.Get());
+
+        ShaderDiskCache* cache = disk_cache.get();
+        for (const ShaderDiskCacheSource& source : disk_cache->GetSources()) {
+            switch (source.type) {
+            case ShaderDiskCacheEntryType::VertexShader: {
+                PicaVSConfig config;
+                if (ReadDiskCacheConfig(config, source.config))
+                    add_stage(programmable_vertex_shaders.Inject(config, source.code, cache));
+                break;
+            }
+            case ShaderDiskCacheEntryType::GeometryShader: {
+                PicaGSConfig config;
+                if (ReadDiskCacheConfig(config, source.config))
+                    add_stage(programmable_geometry_shaders.Inject(config, source.code, cache));
+                break;
+            }
+            case ShaderDiskCacheEntryType::FixedGeometryShader: {
+                PicaFixedGSConfig config;
+                if (ReadDiskCacheConfig(config, source.config))
+                    add_stage(fixed_geometry_shaders.Inject(config, source.code, cache));
+                break;
+            }
+            case ShaderDiskCacheEntryType::FragmentShader: {
+                PicaFSConfig config;
+                if (ReadDiskCacheConfig(config, source.config))
+                    add_stage(fragment_shaders.Inject(config, source.code, cache));
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        if (!separable) {
+            const auto find_stage = [&stage_handles](u64 code_hash) -> std::optional<GLuint> {
+                if (code_hash == 0)
+                    return 0;
+                const auto iter = stage_handles.find(code_hash);
+                if (iter == stage_handles.end())
+                    return {};
+                return iter->second;
+            };
+
+            for (const auto& [hash, binary] : disk_cache->GetBinaries()) {
+                const auto vs = find_stage(binary.stages.vs);
+                const auto gs = find_stage(binary.stages.gs);
+                const auto fs = find_stage(binary.stages.fs);
+                if (!vs || !gs || !fs)
+                    continue;
+
+                const ShaderTuple tuple{*vs, *gs, *fs};
+                OGLProgram program;
+                if (program_cache.count(tuple) != 0 ||
+                    !program.CreateFromBinary(false, binary.format, binary.data))
+                    continue;
+                SetShaderUniformBlockBindings(program.handle);
+                SetShaderSamplerBindings(program.handle);
+                program_cache.emplace(tuple, std::move(program));
+            }
+        }
+
+        LOG_INFO(Render_OpenGL, "Precompiled {} shaders from the disk cache",
+                 disk_cache->GetSources().size());
+        disk_cache->ReleaseLoadedEntries();
+    }
+
+    void UseStage(GLuint& handle, u64& code_hash, const OGLShaderStage& stage) {
+        handle = stage.GetHandle();
+        code_hash = stage.GetCodeHash();
+    }
+
     bool is_amd;
 
     ShaderTuple current;
+    ShaderDiskCacheStages current_stages;
 
     ProgrammableVertexShaders programmable_vertex_shaders;
     TrivialVertexShader trivial_vertex_shader;
@@ -262,6 +437,8 @@ public:
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
+
+    std::unique_ptr<ShaderDiskCache> disk_cache;
 };
 
 ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
@@ -271,36 +448,41 @@ ShaderProgramManager::~ShaderProgramManager() = default;
 
 bool ShaderProgramManager::UseProgrammableVertexShader(const PicaVSConfig& config,
                                                        const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_vertex_shaders.Get(config, setup);
-    if (handle == 0)
+    const OGLShaderStage* stage =
+        impl->programmable_vertex_shaders.Get(config, setup, impl->disk_cache.get());
+    if (stage == nullptr)
         return false;
-    impl->current.vs = handle;
+    impl->UseStage(impl->current.vs, impl->current_stages.vs, *stage);
     return true;
 }
 
 void ShaderProgramManager::UseTrivialVertexShader() {
-    impl->current.vs = impl->trivial_vertex_shader.Get();
+    impl->UseStage(impl->current.vs, impl->current_stages.vs, impl->trivial_vertex_shader.Get());
 }
 
 bool ShaderProgramManager::UseProgrammableGeometryShader(const PicaGSConfig& config,
                                                          const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_geometry_shaders.Get(config, setup);
-    if (handle == 0)
+    const OGLShaderStage* stage =
+        impl->programmable_geometry_shaders.Get(config, setup, impl->disk_cache.get());
+    if (stage == nullptr)
         return false;
-    impl->current.gs = handle;
+    impl->UseStage(impl->current.gs, impl->current_stages.gs, *stage);
     return true;
 }
 
 void ShaderProgramManager::UseFixedGeometryShader(const PicaFixedGSConfig& config) {
-    impl->current.gs = impl->fixed_geometry_shaders.Get(config);
+    impl->UseStage(impl->current.gs, impl->current_stages.gs,
+                   impl->fixed_geometry_shaders.Get(config, impl->disk_cache.get()));
 }
 
 void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
+    impl->current_stages.gs = 0;
 }
 
 void ShaderProgramManager::UseFragmentShader(const PicaFSConfig& config) {
-    impl->current.fs = impl->fragment_shaders.Get(config);
+    impl->UseStage(impl->current.fs, impl->current_stages.fs,
+                   impl->fragment_shaders.Get(config, impl->disk_cache.get()));
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
@@ -323,7 +505,12 @@ void ShaderProgramManager::ApplyTo(OpenGLState& state) {
     } else {
         OGLProgram& cached_program = impl->program_cache[impl->current];
         if (cached_program.handle == 0) {
-            cached_program.Create(false, {impl->current.vs, impl->current.gs, impl->current.fs});
+            ShaderDiskCache* disk_cache = impl->disk_cache.get();
+            cached_program.Create(false, {impl->current.vs, impl->current.gs, impl->current.fs},
+                                  disk_cache != nullptr);
+            if (disk_cache != nullptr) {
+                disk_cache->SaveBinary(impl->current_stages, cached_program.handle);
+            }
             SetShaderUniformBlockBindings(cached_program.handle);
             SetShaderSamplerBindings(cached_program.handle);
         }
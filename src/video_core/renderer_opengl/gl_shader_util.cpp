@@ -50,7 +50,8 @@ GLuint LoadShader(const char* source, GLenum type) {
     return shader_id;
 }
 
-GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
+GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders,
+                   bool retrievable_binary) {
     // Link the program
     LOG_DEBUG(Render_OpenGL, "Linking program...");
 
@@ -66,6 +67,10 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
         glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, GL_TRUE);
     }
 
+    if (retrievable_binary) {
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     glLinkProgram(program_id);
 
     // Check the program
@@ -95,4 +100,26 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
     return program_id;
 }
 
+GLuint LoadProgramBinary(bool separable_program, GLenum binary_format,
+                         const std::vector<u8>& binary) {
+    GLuint program_id = glCreateProgram();
+
+    if (separable_program) {
+        glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+
+    glProgramBinary(program_id, binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // The driver is free to reject binaries, e.g. after it has been updated
+    GLint result = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &result);
+    if (result != GL_TRUE) {
+        LOG_DEBUG(Render_OpenGL, "Program binary rejected by the driver");
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
+    return program_id;
+}
+
 } // namespace OpenGL
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <glad/glad.h>
+#include "common/common_types.h"
 
 namespace OpenGL {
 
@@ -20,8 +21,20 @@ GLuint LoadShader(const char* source, GLenum type);
  * Utility function to create and link an OpenGL GLSL shader program
  * @param separable_program whether to create a separable program
  * @param shaders ID of shaders to attach to the program
+ * @param retrievable_binary whether the program binary is going to be retrieved
  * @returns Handle of the newly created OpenGL program object
  */
-GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders);
+GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders,
+                   bool retrievable_binary = false);
+
+/**
+ * Utility function to create an OpenGL GLSL shader program from a binary returned by the driver
+ * @param separable_program whether to create a separable program
+ * @param binary_format Format of the binary, as returned by glGetProgramBinary
+ * @param binary Program binary
+ * @returns Handle of the newly created OpenGL program object, 0 if the driver rejected the binary
+ */
+GLuint LoadProgramBinary(bool separable_program, GLenum binary_format,
+                         const std::vector<u8>& binary);
 
 } // namespace OpenGL
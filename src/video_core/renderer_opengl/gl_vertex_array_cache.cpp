@@ -0,0 +1,98 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_vertex_array_cache.h"
+
+MICROPROFILE_DEFINE(OpenGL_VertexArrayCache, "OpenGL", "Vertex Array Cache",
+                    MP_RGB(128, 128, 192));
+
+namespace OpenGL {
+
+OGLVertexArrayCache::OGLVertexArrayCache(GLsizeiptr size) : buffer_size(size) {
+    // Bound to the copy target, as the rasterizer state tracks the array buffer binding
+    buffer.Create();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, buffer_size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void OGLVertexArrayCache::BeginDraw() {
+    in_draw = true;
+}
+
+std::optional<GLintptr> OGLVertexArrayCache::Lookup(PAddr addr, u32 size, const u8* data) {
+    DEBUG_ASSERT(in_draw);
+    const u32 aligned_size = Common::AlignUp(size, 4);
+    if (size < MIN_SIZE || aligned_size > buffer_size / 4) {
+        frame_stats.uploaded_bytes += size;
+        return {};
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_VertexArrayCache);
+
+    const u64 key = (static_cast<u64>(addr) << 32) | size;
+    const u64 hash = Common::ComputeHash64(data, size);
+    const auto [it, inserted] = entries.try_emplace(key, Entry{hash, {}});
+    Entry& entry = it->second;
+
+    if (!inserted && entry.hash == hash && entry.offset) {
+        frame_stats.reused_bytes += size;
+        return entry.offset;
+    }
+
+    frame_stats.uploaded_bytes += size;
+    if (inserted || entry.hash != hash) {
+        // First time these contents are seen here, stream them until they're drawn again
+        entry.hash = hash;
+        entry.offset.reset();
+        if (entries.size() > MAX_ENTRIES)
+            clear_pending = true;
+        return {};
+    }
+
+    // Ranges uploaded earlier in this draw must stay where they are until it's issued
+    if (clear_pending || buffer_pos + aligned_size > buffer_size) {
+        clear_pending = true;
+        return {};
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.handle);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, buffer_pos, size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    entry.offset = buffer_pos;
+    buffer_pos += aligned_size;
+    return entry.offset;
+}
+
+void OGLVertexArrayCache::EndDraw() {
+    in_draw = false;
+    if (clear_pending) {
+        Clear();
+    }
+}
+
+void OGLVertexArrayCache::EndFrame() {
+    total_stats.uploaded_bytes += frame_stats.uploaded_bytes;
+    total_stats.reused_bytes += frame_stats.reused_bytes;
+    last_frame_stats = frame_stats;
+    frame_stats = {};
+}
+
+void OGLVertexArrayCache::Clear() {
+    ASSERT_MSG(!in_draw, "Vertex array cache cleared while a draw uses it");
+    entries.clear();
+    buffer_pos = 0;
+    clear_pending = false;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, buffer_size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+} // namespace OpenGL
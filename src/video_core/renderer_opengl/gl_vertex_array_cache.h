@@ -0,0 +1,90 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Vertex array ranges kept in a persistent buffer, so that meshes drawn again from unchanged guest
+ * memory aren't uploaded every time. Ranges are identified by their address and size and checked
+ * against a hash of their contents. A range is only uploaded here once it was seen twice with the
+ * same contents, geometry rewritten for every draw keeps going through the stream buffer.
+ */
+class OGLVertexArrayCache : private NonCopyable {
+public:
+    struct Stats {
+        u64 uploaded_bytes = 0; ///< Vertex data uploaded to the stream buffer or the cache
+        u64 reused_bytes = 0;   ///< Vertex data drawn from the cache without uploading it again
+    };
+
+    explicit OGLVertexArrayCache(GLsizeiptr size);
+
+    GLuint GetHandle() const {
+        return buffer.handle;
+    }
+
+    /// Starts the lookups of a draw. The buffer storage is kept until EndDraw.
+    void BeginDraw();
+
+    /**
+     * Looks up the vertex data at addr, uploading it to the cache if it's reused. Returns its
+     * offset in the cache buffer, or nothing if the caller has to stream it.
+     */
+    std::optional<GLintptr> Lookup(PAddr addr, u32 size, const u8* data);
+
+    /// Called once the draw was issued, clears the cache if it ran out of room during the draw
+    void EndDraw();
+
+    /// Starts counting the data of the next frame
+    void EndFrame();
+
+    const Stats& GetLastFrameStats() const {
+        return last_frame_stats;
+    }
+
+    const Stats& GetTotalStats() const {
+        return total_stats;
+    }
+
+private:
+    struct Entry {
+        u64 hash;
+        /// Where the range was uploaded, if it was
+        std::optional<GLintptr> offset;
+    };
+
+    /**
+     * Forgets every range and orphans the buffer. Attribute pointers set up for the current draw
+     * would read the new storage, so this must not happen between BeginDraw and EndDraw.
+     */
+    void Clear();
+
+    /// Ranges smaller than this are streamed, hashing them would cost about as much
+    static constexpr u32 MIN_SIZE = 256;
+    /// Ranges seen without being uploaded also take an entry, clear them all past this
+    static constexpr std::size_t MAX_ENTRIES = 8192;
+
+    OGLBuffer buffer;
+    GLsizeiptr buffer_size;
+    GLintptr buffer_pos = 0;
+
+    bool in_draw = false;
+    /// The buffer or the entries ran out during the current draw, clear them once it's issued
+    bool clear_pending = false;
+
+    std::unordered_map<u64, Entry> entries;
+
+    Stats frame_stats;
+    Stats last_frame_stats;
+    Stats total_stats;
+};
+
+} // namespace OpenGL
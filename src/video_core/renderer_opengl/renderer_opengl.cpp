@@ -107,7 +107,7 @@ void RendererOpenGL::SwapBuffers() {
 
     for (int i : {0, 1, 2}) {
         int fb_id = i == 2 ? 1 : 0;
-        const auto& framebuffer = GPU::g_regs.framebuffer_config[fb_id];
+        const auto& framebuffer = GPU::GetRegs().framebuffer_config[fb_id];
 
         // Main LCD (0): 0x1ED02204, Sub LCD (1): 0x1ED02A04
         u32 lcd_color_addr =
@@ -140,7 +140,8 @@ void RendererOpenGL::SwapBuffers() {
         }
     }
 
-    if (VideoCore::g_renderer_screenshot_requested) {
+    VideoCore::InstanceState& video_state = VideoCore::GetInstanceState();
+    if (video_state.renderer_screenshot_requested) {
         // Draw this frame to the screenshot framebuffer
         screenshot_framebuffer.Create();
         GLuint old_read_fb = state.draw.read_framebuffer;
@@ -148,7 +149,7 @@ void RendererOpenGL::SwapBuffers() {
         state.draw.read_framebuffer = state.draw.draw_framebuffer = screenshot_framebuffer.handle;
         state.Apply();
 
-        Layout::FramebufferLayout layout{VideoCore::g_screenshot_framebuffer_layout};
+        Layout::FramebufferLayout layout{video_state.screenshot_framebuffer_layout};
 
         GLuint renderbuffer;
         glGenRenderbuffers(1, &renderbuffer);
@@ -160,7 +161,7 @@ void RendererOpenGL::SwapBuffers() {
         DrawScreens(layout);
 
         glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
-                     VideoCore::g_screenshot_bits);
+                     video_state.screenshot_bits);
 
         screenshot_framebuffer.Release();
         state.draw.read_framebuffer = old_read_fb;
@@ -168,16 +169,20 @@ void RendererOpenGL::SwapBuffers() {
         state.Apply();
         glDeleteRenderbuffers(1, &renderbuffer);
 
-        VideoCore::g_screenshot_complete_callback();
-        VideoCore::g_renderer_screenshot_requested = false;
+        video_state.screenshot_complete_callback();
+        video_state.renderer_screenshot_requested = false;
     }
 
     DrawScreens(render_window.GetFramebufferLayout());
+    Rasterizer()->NotifyFramePresented();
 
     Core::System::GetInstance().perf_stats.EndSystemFrame();
 
     // Swap buffers
-    render_window.PollEvents();
+    if (!VideoCore::GetGPUThread()) {
+        // With the GPU thread enabled, events are polled by the emulation thread instead
+        render_window.PollEvents();
+    }
     render_window.SwapBuffers();
 
     Core::System::GetInstance().frame_limiter.DoFrameLimiting(
@@ -228,7 +233,7 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
 
         Memory::RasterizerFlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
 
-        const u8* framebuffer_data = VideoCore::g_memory->GetPhysicalPointer(framebuffer_addr);
+        const u8* framebuffer_data = VideoCore::GetMemory().GetPhysicalPointer(framebuffer_addr);
 
         state.texture_units[0].texture_2d = screen_info.texture.resource.handle;
         state.Apply();
@@ -0,0 +1,134 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_software/renderer_software.h"
+#include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
+
+namespace VideoCore {
+
+RendererSoftware::RendererSoftware(EmuWindow& window, bool convert_screens)
+    : RendererBase{window}, convert_screens{convert_screens} {}
+
+RendererSoftware::~RendererSoftware() = default;
+
+void RendererSoftware::SwapBuffers() {
+    if (convert_screens) {
+        LoadScreenImage(GPU::GetRegs().framebuffer_config[0], LCD_REG_INDEX(color_fill_top),
+                        screen_images[static_cast<std::size_t>(Screen::Top)]);
+        LoadScreenImage(GPU::GetRegs().framebuffer_config[1], LCD_REG_INDEX(color_fill_bottom),
+                        screen_images[static_cast<std::size_t>(Screen::Bottom)]);
+    }
+
+    auto& screenshot_requested = VideoCore::GetInstanceState().renderer_screenshot_requested;
+    if (screenshot_requested) {
+        LOG_ERROR(Render, "Screenshots are not supported without a graphics backend");
+        screenshot_requested = false;
+    }
+
+    m_current_frame++;
+
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+
+    if (!VideoCore::GetGPUThread()) {
+        // With the GPU thread enabled, events are polled by the emulation thread instead
+        render_window.PollEvents();
+    }
+    render_window.SwapBuffers();
+
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(
+        Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+void RendererSoftware::LoadScreenImage(const GPU::Regs::FramebufferConfig& framebuffer,
+                                       u32 color_fill_address, ScreenImage& image) {
+    // The framebuffers are stored rotated by 90 degrees: each row in memory is a column of the
+    // screen, starting from the bottom
+    image.width = framebuffer.height;
+    image.height = framebuffer.width;
+    image.pixels.resize(image.width * image.height * 4);
+
+    LCD::Regs::ColorFill color_fill = {0};
+    LCD::Read(color_fill.raw, HW::VADDR_LCD + 4 * color_fill_address);
+    if (color_fill.is_enabled) {
+        for (std::size_t i = 0; i < image.pixels.size(); i += 4) {
+            image.pixels[i] = color_fill.color_r;
+            image.pixels[i + 1] = color_fill.color_g;
+            image.pixels[i + 2] = color_fill.color_b;
+            image.pixels[i + 3] = 255;
+        }
+        return;
+    }
+
+    const PAddr framebuffer_addr =
+        framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
+    const u32 size = framebuffer.stride * framebuffer.height;
+    Memory::RasterizerFlushRegion(framebuffer_addr, size);
+
+    const u8* source = VideoCore::GetMemory().GetPhysicalPointer(framebuffer_addr);
+    if (source == nullptr) {
+        LOG_ERROR(Render, "Framebuffer at 0x{:08X} is not in physical memory", framebuffer_addr);
+        return;
+    }
+
+    const auto decode = [&framebuffer]() -> Math::Vec4<u8> (*)(const u8*) {
+        switch (framebuffer.color_format) {
+        case GPU::Regs::PixelFormat::RGBA8:
+            return Color::DecodeRGBA8;
+        case GPU::Regs::PixelFormat::RGB8:
+            return Color::DecodeRGB8;
+        case GPU::Regs::PixelFormat::RGB565:
+            return Color::DecodeRGB565;
+        case GPU::Regs::PixelFormat::RGB5A1:
+            return Color::DecodeRGB5A1;
+        case GPU::Regs::PixelFormat::RGBA4:
+            return Color::DecodeRGBA4;
+        default:
+            return nullptr;
+        }
+    }();
+    if (decode == nullptr) {
+        LOG_ERROR(Render, "Unknown framebuffer format {}",
+                  static_cast<u32>(framebuffer.color_format.Value()));
+        return;
+    }
+
+    const int bpp = GPU::Regs::BytesPerPixel(framebuffer.color_format);
+    for (u32 x = 0; x < image.width; ++x) {
+        const u8* column = source + x * framebuffer.stride;
+        for (u32 y = 0; y < image.height; ++y) {
+            const auto color = decode(column + (image.height - 1 - y) * bpp);
+            u8* dest = &image.pixels[(y * image.width + x) * 4];
+            dest[0] = color.r();
+            dest[1] = color.g();
+            dest[2] = color.b();
+            dest[3] = 255;
+        }
+    }
+}
+
+Core::System::ResultStatus RendererSoftware::Init() {
+    // There is no graphics context to use the hardware rasterizer with
+    rasterizer = std::make_unique<SWRasterizer>();
+    return Core::System::ResultStatus::Success;
+}
+
+void RendererSoftware::ShutDown() {}
+
+} // namespace VideoCore
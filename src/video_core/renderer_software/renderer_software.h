@@ -0,0 +1,57 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+#include "video_core/renderer_base.h"
+
+namespace VideoCore {
+
+/**
+ * Renderer which needs no graphics API, for frontends without a display. Drawing is always done by
+ * the software rasterizer. If enabled, the screens are converted to RGBA8 images on each frame,
+ * which the EmuWindow can read when its SwapBuffers is called. Screenshots aren't supported.
+ */
+class RendererSoftware : public RendererBase {
+public:
+    /// An upright image of a screen, as seen on the console
+    struct ScreenImage {
+        u32 width = 0;
+        u32 height = 0;
+        std::vector<u8> pixels; ///< RGBA8 pixels, row by row starting from the top left corner
+    };
+
+    enum class Screen { Top, Bottom };
+
+    RendererSoftware(EmuWindow& window, bool convert_screens);
+    ~RendererSoftware() override;
+
+    /// Swap buffers (render frame)
+    void SwapBuffers() override;
+
+    /// Initialize the renderer
+    Core::System::ResultStatus Init() override;
+
+    /// Shutdown the renderer
+    void ShutDown() override;
+
+    /// Returns the last image of the screen, empty if screens aren't converted.
+    const ScreenImage& GetScreenImage(Screen screen) const {
+        return screen_images[static_cast<std::size_t>(screen)];
+    }
+
+private:
+    /// Converts the current framebuffer of a screen (left eye only) to an upright image.
+    void LoadScreenImage(const GPU::Regs::FramebufferConfig& framebuffer, u32 color_fill_address,
+                         ScreenImage& image);
+
+    bool convert_screens;
+    std::array<ScreenImage, 2> screen_images;
+};
+
+} // namespace VideoCore
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <cstring>
+#include <mutex>
 #include "common/bit_set.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -99,6 +100,34 @@ void UnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer& output) {
     CopyRegistersToOutput(registers.output, config.output_mask, output);
 }
 
+void BatchUnitState::LoadInput(const ShaderRegs& config, const AttributeBuffer* input,
+                               unsigned count) {
+    const unsigned max_attribute = config.max_input_attribute_index;
+
+    for (unsigned attr = 0; attr <= max_attribute; ++attr) {
+        unsigned reg = config.GetRegisterForAttribute(attr);
+        for (unsigned comp = 0; comp < 4; ++comp) {
+            for (unsigned lane = 0; lane < count; ++lane) {
+                registers.input[reg][comp][lane] = input[lane].attr[attr][comp].ToFloat32();
+            }
+        }
+    }
+}
+
+void BatchUnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer* output,
+                                 unsigned count) const {
+    int output_i = 0;
+    for (int reg : Common::BitSet<u32>(config.output_mask)) {
+        for (unsigned comp = 0; comp < 4; ++comp) {
+            for (unsigned lane = 0; lane < count; ++lane) {
+                output[lane].attr[output_i][comp] =
+                    float24::FromFloat32(registers.output[reg][comp][lane]);
+            }
+        }
+        ++output_i;
+    }
+}
+
 UnitState::UnitState(GSEmitter* emitter) : emitter_ptr(emitter) {}
 
 GSEmitter::GSEmitter() {
@@ -136,8 +165,20 @@ void GSUnitState::ConfigOutput(const ShaderRegs& config) {
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                            const AttributeBuffer* input, AttributeBuffer* output,
+                            unsigned count) const {
+    for (unsigned i = 0; i < count; ++i) {
+        state.LoadInput(config, input[i]);
+        Run(setup, state);
+        state.WriteOutput(config, output[i]);
+    }
+}
+
 #ifdef ARCHITECTURE_x86_64
+static std::mutex jit_engine_mutex;
 static std::unique_ptr<JitX64Engine> jit_engine;
+static unsigned engine_users = 0;
 #endif // ARCHITECTURE_x86_64
 static InterpreterEngine interpreter_engine;
 
@@ -145,6 +186,7 @@ ShaderEngine* GetEngine() {
 #ifdef ARCHITECTURE_x86_64
     // TODO(yuriks): Re-initialize on each change rather than being persistent
     if (VideoCore::g_shader_jit_enabled) {
+        std::lock_guard<std::mutex> lock(jit_engine_mutex);
         if (jit_engine == nullptr) {
             jit_engine = std::make_unique<JitX64Engine>();
         }
@@ -155,9 +197,23 @@ ShaderEngine* GetEngine() {
     return &interpreter_engine;
 }
 
+void Init() {
+#ifdef ARCHITECTURE_x86_64
+    std::lock_guard<std::mutex> lock(jit_engine_mutex);
+    ++engine_users;
+#endif // ARCHITECTURE_x86_64
+}
+
 void Shutdown() {
 #ifdef ARCHITECTURE_x86_64
-    jit_engine = nullptr;
+    std::lock_guard<std::mutex> lock(jit_engine_mutex);
+    // Shutting down without a matching Init, e.g. before the first boot, still frees the engine
+    if (engine_users > 0) {
+        --engine_users;
+    }
+    if (engine_users == 0) {
+        jit_engine = nullptr;
+    }
 #endif // ARCHITECTURE_x86_64
 }
 
@@ -161,6 +161,72 @@ struct UnitState {
     void WriteOutput(const ShaderRegs& config, AttributeBuffer& output);
 };
 
+/// Maximum number of vertices processed together by ShaderEngine::RunBatch
+constexpr unsigned MAX_BATCH_SIZE = 8;
+
+/**
+ * Shader unit state for processing several vertices at once, used by batching shader engines.
+ * Registers are stored in a structure-of-arrays layout: each component of each register holds
+ * one value per vertex, so that a SIMD register can operate on the same component of all
+ * vertices in the batch.
+ */
+struct BatchUnitState {
+    struct Registers {
+        // The registers are accessed by the shader JIT using AVX instructions, and are therefore
+        // required to be 32-byte aligned.
+        alignas(32) float input[16][4][MAX_BATCH_SIZE];
+        alignas(32) float temporary[16][4][MAX_BATCH_SIZE];
+        alignas(32) float output[16][4][MAX_BATCH_SIZE];
+    } registers;
+    static_assert(std::is_pod<Registers>::value, "Structure is not POD");
+
+    /// Address registers shared by all vertices, batched programs can only modify the loop one.
+    s32 address_registers[3];
+
+    static std::size_t InputOffset(const SourceRegister& reg, unsigned component) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Input:
+            return offsetof(BatchUnitState, registers.input) +
+                   (reg.GetIndex() * 4 + component) * MAX_BATCH_SIZE * sizeof(float);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   (reg.GetIndex() * 4 + component) * MAX_BATCH_SIZE * sizeof(float);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    static std::size_t OutputOffset(const DestRegister& reg, unsigned component) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Output:
+            return offsetof(BatchUnitState, registers.output) +
+                   (reg.GetIndex() * 4 + component) * MAX_BATCH_SIZE * sizeof(float);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   (reg.GetIndex() * 4 + component) * MAX_BATCH_SIZE * sizeof(float);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    /**
+     * Loads the unit state with a batch of input vertices.
+     *
+     * @param config Shader configuration registers corresponding to the unit.
+     * @param input Attribute buffers to load into the input registers, one per vertex.
+     * @param count Number of vertices in the batch, at most MAX_BATCH_SIZE.
+     */
+    void LoadInput(const ShaderRegs& config, const AttributeBuffer* input, unsigned count);
+
+    void WriteOutput(const ShaderRegs& config, AttributeBuffer* output, unsigned count) const;
+};
+
 /**
  * This is an extended shader unit state that represents the special unit that can run both vertex
  * shader and geometry shader. It contains an additional primitive emitter and utilities for
@@ -206,6 +272,8 @@ struct ShaderSetup {
         unsigned int entry_point;
         /// Used by the JIT, points to a compiled shader object.
         const void* cached_shader = nullptr;
+        /// Used by the JIT, points to a compiled batch shader object if the program supports it.
+        const void* cached_batch_shader = nullptr;
     } engine_data;
 
     void MarkProgramCodeDirty() {
@@ -256,10 +324,28 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on several vertices. The default implementation invokes
+     * `Run` once per vertex, engines that can process multiple vertices at once override it.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param config Shader configuration registers corresponding to the unit.
+     * @param state Shader unit state used for vertices that are processed one at a time.
+     * @param input Attribute buffers holding the input vertices.
+     * @param output Attribute buffers receiving the output vertices.
+     * @param count Number of vertices to process.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                          const AttributeBuffer* input, AttributeBuffer* output,
+                          unsigned count) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
+/// Gets the engine shared by all Systems; compiled JIT shaders are reused between them
 ShaderEngine* GetEngine();
+/// Registers a user of the shared engine, which is destroyed when the last user shuts down
+void Init();
 void Shutdown();
 
 } // namespace Shader
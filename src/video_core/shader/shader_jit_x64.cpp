@@ -2,9 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
 #include "common/microprofile.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 namespace Pica {
@@ -21,6 +24,7 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     u64 swizzle_hash = setup.GetSwizzleDataHash();
 
     u64 cache_key = code_hash ^ swizzle_hash;
+    std::lock_guard<std::mutex> lock(cache_mutex);
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
         setup.engine_data.cached_shader = iter->second.get();
@@ -30,6 +34,23 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
         setup.engine_data.cached_shader = shader.get();
         cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+
+    setup.engine_data.cached_batch_shader = nullptr;
+    if (JitBatchShader::IsSupported()) {
+        BatchCacheEntry& entry = batch_cache[cache_key];
+        auto [support, inserted] = entry.entry_point_support.try_emplace(entry_point, false);
+        if (inserted) {
+            support->second = JitBatchShader::CanRunEntryPoint(setup.program_code, entry_point);
+        }
+        // Only compile programs that can actually be batched, e.g. geometry shaders never are
+        if (support->second) {
+            if (!entry.shader) {
+                entry.shader = std::make_unique<JitBatchShader>();
+                entry.shader->Compile(&setup.program_code, &setup.swizzle_data);
+            }
+            setup.engine_data.cached_batch_shader = entry.shader.get();
+        }
+    }
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -43,5 +64,36 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                            const AttributeBuffer* input, AttributeBuffer* output,
+                            unsigned count) const {
+    if (setup.engine_data.cached_batch_shader == nullptr) {
+        // The program relies on per-vertex control flow, run it one vertex at a time
+        ShaderEngine::RunBatch(setup, config, state, input, output, count);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitBatchShader* shader =
+        static_cast<const JitBatchShader*>(setup.engine_data.cached_batch_shader);
+    const unsigned batch_size = shader->GetBatchSize();
+
+    // Lanes past `count` in the last batch hold stale data, their results are discarded
+    BatchUnitState batch_state;
+    std::copy(std::begin(state.address_registers), std::end(state.address_registers),
+              batch_state.address_registers);
+
+    for (unsigned i = 0; i < count; i += batch_size) {
+        const unsigned vertices = std::min(batch_size, count - i);
+        batch_state.LoadInput(config, input + i, vertices);
+        shader->Run(setup, batch_state, setup.engine_data.entry_point);
+        batch_state.WriteOutput(config, output + i, vertices);
+    }
+
+    std::copy(std::begin(batch_state.address_registers), std::end(batch_state.address_registers),
+              state.address_registers);
+}
+
 } // namespace Shader
 } // namespace Pica
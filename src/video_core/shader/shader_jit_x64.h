@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
@@ -13,6 +14,7 @@ namespace Pica {
 namespace Shader {
 
 class JitShader;
+class JitBatchShader;
 
 class JitX64Engine final : public ShaderEngine {
 public:
@@ -21,9 +23,22 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                  const AttributeBuffer* input, AttributeBuffer* output,
+                  unsigned count) const override;
 
 private:
+    struct BatchCacheEntry {
+        /// Results of JitBatchShader::CanRunEntryPoint, indexed by entry point
+        std::unordered_map<unsigned, bool> entry_point_support;
+        /// Only allocated once an entry point that can be batched is used
+        std::unique_ptr<JitBatchShader> shader;
+    };
+
+    /// Guards the caches, as the engine is shared by the Systems of the process
+    std::mutex cache_mutex;
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    std::unordered_map<u64, BatchCacheEntry> batch_cache;
 };
 
 } // namespace Shader
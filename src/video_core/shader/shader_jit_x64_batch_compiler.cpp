@@ -0,0 +1,1084 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/cpu_detect.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+
+namespace Pica {
+
+namespace Shader {
+
+typedef void (JitBatchShader::*JitBatchFunction)(Instruction instr);
+
+const JitBatchFunction batch_instr_table[64] = {
+    &JitBatchShader::Compile_ADD,         // add
+    &JitBatchShader::Compile_DP3,         // dp3
+    &JitBatchShader::Compile_DP4,         // dp4
+    &JitBatchShader::Compile_DPH,         // dph
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_EX2,         // ex2
+    &JitBatchShader::Compile_LG2,         // lg2
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_MUL,         // mul
+    &JitBatchShader::Compile_SGE,         // sge
+    &JitBatchShader::Compile_SLT,         // slt
+    &JitBatchShader::Compile_FLR,         // flr
+    &JitBatchShader::Compile_MAX,         // max
+    &JitBatchShader::Compile_MIN,         // min
+    &JitBatchShader::Compile_RCP,         // rcp
+    &JitBatchShader::Compile_RSQ,         // rsq
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_Unsupported, // mova
+    &JitBatchShader::Compile_MOV,         // mov
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_DPH,         // dphi
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_SGE,         // sgei
+    &JitBatchShader::Compile_SLT,         // slti
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    nullptr,                              // unknown
+    &JitBatchShader::Compile_NOP,         // nop
+    &JitBatchShader::Compile_END,         // end
+    &JitBatchShader::Compile_Unsupported, // breakc
+    &JitBatchShader::Compile_CALL,        // call
+    &JitBatchShader::Compile_Unsupported, // callc
+    &JitBatchShader::Compile_CALLU,       // callu
+    &JitBatchShader::Compile_IF,          // ifu
+    &JitBatchShader::Compile_Unsupported, // ifc
+    &JitBatchShader::Compile_LOOP,        // loop
+    &JitBatchShader::Compile_Unsupported, // emit
+    &JitBatchShader::Compile_Unsupported, // sete
+    &JitBatchShader::Compile_Unsupported, // jmpc
+    &JitBatchShader::Compile_JMP,         // jmpu
+    &JitBatchShader::Compile_Unsupported, // cmp
+    &JitBatchShader::Compile_Unsupported, // cmp
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // madi
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+    &JitBatchShader::Compile_MAD,         // mad
+};
+
+// The general purpose registers match the ones of JitShader. RAX-RDX can be used as scratch
+// registers within a compiler function.
+
+/// Pointer to the uniform memory
+static const Reg64 UNIFORMS = r9;
+/// VS loop count register (Multiplied by 16)
+static const Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number
+static const Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+static const Reg32 LOOPINC = edi;
+/// Pointer to the BatchUnitState instance for the current batch
+static const Reg64 STATE = r15;
+
+// Vector registers are referred to by index, and are XMM or YMM registers depending on the batch
+// size. Each of them holds one component of a register for all vertices in the batch.
+
+/// SIMD scratch register, also used as the mask operand of VSelect
+static constexpr int SCRATCH = 0;
+/// Loaded with a component of the first source register
+static constexpr int SRC1 = 1;
+/// Loaded with a component of the second source register
+static constexpr int SRC2 = 2;
+/// Loaded with a component of the third source register
+static constexpr int SRC3 = 3;
+/// Hold the results of the four destination components until they are stored
+static const std::array<int, 4> RESULT = {8, 9, 10, 11};
+/// Additional scratch registers
+static constexpr int SCRATCH2 = 12;
+static constexpr int SCRATCH3 = 13;
+/// Constant vector of 1.0f, used to efficiently set a vector to one
+static constexpr int ONE = 14;
+/// Constant vector of -0.f, used to efficiently negate a vector with XOR
+static constexpr int NEGBIT = 15;
+
+/// Values of the constant pool, each of them is replicated to fill a whole vector
+enum ConstantIndex : unsigned {
+    CONST_ONE,
+    CONST_NEGBIT,
+    CONST_EXPONENT_MASK,
+    CONST_MANTISSA_MASK,
+    CONST_EXPONENT_BIAS,
+    CONST_NEGATIVE_INFINITY,
+    CONST_DEFAULT_QNAN,
+    CONST_LOG2_C0,
+    CONST_LOG2_C1,
+    CONST_LOG2_C2,
+    CONST_LOG2_C3,
+    CONST_LOG2_C4,
+    CONST_EXP2_INPUT_MAX,
+    CONST_EXP2_INPUT_MIN,
+    CONST_EXP2_HALF,
+    CONST_EXP2_C0,
+    CONST_EXP2_C1,
+    CONST_EXP2_C2,
+    CONST_EXP2_C3,
+    CONST_EXP2_C4,
+    NUM_CONSTANTS,
+};
+
+static const std::array<u32, NUM_CONSTANTS> constant_values = {
+    0x3f800000, // CONST_ONE
+    0x80000000, // CONST_NEGBIT
+    0x7f800000, // CONST_EXPONENT_MASK
+    0x007fffff, // CONST_MANTISSA_MASK
+    0x0000007f, // CONST_EXPONENT_BIAS
+    0xff800000, // CONST_NEGATIVE_INFINITY
+    0x7fc00000, // CONST_DEFAULT_QNAN
+    // The polynomial coefficients and ranges are the ones used by JitShader, so that both
+    // compilers produce the same results.
+    0x3d74552f, // CONST_LOG2_C0
+    0xbeee7397, // CONST_LOG2_C1
+    0x3fbd96dd, // CONST_LOG2_C2
+    0xc02153f6, // CONST_LOG2_C3
+    0x4038d96c, // CONST_LOG2_C4
+    0x43010000, // CONST_EXP2_INPUT_MAX
+    0xc2fdffff, // CONST_EXP2_INPUT_MIN
+    0x3f000000, // CONST_EXP2_HALF
+    0x3c5dbe69, // CONST_EXP2_C0
+    0x3d5509f9, // CONST_EXP2_C1
+    0x3e773cc5, // CONST_EXP2_C2
+    0x3f3168b3, // CONST_EXP2_C3
+    0x3f800016, // CONST_EXP2_C4
+};
+
+/// Size in bytes of a constant vector, the largest supported vector size
+static constexpr std::size_t CONSTANT_SIZE = MAX_BATCH_SIZE * sizeof(u32);
+
+bool JitBatchShader::IsSupported() {
+    // FLR and the vertex selects rely on SSE4.1 instructions
+    return Common::GetCPUCaps().sse4_1;
+}
+
+Xbyak::Xmm JitBatchShader::Vec(int index) const {
+    if (use_avx2)
+        return Xbyak::Ymm(index);
+    return Xbyak::Xmm(index);
+}
+
+Xbyak::Address JitBatchShader::Constant(unsigned index) const {
+    return ptr[rip + (constant_pool + index * CONSTANT_SIZE)];
+}
+
+void JitBatchShader::VMove(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vmovaps(Vec(dest), src);
+    else
+        movaps(Vec(dest), src);
+}
+
+void JitBatchShader::VStore(const Xbyak::Address& dest, int src) {
+    if (use_avx2)
+        vmovaps(dest, Vec(src));
+    else
+        movaps(dest, Vec(src));
+}
+
+void JitBatchShader::VBroadcast(int dest, const Xbyak::Address& src) {
+    if (use_avx2) {
+        vbroadcastss(Vec(dest), src);
+    } else {
+        movss(Vec(dest), src);
+        shufps(Vec(dest), Vec(dest), _MM_SHUFFLE(0, 0, 0, 0));
+    }
+}
+
+void JitBatchShader::VAdd(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vaddps(Vec(dest), Vec(dest), src);
+    else
+        addps(Vec(dest), src);
+}
+
+void JitBatchShader::VSub(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vsubps(Vec(dest), Vec(dest), src);
+    else
+        subps(Vec(dest), src);
+}
+
+void JitBatchShader::VMul(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vmulps(Vec(dest), Vec(dest), src);
+    else
+        mulps(Vec(dest), src);
+}
+
+void JitBatchShader::VMax(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vmaxps(Vec(dest), Vec(dest), src);
+    else
+        maxps(Vec(dest), src);
+}
+
+void JitBatchShader::VMin(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vminps(Vec(dest), Vec(dest), src);
+    else
+        minps(Vec(dest), src);
+}
+
+void JitBatchShader::VAnd(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vandps(Vec(dest), Vec(dest), src);
+    else
+        andps(Vec(dest), src);
+}
+
+void JitBatchShader::VXor(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vxorps(Vec(dest), Vec(dest), src);
+    else
+        xorps(Vec(dest), src);
+}
+
+void JitBatchShader::VCompare(int dest, const Xbyak::Operand& src, u8 predicate) {
+    if (use_avx2)
+        vcmpps(Vec(dest), Vec(dest), src, predicate);
+    else
+        cmpps(Vec(dest), src, predicate);
+}
+
+void JitBatchShader::VFloor(int dest) {
+    if (use_avx2)
+        vroundps(Vec(dest), Vec(dest), _MM_FROUND_FLOOR);
+    else
+        roundps(Vec(dest), Vec(dest), _MM_FROUND_FLOOR);
+}
+
+void JitBatchShader::VReciprocal(int dest) {
+    if (use_avx2)
+        vrcpps(Vec(dest), Vec(dest));
+    else
+        rcpps(Vec(dest), Vec(dest));
+}
+
+void JitBatchShader::VReciprocalSqrt(int dest) {
+    if (use_avx2)
+        vrsqrtps(Vec(dest), Vec(dest));
+    else
+        rsqrtps(Vec(dest), Vec(dest));
+}
+
+void JitBatchShader::VSelect(int dest, int src) {
+    // The SSE4.1 encoding of BLENDVPS implicitly uses XMM0 as the mask
+    if (use_avx2)
+        vblendvps(Vec(dest), Vec(dest), Vec(src), Vec(SCRATCH));
+    else
+        blendvps(Vec(dest), Vec(src));
+}
+
+void JitBatchShader::VIntAdd(int dest, const Xbyak::Operand& src) {
+    if (use_avx2)
+        vpaddd(Vec(dest), Vec(dest), src);
+    else
+        paddd(Vec(dest), src);
+}
+
+void JitBatchShader::VIntShiftRight(int dest, u8 amount) {
+    if (use_avx2)
+        vpsrld(Vec(dest), Vec(dest), amount);
+    else
+        psrld(Vec(dest), amount);
+}
+
+void JitBatchShader::VIntShiftLeft(int dest, u8 amount) {
+    if (use_avx2)
+        vpslld(Vec(dest), Vec(dest), amount);
+    else
+        pslld(Vec(dest), amount);
+}
+
+void JitBatchShader::VIntToFloat(int dest) {
+    if (use_avx2)
+        vcvtdq2ps(Vec(dest), Vec(dest));
+    else
+        cvtdq2ps(Vec(dest), Vec(dest));
+}
+
+void JitBatchShader::VFloatToInt(int dest) {
+    if (use_avx2)
+        vcvtps2dq(Vec(dest), Vec(dest));
+    else
+        cvtps2dq(Vec(dest), Vec(dest));
+}
+
+SwizzlePattern JitBatchShader::GetSwizzle(Instruction instr) const {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        return {(*swizzle_data)[instr.mad.operand_desc_id]};
+    }
+    return {(*swizzle_data)[instr.common.operand_desc_id]};
+}
+
+/**
+ * Loads one component of a swizzled source register for all vertices of the batch.
+ * @param instr VS instruction, used for determining how to load the source register
+ * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+ * @param src_reg SourceRegister object corresponding to the source register to load
+ * @param component Component of the swizzled source register to load
+ * @param dest Destination vector register
+ */
+void JitBatchShader::Compile_LoadSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                                     unsigned component, int dest) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+
+    // Component of the source register selected by the swizzle, the first one being stored in the
+    // most significant bits
+    const unsigned selected = (swiz.GetRawSelector(src_num) >> (6 - 2 * component)) & 3;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    if (src_reg.GetRegisterType() == RegisterType::FloatUniform) {
+        // Uniforms are the same for all vertices and are broadcast to every lane
+        std::size_t src_offset =
+            Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) + selected * sizeof(float24);
+        int src_offset_disp = (int)src_offset;
+        ASSERT_MSG(src_offset == src_offset_disp, "Source register offset too large for int type");
+
+        // Only the loop register can be used for relative addressing, CanRunEntryPoint rejects
+        // programs using the other address registers
+        if (src_num == offset_src && address_register_index == 3) {
+            VBroadcast(dest, ptr[UNIFORMS + LOOPCOUNT_REG.cvt64() + src_offset_disp]);
+        } else {
+            VBroadcast(dest, ptr[UNIFORMS + src_offset_disp]);
+        }
+    } else {
+        VMove(dest, ptr[STATE + BatchUnitState::InputOffset(src_reg, selected)]);
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        VXor(dest, Vec(NEGBIT));
+    }
+}
+
+void JitBatchShader::Compile_StoreDest(Instruction instr, const std::array<int, 4>& results) {
+    DestRegister dest;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        dest = instr.mad.dest.Value();
+    } else {
+        dest = instr.common.dest.Value();
+    }
+
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned component = 0; component < 4; ++component) {
+        if (swiz.DestComponentEnabled(component)) {
+            VStore(ptr[STATE + BatchUnitState::OutputOffset(dest, component)], results[component]);
+        }
+    }
+}
+
+void JitBatchShader::Compile_StoreDestBroadcast(Instruction instr, int result) {
+    Compile_StoreDest(instr, {result, result, result, result});
+}
+
+void JitBatchShader::Compile_SanitizedMul(int src1, int src2, int scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN, see JitShader for details.
+
+    // Set scratch to mask of (src1 != NaN and src2 != NaN)
+    VMove(scratch, Vec(src1));
+    VCompare(scratch, Vec(src2), CMP_ORD);
+
+    VMul(src1, Vec(src2));
+
+    // Set src2 to mask of (result == NaN)
+    VMove(src2, Vec(src1));
+    VCompare(src2, Vec(src2), CMP_UNORD);
+
+    // Clear lanes where scratch != src2 (i.e. if result is NaN where neither source was NaN)
+    VXor(scratch, Vec(src2));
+    VAnd(src1, Vec(scratch));
+}
+
+void JitBatchShader::Compile_Dot(Instruction instr, SourceRegister src1, SourceRegister src2,
+                                 unsigned num_components, bool homogeneous, int dest) {
+    for (unsigned component = 0; component < num_components; ++component) {
+        if (homogeneous && component == 3) {
+            VMove(RESULT[component], Vec(ONE));
+        } else {
+            Compile_LoadSrc(instr, 1, src1, component, RESULT[component]);
+        }
+        Compile_LoadSrc(instr, 2, src2, component, SRC2);
+        Compile_SanitizedMul(RESULT[component], SRC2, SCRATCH);
+    }
+
+    // Sum the products in the same order as the HADDPS based implementation of JitShader
+    if (num_components == 3) {
+        VAdd(RESULT[0], Vec(RESULT[1]));
+        VAdd(RESULT[0], Vec(RESULT[2]));
+    } else {
+        VAdd(RESULT[0], Vec(RESULT[1]));
+        VAdd(RESULT[2], Vec(RESULT[3]));
+        VAdd(RESULT[0], Vec(RESULT[2]));
+    }
+
+    if (dest != RESULT[0]) {
+        VMove(dest, Vec(RESULT[0]));
+    }
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, instr.common.src2, i, SRC2);
+        VAdd(RESULT[i], Vec(SRC2));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    Compile_Dot(instr, instr.common.src1, instr.common.src2, 3, false, RESULT[0]);
+    Compile_StoreDestBroadcast(instr, RESULT[0]);
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    Compile_Dot(instr, instr.common.src1, instr.common.src2, 4, false, RESULT[0]);
+    Compile_StoreDestBroadcast(instr, RESULT[0]);
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_Dot(instr, instr.common.src1i, instr.common.src2i, 4, true, RESULT[0]);
+    } else {
+        Compile_Dot(instr, instr.common.src1, instr.common.src2, 4, true, RESULT[0]);
+    }
+    Compile_StoreDestBroadcast(instr, RESULT[0]);
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    Compile_LoadSrc(instr, 1, instr.common.src1, 0, SRC1);
+    Compile_Exp2();
+    Compile_StoreDestBroadcast(instr, SRC1);
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    Compile_LoadSrc(instr, 1, instr.common.src1, 0, SRC1);
+    Compile_Log2();
+    Compile_StoreDestBroadcast(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, instr.common.src2, i, SRC2);
+        Compile_SanitizedMul(RESULT[i], SRC2, SCRATCH);
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI;
+    const SourceRegister src1 =
+        is_inverted ? instr.common.src1i.Value() : instr.common.src1.Value();
+    const SourceRegister src2 =
+        is_inverted ? instr.common.src2i.Value() : instr.common.src2.Value();
+
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, src1, i, SRC1);
+        Compile_LoadSrc(instr, 2, src2, i, RESULT[i]);
+        VCompare(RESULT[i], Vec(SRC1), CMP_LE);
+        VAnd(RESULT[i], Vec(ONE));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI;
+    const SourceRegister src1 =
+        is_inverted ? instr.common.src1i.Value() : instr.common.src1.Value();
+    const SourceRegister src2 =
+        is_inverted ? instr.common.src2i.Value() : instr.common.src2.Value();
+
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, src2, i, SRC2);
+        VCompare(RESULT[i], Vec(SRC2), CMP_LT);
+        VAnd(RESULT[i], Vec(ONE));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        VFloor(RESULT[i]);
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, instr.common.src2, i, SRC2);
+        // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+        VMax(RESULT[i], Vec(SRC2));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, instr.common.src2, i, SRC2);
+        // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+        VMin(RESULT[i], Vec(SRC2));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (swiz.DestComponentEnabled(i)) {
+            Compile_LoadSrc(instr, 1, instr.common.src1, i, RESULT[i]);
+        }
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    Compile_LoadSrc(instr, 1, instr.common.src1, 0, SRC1);
+    // Uses the same approximation as the RCPSS instruction emitted by JitShader
+    VReciprocal(SRC1);
+    Compile_StoreDestBroadcast(instr, SRC1);
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    Compile_LoadSrc(instr, 1, instr.common.src1, 0, SRC1);
+    // Uses the same approximation as the RSQRTSS instruction emitted by JitShader
+    VReciprocalSqrt(SRC1);
+    Compile_StoreDestBroadcast(instr, SRC1);
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_Unsupported(Instruction instr) {
+    // Instructions that depend on per-vertex state can't be batched. CanRunEntryPoint ensures that
+    // they are never reached, so nothing needs to be emitted for them.
+}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    // Save loop register
+    sar(LOOPCOUNT_REG, 4);
+    mov(dword[STATE + offsetof(BatchUnitState, address_registers[2])], LOOPCOUNT_REG);
+
+    if (use_avx2) {
+        // Avoid SSE/AVX transition penalties in the caller
+        vzeroupper();
+    }
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+    const SourceRegister src2 = is_inverted ? instr.mad.src2i.Value() : instr.mad.src2.Value();
+    const SourceRegister src3 = is_inverted ? instr.mad.src3i.Value() : instr.mad.src3.Value();
+
+    const SwizzlePattern swiz = GetSwizzle(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+        Compile_LoadSrc(instr, 1, instr.mad.src1, i, RESULT[i]);
+        Compile_LoadSrc(instr, 2, src2, i, SRC2);
+        Compile_LoadSrc(instr, 3, src3, i, SRC3);
+        Compile_SanitizedMul(RESULT[i], SRC2, SCRATCH);
+        VAdd(RESULT[i], Vec(SRC3));
+    }
+    Compile_StoreDest(instr, RESULT);
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    Compile_UniformCondition(instr);
+    jz(l_else, T_NEAR);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    jmp(l_endif, T_NEAR);
+
+    L(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    looping = true;
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id,
+    // see JitShader::Compile_LOOP
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 4);
+    and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 12);
+    and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    sub(LOOPCOUNT, 1);           // Increment loop count by 1
+    jnz(l_loop_start);           // Loop if not equal
+
+    looping = false;
+}
+
+void JitBatchShader::Compile_JMP(Instruction instr) {
+    Compile_UniformCondition(instr);
+
+    bool inverted_condition = (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        jz(b, T_NEAR);
+    } else {
+        jnz(b, T_NEAR);
+    }
+}
+
+void JitBatchShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = batch_instr_table[static_cast<unsigned>(opcode)];
+
+    if (instr_func) {
+        // JIT the instruction!
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitBatchShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+/// Returns whether the relative addressing used by an arithmetic instruction can be batched.
+static bool IsAddressingSupported(Instruction instr) {
+    const OpCode opcode = instr.opcode.Value();
+    const bool is_inverted = (0 != (opcode.GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    SourceRegister offset_src;
+    if (opcode.EffectiveOpCode() == OpCode::Id::MAD ||
+        opcode.EffectiveOpCode() == OpCode::Id::MADI) {
+        address_register_index = instr.mad.address_register_index;
+        offset_src = is_inverted ? instr.mad.src3i.Value() : instr.mad.src2.Value();
+    } else {
+        address_register_index = instr.common.address_register_index;
+        offset_src = is_inverted ? instr.common.src2i.Value() : instr.common.src1.Value();
+    }
+
+    if (address_register_index == 0)
+        return true;
+
+    // a0 and a1 are set per vertex by MOVA. The loop register is uniform, but relative indexing of
+    // input and temporary registers is not implemented for the SoA register layout.
+    return address_register_index == 3 &&
+           offset_src.GetRegisterType() == RegisterType::FloatUniform;
+}
+
+bool JitBatchShader::CanRunEntryPoint(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& code,
+                                      unsigned entry_point) {
+    // Walk all instructions reachable from the entry point. Each path is tracked along with the
+    // return offset of the innermost subroutine it is part of (if any), mirroring the return
+    // checks performed by the compiled code.
+    constexpr unsigned NO_RETURN = ~0u;
+    std::set<std::pair<unsigned, unsigned>> visited;
+    std::vector<std::pair<unsigned, unsigned>> pending = {{entry_point, NO_RETURN}};
+    bool supported = true;
+
+    while (supported && !pending.empty()) {
+        const auto [offset, return_offset] = pending.back();
+        pending.pop_back();
+
+        if (offset >= code.size() || offset == return_offset ||
+            !visited.emplace(offset, return_offset).second) {
+            continue;
+        }
+
+        const Instruction instr = {code[offset]};
+        const OpCode opcode = instr.opcode.Value();
+        const OpCode::Id opcode_id = opcode;
+        const auto instr_func = batch_instr_table[static_cast<unsigned>(opcode_id)];
+        if (instr_func == nullptr || instr_func == &JitBatchShader::Compile_Unsupported) {
+            supported = false;
+            break;
+        }
+
+        switch (opcode.GetInfo().type) {
+        case OpCode::Type::Arithmetic:
+        case OpCode::Type::MultiplyAdd:
+            supported = IsAddressingSupported(instr);
+            pending.emplace_back(offset + 1, return_offset);
+            break;
+
+        default:
+            switch (opcode.EffectiveOpCode()) {
+            case OpCode::Id::END:
+                break;
+
+            case OpCode::Id::CALL:
+            case OpCode::Id::CALLU:
+                pending.emplace_back(offset + 1, return_offset);
+                pending.emplace_back(instr.flow_control.dest_offset,
+                                     instr.flow_control.dest_offset +
+                                         instr.flow_control.num_instructions);
+                break;
+
+            case OpCode::Id::IFU:
+                // Backwards blocks are not supported by the compiler
+                supported = instr.flow_control.dest_offset >= offset;
+                pending.emplace_back(offset + 1, return_offset);
+                pending.emplace_back(instr.flow_control.dest_offset, return_offset);
+                pending.emplace_back(instr.flow_control.dest_offset +
+                                         instr.flow_control.num_instructions,
+                                     return_offset);
+                break;
+
+            case OpCode::Id::LOOP:
+                supported = instr.flow_control.dest_offset >= offset;
+                pending.emplace_back(offset + 1, return_offset);
+                pending.emplace_back(instr.flow_control.dest_offset + 1, return_offset);
+                break;
+
+            case OpCode::Id::JMPU:
+                pending.emplace_back(offset + 1, return_offset);
+                pending.emplace_back(instr.flow_control.dest_offset, return_offset);
+                break;
+
+            default:
+                pending.emplace_back(offset + 1, return_offset);
+                break;
+            }
+            break;
+        }
+    }
+
+    return supported;
+}
+
+void JitBatchShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                             const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    // Reset flow control state
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+    looping = false;
+    instruction_labels.fill(Xbyak::Label());
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // See JitShader::Compile for the stack layout
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+
+    // Load loop register
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(BatchUnitState, address_registers[2])]);
+    shl(LOOPCOUNT_REG, 4);
+
+    VMove(ONE, Constant(CONST_ONE));
+    VMove(NEGBIT, Constant(CONST_NEGBIT));
+
+    // Jump to start of the shader program
+    jmp(ABI_PARAM3);
+
+    // Compile entire program
+    Compile_Block(static_cast<unsigned>(program_code->size()));
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_BATCH_SHADER_SIZE,
+               "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={}, batch size={}", getSize(), batch_size);
+}
+
+JitBatchShader::JitBatchShader()
+    : Xbyak::CodeGenerator(MAX_BATCH_SHADER_SIZE), use_avx2(Common::GetCPUCaps().avx2),
+      batch_size(use_avx2 ? 8 : 4) {
+    CompilePrelude();
+}
+
+void JitBatchShader::CompilePrelude() {
+    align(CONSTANT_SIZE);
+    constant_pool = getCurr();
+    for (u32 value : constant_values) {
+        for (unsigned lane = 0; lane < MAX_BATCH_SIZE; ++lane) {
+            dd(value);
+        }
+    }
+}
+
+void JitBatchShader::Compile_Log2() {
+    // Vectorized version of JitShader::CompilePrelude_Log2, performing the same operations in the
+    // same order. The edge cases are handled by selecting the appropriate results at the end.
+
+    // Keep the input around for the edge cases
+    VMove(SRC2, Vec(SRC1));
+
+    // Split input
+    VMove(SRC3, Vec(SRC1));
+    VAnd(SRC3, Constant(CONST_EXPONENT_MASK));
+    VIntShiftRight(SRC3, 23);
+    if (use_avx2)
+        vpsubd(Vec(SRC3), Vec(SRC3), Constant(CONST_EXPONENT_BIAS));
+    else
+        psubd(Vec(SRC3), Constant(CONST_EXPONENT_BIAS));
+    VIntToFloat(SRC3);
+    // SRC3 now contains the exponent of the input.
+    VAnd(SRC1, Constant(CONST_MANTISSA_MASK));
+    if (use_avx2)
+        vorps(Vec(SRC1), Vec(SRC1), Vec(ONE));
+    else
+        orps(Vec(SRC1), Vec(ONE));
+    // SRC1 now contains the mantissa of the input.
+
+    // Compute polynomial
+    VMove(SCRATCH2, Constant(CONST_LOG2_C0));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SCRATCH2, Constant(CONST_LOG2_C1));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SCRATCH2, Constant(CONST_LOG2_C2));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SCRATCH2, Constant(CONST_LOG2_C3));
+    VMul(SCRATCH2, Vec(SRC1));
+    VSub(SRC1, Vec(ONE));
+    VAdd(SCRATCH2, Constant(CONST_LOG2_C4));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SRC3, Vec(SCRATCH2));
+    VMove(SRC1, Vec(SRC3));
+
+    // Inputs that are zero or negative return -inf and NaN respectively
+    VXor(SCRATCH3, Vec(SCRATCH3));
+    VMove(SCRATCH, Vec(SRC2));
+    VCompare(SCRATCH, Vec(SCRATCH3), CMP_LE);
+    VMove(SCRATCH2, Constant(CONST_DEFAULT_QNAN));
+    VSelect(SRC1, SCRATCH2);
+
+    VMove(SCRATCH, Vec(SRC2));
+    VCompare(SCRATCH, Vec(SCRATCH3), CMP_EQ);
+    VMove(SCRATCH2, Constant(CONST_NEGATIVE_INFINITY));
+    VSelect(SRC1, SCRATCH2);
+
+    // NaN inputs are returned unmodified
+    VMove(SCRATCH, Vec(SRC2));
+    VCompare(SCRATCH, Vec(SRC2), CMP_UNORD);
+    VSelect(SRC1, SRC2);
+}
+
+void JitBatchShader::Compile_Exp2() {
+    // Vectorized version of JitShader::CompilePrelude_Exp2, performing the same operations in the
+    // same order. NaN inputs are selected back at the end.
+
+    // Keep the input around for the edge cases
+    VMove(SRC2, Vec(SRC1));
+
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    VMin(SRC1, Constant(CONST_EXP2_INPUT_MAX));
+    VMax(SRC1, Constant(CONST_EXP2_INPUT_MIN));
+
+    // Decompose input
+    VMove(SRC3, Vec(SRC1));
+    VSub(SRC3, Constant(CONST_EXP2_HALF));
+    VFloatToInt(SRC3);
+    VMove(SCRATCH, Vec(SRC3));
+    VIntToFloat(SCRATCH);
+    // SCRATCH now contains input rounded to the nearest integer.
+    VIntAdd(SRC3, Constant(CONST_EXPONENT_BIAS));
+    VSub(SRC1, Vec(SCRATCH));
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    VMove(SCRATCH2, Constant(CONST_EXP2_C0));
+    VMul(SCRATCH2, Vec(SRC1));
+    VIntShiftLeft(SRC3, 23);
+    // SRC3 contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    VAdd(SCRATCH2, Constant(CONST_EXP2_C1));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SCRATCH2, Constant(CONST_EXP2_C2));
+    VMul(SCRATCH2, Vec(SRC1));
+    VAdd(SCRATCH2, Constant(CONST_EXP2_C3));
+    VMul(SRC1, Vec(SCRATCH2));
+    VAdd(SRC1, Constant(CONST_EXP2_C4));
+    VMul(SRC1, Vec(SRC3));
+
+    // NaN inputs are returned unmodified
+    VMove(SCRATCH, Vec(SRC2));
+    VCompare(SCRATCH, Vec(SRC2), CMP_UNORD);
+    VSelect(SRC1, SRC2);
+}
+
+} // namespace Shader
+
+} // namespace Pica
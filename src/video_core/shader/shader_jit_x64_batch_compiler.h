@@ -0,0 +1,184 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/shader/shader.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SwizzlePattern;
+
+namespace Pica {
+
+namespace Shader {
+
+/// Memory allocated for each compiled batch shader
+constexpr std::size_t MAX_BATCH_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 512;
+
+/**
+ * This class implements a shader JIT compiler that processes several vertices per invocation. The
+ * program is recompiled into x86_64 code operating on a BatchUnitState, where each SIMD register
+ * holds the same component of 4 (SSE4.1) or 8 (AVX2) vertices.
+ *
+ * Since all vertices of a batch execute the same instructions, only programs whose control flow
+ * does not depend on per-vertex data can be batched: conditional code based branches (IFC, CALLC,
+ * JMPC, BREAKC), MOVA and relative addressing through the address registers, as well as geometry
+ * shader instructions, are not supported. CanRunEntryPoint tells whether the code reachable from an
+ * entry point meets these requirements; other programs have to be run by the per-vertex JitShader.
+ */
+class JitBatchShader : public Xbyak::CodeGenerator {
+public:
+    JitBatchShader();
+
+    /// Returns whether the host CPU supports batched shader execution.
+    static bool IsSupported();
+
+    /// Number of vertices processed by each invocation of the compiled program.
+    unsigned GetBatchSize() const {
+        return batch_size;
+    }
+
+    bool IsCompiled() const {
+        return program != nullptr;
+    }
+
+    void Run(const ShaderSetup& setup, BatchUnitState& state, unsigned offset) const {
+        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+    }
+
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+
+    /**
+     * Checks whether the code reachable from an entry point can be executed in batches. This only
+     * inspects the program, so it can be done before allocating a shader.
+     */
+    static bool CanRunEntryPoint(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                                 unsigned entry_point);
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+    void Compile_Unsupported(Instruction instr);
+
+private:
+    void Compile_Block(unsigned end);
+    void Compile_NextInstr();
+
+    /// Returns the swizzle pattern referenced by an arithmetic instruction.
+    SwizzlePattern GetSwizzle(Instruction instr) const;
+
+    /**
+     * Loads one component of a swizzled source register for all vertices of the batch.
+     * @param component Destination component, the swizzle determines the one loaded
+     */
+    void Compile_LoadSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                         unsigned component, int dest);
+
+    /// Stores the per-component results held in `results` to the enabled destination components.
+    void Compile_StoreDest(Instruction instr, const std::array<int, 4>& results);
+
+    /// Stores `result` to all enabled destination components.
+    void Compile_StoreDestBroadcast(Instruction instr, int result);
+
+    /// Computes the dot product of the first `num_components` swizzled components into `dest`.
+    void Compile_Dot(Instruction instr, SourceRegister src1, SourceRegister src2,
+                     unsigned num_components, bool homogeneous, int dest);
+
+    /**
+     * Compiles a `MUL src1, src2` operation, properly handling the PICA semantics when multiplying
+     * zero by inf. Clobbers `src2` and `scratch`.
+     */
+    void Compile_SanitizedMul(int src1, int src2, int scratch);
+
+    void Compile_UniformCondition(Instruction instr);
+    void Compile_Return();
+
+    void FindReturnOffsets();
+
+    // Emitters selecting between SSE and AVX encodings depending on the batch size. Vector
+    // registers are referred to by index. Binary operations behave like their two-operand SSE
+    // counterparts, i.e. `dest = dest op src`.
+    Xbyak::Xmm Vec(int index) const;
+    Xbyak::Address Constant(unsigned index) const;
+    void VMove(int dest, const Xbyak::Operand& src);
+    void VStore(const Xbyak::Address& dest, int src);
+    void VBroadcast(int dest, const Xbyak::Address& src);
+    void VAdd(int dest, const Xbyak::Operand& src);
+    void VSub(int dest, const Xbyak::Operand& src);
+    void VMul(int dest, const Xbyak::Operand& src);
+    void VMax(int dest, const Xbyak::Operand& src);
+    void VMin(int dest, const Xbyak::Operand& src);
+    void VAnd(int dest, const Xbyak::Operand& src);
+    void VXor(int dest, const Xbyak::Operand& src);
+    void VCompare(int dest, const Xbyak::Operand& src, u8 predicate);
+    void VFloor(int dest);
+    void VReciprocal(int dest);
+    void VReciprocalSqrt(int dest);
+    /// dest = mask ? src : dest, where `mask` has to be the SCRATCH register.
+    void VSelect(int dest, int src);
+    void VIntAdd(int dest, const Xbyak::Operand& src);
+    void VIntShiftRight(int dest, u8 amount);
+    void VIntShiftLeft(int dest, u8 amount);
+    void VIntToFloat(int dest);
+    void VFloatToInt(int dest);
+
+    /// Emits the vectorized log2/exp2 approximations, operating in place on the SRC1 register.
+    void Compile_Log2();
+    void Compile_Exp2();
+
+    void CompilePrelude();
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<unsigned> return_offsets;
+
+    unsigned program_counter = 0; ///< Offset of the next instruction to decode
+    bool looping = false;         ///< True if compiling a loop, used to check for nested loops
+
+    bool use_avx2;
+    unsigned batch_size;
+
+    /// Vectors of constants used by the compiled code, emitted in front of the program
+    const u8* constant_pool = nullptr;
+
+    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    CompiledShader* program = nullptr;
+};
+
+} // namespace Shader
+
+} // namespace Pica
@@ -20,7 +20,7 @@ namespace Pica {
 namespace Rasterizer {
 
 void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
@@ -32,7 +32,7 @@ void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
         GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
     u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
                      coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    u8* dst_pixel = VideoCore::GetMemory().GetPhysicalPointer(addr) + dst_offset;
 
     switch (framebuffer.color_format) {
     case FramebufferRegs::ColorFormat::RGBA8:
@@ -63,7 +63,7 @@ void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
 }
 
 const Math::Vec4<u8> GetPixel(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     y = framebuffer.height - y;
@@ -73,7 +73,7 @@ const Math::Vec4<u8> GetPixel(int x, int y) {
         GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
     u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
                      coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + src_offset;
+    u8* src_pixel = VideoCore::GetMemory().GetPhysicalPointer(addr) + src_offset;
 
     switch (framebuffer.color_format) {
     case FramebufferRegs::ColorFormat::RGBA8:
@@ -101,9 +101,9 @@ const Math::Vec4<u8> GetPixel(int x, int y) {
 }
 
 u32 GetDepth(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+    u8* depth_buffer = VideoCore::GetMemory().GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -130,9 +130,9 @@ u32 GetDepth(int x, int y) {
 }
 
 u8 GetStencil(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+    u8* depth_buffer = VideoCore::GetMemory().GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -157,9 +157,9 @@ u8 GetStencil(int x, int y) {
 }
 
 void SetDepth(int x, int y, u32 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+    u8* depth_buffer = VideoCore::GetMemory().GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -192,9 +192,9 @@ void SetDepth(int x, int y, u32 value) {
 }
 
 void SetStencil(int x, int y, u8 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
     const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
+    u8* depth_buffer = VideoCore::GetMemory().GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -375,8 +375,8 @@ static void EncodeX24S8Shadow(u8 stencil, u8* bytes) {
 }
 
 void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const auto& shadow = g_state.regs.framebuffer.shadow;
+    const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
+    const auto& shadow = GetState().regs.framebuffer.shadow;
     const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     y = framebuffer.height - y;
@@ -385,7 +385,7 @@ void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
     u32 bytes_per_pixel = 4;
     u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
                      coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    u8* dst_pixel = VideoCore::GetMemory().GetPhysicalPointer(addr) + dst_offset;
 
     auto ref = DecodeD24S8Shadow(dst_pixel);
     u32 ref_z = ref.x;
@@ -5,12 +5,15 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -28,6 +31,7 @@
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/texturing.h"
+#include "video_core/swrasterizer/tile_rasterizer.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
@@ -120,25 +124,31 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+// vertex positions in rasterizer coordinates
+static Fix12P4 FloatToFix(float24 flt) {
+    // TODO: Rounding here is necessary to prevent garbage pixels at
+    //       triangle borders. Is it that the correct solution, though?
+    return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
+}
+
+static Math::Vec3<Fix12P4> ScreenToRasterizerCoordinates(const Math::Vec3<float24>& vec) {
+    return Math::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
+}
+
+/// Rasterizes the whole triangle when no bounds are given
+constexpr MathUtil::Rectangle<unsigned> NO_BOUNDS{0, 0, 0x1000, 0x1000};
+
 /**
  * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
  * culling via recursion.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                    const MathUtil::Rectangle<unsigned>& bounds,
                                     bool reversed = false) {
-    const auto& regs = g_state.regs;
+    const State& state = GetState();
+    const auto& regs = state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
 
-    // vertex positions in rasterizer coordinates
-    static auto FloatToFix = [](float24 flt) {
-        // TODO: Rounding here is necessary to prevent garbage pixels at
-        //       triangle borders. Is it that the correct solution, though?
-        return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
-    };
-    static auto ScreenToRasterizerCoordinates = [](const Math::Vec3<float24>& vec) {
-        return Math::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
-    };
-
     Math::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
                                   ScreenToRasterizerCoordinates(v1.screenpos),
                                   ScreenToRasterizerCoordinates(v2.screenpos)};
@@ -146,13 +156,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, bounds, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, bounds, true);
             return;
         }
 
@@ -186,6 +196,12 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    // Only visit the pixels within the given bounds
+    min_x = static_cast<u16>(std::max<unsigned>(min_x, bounds.left << 4));
+    min_y = static_cast<u16>(std::max<unsigned>(min_y, bounds.top << 4));
+    max_x = static_cast<u16>(std::min<unsigned>(max_x, bounds.right << 4));
+    max_y = static_cast<u16>(std::min<unsigned>(max_y, bounds.bottom << 4));
+
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -217,9 +233,9 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     auto tev_stages = regs.texturing.GetTevStages();
 
     bool stencil_action_enable =
-        g_state.regs.framebuffer.output_merger.stencil_test.enable &&
-        g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
-    const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+        regs.framebuffer.output_merger.stencil_test.enable &&
+        regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+    const auto stencil_test = regs.framebuffer.output_merger.stencil_test;
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
@@ -404,7 +420,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
 
                     const u8* texture_data =
-                        VideoCore::g_memory->GetPhysicalPointer(texture_address);
+                        VideoCore::GetMemory().GetPhysicalPointer(texture_address);
                     auto info =
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
@@ -433,7 +449,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (regs.texturing.main_config.texture3_enable) {
                 const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
                 texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                           g_state.regs.texturing, g_state.proctex);
+                                           regs.texturing, state.proctex);
             }
 
             // Texture environment - consists of 6 stages of color and alpha combining.
@@ -455,7 +471,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             Math::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
             Math::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
 
-            if (!g_state.regs.lighting.disable) {
+            if (!regs.lighting.disable) {
                 Math::Quaternion<float> normquat =
                     Math::Quaternion<float>{
                         {GetInterpolatedAttribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
@@ -471,7 +487,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
                 std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+                    regs.lighting, state.lighting, normquat, view, texture_color);
             }
 
             for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
@@ -639,7 +655,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 
                 // Get index into fog LUT
                 float fog_index;
-                if (g_state.regs.texturing.fog_flip) {
+                if (regs.texturing.fog_flip) {
                     fog_index = (1.0f - depth) * 128.0f;
                 } else {
                     fog_index = depth * 128.0f;
@@ -648,7 +664,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 // Generate clamped fog factor from LUT for given fog index
                 float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
                 float fog_f = fog_index - fog_i;
-                const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
+                const auto& fog_lut_entry = state.fog.lut[static_cast<unsigned int>(fog_i)];
                 float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
                 fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
 
@@ -661,11 +677,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 
             u8 old_stencil = 0;
 
-            auto UpdateStencil = [stencil_test, x, y,
+            auto UpdateStencil = [stencil_test, x, y, &regs,
                                   &old_stencil](Pica::FramebufferRegs::StencilAction action) {
                 u8 new_stencil =
                     PerformStencilAction(action, old_stencil, stencil_test.reference_value);
-                if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
+                if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
                     SetStencil(x >> 4, y >> 4,
                                (new_stencil & stencil_test.write_mask) |
                                    (old_stencil & ~stencil_test.write_mask));
@@ -890,7 +906,54 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 }
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    if (const auto& tile_rasterizer = VideoCore::GetInstanceState().tile_rasterizer) {
+        tile_rasterizer->AddTriangle(v0, v1, v2);
+    } else {
+        ProcessTriangleInternal(v0, v1, v2, NO_BOUNDS);
+    }
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const MathUtil::Rectangle<unsigned>& bounds) {
+    ProcessTriangleInternal(v0, v1, v2, bounds);
+}
+
+MathUtil::Rectangle<unsigned> GetTriangleBounds(const Vertex& v0, const Vertex& v1,
+                                                const Vertex& v2) {
+    const Fix12P4 x[3]{FloatToFix(v0.screenpos.x), FloatToFix(v1.screenpos.x),
+                       FloatToFix(v2.screenpos.x)};
+    const Fix12P4 y[3]{FloatToFix(v0.screenpos.y), FloatToFix(v1.screenpos.y),
+                       FloatToFix(v2.screenpos.y)};
+    const unsigned min_x = std::min({x[0], x[1], x[2]});
+    const unsigned min_y = std::min({y[0], y[1], y[2]});
+    const unsigned max_x = std::max({x[0], x[1], x[2]}) + Fix12P4::FracMask();
+    const unsigned max_y = std::max({y[0], y[1], y[2]}) + Fix12P4::FracMask();
+    return {min_x >> 4, min_y >> 4, max_x >> 4, max_y >> 4};
+}
+
+void SetNumThreads(unsigned num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    auto& tile_rasterizer = VideoCore::GetInstanceState().tile_rasterizer;
+    const unsigned current_threads = tile_rasterizer ? tile_rasterizer->GetNumThreads() : 1;
+    if (num_threads == current_threads) {
+        return;
+    }
+
+    FlushTriangles();
+    if (num_threads > 1) {
+        tile_rasterizer = std::make_unique<TileRasterizer>(num_threads);
+    } else {
+        tile_rasterizer.reset();
+    }
+}
+
+void FlushTriangles() {
+    if (const auto& tile_rasterizer = VideoCore::GetInstanceState().tile_rasterizer) {
+        tile_rasterizer->Flush();
+    }
 }
 
 } // namespace Rasterizer
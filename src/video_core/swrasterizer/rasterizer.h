@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
@@ -40,7 +41,29 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/// Rasterizes a triangle, or queues it when tile-parallel rasterization is enabled.
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/**
+ * Rasterizes a triangle right away, only drawing the pixels within the given bounds. The right and
+ * bottom edges of the bounds are excluded.
+ */
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const MathUtil::Rectangle<unsigned>& bounds);
+
+/// Returns the pixels a triangle may cover, with the right and bottom edges excluded.
+MathUtil::Rectangle<unsigned> GetTriangleBounds(const Vertex& v0, const Vertex& v1,
+                                                const Vertex& v2);
+
+/**
+ * Sets the number of threads used to rasterize triangles, 0 meaning one per host CPU core. With
+ * more than one thread, triangles are queued by ProcessTriangle and rasterized in parallel by
+ * screen tiles on FlushTriangles.
+ */
+void SetNumThreads(unsigned num_threads);
+
+/// Rasterizes the queued triangles. Has to be done before the PICA state or framebuffer changes.
+void FlushTriangles();
+
 } // namespace Rasterizer
 } // namespace Pica
@@ -3,14 +3,48 @@
 // Refer to the license.txt file included.
 
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    Pica::Rasterizer::SetNumThreads(g_sw_rasterizer_threads);
+}
+
+SWRasterizer::~SWRasterizer() {
+    Pica::Rasterizer::SetNumThreads(1);
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::FlushTriangles();
+    Pica::Rasterizer::SetNumThreads(g_sw_rasterizer_threads);
+}
+
+// Triangles queued for tile-parallel rasterization depend on the current PICA state, and have to be
+// drawn before the framebuffer is read.
+
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    Pica::Rasterizer::FlushTriangles();
+}
+
+void SWRasterizer::FlushAll() {
+    Pica::Rasterizer::FlushTriangles();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::FlushTriangles();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::FlushTriangles();
+}
+
 } // namespace VideoCore
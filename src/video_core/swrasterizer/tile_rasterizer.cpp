@@ -0,0 +1,150 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/tile_rasterizer.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_TileRasterization, "GPU", "Tile Rasterization", MP_RGB(80, 80, 240));
+
+/// Rasterizer coordinates are 12.4 fixed point, the edge tiles extend to the end of that range
+constexpr unsigned MAX_COORDINATE = 0x1000;
+
+TileRasterizer::TileRasterizer(unsigned num_threads) : system(Core::System::GetInstance()) {
+    for (unsigned i = 1; i < num_threads; ++i) {
+        workers.emplace_back([this] { WorkerThread(); });
+    }
+}
+
+TileRasterizer::~TileRasterizer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TileRasterizer::AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    if (triangles.empty()) {
+        // The framebuffer can only change between flushes
+        const auto& framebuffer = GetState().regs.framebuffer.framebuffer;
+        tiles_x = std::max((framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE, 1u);
+        tiles_y = std::max((framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE, 1u);
+        bins.resize(tiles_x * tiles_y);
+    }
+
+    const auto bounds = GetTriangleBounds(v0, v1, v2);
+    if (bounds.right <= bounds.left || bounds.bottom <= bounds.top) {
+        return;
+    }
+
+    // Pixels beyond the framebuffer belong to the edge tiles
+    const unsigned first_x = std::min(bounds.left / TILE_SIZE, tiles_x - 1);
+    const unsigned first_y = std::min(bounds.top / TILE_SIZE, tiles_y - 1);
+    const unsigned last_x = std::min((bounds.right - 1) / TILE_SIZE, tiles_x - 1);
+    const unsigned last_y = std::min((bounds.bottom - 1) / TILE_SIZE, tiles_y - 1);
+
+    const u32 index = static_cast<u32>(triangles.size());
+    triangles.push_back({v0, v1, v2});
+    for (unsigned y = first_y; y <= last_y; ++y) {
+        for (unsigned x = first_x; x <= last_x; ++x) {
+            auto& bin = bins[y * tiles_x + x];
+            if (bin.empty()) {
+                active_tiles.push_back(y * tiles_x + x);
+            }
+            bin.push_back(index);
+        }
+    }
+}
+
+void TileRasterizer::Flush() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_TileRasterization);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        next_tile = 0;
+        busy_workers = static_cast<unsigned>(workers.size());
+        ++flush_count;
+    }
+    work_available.notify_all();
+
+    RenderTiles();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [this] { return busy_workers == 0; });
+    }
+
+    for (u32 tile : active_tiles) {
+        bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void TileRasterizer::WorkerThread() {
+    Common::SetCurrentThreadName("SWRasterizer");
+    Core::System::InstanceScope instance_scope{system};
+
+    u64 last_flush = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_available.wait(lock, [&] { return stop || flush_count != last_flush; });
+            if (stop) {
+                return;
+            }
+            last_flush = flush_count;
+        }
+
+        RenderTiles();
+
+        bool last_worker;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_worker = --busy_workers == 0;
+        }
+        if (last_worker) {
+            work_done.notify_one();
+        }
+    }
+}
+
+void TileRasterizer::RenderTiles() {
+    const u32 num_tiles = static_cast<u32>(active_tiles.size());
+    for (u32 i = next_tile++; i < num_tiles; i = next_tile++) {
+        const u32 tile = active_tiles[i];
+        const unsigned x = tile % tiles_x;
+        const unsigned y = tile / tiles_x;
+
+        MathUtil::Rectangle<unsigned> bounds{x * TILE_SIZE, y * TILE_SIZE, (x + 1) * TILE_SIZE,
+                                             (y + 1) * TILE_SIZE};
+        if (x == tiles_x - 1) {
+            bounds.right = MAX_COORDINATE;
+        }
+        if (y == tiles_y - 1) {
+            bounds.bottom = MAX_COORDINATE;
+        }
+
+        for (u32 index : bins[tile]) {
+            const Triangle& triangle = triangles[index];
+            ProcessTriangle(triangle.v0, triangle.v1, triangle.v2, bounds);
+        }
+    }
+}
+
+} // namespace Rasterizer
+} // namespace Pica
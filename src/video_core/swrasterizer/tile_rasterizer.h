@@ -0,0 +1,80 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Core {
+class System;
+}
+
+namespace Pica {
+namespace Rasterizer {
+
+/**
+ * Rasterizes triangles in parallel by splitting the screen into tiles. Triangles are binned into
+ * the tiles they overlap as they are added, and each tile is then rendered by a single thread,
+ * drawing its triangles in submission order. Since every pixel is only touched by one thread, in
+ * the same order as with serial rasterization, depth, stencil and blending results are identical.
+ */
+class TileRasterizer {
+public:
+    /// Side length of the square screen tiles, in pixels
+    static constexpr unsigned TILE_SIZE = 32;
+
+    /// The thread calling Flush takes part in rendering, so `num_threads - 1` workers are created.
+    explicit TileRasterizer(unsigned num_threads);
+    ~TileRasterizer();
+
+    unsigned GetNumThreads() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes the triangles added since the last flush, and waits for completion.
+    void Flush();
+
+private:
+    struct Triangle {
+        Vertex v0;
+        Vertex v1;
+        Vertex v2;
+    };
+
+    void WorkerThread();
+
+    /// Renders tiles until all tiles of the current flush have been taken.
+    void RenderTiles();
+
+    std::vector<Triangle> triangles;
+
+    /// Indices of the triangles overlapping each tile, in submission order
+    std::vector<std::vector<u32>> bins;
+    /// Tiles with a non-empty bin, to be rendered on the next flush
+    std::vector<u32> active_tiles;
+    unsigned tiles_x = 0;
+    unsigned tiles_y = 0;
+
+    /// The System the workers render for, bound on their threads for GetState
+    Core::System& system;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    u64 flush_count = 0;          ///< Incremented to wake up the workers on each flush
+    unsigned busy_workers = 0;    ///< Workers which haven't finished the current flush
+    bool stop = false;            ///< Tells the workers to exit
+    std::atomic<u32> next_tile{}; ///< Index of the next entry of active_tiles to be rendered
+};
+
+} // namespace Rasterizer
+} // namespace Pica
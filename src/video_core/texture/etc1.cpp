@@ -4,9 +4,11 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
+#include "common/swap.h"
 #include "common/vector_math.h"
 #include "video_core/texture/etc1.h"
 
@@ -118,6 +120,34 @@ union ETC1Tile {
     }
 };
 
+void DecodeETC1TileScalar(const u8* tile, bool has_alpha, u8* dest) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    for (unsigned subtile = 0; subtile < 4; ++subtile) {
+        const u8* subtile_ptr = tile + subtile * subtile_size;
+
+        u64_le packed_alpha = 0xFFFFFFFFFFFFFFFF;
+        if (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        std::memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+
+        for (unsigned y = 0; y < 4; ++y) {
+            for (unsigned x = 0; x < 4; ++x) {
+                const auto rgb = SampleETC1Subtile(subtile_data, x, y);
+                const u8 alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                u8* texel = dest + ((subtile / 2 * 4 + y) * 8 + subtile % 2 * 4 + x) * 4;
+                texel[0] = rgb.r();
+                texel[1] = rgb.g();
+                texel[2] = rgb.b();
+                texel[3] = alpha;
+            }
+        }
+    }
+}
+
 } // anonymous namespace
 
 Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
@@ -125,5 +155,54 @@ Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+ETC1BlockInfo GetETC1BlockInfo(u64 value) {
+    const ETC1Tile tile{value};
+    ETC1BlockInfo info;
+    info.flip = tile.flip;
+
+    const unsigned table_indices[2] = {static_cast<unsigned>(tile.table_index_1),
+                                       static_cast<unsigned>(tile.table_index_2)};
+    for (unsigned half = 0; half < 2; ++half) {
+        u8* color = info.base_colors[half];
+        if (tile.differential_mode) {
+            const bool add_delta = half == 1;
+            color[0] = Color::Convert5To8(static_cast<u8>(
+                static_cast<int>(tile.differential.r) +
+                (add_delta ? static_cast<int>(tile.differential.dr) : 0)));
+            color[1] = Color::Convert5To8(static_cast<u8>(
+                static_cast<int>(tile.differential.g) +
+                (add_delta ? static_cast<int>(tile.differential.dg) : 0)));
+            color[2] = Color::Convert5To8(static_cast<u8>(
+                static_cast<int>(tile.differential.b) +
+                (add_delta ? static_cast<int>(tile.differential.db) : 0)));
+        } else if (half == 0) {
+            color[0] = Color::Convert4To8(static_cast<u8>(tile.separate.r1));
+            color[1] = Color::Convert4To8(static_cast<u8>(tile.separate.g1));
+            color[2] = Color::Convert4To8(static_cast<u8>(tile.separate.b1));
+        } else {
+            color[0] = Color::Convert4To8(static_cast<u8>(tile.separate.r2));
+            color[1] = Color::Convert4To8(static_cast<u8>(tile.separate.g2));
+            color[2] = Color::Convert4To8(static_cast<u8>(tile.separate.b2));
+        }
+
+        info.modifiers[half][0] = etc1_modifier_table[table_indices[half]][0];
+        info.modifiers[half][1] = etc1_modifier_table[table_indices[half]][1];
+    }
+    return info;
+}
+
+ETC1TileDecodeFn GetETC1TileDecodeFn(SimdLevel level) {
+    switch (level) {
+#ifdef ARCHITECTURE_x86_64
+    case SimdLevel::AVX2:
+        return AVX2::DecodeETC1Tile;
+    case SimdLevel::SSE41:
+        return SSE41::DecodeETC1Tile;
+#endif
+    default:
+        return DecodeETC1TileScalar;
+    }
+}
+
 } // namespace Texture
 } // namespace Pica
@@ -6,11 +6,15 @@
 
 #include "common/common_types.h"
 #include "common/vector_math.h"
+#include "video_core/texture/simd.h"
 
 namespace Pica {
 namespace Texture {
 
 Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/// Returns the function decoding ETC1 and ETC1A4 tiles using the given instruction set extensions.
+ETC1TileDecodeFn GetETC1TileDecodeFn(SimdLevel level = GetHostSimdLevel());
+
 } // namespace Texture
 } // namespace Pica
@@ -0,0 +1,92 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/assert.h"
+#include "video_core/texture/morton.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica {
+namespace Texture {
+
+SimdLevel GetHostSimdLevel() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2) {
+        return SimdLevel::AVX2;
+    }
+    if (caps.sse4_1) {
+        return SimdLevel::SSE41;
+    }
+#endif
+    return SimdLevel::None;
+}
+
+template <MortonLayout layout, bool to_linear>
+static void MortonCopyTile(u32 stride, u8* tile, u8* linear) {
+    constexpr u32 bytes_per_pixel = GetMortonBytesPerPixel(layout);
+    constexpr u32 linear_bytes_per_pixel = GetLinearBytesPerPixel(layout);
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            u8* tile_ptr = tile + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+            u8* linear_ptr = linear + ((7 - y) * stride + x) * linear_bytes_per_pixel;
+            if (to_linear) {
+                if (layout == MortonLayout::D24S8) {
+                    linear_ptr[0] = tile_ptr[3];
+                    std::memcpy(linear_ptr + 1, tile_ptr, 3);
+                } else {
+                    std::memcpy(linear_ptr + linear_bytes_per_pixel - bytes_per_pixel, tile_ptr,
+                                bytes_per_pixel);
+                }
+            } else {
+                if (layout == MortonLayout::D24S8) {
+                    std::memcpy(tile_ptr, linear_ptr + 1, 3);
+                    tile_ptr[3] = linear_ptr[0];
+                } else {
+                    std::memcpy(tile_ptr, linear_ptr + linear_bytes_per_pixel - bytes_per_pixel,
+                                bytes_per_pixel);
+                }
+            }
+        }
+    }
+}
+
+template <bool to_linear>
+static MortonCopyTileFn GetScalarMortonCopyTileFn(MortonLayout layout) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        return MortonCopyTile<MortonLayout::Bytes2, to_linear>;
+    case MortonLayout::Bytes3:
+        return MortonCopyTile<MortonLayout::Bytes3, to_linear>;
+    case MortonLayout::Bytes4:
+        return MortonCopyTile<MortonLayout::Bytes4, to_linear>;
+    case MortonLayout::D24:
+        return MortonCopyTile<MortonLayout::D24, to_linear>;
+    case MortonLayout::D24S8:
+        return MortonCopyTile<MortonLayout::D24S8, to_linear>;
+    }
+    UNREACHABLE();
+    return nullptr;
+}
+
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear, SimdLevel level) {
+    switch (level) {
+#ifdef ARCHITECTURE_x86_64
+    case SimdLevel::AVX2:
+        return AVX2::GetMortonCopyTileFn(layout, to_linear);
+    case SimdLevel::SSE41:
+        return SSE41::GetMortonCopyTileFn(layout, to_linear);
+#endif
+    default:
+        return to_linear ? GetScalarMortonCopyTileFn<true>(layout)
+                         : GetScalarMortonCopyTileFn<false>(layout);
+    }
+}
+
+} // namespace Texture
+} // namespace Pica
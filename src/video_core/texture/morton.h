@@ -0,0 +1,40 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "video_core/texture/simd.h"
+
+namespace Pica {
+namespace Texture {
+
+/// Pixel layouts which tiles can be copied with, in Morton order -> linear order
+enum class MortonLayout {
+    Bytes2, ///< 2 bytes per pixel -> same
+    Bytes3, ///< 3 bytes per pixel -> same
+    Bytes4, ///< 4 bytes per pixel -> same
+    D24,    ///< 3 bytes of depth -> last 3 bytes of 4, the first byte is left untouched
+    D24S8,  ///< 3 bytes of depth followed by stencil -> stencil followed by depth
+};
+
+/// Returns the size of a pixel of the layout in Morton order.
+constexpr u32 GetMortonBytesPerPixel(MortonLayout layout) {
+    return layout == MortonLayout::Bytes2
+               ? 2
+               : (layout == MortonLayout::Bytes3 || layout == MortonLayout::D24) ? 3 : 4;
+}
+
+/// Returns the size of a pixel of the layout in linear order.
+constexpr u32 GetLinearBytesPerPixel(MortonLayout layout) {
+    return layout == MortonLayout::Bytes2 ? 2 : layout == MortonLayout::Bytes3 ? 3 : 4;
+}
+
+/// Returns the function copying tiles of the layout from Morton order to linear order, or from
+/// linear order to Morton order, using the given instruction set extensions.
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear,
+                                     SimdLevel level = GetHostSimdLevel());
+
+} // namespace Texture
+} // namespace Pica
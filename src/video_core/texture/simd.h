@@ -0,0 +1,69 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Pica {
+namespace Texture {
+
+enum class MortonLayout;
+
+/**
+ * Copies an 8x8 tile between Morton order and linear order.
+ * @param stride Width in pixels of the linear image
+ * @param tile Pointer to the tile in Morton order
+ * @param linear Pointer to the first pixel of the tile in the linear image. The rows of the tile
+ *               are stored bottom-up, so tile row y is at linear row 7 - y.
+ */
+using MortonCopyTileFn = void (*)(u32 stride, u8* tile, u8* linear);
+
+/**
+ * Decodes an 8x8 ETC1 or ETC1A4 tile.
+ * @param tile Pointer to the four 4x4 blocks of the tile
+ * @param has_alpha Whether the blocks are ETC1A4 blocks
+ * @param dest Receives the 64 RGBA8 texels, row by row starting with y = 0
+ */
+using ETC1TileDecodeFn = void (*)(const u8* tile, bool has_alpha, u8* dest);
+
+/// Values shared by all texels of an ETC1 block, for decoders working on whole blocks
+struct ETC1BlockInfo {
+    /// Whether the block is split into a top and bottom half, rather than a left and right one
+    bool flip;
+    /// Base RGB color of each half of the block
+    u8 base_colors[2][3];
+    /// Modifier magnitudes of each half of the block, selected by the table subindex of a texel
+    u8 modifiers[2][2];
+};
+
+ETC1BlockInfo GetETC1BlockInfo(u64 value);
+
+/// Instruction set extensions the texture conversion routines have implementations for
+enum class SimdLevel {
+    None,
+    SSE41,
+    AVX2,
+};
+
+/// Returns the best instruction set extensions supported by the host CPU.
+SimdLevel GetHostSimdLevel();
+
+#ifdef ARCHITECTURE_x86_64
+// These are built with the corresponding instruction set extensions enabled, so they may only be
+// called after checking that the host supports them.
+
+namespace SSE41 {
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear);
+void DecodeETC1Tile(const u8* tile, bool has_alpha, u8* dest);
+} // namespace SSE41
+
+namespace AVX2 {
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear);
+void DecodeETC1Tile(const u8* tile, bool has_alpha, u8* dest);
+} // namespace AVX2
+#endif // ARCHITECTURE_x86_64
+
+} // namespace Texture
+} // namespace Pica
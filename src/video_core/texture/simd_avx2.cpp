@@ -0,0 +1,261 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is built with AVX2 enabled. To keep code using it from leaking into the rest of the
+// program through inline functions shared with other files, it should only include what it needs.
+
+#include <cstring>
+#include <immintrin.h>
+#include "video_core/texture/morton.h"
+#include "video_core/texture/simd.h"
+
+namespace Pica {
+namespace Texture {
+namespace AVX2 {
+
+namespace {
+
+__m256i Combine(__m128i lo, __m128i hi) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/// Loads 8 consecutive pixels as a vector of 4 byte pixels, see the SSE4.1 version.
+template <MortonLayout layout, bool linear>
+__m256i LoadPixels(const u8* src) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    case MortonLayout::Bytes3:
+    case MortonLayout::D24: {
+        if (linear && layout == MortonLayout::D24) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        }
+        // Both halves stay within the 24 bytes of the pixels, the upper one loads bytes 8-23
+        const __m256i expand =
+            layout == MortonLayout::D24
+                ? _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 4, 5,
+                                   6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15)
+                : _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 4, 5, 6,
+                                   -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+        const __m256i pixels = Combine(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8)));
+        return _mm256_shuffle_epi8(pixels, expand);
+    }
+    case MortonLayout::Bytes4:
+    case MortonLayout::D24S8: {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        if (!linear && layout == MortonLayout::D24S8) {
+            const __m256i rotate =
+                _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14, 3, 0, 1, 2,
+                                 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+            return _mm256_shuffle_epi8(pixels, rotate);
+        }
+        return pixels;
+    }
+    }
+    return _mm256_setzero_si256();
+}
+
+/// Stores 8 consecutive pixels loaded by LoadPixels.
+template <MortonLayout layout, bool linear>
+void StorePixels(u8* dest, __m256i pixels) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+                         _mm_packus_epi32(_mm256_castsi256_si128(pixels),
+                                          _mm256_extracti128_si256(pixels, 1)));
+        break;
+    case MortonLayout::Bytes3:
+    case MortonLayout::D24: {
+        if (linear && layout == MortonLayout::D24) {
+            // Keep the first byte of each pixel
+            const __m256i depth_mask = _mm256_set1_epi32(0xFFFFFF00);
+            __m256i* dest_pixels = reinterpret_cast<__m256i*>(dest);
+            _mm256_storeu_si256(dest_pixels, _mm256_blendv_epi8(_mm256_loadu_si256(dest_pixels),
+                                                                pixels, depth_mask));
+            break;
+        }
+        const __m256i compact =
+            layout == MortonLayout::D24
+                ? _mm256_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1, 1, 2,
+                                   3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1)
+                : _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1,
+                                   2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        pixels = _mm256_shuffle_epi8(pixels, compact);
+        const __m128i lo = _mm256_castsi256_si128(pixels);
+        const __m128i hi = _mm256_extracti128_si256(pixels, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+                         _mm_or_si128(lo, _mm_slli_si128(hi, 12)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 16), _mm_srli_si128(hi, 4));
+        break;
+    }
+    case MortonLayout::Bytes4:
+    case MortonLayout::D24S8:
+        if (!linear && layout == MortonLayout::D24S8) {
+            const __m256i rotate =
+                _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12, 1, 2, 3, 0,
+                                 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+            pixels = _mm256_shuffle_epi8(pixels, rotate);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), pixels);
+        break;
+    }
+}
+
+/**
+ * Same as the SSE4.1 version, with a whole run or row in a vector. Reordering the 64-bit quarters
+ * of a run puts the pixels of row 2n in its lower half and those of row 2n + 1 in its upper half.
+ */
+template <MortonLayout layout, bool to_linear>
+void MortonCopyTile(u32 stride, u8* tile, u8* linear) {
+    constexpr u32 bytes_per_pixel = GetMortonBytesPerPixel(layout);
+    constexpr u32 linear_bytes_per_pixel = GetLinearBytesPerPixel(layout);
+    constexpr u32 run_offsets[4] = {0, 8, 32, 40};
+    constexpr int interleave_rows = _MM_SHUFFLE(3, 1, 2, 0);
+
+    const std::ptrdiff_t row_size = static_cast<std::ptrdiff_t>(stride) * linear_bytes_per_pixel;
+    for (u32 pair = 0; pair < 4; ++pair) {
+        u8* run0 = tile + run_offsets[pair] * bytes_per_pixel;
+        u8* run1 = run0 + 16 * bytes_per_pixel;
+        u8* row0 = linear + (7 - 2 * pair) * row_size;
+        u8* row1 = row0 - row_size;
+
+        if (to_linear) {
+            const __m256i a =
+                _mm256_permute4x64_epi64(LoadPixels<layout, false>(run0), interleave_rows);
+            const __m256i b =
+                _mm256_permute4x64_epi64(LoadPixels<layout, false>(run1), interleave_rows);
+            StorePixels<layout, true>(row0, _mm256_permute2x128_si256(a, b, 0x20));
+            StorePixels<layout, true>(row1, _mm256_permute2x128_si256(a, b, 0x31));
+        } else {
+            const __m256i a = LoadPixels<layout, true>(row0);
+            const __m256i b = LoadPixels<layout, true>(row1);
+            StorePixels<layout, false>(run0, _mm256_permute4x64_epi64(
+                                                 _mm256_permute2x128_si256(a, b, 0x20),
+                                                 interleave_rows));
+            StorePixels<layout, false>(run1, _mm256_permute4x64_epi64(
+                                                 _mm256_permute2x128_si256(a, b, 0x31),
+                                                 interleave_rows));
+        }
+    }
+}
+
+template <bool to_linear>
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        return MortonCopyTile<MortonLayout::Bytes2, to_linear>;
+    case MortonLayout::Bytes3:
+        return MortonCopyTile<MortonLayout::Bytes3, to_linear>;
+    case MortonLayout::Bytes4:
+        return MortonCopyTile<MortonLayout::Bytes4, to_linear>;
+    case MortonLayout::D24:
+        return MortonCopyTile<MortonLayout::D24, to_linear>;
+    case MortonLayout::D24S8:
+        return MortonCopyTile<MortonLayout::D24S8, to_linear>;
+    }
+    return nullptr;
+}
+
+/// Expands two sets of 16 bits into the bytes of each half, set to 0xFF for set bits.
+__m256i ExpandBits(u16 lo_bits, u16 hi_bits) {
+    const __m256i bit_masks = _mm256_set1_epi64x(0x8040201008040201);
+    const __m256i bytes = _mm256_shuffle_epi8(
+        Combine(_mm_cvtsi32_si128(lo_bits), _mm_cvtsi32_si128(hi_bits)),
+        _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                         1, 1, 1, 1, 1, 1, 1));
+    return _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit_masks), bit_masks);
+}
+
+/**
+ * Decodes two horizontally adjacent 4x4 ETC1 blocks into RGBA8 texels, one block in each half of
+ * the vectors, which then hold full rows of 8 texels. See the SSE4.1 version for the details.
+ */
+void DecodeETC1BlockPair(const u8* blocks, bool has_alpha, u8* dest, std::size_t dest_stride) {
+    const std::size_t block_size = has_alpha ? 16 : 8;
+
+    __m256i alpha = _mm256_set1_epi8(-1);
+    if (has_alpha) {
+        const __m256i packed =
+            Combine(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(blocks)),
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blocks + block_size)));
+        const __m256i nibble_mask = _mm256_set1_epi8(0xF);
+        const __m256i nibbles =
+            _mm256_unpacklo_epi8(_mm256_and_si256(packed, nibble_mask),
+                                 _mm256_and_si256(_mm256_srli_epi16(packed, 4), nibble_mask));
+        alpha = _mm256_or_si256(nibbles, _mm256_slli_epi16(nibbles, 4));
+        blocks += 8;
+    }
+
+    u64 values[2];
+    std::memcpy(&values[0], blocks, sizeof(u64));
+    std::memcpy(&values[1], blocks + block_size, sizeof(u64));
+    const ETC1BlockInfo infos[2] = {GetETC1BlockInfo(values[0]), GetETC1BlockInfo(values[1])};
+
+    const __m256i use_subindex_1 =
+        ExpandBits(static_cast<u16>(values[0]), static_cast<u16>(values[1]));
+    const __m256i negate =
+        ExpandBits(static_cast<u16>(values[0] >> 16), static_cast<u16>(values[1] >> 16));
+    const auto get_second_half = [](bool flip) {
+        return flip ? _mm_setr_epi8(0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1)
+                    : _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, -1, -1, -1, -1);
+    };
+    const __m256i second_half =
+        Combine(get_second_half(infos[0].flip), get_second_half(infos[1].flip));
+
+    // Selects per block between a value of the first and second half of the block
+    const auto select = [&second_half](const u8 (&lo)[2], const u8 (&hi)[2]) {
+        return _mm256_blendv_epi8(Combine(_mm_set1_epi8(lo[0]), _mm_set1_epi8(hi[0])),
+                                  Combine(_mm_set1_epi8(lo[1]), _mm_set1_epi8(hi[1])), second_half);
+    };
+    const u8 modifiers_0[2][2] = {{infos[0].modifiers[0][0], infos[0].modifiers[1][0]},
+                                  {infos[1].modifiers[0][0], infos[1].modifiers[1][0]}};
+    const u8 modifiers_1[2][2] = {{infos[0].modifiers[0][1], infos[0].modifiers[1][1]},
+                                  {infos[1].modifiers[0][1], infos[1].modifiers[1][1]}};
+    const __m256i modifier =
+        _mm256_blendv_epi8(select(modifiers_0[0], modifiers_0[1]),
+                           select(modifiers_1[0], modifiers_1[1]), use_subindex_1);
+
+    const __m256i transpose =
+        _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5,
+                         9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    __m256i channels[3];
+    for (int i = 0; i < 3; ++i) {
+        const u8 block_0[2] = {infos[0].base_colors[0][i], infos[0].base_colors[1][i]};
+        const u8 block_1[2] = {infos[1].base_colors[0][i], infos[1].base_colors[1][i]};
+        const __m256i base = select(block_0, block_1);
+        const __m256i color = _mm256_blendv_epi8(_mm256_adds_epu8(base, modifier),
+                                                 _mm256_subs_epu8(base, modifier), negate);
+        channels[i] = _mm256_shuffle_epi8(color, transpose);
+    }
+    alpha = _mm256_shuffle_epi8(alpha, transpose);
+
+    const __m256i rg_lo = _mm256_unpacklo_epi8(channels[0], channels[1]);
+    const __m256i ba_lo = _mm256_unpacklo_epi8(channels[2], alpha);
+    const __m256i rg_hi = _mm256_unpackhi_epi8(channels[0], channels[1]);
+    const __m256i ba_hi = _mm256_unpackhi_epi8(channels[2], alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_unpacklo_epi16(rg_lo, ba_lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + dest_stride),
+                        _mm256_unpackhi_epi16(rg_lo, ba_lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2 * dest_stride),
+                        _mm256_unpacklo_epi16(rg_hi, ba_hi));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 3 * dest_stride),
+                        _mm256_unpackhi_epi16(rg_hi, ba_hi));
+}
+
+} // anonymous namespace
+
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear) {
+    return to_linear ? GetMortonCopyTileFn<true>(layout) : GetMortonCopyTileFn<false>(layout);
+}
+
+void DecodeETC1Tile(const u8* tile, bool has_alpha, u8* dest) {
+    const std::size_t block_size = has_alpha ? 16 : 8;
+    DecodeETC1BlockPair(tile, has_alpha, dest, 8 * 4);
+    DecodeETC1BlockPair(tile + 2 * block_size, has_alpha, dest + 4 * 8 * 4, 8 * 4);
+}
+
+} // namespace AVX2
+} // namespace Texture
+} // namespace Pica
@@ -0,0 +1,248 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is built with SSE4.1 enabled. To keep code using it from leaking into the rest of the
+// program through inline functions shared with other files, it should only include what it needs.
+
+#include <cstring>
+#include <smmintrin.h>
+#include "video_core/texture/morton.h"
+#include "video_core/texture/simd.h"
+
+namespace Pica {
+namespace Texture {
+namespace SSE41 {
+
+namespace {
+
+/**
+ * Loads 8 consecutive pixels as two vectors of 4 pixels of 4 bytes. D24 depth is placed in the
+ * last 3 bytes and D24S8 pixels are in their linear order, so that both sides convert to the same
+ * vectors and only differ by how they load and store them.
+ */
+template <MortonLayout layout, bool linear>
+void LoadPixels(const u8* src, __m128i& lo, __m128i& hi) {
+    switch (layout) {
+    case MortonLayout::Bytes2: {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        lo = _mm_cvtepu16_epi32(pixels);
+        hi = _mm_cvtepu16_epi32(_mm_srli_si128(pixels, 8));
+        break;
+    }
+    case MortonLayout::Bytes3:
+    case MortonLayout::D24: {
+        if (linear && layout == MortonLayout::D24) {
+            lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+            break;
+        }
+        // Both loads stay within the 24 bytes of the pixels, the second one loads bytes 8-23
+        const __m128i expand_lo = layout == MortonLayout::D24
+                                      ? _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9,
+                                                      10, 11)
+                                      : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10,
+                                                      11, -1);
+        const __m128i expand_hi = layout == MortonLayout::D24
+                                      ? _mm_setr_epi8(-1, 4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1,
+                                                      13, 14, 15)
+                                      : _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13,
+                                                      14, 15, -1);
+        lo = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), expand_lo);
+        hi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8)),
+                              expand_hi);
+        break;
+    }
+    case MortonLayout::Bytes4:
+    case MortonLayout::D24S8:
+        lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        if (!linear && layout == MortonLayout::D24S8) {
+            const __m128i rotate =
+                _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+            lo = _mm_shuffle_epi8(lo, rotate);
+            hi = _mm_shuffle_epi8(hi, rotate);
+        }
+        break;
+    }
+}
+
+/// Stores 8 consecutive pixels loaded by LoadPixels.
+template <MortonLayout layout, bool linear>
+void StorePixels(u8* dest, __m128i lo, __m128i hi) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_packus_epi32(lo, hi));
+        break;
+    case MortonLayout::Bytes3:
+    case MortonLayout::D24: {
+        if (linear && layout == MortonLayout::D24) {
+            // Keep the first byte of each pixel
+            const __m128i depth_mask = _mm_set1_epi32(0xFFFFFF00);
+            __m128i* dest_lo = reinterpret_cast<__m128i*>(dest);
+            __m128i* dest_hi = reinterpret_cast<__m128i*>(dest + 16);
+            _mm_storeu_si128(dest_lo, _mm_blendv_epi8(_mm_loadu_si128(dest_lo), lo, depth_mask));
+            _mm_storeu_si128(dest_hi, _mm_blendv_epi8(_mm_loadu_si128(dest_hi), hi, depth_mask));
+            break;
+        }
+        const __m128i compact = layout == MortonLayout::D24
+                                    ? _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1,
+                                                    -1, -1, -1)
+                                    : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1,
+                                                    -1, -1, -1);
+        lo = _mm_shuffle_epi8(lo, compact);
+        hi = _mm_shuffle_epi8(hi, compact);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+                         _mm_or_si128(lo, _mm_slli_si128(hi, 12)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 16), _mm_srli_si128(hi, 4));
+        break;
+    }
+    case MortonLayout::Bytes4:
+    case MortonLayout::D24S8:
+        if (!linear && layout == MortonLayout::D24S8) {
+            const __m128i rotate =
+                _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+            lo = _mm_shuffle_epi8(lo, rotate);
+            hi = _mm_shuffle_epi8(hi, rotate);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16), hi);
+        break;
+    }
+}
+
+/**
+ * Rows 2n and 2n + 1 of a tile are stored in Morton order as two runs of 8 pixels, the second one
+ * 16 pixels after the first. Each run covers 4 columns, in 2x2 blocks of two pixels of row 2n
+ * followed by two pixels of row 2n + 1, so the rows are separated by interleaving 64-bit halves.
+ */
+template <MortonLayout layout, bool to_linear>
+void MortonCopyTile(u32 stride, u8* tile, u8* linear) {
+    constexpr u32 bytes_per_pixel = GetMortonBytesPerPixel(layout);
+    constexpr u32 linear_bytes_per_pixel = GetLinearBytesPerPixel(layout);
+    constexpr u32 run_offsets[4] = {0, 8, 32, 40};
+
+    const std::ptrdiff_t row_size = static_cast<std::ptrdiff_t>(stride) * linear_bytes_per_pixel;
+    for (u32 pair = 0; pair < 4; ++pair) {
+        u8* run0 = tile + run_offsets[pair] * bytes_per_pixel;
+        u8* run1 = run0 + 16 * bytes_per_pixel;
+        u8* row0 = linear + (7 - 2 * pair) * row_size;
+        u8* row1 = row0 - row_size;
+
+        if (to_linear) {
+            __m128i a, b, c, d;
+            LoadPixels<layout, false>(run0, a, b);
+            LoadPixels<layout, false>(run1, c, d);
+            StorePixels<layout, true>(row0, _mm_unpacklo_epi64(a, b), _mm_unpacklo_epi64(c, d));
+            StorePixels<layout, true>(row1, _mm_unpackhi_epi64(a, b), _mm_unpackhi_epi64(c, d));
+        } else {
+            __m128i a, b, c, d;
+            LoadPixels<layout, true>(row0, a, b);
+            LoadPixels<layout, true>(row1, c, d);
+            StorePixels<layout, false>(run0, _mm_unpacklo_epi64(a, c), _mm_unpackhi_epi64(a, c));
+            StorePixels<layout, false>(run1, _mm_unpacklo_epi64(b, d), _mm_unpackhi_epi64(b, d));
+        }
+    }
+}
+
+template <bool to_linear>
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout) {
+    switch (layout) {
+    case MortonLayout::Bytes2:
+        return MortonCopyTile<MortonLayout::Bytes2, to_linear>;
+    case MortonLayout::Bytes3:
+        return MortonCopyTile<MortonLayout::Bytes3, to_linear>;
+    case MortonLayout::Bytes4:
+        return MortonCopyTile<MortonLayout::Bytes4, to_linear>;
+    case MortonLayout::D24:
+        return MortonCopyTile<MortonLayout::D24, to_linear>;
+    case MortonLayout::D24S8:
+        return MortonCopyTile<MortonLayout::D24S8, to_linear>;
+    }
+    return nullptr;
+}
+
+/// Expands 16 bits into 16 bytes, set to 0xFF for set bits.
+__m128i ExpandBits(u16 bits) {
+    const __m128i bit_masks = _mm_set1_epi64x(0x8040201008040201);
+    const __m128i bytes = _mm_shuffle_epi8(_mm_cvtsi32_si128(bits),
+                                           _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1,
+                                                         1, 1));
+    return _mm_cmpeq_epi8(_mm_and_si128(bytes, bit_masks), bit_masks);
+}
+
+/**
+ * Decodes a 4x4 ETC1 block into RGBA8 texels. The texels are first computed in the column-major
+ * order of the block's bit fields, then transposed into rows.
+ */
+void DecodeETC1Block(const u8* block, bool has_alpha, u8* dest, std::size_t dest_stride) {
+    __m128i alpha = _mm_set1_epi8(-1);
+    if (has_alpha) {
+        const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+        const __m128i nibble_mask = _mm_set1_epi8(0xF);
+        const __m128i nibbles =
+            _mm_unpacklo_epi8(_mm_and_si128(packed, nibble_mask),
+                              _mm_and_si128(_mm_srli_epi16(packed, 4), nibble_mask));
+        alpha = _mm_or_si128(nibbles, _mm_slli_epi16(nibbles, 4));
+        block += 8;
+    }
+
+    u64 value;
+    std::memcpy(&value, block, sizeof(u64));
+    const ETC1BlockInfo info = GetETC1BlockInfo(value);
+
+    const __m128i use_subindex_1 = ExpandBits(static_cast<u16>(value));
+    const __m128i negate = ExpandBits(static_cast<u16>(value >> 16));
+    // Texels in the second half of the block: the right half, or the bottom one when flipped
+    const __m128i second_half =
+        info.flip ? _mm_setr_epi8(0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1)
+                  : _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    const auto select = [&second_half](u8 first, u8 second) {
+        return _mm_blendv_epi8(_mm_set1_epi8(first), _mm_set1_epi8(second), second_half);
+    };
+    const __m128i modifier =
+        _mm_blendv_epi8(select(info.modifiers[0][0], info.modifiers[1][0]),
+                        select(info.modifiers[0][1], info.modifiers[1][1]), use_subindex_1);
+
+    const __m128i transpose =
+        _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    __m128i channels[3];
+    for (int i = 0; i < 3; ++i) {
+        const __m128i base = select(info.base_colors[0][i], info.base_colors[1][i]);
+        const __m128i color = _mm_blendv_epi8(_mm_adds_epu8(base, modifier),
+                                              _mm_subs_epu8(base, modifier), negate);
+        channels[i] = _mm_shuffle_epi8(color, transpose);
+    }
+    alpha = _mm_shuffle_epi8(alpha, transpose);
+
+    const __m128i rg_lo = _mm_unpacklo_epi8(channels[0], channels[1]);
+    const __m128i ba_lo = _mm_unpacklo_epi8(channels[2], alpha);
+    const __m128i rg_hi = _mm_unpackhi_epi8(channels[0], channels[1]);
+    const __m128i ba_hi = _mm_unpackhi_epi8(channels[2], alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + dest_stride),
+                     _mm_unpackhi_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * dest_stride),
+                     _mm_unpacklo_epi16(rg_hi, ba_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3 * dest_stride),
+                     _mm_unpackhi_epi16(rg_hi, ba_hi));
+}
+
+} // anonymous namespace
+
+MortonCopyTileFn GetMortonCopyTileFn(MortonLayout layout, bool to_linear) {
+    return to_linear ? GetMortonCopyTileFn<true>(layout) : GetMortonCopyTileFn<false>(layout);
+}
+
+void DecodeETC1Tile(const u8* tile, bool has_alpha, u8* dest) {
+    const std::size_t block_size = has_alpha ? 16 : 8;
+    for (unsigned block = 0; block < 4; ++block) {
+        DecodeETC1Block(tile + block * block_size, has_alpha,
+                        dest + (block / 2 * 4 * 8 + block % 2 * 4) * 4, 8 * 4);
+    }
+}
+
+} // namespace SSE41
+} // namespace Texture
+} // namespace Pica
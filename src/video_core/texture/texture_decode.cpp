@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -212,6 +213,21 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 }
 
+void DecodeTile(const u8* source, const TextureInfo& info, u8* dest) {
+    if (info.format == TextureFormat::ETC1 || info.format == TextureFormat::ETC1A4) {
+        static const ETC1TileDecodeFn decode_etc1_tile = GetETC1TileDecodeFn();
+        decode_etc1_tile(source, info.format == TextureFormat::ETC1A4, dest);
+        return;
+    }
+
+    for (unsigned y = 0; y < 8; ++y) {
+        for (unsigned x = 0; x < 8; ++x) {
+            auto texel = LookupTexelInTile(source, x, y, info, false);
+            std::memcpy(dest + (y * 8 + x) * 4, texel.AsArray(), 4);
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
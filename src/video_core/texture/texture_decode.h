@@ -56,5 +56,14 @@ Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                  const TextureInfo& info, bool disable_alpha);
 
+/**
+ * Decodes all texels of a single 8x8 texture tile.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param info TextureInfo describing the texture format.
+ * @param dest Receives the 64 RGBA8 texels, row by row starting with y = 0.
+ */
+void DecodeTile(const u8* source, const TextureInfo& info, u8* dest);
+
 } // namespace Texture
 } // namespace Pica
@@ -0,0 +1,87 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "video_core/vertex_cache.h"
+
+namespace Pica {
+
+void VertexCache::SetSize(std::size_t size) {
+    std::size_t num_entries = 1;
+    while (num_entries < std::min(size, MAX_SIZE)) {
+        num_entries <<= 1;
+    }
+    if (num_entries == outputs.size()) {
+        return;
+    }
+
+    mask = static_cast<u32>(num_entries - 1);
+    tags.assign(num_entries, {});
+    outputs.resize(num_entries);
+    outputs.shrink_to_fit();
+    chunk_epoch = draw_epoch = 1;
+}
+
+void VertexCache::BeginDraw() {
+    // Everything stored so far was stored before the next chunk
+    draw_epoch = chunk_epoch + 1;
+    stats = {};
+}
+
+void VertexCache::BeginChunk(unsigned max_vertices) {
+    if (++chunk_epoch == 0) {
+        // The epochs wrapped around, start over with an empty cache
+        Clear();
+    }
+    if (pending_entries.size() < max_vertices) {
+        pending_entries.resize(max_vertices);
+    }
+}
+
+VertexCache::LookupResult VertexCache::Lookup(u32 vertex, unsigned& num_shaded) {
+    const u32 entry = vertex & mask;
+    Tag& tag = tags[entry];
+    if (tag.vertex == vertex) {
+        if (tag.claimed_epoch == chunk_epoch) {
+            // Already queued for shading by this chunk
+            ++stats.hits;
+            return {nullptr, tag.shaded_index};
+        }
+        if (tag.stored_epoch >= draw_epoch) {
+            ++stats.hits;
+            tag.used_epoch = chunk_epoch;
+            return {&outputs[entry], 0};
+        }
+    }
+
+    ++stats.misses;
+    const unsigned shaded_index = num_shaded++;
+    if (tag.used_epoch != chunk_epoch && tag.claimed_epoch != chunk_epoch) {
+        // Reserve the entry, unless a previous lookup of this chunk still needs its contents
+        tag.vertex = vertex;
+        tag.claimed_epoch = chunk_epoch;
+        tag.shaded_index = shaded_index;
+        pending_entries[shaded_index] = entry;
+    } else {
+        pending_entries[shaded_index] = NO_ENTRY;
+    }
+    return {nullptr, shaded_index};
+}
+
+void VertexCache::Store(const Shader::AttributeBuffer* shaded_outputs, unsigned num_shaded) {
+    for (unsigned i = 0; i < num_shaded; ++i) {
+        const u32 entry = pending_entries[i];
+        if (entry != NO_ENTRY) {
+            outputs[entry] = shaded_outputs[i];
+            tags[entry].stored_epoch = chunk_epoch;
+        }
+    }
+}
+
+void VertexCache::Clear() {
+    std::fill(tags.begin(), tags.end(), Tag{});
+    chunk_epoch = draw_epoch = 1;
+}
+
+} // namespace Pica
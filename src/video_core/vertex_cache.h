@@ -0,0 +1,93 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica {
+
+/**
+ * Direct-mapped cache of vertex shader outputs for indexed draws, keyed by vertex index.
+ *
+ * Draws are processed in chunks. All indices of a chunk are looked up before any of its vertices
+ * are shaded, which also deduplicates the indices repeated within the chunk. Shaded outputs are
+ * only stored once the chunk has been submitted, so the outputs returned by lookups stay valid
+ * until then and can be submitted without being copied.
+ */
+class VertexCache {
+public:
+    /// Result of a lookup: the cached output, or the position of the vertex among the vertices
+    /// to shade for the current chunk if `output` is null.
+    struct LookupResult {
+        const Shader::AttributeBuffer* output;
+        unsigned shaded_index;
+    };
+
+    struct Stats {
+        u32 hits = 0;   ///< Lookups which didn't require shading the vertex
+        u32 misses = 0; ///< Lookups which added a vertex to shade
+    };
+
+    /// Vertex indices are at most 16 bits, so every vertex of a draw fits in this many entries
+    static constexpr std::size_t MAX_SIZE = 0x10000;
+
+    /// Sets the number of entries, rounded up to a power of two and clamped to MAX_SIZE.
+    /// Invalidates the cache if the size changes.
+    void SetSize(std::size_t size);
+
+    std::size_t GetSize() const {
+        return outputs.size();
+    }
+
+    /// Invalidates all entries and resets the statistics, as outputs can't be reused across draws.
+    void BeginDraw();
+
+    /// Starts a new chunk, which shades up to `max_vertices` vertices.
+    void BeginChunk(unsigned max_vertices);
+
+    /**
+     * Looks up a vertex of the current chunk. If it's neither cached nor already queued for
+     * shading in this chunk, it is queued at position `num_shaded`, which is then incremented.
+     */
+    LookupResult Lookup(u32 vertex, unsigned& num_shaded);
+
+    /// Stores the outputs of the vertices shaded for the current chunk. Invalidates the outputs
+    /// returned by the lookups of the chunk.
+    void Store(const Shader::AttributeBuffer* shaded_outputs, unsigned num_shaded);
+
+    const Stats& GetStats() const {
+        return stats;
+    }
+
+private:
+    static constexpr u32 NO_ENTRY = 0xFFFFFFFF;
+
+    struct Tag {
+        u32 vertex = NO_ENTRY;
+        u32 stored_epoch = 0;  ///< Chunk which stored the output
+        u32 claimed_epoch = 0; ///< Chunk which reserved the entry for a vertex it shades
+        u32 used_epoch = 0;    ///< Last chunk which hit the entry
+        u32 shaded_index = 0;  ///< Position of the vertex to shade, while claimed
+    };
+
+    void Clear();
+
+    u32 mask = 0;
+    std::vector<Tag> tags;
+    std::vector<Shader::AttributeBuffer> outputs;
+
+    /// Entry reserved for each vertex to shade in the current chunk, or NO_ENTRY
+    std::vector<u32> pending_entries;
+
+    /// Incremented for each chunk, entries stored before draw_epoch are stale
+    u32 chunk_epoch = 1;
+    u32 draw_epoch = 1;
+
+    Stats stats;
+};
+
+} // namespace Pica
@@ -71,87 +71,88 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
     is_setup = true;
 }
 
-void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
-                              Shader::AttributeBuffer& input,
-                              DebugUtils::MemoryAccessTracker& memory_accesses) {
+template <typename T>
+static void LoadAttribute(u32 source_address, u32 stride, const u32* vertices, unsigned count,
+                          unsigned elements, std::size_t attribute,
+                          Shader::AttributeBuffer* inputs) {
+    for (unsigned v = 0; v < count; ++v) {
+        const T* srcdata = reinterpret_cast<const T*>(
+            VideoCore::GetMemory().GetPhysicalPointer(source_address + stride * vertices[v]));
+        for (unsigned int comp = 0; comp < elements; ++comp) {
+            inputs[v].attr[attribute][comp] = float24::FromFloat32(srcdata[comp]);
+        }
+    }
+}
+
+void VertexLoader::LoadVertices(u32 base_address, const u32* vertices, unsigned count,
+                                Shader::AttributeBuffer* inputs,
+                                DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
     for (int i = 0; i < num_total_attributes; ++i) {
         if (vertex_attribute_elements[i] != 0) {
             // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+            const u32 source_address = base_address + vertex_attribute_sources[i];
+            const u32 stride = vertex_attribute_strides[i];
+            const u32 elements = vertex_attribute_elements[i];
 
             if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(
-                    source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
-                             ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
-                                   ? 2
-                                   : 1));
+                const u32 size =
+                    elements *
+                    ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
+                         ? 4
+                         : (vertex_attribute_formats[i] ==
+                            PipelineRegs::VertexAttributeFormat::SHORT)
+                               ? 2
+                               : 1);
+                for (unsigned v = 0; v < count; ++v) {
+                    memory_accesses.AddAccess(source_address + stride * vertices[v], size);
+                }
             }
 
             switch (vertex_attribute_formats[i]) {
-            case PipelineRegs::VertexAttributeFormat::BYTE: {
-                const s8* srcdata = reinterpret_cast<const s8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::BYTE:
+                LoadAttribute<s8>(source_address, stride, vertices, count, elements, i, inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::UBYTE: {
-                const u8* srcdata = reinterpret_cast<const u8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::UBYTE:
+                LoadAttribute<u8>(source_address, stride, vertices, count, elements, i, inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::SHORT: {
-                const s16* srcdata = reinterpret_cast<const s16*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::SHORT:
+                LoadAttribute<s16>(source_address, stride, vertices, count, elements, i, inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::FLOAT: {
-                const float* srcdata = reinterpret_cast<const float*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::FLOAT:
+                LoadAttribute<float>(source_address, stride, vertices, count, elements, i, inputs);
                 break;
             }
-            }
 
-            // Default attribute values set if array elements have < 4 components. This
-            // is *not* carried over from the default attribute settings even if they're
-            // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
-                input.attr[i][comp] =
-                    comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
-            }
+            for (unsigned v = 0; v < count; ++v) {
+                Shader::AttributeBuffer& input = inputs[v];
 
-            LOG_TRACE(HW_GPU,
-                      "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
-                      "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
+                // Default attribute values set if array elements have < 4 components. This
+                // is *not* carried over from the default attribute settings even if they're
+                // enabled for this attribute.
+                for (unsigned int comp = elements; comp < 4; ++comp) {
+                    input.attr[i][comp] =
+                        comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+                }
+
+                LOG_TRACE(HW_GPU,
+                          "Loaded {} components of attribute {:x} for vertex {:x} from "
+                          "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
+                          elements, i, vertices[v], base_address, vertex_attribute_sources[i],
+                          stride * vertices[v], input.attr[i][0].ToFloat32(),
+                          input.attr[i][1].ToFloat32(), input.attr[i][2].ToFloat32(),
+                          input.attr[i][3].ToFloat32());
+            }
         } else if (vertex_attribute_is_default[i]) {
             // Load the default attribute if we're configured to do so
-            input.attr[i] = g_state.input_default_attributes.attr[i];
-            LOG_TRACE(
-                HW_GPU,
-                "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, {}, {})", i,
-                vertex, index, input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
+            for (unsigned v = 0; v < count; ++v) {
+                inputs[v].attr[i] = GetState().input_default_attributes.attr[i];
+                LOG_TRACE(HW_GPU, "Loaded default attribute {:x} for vertex {:x}: ({}, {}, {}, {})",
+                          i, vertices[v], inputs[v].attr[i][0].ToFloat32(),
+                          inputs[v].attr[i][1].ToFloat32(), inputs[v].attr[i][2].ToFloat32(),
+                          inputs[v].attr[i][3].ToFloat32());
+            }
         } else {
             // TODO(yuriks): In this case, no data gets loaded and the vertex
             // remains with the last value it had. This isn't currently maintained
@@ -22,8 +22,19 @@ public:
     }
 
     void Setup(const PipelineRegs& regs);
-    void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
-                    DebugUtils::MemoryAccessTracker& memory_accesses);
+
+    /**
+     * Loads the attributes of several vertices. Attributes are gathered one at a time for all
+     * vertices, so that the format dispatch only happens once per attribute.
+     * @param base_address Physical base address of the vertex arrays
+     * @param vertices Indices of the vertices to load
+     * @param count Number of vertices to load
+     * @param inputs Attribute buffers receiving the loaded vertices, one per vertex
+     * @param memory_accesses Tracker recording the memory reads, used by the debugger
+     */
+    void LoadVertices(u32 base_address, const u32* vertices, unsigned count,
+                      Shader::AttributeBuffer* inputs,
+                      DebugUtils::MemoryAccessTracker& memory_accesses);
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
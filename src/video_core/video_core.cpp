@@ -5,9 +5,13 @@
 #include <memory>
 #include "common/logging/log.h"
 #include "core/settings.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
+#include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/renderer_software/renderer_software.h"
+#include "video_core/swrasterizer/tile_rasterizer.h"
 #include "video_core/video_core.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -15,33 +19,44 @@
 
 namespace VideoCore {
 
-std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
-
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
 std::atomic<bool> g_hw_shader_enabled;
 std::atomic<bool> g_hw_shader_accurate_gs;
 std::atomic<bool> g_hw_shader_accurate_mul;
+std::atomic<u16> g_sw_rasterizer_threads;
+std::atomic<u32> g_vertex_cache_size;
+std::atomic<u32> g_surface_cache_budget;
 std::atomic<bool> g_renderer_bg_color_update_requested;
-// Screenshot
-std::atomic<bool> g_renderer_screenshot_requested;
-void* g_screenshot_bits;
-std::function<void()> g_screenshot_complete_callback;
-Layout::FramebufferLayout g_screenshot_framebuffer_layout;
 
-Memory::MemorySystem* g_memory;
+InstanceState::InstanceState() : pica_state(std::make_unique<Pica::State>()) {}
+
+InstanceState::~InstanceState() = default;
 
 /// Initialize the video core
 Core::System::ResultStatus Init(EmuWindow& emu_window, Memory::MemorySystem& memory) {
-    g_memory = &memory;
+    InstanceState& state = GetInstanceState();
+    state.memory = &memory;
     Pica::Init();
 
-    g_renderer = std::make_unique<OpenGL::RendererOpenGL>(emu_window);
-    Core::System::ResultStatus result = g_renderer->Init();
+    switch (Settings::values.renderer_backend) {
+    case Settings::RendererBackend::Null:
+    case Settings::RendererBackend::Software:
+        state.renderer = std::make_unique<RendererSoftware>(
+            emu_window, Settings::values.renderer_backend == Settings::RendererBackend::Software);
+        break;
+    default:
+        state.renderer = std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+        break;
+    }
+    Core::System::ResultStatus result = state.renderer->Init();
 
     if (result != Core::System::ResultStatus::Success) {
         LOG_ERROR(Render, "initialization failed !");
     } else {
+        if (Settings::values.use_gpu_thread) {
+            state.gpu_thread = std::make_unique<GPUThread>(emu_window);
+        }
         LOG_DEBUG(Render, "initialized OK");
     }
 
@@ -50,29 +65,43 @@ Core::System::ResultStatus Init(EmuWindow& emu_window, Memory::MemorySystem& mem
 
 /// Shutdown the video core
 void Shutdown() {
+    InstanceState& state = GetInstanceState();
+
+    // Finish the queued GPU work and take the graphics context back before tearing down
+    state.gpu_thread.reset();
+
     Pica::Shutdown();
 
-    g_renderer.reset();
+    state.renderer.reset();
 
     LOG_DEBUG(Render, "shutdown OK");
 }
 
+void RunOnRendererThread(const std::function<void()>& function) {
+    if (const auto& gpu_thread = GetGPUThread()) {
+        gpu_thread->SyncCommand(function);
+    } else {
+        function();
+    }
+}
+
 void RequestScreenshot(void* data, std::function<void()> callback,
                        const Layout::FramebufferLayout& layout) {
-    if (g_renderer_screenshot_requested) {
+    InstanceState& state = GetInstanceState();
+    if (state.renderer_screenshot_requested) {
         LOG_ERROR(Render, "A screenshot is already requested or in progress, ignoring the request");
         return;
     }
-    g_screenshot_bits = data;
-    g_screenshot_complete_callback = std::move(callback);
-    g_screenshot_framebuffer_layout = layout;
-    g_renderer_screenshot_requested = true;
+    state.screenshot_bits = data;
+    state.screenshot_complete_callback = std::move(callback);
+    state.screenshot_framebuffer_layout = layout;
+    state.renderer_screenshot_requested = true;
 }
 
 u16 GetResolutionScaleFactor() {
     if (g_hw_renderer_enabled) {
         return !Settings::values.resolution_factor
-                   ? g_renderer->GetRenderWindow().GetFramebufferLayout().GetScalingRatio()
+                   ? GetRenderer()->GetRenderWindow().GetFramebufferLayout().GetScalingRatio()
                    : Settings::values.resolution_factor;
     } else {
         // Software renderer always render at native resolution
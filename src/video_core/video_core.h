@@ -5,6 +5,7 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
@@ -16,12 +17,55 @@ namespace Memory {
 class MemorySystem;
 }
 
+namespace Pica {
+struct State;
+namespace Rasterizer {
+class TileRasterizer;
+}
+} // namespace Pica
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Video Core namespace
 
 namespace VideoCore {
 
-extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+class GPUThread;
+
+/// Video core state of one emulator instance, owned by its Core::System
+struct InstanceState {
+    InstanceState();
+    ~InstanceState();
+
+    std::unique_ptr<Pica::State> pica_state;
+    std::unique_ptr<RendererBase> renderer; ///< Renderer plugin
+    std::unique_ptr<GPUThread> gpu_thread;  ///< Asynchronous GPU thread, if enabled
+    /// Worker threads of the software rasterizer, if it uses more than one thread
+    std::unique_ptr<Pica::Rasterizer::TileRasterizer> tile_rasterizer;
+    Memory::MemorySystem* memory = nullptr;
+
+    // Screenshot
+    std::atomic<bool> renderer_screenshot_requested{false};
+    void* screenshot_bits = nullptr;
+    std::function<void()> screenshot_complete_callback;
+    Layout::FramebufferLayout screenshot_framebuffer_layout{};
+};
+
+/// Gets the video core state of the System bound to the calling thread
+inline InstanceState& GetInstanceState() {
+    return Core::System::GetInstance().VideoState();
+}
+
+inline std::unique_ptr<RendererBase>& GetRenderer() {
+    return GetInstanceState().renderer;
+}
+
+inline std::unique_ptr<GPUThread>& GetGPUThread() {
+    return GetInstanceState().gpu_thread;
+}
+
+inline Memory::MemorySystem& GetMemory() {
+    return *GetInstanceState().memory;
+}
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
@@ -30,14 +74,10 @@ extern std::atomic<bool> g_shader_jit_enabled;
 extern std::atomic<bool> g_hw_shader_enabled;
 extern std::atomic<bool> g_hw_shader_accurate_gs;
 extern std::atomic<bool> g_hw_shader_accurate_mul;
+extern std::atomic<u16> g_sw_rasterizer_threads;
+extern std::atomic<u32> g_vertex_cache_size;
+extern std::atomic<u32> g_surface_cache_budget;
 extern std::atomic<bool> g_renderer_bg_color_update_requested;
-// Screenshot
-extern std::atomic<bool> g_renderer_screenshot_requested;
-extern void* g_screenshot_bits;
-extern std::function<void()> g_screenshot_complete_callback;
-extern Layout::FramebufferLayout g_screenshot_framebuffer_layout;
-
-extern Memory::MemorySystem* g_memory;
 
 /// Initialize the video core
 Core::System::ResultStatus Init(EmuWindow& emu_window, Memory::MemorySystem& memory);
@@ -45,6 +85,12 @@ Core::System::ResultStatus Init(EmuWindow& emu_window, Memory::MemorySystem& mem
 /// Shutdown the video core
 void Shutdown();
 
+/**
+ * Runs a function that accesses the renderer on the thread owning it, after all GPU work queued so
+ * far, and returns once it has finished. Without the GPU thread the function is called directly.
+ */
+void RunOnRendererThread(const std::function<void()>& function);
+
 /// Request a screenshot of the next frame
 void RequestScreenshot(void* data, std::function<void()> callback,
                        const Layout::FramebufferLayout& layout);